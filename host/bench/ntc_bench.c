@@ -0,0 +1,297 @@
+// Hot path benchmarks on the host build, results are written as JSON for per-commit tracking
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "mock_host.h"
+#include "mock_internal.h"
+#include "ntc_adc.h"
+#include "lcd.h"
+#include "events.h"
+#include "state_manager.h"
+#include "nvs_manager.h"
+#include "alarm_manager.h"
+#include "captive_portal.h"
+#include "hd44780_emu.h"
+
+#define BENCH_RAW_TRACE_MAX 65536
+#define BENCH_HTTP_RESPONSE_SIZE 16384
+
+typedef struct {
+    const char *adc_trace;      // Raw DMA frames as written by ntc_host --adc-record
+    const char *output;         // JSON file, stdout when NULL
+    const char *label;          // Free-form run label, e.g. the commit hash
+    uint32_t iterations;        // Iterations of the pure function benchmarks
+    uint32_t frame_seconds;     // Acquisition run time of the frame processing benchmark
+    uint32_t render_frames;     // lcd_render() calls
+    bool verbose;
+} bench_options_t;
+
+static volatile float float_sink;
+static volatile int int_sink;
+
+static int64_t now_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Raw readings decoded from the trace, or a sweep of the ADC range without one
+static size_t load_raw_trace(const char *path, uint16_t *raws, size_t max_raws) {
+    size_t count = 0;
+    FILE *file = path != NULL ? fopen(path, "rb") : NULL;
+    if (file != NULL) {
+        adc_digi_output_data_t data;
+        while (count < max_raws && fread(&data, sizeof(data), 1, file) == 1) {
+#if CONFIG_IDF_TARGET_ESP32
+            raws[count++] = data.type1.data;
+#else
+            raws[count++] = data.type2.data;
+#endif
+        }
+        fclose(file);
+    }
+    if (count == 0) {
+        for (count = 0; count < 4096 && count < max_raws; count++) {
+            raws[count] = count;
+        }
+    }
+    return count;
+}
+
+static void bench_raw_to_temperature(FILE *out, const uint16_t *raws, size_t raw_count, uint32_t iterations) {
+    float sum = 0;
+    int64_t start = now_ns(CLOCK_MONOTONIC);
+    for (uint32_t i = 0; i < iterations; i++) {
+        sum += ntc_adc_raw_to_temperature(raws[i % raw_count]);
+    }
+    int64_t elapsed = now_ns(CLOCK_MONOTONIC) - start;
+    float_sink = sum;
+
+    fprintf(out, "    \"raw_to_temperature\": {\"iterations\": %lu, \"trace_samples\": %zu, \"ns_per_op\": %.2f, \"ops_per_s\": %.0f},\n",
+            (unsigned long)iterations, raw_count, (double)elapsed / iterations, iterations * 1e9 / elapsed);
+}
+
+static void bench_format_temperature(FILE *out, const uint16_t *raws, size_t raw_count, uint32_t iterations) {
+    // Temperatures are converted up front so only the formatting is timed
+    float temperatures[256];
+    size_t count = raw_count < 256 ? raw_count : 256;
+    for (size_t i = 0; i < count; i++) {
+        temperatures[i] = ntc_adc_raw_to_temperature(raws[i * raw_count / count]);
+    }
+
+    char buffer[8];
+    int checksum = 0;
+    int64_t start = now_ns(CLOCK_MONOTONIC);
+    for (uint32_t i = 0; i < iterations; i++) {
+        lcd_format_temperature(temperatures[i % count], buffer, sizeof(buffer));
+        checksum += buffer[4];
+    }
+    int64_t elapsed = now_ns(CLOCK_MONOTONIC) - start;
+    int_sink = checksum;
+
+    fprintf(out, "    \"lcd_format_temperature\": {\"iterations\": %lu, \"ns_per_op\": %.2f, \"ops_per_s\": %.0f},\n",
+            (unsigned long)iterations, (double)elapsed / iterations, iterations * 1e9 / elapsed);
+}
+
+// Runs the real acquisition task on the (replayed) mock ADC and charges its CPU time to the frames
+static void bench_process_frames(FILE *out, uint32_t seconds) {
+    alarm_initialize();
+    ntc_adc_initialize();
+    vTaskDelay(pdMS_TO_TICKS(200)); // Let the task configure and start the ADC
+
+    TaskHandle_t task = xTaskGetHandle("temperature_task");
+    ntc_adc_stats_t before = ntc_adc_get_stats();
+    uint32_t cpu_before = ulTaskGetRunTimeCounter(task);
+    vTaskDelay(pdMS_TO_TICKS(seconds * 1000));
+    uint32_t cpu_used = ulTaskGetRunTimeCounter(task) - cpu_before;
+    ntc_adc_stats_t after = ntc_adc_get_stats();
+
+    uint32_t frames = after.frames_processed - before.frames_processed;
+    uint32_t samples = after.samples_processed - before.samples_processed;
+    uint32_t publishes = after.publish_count - before.publish_count;
+    fprintf(out, "    \"process_frames\": {\"frames\": %lu, \"samples\": %lu, \"publishes\": %lu, \"pool_overflows\": %lu, "
+                 "\"cpu_us_per_frame\": %.2f, \"cpu_ns_per_sample\": %.2f},\n",
+            (unsigned long)frames, (unsigned long)samples, (unsigned long)publishes,
+            (unsigned long)(after.pool_overflows - before.pool_overflows),
+            frames ? (double)cpu_used / frames : 0.0, samples ? cpu_used * 1000.0 / samples : 0.0);
+}
+
+static hd44780_emu_t lcd_emu;
+
+static esp_err_t lcd_emu_tx_hook(uint16_t address, const uint8_t *data, size_t size, void *ctx) {
+    if (address == LCD_I2C_ADDRESS) {
+        hd44780_emu_feed(&lcd_emu, data, size);
+    }
+    return ESP_OK;
+}
+
+static void bench_lcd_render(FILE *out, uint32_t frames) {
+    static const char *const expected[LCD_ROWS] = { "T1  25.0C  T2  25.1C", "", "", "" };
+
+    i2c_initialize();
+    lcd_clear_buffer();
+    lcd_write_text(expected[0]);
+
+    hd44780_emu_init_4bit(&lcd_emu); // lcd_initialize() would start the update task
+    mock_i2c_set_tx_hook(lcd_emu_tx_hook, NULL);
+    lcd_render(); // Backlight and the first frame, later frames without a change send nothing
+    mock_i2c_clear_streams();
+    hd44780_emu_reset_stats(&lcd_emu);
+    int64_t wall_start = now_ns(CLOCK_MONOTONIC);
+    int64_t cpu_start = now_ns(CLOCK_THREAD_CPUTIME_ID);
+    for (uint32_t i = 0; i < frames; i++) {
+        lcd_invalidate(); // Full frames, the cost of a screen change
+        lcd_render();
+    }
+    int64_t cpu_elapsed = now_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+    int64_t wall_elapsed = now_ns(CLOCK_MONOTONIC) - wall_start;
+
+    const uint8_t *stream;
+    size_t bytes = mock_i2c_get_stream(LCD_I2C_ADDRESS, &stream);
+    uint32_t transactions = mock_i2c_get_transaction_count(LCD_I2C_ADDRESS);
+    hd44780_emu_stats_t lcd_stats = hd44780_emu_get_stats(&lcd_emu);
+    mock_i2c_set_tx_hook(NULL, NULL);
+
+    // The emulated glass must show the buffer, otherwise the numbers are meaningless
+    fprintf(out, "    \"lcd_render\": {\"frames\": %lu, \"i2c_bytes_per_frame\": %.1f, \"i2c_transactions_per_frame\": %.1f, "
+                 "\"bus_ms_per_frame\": %.3f, \"lcd_writes_per_frame\": %.1f, \"screen_ok\": %s, "
+                 "\"wall_ms_per_frame\": %.3f, \"cpu_us_per_frame\": %.2f},\n",
+            (unsigned long)frames, (double)bytes / frames, (double)transactions / frames,
+            lcd_stats.bus_time_ns / 1e6 / frames, (double)(lcd_stats.commands + lcd_stats.data_writes) / frames,
+            hd44780_emu_screen_equals(&lcd_emu, expected) ? "true" : "false",
+            wall_elapsed / 1e6 / frames, cpu_elapsed / 1e3 / frames);
+}
+
+static void bench_dns(FILE *out, uint32_t iterations) {
+    // Standard query for captive.apple.com, type A, class IN
+    static const char query[] = "\x12\x34\x01\x00\x00\x01\x00\x00\x00\x00\x00\x00"
+                                "\x07" "captive" "\x05" "apple" "\x03" "com" "\x00"
+                                "\x00\x01\x00\x01";
+    char packet[512];
+    int total = 0;
+
+    int64_t start = now_ns(CLOCK_MONOTONIC);
+    for (uint32_t i = 0; i < iterations; i++) {
+        memcpy(packet, query, sizeof(query) - 1);
+        total += cp_dns_build_response(packet, sizeof(query) - 1, sizeof(packet));
+    }
+    int64_t elapsed = now_ns(CLOCK_MONOTONIC) - start;
+    int_sink = total;
+
+    fprintf(out, "    \"dns_response\": {\"iterations\": %lu, \"ns_per_op\": %.2f, \"ops_per_s\": %.0f},\n",
+            (unsigned long)iterations, (double)elapsed / iterations, iterations * 1e9 / elapsed);
+}
+
+static void bench_http(FILE *out, uint32_t iterations) {
+    static const char *uris[] = { "/", "/generate_204", "/hotspot-detect.html", "/connecttest.txt" };
+    const int uri_count = sizeof(uris) / sizeof(uris[0]);
+    char *response = malloc(BENCH_HTTP_RESPONSE_SIZE);
+    size_t response_bytes = 0;
+    int status;
+
+    cp_start_http_server();
+    int64_t start = now_ns(CLOCK_MONOTONIC);
+    for (uint32_t i = 0; i < iterations; i++) {
+        mock_httpd_request(HTTP_GET, uris[i % uri_count], NULL, response, BENCH_HTTP_RESPONSE_SIZE, &status);
+        response_bytes += strlen(response);
+    }
+    int64_t elapsed = now_ns(CLOCK_MONOTONIC) - start;
+    cp_stop_http_server();
+    free(response);
+
+    fprintf(out, "    \"http_request\": {\"iterations\": %lu, \"ns_per_op\": %.2f, \"ops_per_s\": %.0f, \"bytes_per_response\": %.1f}\n",
+            (unsigned long)iterations, (double)elapsed / iterations, iterations * 1e9 / elapsed,
+            (double)response_bytes / iterations);
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n"
+           "  --adc-trace FILE     Raw DMA frames to convert and replay (ntc_host --adc-record)\n"
+           "  --output FILE        Write the JSON results to FILE instead of stdout\n"
+           "  --label TEXT         Label stored with the results, e.g. a commit hash\n"
+           "  --iterations N       Iterations of the conversion, formatting, DNS and HTTP benchmarks\n"
+           "  --frame-seconds N    Acquisition run time of the frame processing benchmark\n"
+           "  --render-frames N    lcd_render() calls\n"
+           "  --verbose            Keep the application log on stdout\n",
+           program);
+}
+
+static bool parse_options(int argc, char **argv, bench_options_t *options) {
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--adc-trace") == 0 && has_value) {
+            options->adc_trace = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && has_value) {
+            options->output = argv[++i];
+        } else if (strcmp(argv[i], "--label") == 0 && has_value) {
+            options->label = argv[++i];
+        } else if (strcmp(argv[i], "--iterations") == 0 && has_value) {
+            options->iterations = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--frame-seconds") == 0 && has_value) {
+            options->frame_seconds = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--render-frames") == 0 && has_value) {
+            options->render_frames = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            options->verbose = true;
+        } else {
+            return false;
+        }
+    }
+    return options->iterations > 0 && options->render_frames > 0;
+}
+
+int main(int argc, char **argv) {
+    bench_options_t options = {
+        .iterations = 1000000,
+        .frame_seconds = 2,
+        .render_frames = 5,
+    };
+    if (!parse_options(argc, argv, &options)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+    if (!options.verbose) {
+        esp_log_level_set("*", ESP_LOG_NONE); // Keep stdout parseable
+    }
+
+    static uint16_t raws[BENCH_RAW_TRACE_MAX];
+    size_t raw_count = load_raw_trace(options.adc_trace, raws, BENCH_RAW_TRACE_MAX);
+    if (options.adc_trace != NULL && mock_adc_replay_load(options.adc_trace) != ESP_OK) {
+        fprintf(stderr, "Cannot load ADC trace %s\n", options.adc_trace);
+        return 1;
+    }
+
+    FILE *out = options.output != NULL ? fopen(options.output, "w") : stdout;
+    if (out == NULL) {
+        fprintf(stderr, "Cannot write %s\n", options.output);
+        return 1;
+    }
+
+    // Same bring-up as app_main(), without Wi-Fi and the display task
+    mock_task_adopt_thread("main", 1);
+    state_initialize();
+    nvs_initialize();
+    read_running_config();
+    events_init();
+    ntc_init_mutex();
+
+    fprintf(out, "{\n  \"label\": \"%s\",\n  \"adc_trace\": \"%s\",\n  \"benchmarks\": {\n",
+            options.label != NULL ? options.label : "", options.adc_trace != NULL ? options.adc_trace : "");
+    bench_raw_to_temperature(out, raws, raw_count, options.iterations);
+    bench_format_temperature(out, raws, raw_count, options.iterations);
+    bench_lcd_render(out, options.render_frames);
+    bench_process_frames(out, options.frame_seconds);
+    bench_dns(out, options.iterations);
+    bench_http(out, options.iterations / 10 > 0 ? options.iterations / 10 : 1);
+    fprintf(out, "  }\n}\n");
+
+    fflush(out);
+    if (out != stdout) {
+        fclose(out);
+    }
+    _Exit(0); // Tasks are endless loops, do not run destructors under them
+}
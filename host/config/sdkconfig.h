@@ -0,0 +1,119 @@
+/*
+ * Host build configuration.
+ *
+ * Mirrors the defaults of main/Kconfig.projbuild and sdkconfig.defaults for an ESP32 board,
+ * the mocks emulate that target (ADC output format TYPE1, a single DMA capable ADC unit). Keep
+ * in sync when options are added to Kconfig.projbuild.
+ */
+#pragma once
+
+// Target
+#define CONFIG_IDF_TARGET "esp32"
+#define CONFIG_IDF_TARGET_ESP32 1
+#define CONFIG_FREERTOS_HZ 1000
+#define CONFIG_FREERTOS_USE_TRACE_FACILITY 1
+#define CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS 1
+#define CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID 1
+#define CONFIG_ESP_CONSOLE_UART 1
+#define CONFIG_ESP_CONSOLE_UART_NUM 0
+
+// Application WiFi settings
+#define CONFIG_DEFAULT_STA_SSID "my_wifi"
+#define CONFIG_DEFAULT_STA_PASSWORD "my_password"
+#define CONFIG_DEFAULT_AP_SSID "ESP32-AP"
+#define CONFIG_DEFAULT_AP_PASSWORD "12345678"
+#define CONFIG_DEFAULT_AP_CHANNEL 1
+#define CONFIG_WIFI_RSSI_POLL_S 10
+
+// Application power settings
+#define CONFIG_POWER_BACKLIGHT_TIMEOUT_S 0
+#define CONFIG_POWER_STATS_LOG_INTERVAL_S 60
+
+// Application ADC settings
+#define CONFIG_NTC_ADC_ACQ_CONTINUOUS 1
+#define CONFIG_NTC_ADC_BURST_SAMPLES 16
+#define CONFIG_NTC_ADC_BURST_INTERVAL_MS 1000
+#define CONFIG_NTC_CHANNEL_COUNT 6
+#define CONFIG_NTC_CHANNEL_ENABLE_MASK 0xFF
+#define CONFIG_NTC_CHANNEL_1_ADC_CHANNEL 0
+#define CONFIG_NTC_CHANNEL_2_ADC_CHANNEL 3
+#define CONFIG_NTC_CHANNEL_3_ADC_CHANNEL 6
+#define CONFIG_NTC_CHANNEL_4_ADC_CHANNEL 7
+#define CONFIG_NTC_CHANNEL_5_ADC_CHANNEL 4
+#define CONFIG_NTC_CHANNEL_6_ADC_CHANNEL 5
+#define CONFIG_NTC_CHANNEL_1_NAME "T1"
+#define CONFIG_NTC_CHANNEL_2_NAME "T2"
+#define CONFIG_NTC_CHANNEL_3_NAME "T3"
+#define CONFIG_NTC_CHANNEL_4_NAME "T4"
+#define CONFIG_NTC_CHANNEL_5_NAME "T5"
+#define CONFIG_NTC_CHANNEL_6_NAME "T6"
+#define CONFIG_NTC_ADC_CONV_FRAME_SIZE 256
+#define CONFIG_NTC_ADC_POOL_SIZE 1024
+#define CONFIG_NTC_FAULT_RAW_MARGIN 16
+#define CONFIG_NTC_FAULT_STUCK_PUBLISHES 10
+
+// Application sensor drivers
+#define CONFIG_NTC_RTD_PT100_R_REF 1000
+#define CONFIG_NTC_RTD_PT1000_R_REF 10000
+
+// Application alarm settings
+#define CONFIG_ALARM_ENABLE 1
+#define CONFIG_ALARM_HIGH_LIMIT_C 85
+#define CONFIG_ALARM_LOW_LIMIT_C -10
+#define CONFIG_ALARM_HYSTERESIS_DECI_C 10
+#define CONFIG_ALARM_MIN_DURATION_MS 2000
+#define CONFIG_ALARM_RATE_LIMIT_C_PER_MIN 0
+#define CONFIG_ALARM_RATE_HYSTERESIS_DECI_C_PER_MIN 5
+#define CONFIG_ALARM_RATE_WINDOW_MS 10000
+
+// Application display settings
+#define CONFIG_LCD_I2C_ADDRESS 0x27
+#define CONFIG_LCD_I2C_FREQ_HZ 400000
+#define CONFIG_LCD_I2C_FALLBACK_ERRORS 3
+#define CONFIG_LCD_I2C_TIMEOUT_MS 20
+#define CONFIG_LCD_SECOND_I2C_ADDRESS 0x0
+
+// Application history settings
+#define CONFIG_HISTORY_PERIOD_S 30
+#define CONFIG_HISTORY_DEPTH 24
+#define CONFIG_BUTTON_DEBOUNCE_MS 50
+#define CONFIG_BUTTON_LONG_PRESS_MS 3000
+#define CONFIG_BUTTON_DOUBLE_CLICK_MS 300
+#define CONFIG_BUTTON_REPEAT_MS 250
+#define CONFIG_BUTTON_UP_GPIO -1
+#define CONFIG_BUTTON_DOWN_GPIO -1
+#define CONFIG_MENU_TIMEOUT_S 60
+
+// Application boot settings
+#define CONFIG_BOOT_WORKERS 2
+#define CONFIG_BOOT_WORKER_STACK_SIZE 4096
+#define CONFIG_BOOT_FIRST_READING_TIMEOUT_MS 1000
+
+// Application task settings
+#define CONFIG_TASK_TEMPERATURE_STACK 4096
+#define CONFIG_TASK_TEMPERATURE_PRIORITY 10
+#define CONFIG_TASK_TEMPERATURE_CORE 1
+#define CONFIG_TASK_LCD_STACK 4096
+#define CONFIG_TASK_LCD_PRIORITY 4
+#define CONFIG_TASK_LCD_CORE 1
+#define CONFIG_TASK_BUTTON_STACK 2048
+#define CONFIG_TASK_BUTTON_PRIORITY 6
+#define CONFIG_TASK_BUTTON_CORE 0
+#define CONFIG_TASK_DNS_STACK 4096
+#define CONFIG_TASK_DNS_PRIORITY 5
+#define CONFIG_TASK_DNS_CORE 0
+#define CONFIG_TASK_EVENTS_STACK 3072
+#define CONFIG_TASK_EVENTS_PRIORITY 1
+#define CONFIG_TASK_EVENTS_CORE 0
+#define CONFIG_TASK_CLI_STACK 4096
+#define CONFIG_TASK_CLI_PRIORITY 2
+#define CONFIG_TASK_CLI_CORE 0
+
+// Application heap monitor
+#define CONFIG_HEAP_MONITOR_INTERVAL_S 10
+#define CONFIG_HEAP_MONITOR_HISTORY 60
+#define CONFIG_HEAP_FRAG_SPIKE_PCT 50
+
+// Application console settings
+#define CONFIG_CLI_UART 1
+#define CONFIG_CLI_LINE_LENGTH 128
@@ -0,0 +1,200 @@
+#include "hd44780_emu.h"
+#include <string.h>
+
+// I2C bits per transaction: start, address byte and ACK, stop. Each data byte adds 8 bits and ACK.
+#define I2C_FRAME_OVERHEAD_BITS (1 + 9 + 1)
+#define I2C_BITS_PER_BYTE 9
+
+static const uint8_t row_offsets[LCD_ROWS] = LCD_ROW_OFFSET;
+
+// Keep the address counter inside the DDRAM ranges of the configured line mode
+static uint8_t ddram_wrap(const hd44780_emu_t *emu, int address) {
+    if (!emu->two_lines) {
+        return (address + 0x50) % 0x50;
+    }
+    if (address < 0) {
+        return 0x67;
+    }
+    if (address > 0x67) {
+        return 0x00;
+    }
+    if (address > 0x27 && address < 0x40) {
+        return emu->increment ? 0x40 : 0x27;
+    }
+    return address;
+}
+
+static void move_address(hd44780_emu_t *emu, bool increment) {
+    int next = emu->address + (increment ? 1 : -1);
+    if (emu->cgram_selected) {
+        emu->address = (next + HD44780_CGRAM_SIZE) % HD44780_CGRAM_SIZE;
+    } else {
+        emu->address = ddram_wrap(emu, next);
+    }
+}
+
+static void execute_command(hd44780_emu_t *emu, uint8_t command) {
+    emu->stats.commands++;
+
+    if (command & 0x80) {
+        // Set DDRAM address
+        emu->cgram_selected = false;
+        emu->address = command & 0x7F;
+    } else if (command & 0x40) {
+        // Set CGRAM address
+        emu->cgram_selected = true;
+        emu->address = command & 0x3F;
+    } else if (command & 0x20) {
+        // Function set, N is only valid in 4-bit mode where the low nibble is transferred
+        bool was_four_bit = emu->four_bit;
+        emu->four_bit = !(command & 0x10);
+        if (was_four_bit) {
+            emu->two_lines = command & 0x08;
+        }
+    } else if (command & 0x10) {
+        // Cursor or display shift, only the cursor move changes what is written next
+        if (!(command & 0x08)) {
+            move_address(emu, command & 0x04);
+        }
+    } else if (command & 0x08) {
+        // Display on/off control
+        emu->display_on = command & 0x04;
+        emu->cursor_on = command & 0x02;
+        emu->blink_on = command & 0x01;
+    } else if (command & 0x04) {
+        // Entry mode set, display shift on write is not emulated
+        emu->increment = command & 0x02;
+    } else if (command & 0x02) {
+        // Return home
+        emu->cgram_selected = false;
+        emu->address = 0;
+    } else if (command & 0x01) {
+        // Clear display
+        memset(emu->ddram, ' ', sizeof(emu->ddram));
+        emu->cgram_selected = false;
+        emu->address = 0;
+        emu->increment = true;
+    }
+}
+
+static void write_data(hd44780_emu_t *emu, uint8_t data) {
+    emu->stats.data_writes++;
+    if (emu->cgram_selected) {
+        emu->cgram[emu->address] = data & 0x1F; // 5 pixel rows
+        emu->stats.cgram_writes++;
+    } else {
+        emu->ddram[emu->address] = data;
+    }
+    move_address(emu, emu->increment);
+}
+
+// A falling edge of E latches D4-D7 and RS from the expander outputs
+static void clock_nibble(hd44780_emu_t *emu, uint8_t latch) {
+    if (latch & LCD_RW) {
+        return; // Read cycle, e.g. the power-on high outputs, nothing is written
+    }
+    uint8_t nibble = latch & 0xF0;
+    bool data = latch & LCD_RS;
+
+    uint8_t value;
+    if (!emu->four_bit) {
+        value = nibble; // D0-D3 are not wired, they read as 0
+    } else if (!emu->nibble_pending) {
+        emu->nibble_high = nibble;
+        emu->nibble_pending = true;
+        return;
+    } else {
+        value = emu->nibble_high | (nibble >> 4);
+        emu->nibble_pending = false;
+    }
+
+    if (data) {
+        write_data(emu, value);
+    } else {
+        execute_command(emu, value);
+    }
+}
+
+void hd44780_emu_init(hd44780_emu_t *emu) {
+    memset(emu, 0, sizeof(*emu));
+    memset(emu->ddram, ' ', sizeof(emu->ddram));
+    emu->latch = 0xFF; // PCF8574 outputs are high after power on
+    emu->increment = true;
+}
+
+void hd44780_emu_init_4bit(hd44780_emu_t *emu) {
+    hd44780_emu_init(emu);
+    emu->four_bit = true;
+    emu->two_lines = true;
+    emu->display_on = true;
+}
+
+void hd44780_emu_feed(hd44780_emu_t *emu, const uint8_t *data, size_t size) {
+    emu->stats.transactions++;
+    emu->stats.bytes += size;
+    emu->stats.bus_time_ns += (uint64_t)(I2C_FRAME_OVERHEAD_BITS + I2C_BITS_PER_BYTE * size) * 1000000000 / I2C_MASTER_FREQ_HZ;
+
+    for (size_t i = 0; i < size; i++) {
+        uint8_t previous = emu->latch;
+        emu->latch = data[i];
+        emu->backlight = data[i] & LCD_BACKLIGHT;
+        if ((previous & LCD_ENABLE) && !(data[i] & LCD_ENABLE)) {
+            clock_nibble(emu, previous);
+        }
+    }
+}
+
+void hd44780_emu_feed_stream(hd44780_emu_t *emu, const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hd44780_emu_feed(emu, &data[i], 1);
+    }
+}
+
+void hd44780_emu_get_screen(const hd44780_emu_t *emu, char screen[LCD_ROWS][LCD_COLS + 1]) {
+    for (int row = 0; row < LCD_ROWS; row++) {
+        for (int col = 0; col < LCD_COLS; col++) {
+            uint8_t c = emu->ddram[row_offsets[row] + col];
+            screen[row][col] = c < 8 || (c >= 0x20 && c < 0x7F) ? (char)c : '?';
+        }
+        screen[row][LCD_COLS] = '\0';
+    }
+}
+
+bool hd44780_emu_screen_equals(const hd44780_emu_t *emu, const char *const expected[LCD_ROWS]) {
+    char screen[LCD_ROWS][LCD_COLS + 1];
+    hd44780_emu_get_screen(emu, screen);
+    for (int row = 0; row < LCD_ROWS; row++) {
+        size_t length = strlen(expected[row]);
+        for (int col = 0; col < LCD_COLS; col++) {
+            char c = col < (int)length ? expected[row][col] : ' ';
+            if (screen[row][col] != c) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void hd44780_emu_print(const hd44780_emu_t *emu, FILE *out) {
+    char screen[LCD_ROWS][LCD_COLS + 1];
+    hd44780_emu_get_screen(emu, screen);
+
+    fprintf(out, "+--------------------+%s\n", emu->display_on ? "" : " (display off)");
+    for (int row = 0; row < LCD_ROWS; row++) {
+        fputc('|', out);
+        for (int col = 0; col < LCD_COLS; col++) {
+            char c = screen[row][col];
+            fputc(c < 8 ? '0' + c : c, out);
+        }
+        fputs("|\n", out);
+    }
+    fprintf(out, "+--------------------+%s\n", emu->backlight ? "" : " (backlight off)");
+}
+
+hd44780_emu_stats_t hd44780_emu_get_stats(const hd44780_emu_t *emu) {
+    return emu->stats;
+}
+
+void hd44780_emu_reset_stats(hd44780_emu_t *emu) {
+    memset(&emu->stats, 0, sizeof(emu->stats));
+}
@@ -0,0 +1,131 @@
+/*
+ * HD44780 behind a PCF8574 I2C backpack, emulated from the bytes written to the
+ * expander. Rebuilds DDRAM/CGRAM and the visible 20x4 screen, and accounts the
+ * bus cost of what was sent so rendering changes can be checked against a budget.
+ */
+#ifndef HD44780_EMU_H
+#define HD44780_EMU_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "lcd.h"
+
+#define HD44780_DDRAM_SIZE 0x80
+#define HD44780_CGRAM_SIZE 64
+
+typedef struct {
+    uint32_t transactions;      // I2C write transactions
+    uint32_t bytes;             // Data bytes, address bytes excluded
+    uint32_t commands;          // Instructions executed (RS = 0)
+    uint32_t data_writes;       // DDRAM/CGRAM writes (RS = 1)
+    uint32_t cgram_writes;      // Of data_writes, the ones landing in CGRAM
+    uint64_t bus_time_ns;       // Bus time at I2C_MASTER_FREQ_HZ, see hd44780_emu_feed()
+} hd44780_emu_stats_t;
+
+typedef struct {
+    // PCF8574 output latch
+    uint8_t latch;
+    bool backlight;
+
+    // HD44780 state
+    bool four_bit;              // Interface width, 8-bit after power on
+    bool nibble_pending;        // High nibble received, waiting for the low one
+    uint8_t nibble_high;
+    bool two_lines;
+    bool display_on;
+    bool cursor_on;
+    bool blink_on;
+    bool increment;             // Entry mode I/D
+    bool cgram_selected;        // Data writes go to CGRAM instead of DDRAM
+    uint8_t address;            // Address counter of the selected RAM
+    uint8_t ddram[HD44780_DDRAM_SIZE];
+    uint8_t cgram[HD44780_CGRAM_SIZE];
+
+    hd44780_emu_stats_t stats;
+} hd44780_emu_t;
+
+/**
+ * @brief Reset to the power-on state: 8-bit interface, display off, DDRAM cleared.
+ *
+ * @param emu Emulator instance.
+ */
+void hd44780_emu_init(hd44780_emu_t *emu);
+
+/**
+ * @brief Reset to the state after the 4-bit initialization of lcd.c: 2 lines, display on.
+ *
+ * For streams captured after the display was initialized, e.g. a single
+ * lcd_render() or a dump whose start was dropped.
+ *
+ * @param emu Emulator instance.
+ */
+void hd44780_emu_init_4bit(hd44780_emu_t *emu);
+
+/**
+ * @brief Feed one I2C write transaction to the expander.
+ *
+ * Every byte updates the PCF8574 latch; a falling edge of E clocks the data
+ * nibble into the controller. Bus time is charged as start, address and data
+ * bytes with their ACK bits, and stop.
+ *
+ * @param emu Emulator instance.
+ * @param data Bytes written to the expander.
+ * @param size Number of bytes.
+ */
+void hd44780_emu_feed(hd44780_emu_t *emu, const uint8_t *data, size_t size);
+
+/**
+ * @brief Feed a recorded byte stream, one transaction per byte as sent by lcd.c.
+ *
+ * @param emu Emulator instance.
+ * @param data Recorded bytes, e.g. from ntc_host --i2c-dump.
+ * @param size Number of bytes.
+ */
+void hd44780_emu_feed_stream(hd44780_emu_t *emu, const uint8_t *data, size_t size);
+
+/**
+ * @brief Get the visible screen, mapped through LCD_ROW_OFFSET.
+ *
+ * CGRAM characters (0-7) are returned as their codes, other non-printable
+ * codes as '?'.
+ *
+ * @param emu Emulator instance.
+ * @param screen LCD_ROWS NUL terminated rows of LCD_COLS characters.
+ */
+void hd44780_emu_get_screen(const hd44780_emu_t *emu, char screen[LCD_ROWS][LCD_COLS + 1]);
+
+/**
+ * @brief Compare the visible screen with expected rows, shorter rows are padded with spaces.
+ *
+ * @param emu Emulator instance.
+ * @param expected LCD_ROWS rows.
+ * @return true if every row matches.
+ */
+bool hd44780_emu_screen_equals(const hd44780_emu_t *emu, const char *const expected[LCD_ROWS]);
+
+/**
+ * @brief Print the screen inside a frame, with CGRAM characters shown as digits.
+ *
+ * @param emu Emulator instance.
+ * @param out Output stream.
+ */
+void hd44780_emu_print(const hd44780_emu_t *emu, FILE *out);
+
+/**
+ * @brief Get the accumulated bus statistics.
+ *
+ * @param emu Emulator instance.
+ * @return hd44780_emu_stats_t Statistics since init or the last reset.
+ */
+hd44780_emu_stats_t hd44780_emu_get_stats(const hd44780_emu_t *emu);
+
+/**
+ * @brief Reset the bus statistics, e.g. at the start of a frame.
+ *
+ * @param emu Emulator instance.
+ */
+void hd44780_emu_reset_stats(hd44780_emu_t *emu);
+
+#endif // HD44780_EMU_H
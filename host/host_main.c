@@ -0,0 +1,274 @@
+// Host entry point, runs app_main() on the mocked drivers for a fixed time and prints a summary
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "mock_host.h"
+#include "mock_internal.h"
+#include "ntc_adc.h"
+#include "lcd.h"
+#include "status_led.h"
+#include "hd44780_emu.h"
+#include "captive_portal.h"
+#include "config_manager.h"
+#include "state_manager.h"
+#include "heap_monitor.h"
+#include "adc_stream.h"
+
+static const char *TAG = "host";
+
+void app_main(void);
+
+// The display as it would look, fed from the I2C transmits to the LCD address
+static hd44780_emu_t lcd_emu;
+
+// Every Nth transmit to the display is NACKed, 0 for none
+static uint32_t i2c_glitch_every = 0;
+static uint32_t i2c_glitch_count = 0;
+
+static esp_err_t lcd_emu_tx_hook(uint16_t address, const uint8_t *data, size_t size, void *ctx) {
+    if (address == LCD_I2C_ADDRESS && i2c_glitch_every != 0 && ++i2c_glitch_count % i2c_glitch_every == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (address == LCD_I2C_ADDRESS) {
+        hd44780_emu_feed(&lcd_emu, data, size);
+    }
+    return ESP_OK;
+}
+
+typedef struct {
+    uint32_t seconds;
+    const char *adc_replay;
+    const char *adc_record;
+    const char *i2c_dump;
+    int uart_record_port;
+    const char *uart_record;
+    uint32_t i2c_max_speed_hz;
+    uint32_t i2c_glitch_every;
+    uint32_t soak_iterations;
+    uint32_t soak_tolerance;
+} host_options_t;
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n"
+           "  --seconds N          Run time after app_main() returns (default 10)\n"
+           "  --adc-replay FILE    Loop raw DMA frames from FILE instead of synthesized inputs\n"
+           "  --adc-record FILE    Record every produced DMA frame to FILE\n"
+           "  --i2c-dump FILE      Write the LCD I2C byte stream to FILE on exit\n"
+           "  --uart-record N:FILE Write everything sent on UART N to FILE\n"
+           "  --i2c-max-speed HZ   Transfers of devices faster than HZ time out\n"
+           "  --i2c-glitch N       NACK every Nth transfer to the LCD\n"
+           "  --soak N             Run N rounds of HTTP, state and config traffic, fail if the heap grew\n"
+           "  --soak-tolerance B   Heap growth in bytes the soak accepts (default 512)\n",
+           program);
+}
+
+static bool parse_options(int argc, char **argv, host_options_t *options) {
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--seconds") == 0 && has_value) {
+            options->seconds = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--adc-replay") == 0 && has_value) {
+            options->adc_replay = argv[++i];
+        } else if (strcmp(argv[i], "--adc-record") == 0 && has_value) {
+            options->adc_record = argv[++i];
+        } else if (strcmp(argv[i], "--i2c-dump") == 0 && has_value) {
+            options->i2c_dump = argv[++i];
+        } else if (strcmp(argv[i], "--uart-record") == 0 && has_value) {
+            char *end = NULL;
+            options->uart_record_port = strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != ':' || end[1] == '\0') {
+                return false;
+            }
+            options->uart_record = end + 1;
+        } else if (strcmp(argv[i], "--i2c-max-speed") == 0 && has_value) {
+            options->i2c_max_speed_hz = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--i2c-glitch") == 0 && has_value) {
+            options->i2c_glitch_every = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--soak") == 0 && has_value) {
+            options->soak_iterations = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--soak-tolerance") == 0 && has_value) {
+            options->soak_tolerance = strtoul(argv[++i], NULL, 10);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void print_summary(void) {
+    ntc_adc_stats_t stats = ntc_adc_get_stats();
+    const uint8_t *stream;
+    size_t stream_size = mock_i2c_get_stream(LCD_I2C_ADDRESS, &stream);
+
+    printf("\n--- host run summary ---\n");
+    printf("uptime:        %lld ms\n", (long long)(esp_timer_get_time() / 1000));
+    printf("adc frames:    %lu produced, %lu dropped, %lu processed\n",
+           (unsigned long)mock_adc_get_frames_produced(), (unsigned long)mock_adc_get_frames_dropped(),
+           (unsigned long)stats.frames_processed);
+    printf("adc samples:   %lu\n", (unsigned long)stats.samples_processed);
+    printf("publishes:     %lu\n", (unsigned long)stats.publish_count);
+    adc_stream_stats_t stream_stats = adc_stream_get_stats();
+    if (stream_stats.records > 0) {
+        printf("adc stream:    %s, %lu records, %lu dropped, %lu bytes sent, ring peak %lu bytes\n",
+               adc_stream_get_mode_name(stream_stats.mode), (unsigned long)stream_stats.records,
+               (unsigned long)stream_stats.dropped, (unsigned long)stream_stats.bytes_sent,
+               (unsigned long)stream_stats.ring_peak);
+    }
+    for (int i = 0; i < ntc_get_channel_count(); i++) {
+        if (!ntc_channel_is_enabled(i)) {
+            continue;
+        }
+        float temperature = ntc_get_channel_temperature(i);
+        const char *name = ntc_get_channel_config(i)->name;
+        if (isnan(temperature)) {
+            printf("%s:%*s raw %4d  %s\n", name, 13 - (int)strlen(name), "", ntc_get_channel_data(i),
+                   ntc_sensor_get_fault_name(ntc_get_channel_fault(i)));
+        } else {
+            printf("%s:%*s raw %4d  %.2f C\n", name, 13 - (int)strlen(name), "", ntc_get_channel_data(i), temperature);
+        }
+    }
+    hd44780_emu_stats_t lcd_stats = hd44780_emu_get_stats(&lcd_emu);
+    printf("lcd i2c:       %zu bytes, %lu transactions, %.1f ms bus time\n", stream_size,
+           (unsigned long)lcd_stats.transactions, lcd_stats.bus_time_ns / 1e6);
+    printf("lcd glyphs:    %lu uploaded, %lu CGRAM writes\n", (unsigned long)lcd_get_glyph_upload_count(),
+           (unsigned long)lcd_stats.cgram_writes);
+    for (int d = 0; d < lcd_get_display_count(); d++) {
+        lcd_bus_stats_t bus;
+        lcd_get_bus_stats(d, &bus);
+        printf("lcd bus %d:     0x%02x at %lu Hz, %lu recoveries\n", d, bus.address, (unsigned long)bus.speed_hz,
+               (unsigned long)bus.recoveries);
+        for (int i = 0; i < LCD_I2C_SPEED_COUNT; i++) {
+            printf("  %6lu Hz:    %lu transfers, %lu errors\n", (unsigned long)bus.speeds[i].speed_hz,
+                   (unsigned long)bus.speeds[i].transactions, (unsigned long)bus.speeds[i].errors);
+        }
+    }
+    const rmt_symbol_word_t *symbols;
+    uint32_t resolution_hz = 1;
+    int loop_count = 0;
+    size_t symbol_count = mock_rmt_get_waveform(STATUS_LED_GPIO, &symbols, &resolution_hz, &loop_count);
+    uint64_t period_ticks = 0;
+    uint64_t on_ticks = 0;
+    for (size_t i = 0; i < symbol_count; i++) {
+        period_ticks += symbols[i].duration0 + symbols[i].duration1;
+        on_ticks += symbols[i].level0 * symbols[i].duration0 + symbols[i].level1 * symbols[i].duration1;
+    }
+    printf("status led:    pattern %d, %zu symbols, %.1f ms %s, %.0f%% on, %lu reprograms\n", status_led_get(),
+           symbol_count, period_ticks * 1000.0 / resolution_hz, loop_count < 0 ? "looped" : "once",
+           period_ticks ? on_ticks * 100.0 / period_ticks : 0.0, (unsigned long)mock_rmt_get_transmit_count(STATUS_LED_GPIO));
+    hd44780_emu_print(&lcd_emu, stdout);
+}
+
+// One round of the traffic a running device sees: portal and API requests, state changes and
+// configuration commits. Every allocation they make must be released by the end of the round.
+static void soak_round(uint32_t round) {
+    static const char *uris[] = { "/", "/generate_204", "/api/instrumentation", "/api/heap", "/api/probes", "/unknown" };
+    static char response[4096];
+    int status;
+
+    for (size_t i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
+        if (mock_httpd_request(HTTP_GET, uris[i], NULL, response, sizeof(response), &status) == ESP_ERR_INVALID_STATE) {
+            cp_start_http_server(); // Not in AP mode, serve the API anyway
+            mock_httpd_request(HTTP_GET, uris[i], NULL, response, sizeof(response), &status);
+        }
+    }
+    if (round % 10 == 0) {
+        state_set_rssi(-50 - (int8_t)(round / 10 % 20));
+    }
+    if (round % 50 == 0) {
+        config_transaction_t transaction;
+        config_begin(&transaction);
+        transaction.config.backlight_timeout_s = transaction.config.backlight_timeout_s == 60 ? 120 : 60;
+        config_commit(&transaction);
+    }
+    vTaskDelay(pdMS_TO_TICKS(2)); // Leave the event loop time to drain its queue
+}
+
+// Runs the rounds and compares the heap after a warm-up with the heap at the end
+static bool run_soak(const host_options_t *options) {
+    uint32_t warmup = options->soak_iterations / 10 + 1;
+    heap_cap_stats_t baseline;
+    heap_cap_stats_t final;
+
+    for (uint32_t round = 0; round < options->soak_iterations + warmup; round++) {
+        if (round == warmup) {
+            heap_monitor_sample();
+            heap_monitor_get_stats(HEAP_CAP_8BIT, &baseline);
+        }
+        soak_round(round);
+    }
+    vTaskDelay(pdMS_TO_TICKS(100));
+    heap_monitor_sample();
+    heap_monitor_get_stats(HEAP_CAP_8BIT, &final);
+
+    printf("\n--- soak: %lu rounds ---\n", (unsigned long)options->soak_iterations);
+    heap_monitor_print_report(stdout);
+    bool passed = true;
+    int64_t growth = (int64_t)baseline.current.free_bytes - final.current.free_bytes;
+    printf("\nheap growth:   %lld bytes (tolerance %lu)\n", (long long)growth, (unsigned long)options->soak_tolerance);
+    if (growth > (int64_t)options->soak_tolerance) {
+        passed = false;
+    }
+    for (int tag = 0; tag < HEAP_TAG_MAX; tag++) {
+        heap_tag_stats_t stats;
+        heap_tag_get_stats(tag, &stats);
+        if (stats.current_bytes != 0 || stats.alloc_count != stats.free_count) {
+            printf("tag %s leaked: %lu bytes in %lu blocks\n", heap_tag_get_name(tag),
+                   (unsigned long)stats.current_bytes, (unsigned long)(stats.alloc_count - stats.free_count));
+            passed = false;
+        }
+    }
+    printf("soak:          %s\n", passed ? "PASSED" : "FAILED");
+    return passed;
+}
+
+int main(int argc, char **argv) {
+    host_options_t options = { .seconds = 10, .soak_tolerance = 512 };
+    if (!parse_options(argc, argv, &options)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    signal(SIGPIPE, SIG_IGN); // lwIP reports a closed peer as a send error, not a signal
+
+    if (options.adc_replay != NULL && mock_adc_replay_load(options.adc_replay) != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot load ADC replay %s", options.adc_replay);
+        return 1;
+    }
+    if (options.adc_record != NULL && mock_adc_record_to(options.adc_record) != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot record ADC frames to %s", options.adc_record);
+        return 1;
+    }
+    if (options.uart_record != NULL && mock_uart_record_to(options.uart_record_port, options.uart_record) != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot record UART%d to %s", options.uart_record_port, options.uart_record);
+        return 1;
+    }
+
+    hd44780_emu_init(&lcd_emu);
+    i2c_glitch_every = options.i2c_glitch_every;
+    mock_i2c_set_tx_hook(lcd_emu_tx_hook, NULL);
+    mock_i2c_set_max_speed_hz(options.i2c_max_speed_hz);
+
+    // app_main() runs on the main task and returns, the other tasks keep running
+    mock_task_adopt_thread("main", 1);
+    app_main();
+    ESP_LOGI(TAG, "app_main() returned, running for %lu s", (unsigned long)options.seconds);
+    vTaskDelay(pdMS_TO_TICKS(options.seconds * 1000));
+
+    mock_adc_record_to(NULL);
+    if (options.uart_record != NULL) {
+        mock_uart_record_to(options.uart_record_port, NULL);
+    }
+    if (options.i2c_dump != NULL && mock_i2c_dump_stream(LCD_I2C_ADDRESS, options.i2c_dump) != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot write the I2C stream to %s", options.i2c_dump);
+    }
+    print_summary();
+    bool passed = options.soak_iterations == 0 || run_soak(&options);
+    fflush(stdout);
+    _Exit(passed ? 0 : 1); // Tasks are endless loops, do not run destructors under them
+}
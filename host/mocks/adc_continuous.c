@@ -0,0 +1,377 @@
+// ADC continuous mode, a producer thread stands in for the DMA engine and its interrupt
+#include "mock_internal.h"
+#include "mock_host.h"
+#include "esp_adc/adc_continuous.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MOCK_ADC_DEFAULT_RAW 1200   // Mid-scale reading of a divider at room temperature
+#define MOCK_ADC_DEFAULT_NOISE 2
+
+struct adc_continuous_ctx_t {
+    adc_continuous_handle_cfg_t handle_config;
+    adc_digi_pattern_config_t pattern[SOC_ADC_PATT_LEN_MAX];
+    uint32_t pattern_num;
+    uint32_t sample_freq_hz;
+    adc_digi_output_format_t format;
+    adc_continuous_evt_cbs_t callbacks;
+    void *user_data;
+
+    // Pool of converted frames, a ring of conv_frame_size slots
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t *pool;
+    uint32_t pool_frames;
+    uint32_t pool_head;
+    uint32_t pool_count;
+
+    pthread_t producer;
+    bool running;
+    bool stop_requested;
+};
+
+static pthread_mutex_t input_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint16_t input_raw[SOC_ADC_PERIPH_NUM][SOC_ADC_MAX_CHANNEL_NUM];
+static bool input_raw_set[SOC_ADC_PERIPH_NUM][SOC_ADC_MAX_CHANNEL_NUM];
+static uint16_t input_noise = MOCK_ADC_DEFAULT_NOISE;
+static uint8_t *replay_data = NULL;
+static size_t replay_size = 0;
+static size_t replay_offset = 0;
+static FILE *record_file = NULL;
+static volatile uint32_t frames_produced = 0;
+static volatile uint32_t frames_dropped = 0;
+
+void mock_adc_set_input(adc_unit_t unit, adc_channel_t channel, uint16_t raw) {
+    if (unit >= SOC_ADC_PERIPH_NUM || channel >= SOC_ADC_MAX_CHANNEL_NUM) {
+        return;
+    }
+    pthread_mutex_lock(&input_lock);
+    input_raw[unit][channel] = raw;
+    input_raw_set[unit][channel] = true;
+    pthread_mutex_unlock(&input_lock);
+}
+
+void mock_adc_set_noise(uint16_t noise_lsb) {
+    pthread_mutex_lock(&input_lock);
+    input_noise = noise_lsb;
+    pthread_mutex_unlock(&input_lock);
+}
+
+void mock_adc_replay_set(const uint8_t *data, size_t size) {
+    pthread_mutex_lock(&input_lock);
+    free(replay_data);
+    replay_data = NULL;
+    replay_size = 0;
+    replay_offset = 0;
+    if (data != NULL && size > 0) {
+        replay_data = malloc(size);
+        memcpy(replay_data, data, size);
+        replay_size = size;
+    }
+    pthread_mutex_unlock(&input_lock);
+}
+
+esp_err_t mock_adc_replay_load(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size <= 0) {
+        fclose(file);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t *data = malloc(size);
+    bool complete = data != NULL && fread(data, 1, size, file) == (size_t)size;
+    fclose(file);
+    if (complete) {
+        mock_adc_replay_set(data, size);
+    }
+    free(data);
+    return complete ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t mock_adc_record_to(const char *path) {
+    pthread_mutex_lock(&input_lock);
+    if (record_file != NULL) {
+        fclose(record_file);
+        record_file = NULL;
+    }
+    if (path != NULL) {
+        record_file = fopen(path, "wb");
+    }
+    bool ok = path == NULL || record_file != NULL;
+    pthread_mutex_unlock(&input_lock);
+    return ok ? ESP_OK : ESP_FAIL;
+}
+
+uint32_t mock_adc_get_frames_produced(void) {
+    return frames_produced;
+}
+
+uint32_t mock_adc_get_frames_dropped(void) {
+    return frames_dropped;
+}
+
+// xorshift32, reproducible noise between runs
+static uint16_t noisy_raw(uint16_t raw, uint16_t noise) {
+    static uint32_t state = 2463534242u;
+    if (noise == 0) {
+        return raw;
+    }
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    int32_t value = (int32_t)raw + (int32_t)(state % (2 * noise + 1)) - noise;
+    return value < 0 ? 0 : value > 4095 ? 4095 : value;
+}
+
+// Fill a frame from the replay buffer or the per-input values, called with input_lock held
+static void synthesize_frame(adc_continuous_handle_t handle, uint8_t *frame, uint32_t *pattern_index) {
+    uint32_t size = handle->handle_config.conv_frame_size;
+
+    if (replay_data != NULL) {
+        for (uint32_t i = 0; i < size; i++) {
+            frame[i] = replay_data[replay_offset];
+            replay_offset = (replay_offset + 1) % replay_size;
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i + sizeof(adc_digi_output_data_t) <= size; i += sizeof(adc_digi_output_data_t)) {
+        const adc_digi_pattern_config_t *pattern = &handle->pattern[*pattern_index];
+        *pattern_index = (*pattern_index + 1) % handle->pattern_num;
+
+        uint16_t raw = input_raw_set[pattern->unit][pattern->channel]
+                           ? input_raw[pattern->unit][pattern->channel]
+                           : MOCK_ADC_DEFAULT_RAW + 16 * pattern->channel;
+        raw = noisy_raw(raw, input_noise);
+
+        adc_digi_output_data_t data = { .val = 0 };
+        if (handle->format == ADC_DIGI_OUTPUT_FORMAT_TYPE1) {
+            data.type1.data = raw;
+            data.type1.channel = pattern->channel;
+        } else {
+            data.type2.data = raw > 2047 ? 2047 : raw; // 11-bit data field
+            data.type2.channel = pattern->channel;
+            data.type2.unit = pattern->unit;
+        }
+        memcpy(&frame[i], &data, sizeof(data));
+    }
+}
+
+static void *producer_thread(void *arg) {
+    adc_continuous_handle_t handle = arg;
+    uint32_t frame_size = handle->handle_config.conv_frame_size;
+    uint32_t conversions = frame_size / sizeof(adc_digi_output_data_t);
+    int64_t frame_period_us = (int64_t)conversions * 1000000 / handle->sample_freq_hz;
+    uint8_t *frame = malloc(frame_size);
+    uint32_t pattern_index = 0;
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (1) {
+        next.tv_nsec += frame_period_us * 1000;
+        while (next.tv_nsec >= 1000000000) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {
+        }
+
+        pthread_mutex_lock(&input_lock);
+        synthesize_frame(handle, frame, &pattern_index);
+        if (record_file != NULL) {
+            fwrite(frame, 1, frame_size, record_file);
+        }
+        pthread_mutex_unlock(&input_lock);
+
+        pthread_mutex_lock(&handle->lock);
+        if (handle->stop_requested) {
+            pthread_mutex_unlock(&handle->lock);
+            break;
+        }
+        bool overflow = handle->pool_count == handle->pool_frames;
+        if (!overflow) {
+            uint32_t slot = (handle->pool_head + handle->pool_count) % handle->pool_frames;
+            memcpy(handle->pool + slot * frame_size, frame, frame_size);
+            handle->pool_count++;
+            pthread_cond_signal(&handle->cond);
+        }
+        pthread_mutex_unlock(&handle->lock);
+
+        // The real driver drops the frame and reports the overflow when the pool is full
+        frames_produced++;
+        adc_continuous_evt_data_t edata = { .conv_frame_buffer = frame, .size = frame_size };
+        if (overflow) {
+            frames_dropped++;
+            if (handle->callbacks.on_pool_ovf != NULL) {
+                handle->callbacks.on_pool_ovf(handle, &edata, handle->user_data);
+            }
+        } else if (handle->callbacks.on_conv_done != NULL) {
+            handle->callbacks.on_conv_done(handle, &edata, handle->user_data);
+        }
+    }
+
+    free(frame);
+    return NULL;
+}
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t *hdl_config, adc_continuous_handle_t *ret_handle) {
+    if (hdl_config == NULL || ret_handle == NULL || hdl_config->conv_frame_size == 0 ||
+        hdl_config->conv_frame_size % SOC_ADC_DIGI_DATA_BYTES_PER_CONV != 0 ||
+        hdl_config->max_store_buf_size < hdl_config->conv_frame_size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    adc_continuous_handle_t handle = calloc(1, sizeof(*handle));
+    if (handle == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    handle->handle_config = *hdl_config;
+    handle->pool_frames = hdl_config->max_store_buf_size / hdl_config->conv_frame_size;
+    handle->pool = malloc(handle->pool_frames * hdl_config->conv_frame_size);
+    pthread_mutex_init(&handle->lock, NULL);
+    mock_cond_init(&handle->cond);
+    *ret_handle = handle;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t *config) {
+    if (handle == NULL || config == NULL || config->pattern_num == 0 || config->pattern_num > SOC_ADC_PATT_LEN_MAX ||
+        config->sample_freq_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW || config->sample_freq_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (uint32_t i = 0; i < config->pattern_num; i++) {
+        if (config->adc_pattern[i].unit >= SOC_ADC_PERIPH_NUM ||
+            config->adc_pattern[i].channel >= SOC_ADC_CHANNEL_NUM(config->adc_pattern[i].unit)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    memcpy(handle->pattern, config->adc_pattern, config->pattern_num * sizeof(adc_digi_pattern_config_t));
+    handle->pattern_num = config->pattern_num;
+    handle->sample_freq_hz = config->sample_freq_hz;
+    handle->format = config->format;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_register_event_callbacks(adc_continuous_handle_t handle, const adc_continuous_evt_cbs_t *cbs, void *user_data) {
+    if (handle == NULL || cbs == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    handle->callbacks = *cbs;
+    handle->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle) {
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->running || handle->pattern_num == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    handle->stop_requested = false;
+    handle->running = true;
+    pthread_create(&handle->producer, NULL, producer_thread, handle);
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle) {
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!handle->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_mutex_lock(&handle->lock);
+    handle->stop_requested = true;
+    pthread_mutex_unlock(&handle->lock);
+    pthread_join(handle->producer, NULL);
+    handle->running = false;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t *buf, uint32_t length_max, uint32_t *out_length, uint32_t timeout_ms) {
+    if (handle == NULL || buf == NULL || out_length == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t frame_size = handle->handle_config.conv_frame_size;
+    struct timespec deadline;
+    mock_deadline_from_us((int64_t)timeout_ms * 1000, &deadline);
+
+    pthread_mutex_lock(&handle->lock);
+    while (handle->pool_count == 0) {
+        if (timeout_ms == 0 || !mock_cond_wait(&handle->cond, &handle->lock, timeout_ms == UINT32_MAX ? NULL : &deadline)) {
+            pthread_mutex_unlock(&handle->lock);
+            *out_length = 0;
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+    uint32_t length = length_max < frame_size ? length_max : frame_size;
+    memcpy(buf, handle->pool + handle->pool_head * frame_size, length);
+    handle->pool_head = (handle->pool_head + 1) % handle->pool_frames;
+    handle->pool_count--;
+    pthread_mutex_unlock(&handle->lock);
+
+    *out_length = length;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_flush_pool(adc_continuous_handle_t handle) {
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_mutex_lock(&handle->lock);
+    handle->pool_head = 0;
+    handle->pool_count = 0;
+    pthread_mutex_unlock(&handle->lock);
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_deinit(adc_continuous_handle_t handle) {
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    free(handle->pool);
+    free(handle);
+    return ESP_OK;
+}
+
+// ESP32 ADC1 channel to GPIO mapping, ADC2 is not routed on the host
+static const int8_t adc1_channel_io[] = { 36, 37, 38, 39, 32, 33, 34, 35 };
+
+esp_err_t adc_continuous_channel_to_io(adc_unit_t unit_id, adc_channel_t channel, int *const io_num) {
+    if (unit_id != ADC_UNIT_1 || channel >= sizeof(adc1_channel_io)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *io_num = adc1_channel_io[channel];
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_io_to_channel(int io_num, adc_unit_t *const unit_id, adc_channel_t *const channel) {
+    for (size_t i = 0; i < sizeof(adc1_channel_io); i++) {
+        if (adc1_channel_io[i] == io_num) {
+            *unit_id = ADC_UNIT_1;
+            *channel = i;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_INVALID_ARG;
+}
@@ -0,0 +1,198 @@
+// esp_console command table and the UART driver, the console UART is stdin and stdout on the host,
+// the others pace writes at their baud rate and can be recorded to a file
+#include "mock_internal.h"
+#include "mock_host.h"
+#include "esp_console.h"
+#include "driver/uart.h"
+#include "driver/uart_vfs.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MOCK_CONSOLE_MAX_COMMANDS 32
+#define MOCK_UART_PORTS 3
+
+static pthread_mutex_t console_lock = PTHREAD_MUTEX_INITIALIZER;
+static esp_console_config_t console_config;
+static bool console_initialized = false;
+static esp_console_cmd_t commands[MOCK_CONSOLE_MAX_COMMANDS];
+static int command_count = 0;
+
+esp_err_t esp_console_init(const esp_console_config_t *config) {
+    if (config == NULL || config->max_cmdline_length == 0 || config->max_cmdline_args == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&console_lock);
+    esp_err_t err = console_initialized ? ESP_ERR_INVALID_STATE : ESP_OK;
+    if (err == ESP_OK) {
+        console_config = *config;
+        console_initialized = true;
+    }
+    pthread_mutex_unlock(&console_lock);
+    return err;
+}
+
+esp_err_t esp_console_deinit(void) {
+    pthread_mutex_lock(&console_lock);
+    esp_err_t err = console_initialized ? ESP_OK : ESP_ERR_INVALID_STATE;
+    console_initialized = false;
+    command_count = 0;
+    pthread_mutex_unlock(&console_lock);
+    return err;
+}
+
+esp_err_t esp_console_cmd_register(const esp_console_cmd_t *cmd) {
+    if (cmd == NULL || cmd->command == NULL || strchr(cmd->command, ' ') != NULL || cmd->func == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&console_lock);
+    esp_err_t err = ESP_OK;
+    if (!console_initialized) {
+        err = ESP_ERR_INVALID_STATE;
+    } else if (command_count >= MOCK_CONSOLE_MAX_COMMANDS) {
+        err = ESP_ERR_NO_MEM;
+    } else {
+        commands[command_count++] = *cmd;
+    }
+    pthread_mutex_unlock(&console_lock);
+    return err;
+}
+
+// Splits in place at whitespace, double quotes group words, as esp_console_split_argv() does
+static int split_argv(char *line, char **argv, int max_args) {
+    int argc = 0;
+    char *read = line;
+    while (*read != '\0' && argc < max_args) {
+        while (isspace((unsigned char)*read)) {
+            read++;
+        }
+        if (*read == '\0') {
+            break;
+        }
+        char *write = read;
+        argv[argc++] = write;
+        bool quoted = false;
+        while (*read != '\0' && (quoted || !isspace((unsigned char)*read))) {
+            if (*read == '"') {
+                quoted = !quoted;
+                read++;
+                continue;
+            }
+            *write++ = *read++;
+        }
+        if (*read != '\0') {
+            read++;
+        }
+        *write = '\0';
+    }
+    return argc;
+}
+
+esp_err_t esp_console_run(const char *cmdline, int *cmd_ret) {
+    if (cmdline == NULL || cmd_ret == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&console_lock);
+    size_t max_length = console_config.max_cmdline_length;
+    int max_args = console_config.max_cmdline_args;
+    bool initialized = console_initialized;
+    pthread_mutex_unlock(&console_lock);
+    if (!initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    char line[max_length + 1];
+    char *argv[max_args];
+    strncpy(line, cmdline, max_length);
+    line[max_length] = '\0';
+    int argc = split_argv(line, argv, max_args);
+    if (argc == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_console_cmd_func_t func = NULL;
+    pthread_mutex_lock(&console_lock);
+    for (int i = 0; i < command_count && func == NULL; i++) {
+        if (strcmp(commands[i].command, argv[0]) == 0) {
+            func = commands[i].func;
+        }
+    }
+    pthread_mutex_unlock(&console_lock);
+    if (func == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *cmd_ret = func(argc, argv);
+    return ESP_OK;
+}
+
+// UART: the console UART is the process's stdin and stdout, nothing to install
+
+static pthread_mutex_t uart_lock = PTHREAD_MUTEX_INITIALIZER;
+static int uart_baud[MOCK_UART_PORTS] = { 115200, 115200, 115200 };
+static FILE *uart_record[MOCK_UART_PORTS];
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size, int tx_buffer_size, int queue_size,
+                              QueueHandle_t *uart_queue, int intr_alloc_flags) {
+    if (uart_num < 0 || uart_num >= MOCK_UART_PORTS || rx_buffer_size <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (uart_queue != NULL) {
+        *uart_queue = NULL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num, const uart_config_t *uart_config) {
+    if (uart_num < 0 || uart_num >= MOCK_UART_PORTS || uart_config == NULL || uart_config->baud_rate <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&uart_lock);
+    uart_baud[uart_num] = uart_config->baud_rate;
+    pthread_mutex_unlock(&uart_lock);
+    return ESP_OK;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num, int rts_io_num, int cts_io_num) {
+    return uart_num >= 0 && uart_num < MOCK_UART_PORTS ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+// Blocks for the time the bytes take on the wire, 10 bits per byte
+int uart_write_bytes(uart_port_t uart_num, const void *src, size_t size) {
+    if (uart_num < 0 || uart_num >= MOCK_UART_PORTS || src == NULL) {
+        return -1;
+    }
+    pthread_mutex_lock(&uart_lock);
+    FILE *out = uart_num == CONFIG_ESP_CONSOLE_UART_NUM ? stdout : uart_record[uart_num];
+    if (out != NULL) {
+        fwrite(src, 1, size, out);
+    }
+    int baud = uart_baud[uart_num];
+    pthread_mutex_unlock(&uart_lock);
+
+    struct timespec wire_time = {
+        .tv_sec = size * 10 / baud,
+        .tv_nsec = (long)(size * 10 % baud * 1000000000LL / baud),
+    };
+    nanosleep(&wire_time, NULL);
+    return (int)size;
+}
+
+esp_err_t mock_uart_record_to(uart_port_t uart_num, const char *path) {
+    if (uart_num < 0 || uart_num >= MOCK_UART_PORTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&uart_lock);
+    if (uart_record[uart_num] != NULL) {
+        fclose(uart_record[uart_num]);
+        uart_record[uart_num] = NULL;
+    }
+    if (path != NULL) {
+        uart_record[uart_num] = fopen(path, "wb");
+    }
+    bool ok = path == NULL || uart_record[uart_num] != NULL;
+    pthread_mutex_unlock(&uart_lock);
+    return ok ? ESP_OK : ESP_FAIL;
+}
+
+void uart_vfs_dev_use_driver(int uart_num) {
+}
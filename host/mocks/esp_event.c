@@ -0,0 +1,172 @@
+// esp_event loops on a FreeRTOS queue, dispatching on the loop task or in esp_event_loop_run()
+#include "mock_internal.h"
+#include "esp_event.h"
+#include "freertos/queue.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MOCK_EVENT_MAX_HANDLERS 64
+
+typedef struct {
+    esp_event_base_t base;
+    int32_t id;
+    void *data;
+    size_t size;
+} posted_event_t;
+
+typedef struct {
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t handler;
+    void *arg;
+} handler_entry_t;
+
+typedef struct {
+    QueueHandle_t queue;
+    pthread_mutex_t lock;
+    handler_entry_t handlers[MOCK_EVENT_MAX_HANDLERS];
+    int handler_count;
+} event_loop_t;
+
+static event_loop_t *default_loop = NULL;
+
+static void dispatch(event_loop_t *loop, posted_event_t *event) {
+    handler_entry_t handlers[MOCK_EVENT_MAX_HANDLERS];
+
+    // Handlers may register further handlers, dispatch from a snapshot
+    pthread_mutex_lock(&loop->lock);
+    int count = loop->handler_count;
+    memcpy(handlers, loop->handlers, count * sizeof(handler_entry_t));
+    pthread_mutex_unlock(&loop->lock);
+
+    for (int i = 0; i < count; i++) {
+        bool base_match = handlers[i].base == ESP_EVENT_ANY_BASE || handlers[i].base == event->base;
+        bool id_match = handlers[i].id == ESP_EVENT_ANY_ID || handlers[i].id == event->id;
+        if (base_match && id_match) {
+            handlers[i].handler(handlers[i].arg, event->base, event->id, event->data);
+        }
+    }
+    free(event->data);
+}
+
+static void event_loop_task(void *arg) {
+    event_loop_t *loop = arg;
+    while (1) {
+        esp_event_loop_run(loop, portMAX_DELAY);
+    }
+}
+
+esp_err_t esp_event_loop_create(const esp_event_loop_args_t *args, esp_event_loop_handle_t *loop_handle) {
+    if (args == NULL || loop_handle == NULL || args->queue_size <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    event_loop_t *loop = calloc(1, sizeof(*loop));
+    if (loop == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    loop->queue = xQueueCreate(args->queue_size, sizeof(posted_event_t));
+    pthread_mutex_init(&loop->lock, NULL);
+    if (args->task_name != NULL) {
+        xTaskCreatePinnedToCore(event_loop_task, args->task_name, args->task_stack_size, loop,
+                                args->task_priority, NULL, args->task_core_id);
+    }
+    *loop_handle = loop;
+    return ESP_OK;
+}
+
+esp_err_t esp_event_loop_create_default(void) {
+    if (default_loop != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_event_loop_args_t args = {
+        .queue_size = 32,
+        .task_name = "sys_evt",
+        .task_priority = 20,
+        .task_stack_size = 2304,
+        .task_core_id = 0,
+    };
+    esp_event_loop_handle_t loop;
+    esp_err_t err = esp_event_loop_create(&args, &loop);
+    if (err == ESP_OK) {
+        default_loop = loop;
+    }
+    return err;
+}
+
+esp_err_t esp_event_loop_run(esp_event_loop_handle_t loop_handle, TickType_t ticks) {
+    event_loop_t *loop = loop_handle;
+    TickType_t start = xTaskGetTickCount();
+    posted_event_t event;
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        if (ticks != portMAX_DELAY) {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            wait = elapsed < ticks ? ticks - elapsed : 0;
+        }
+        if (xQueueReceive(loop->queue, &event, wait) != pdPASS) {
+            return ESP_OK; // Ran for the requested time
+        }
+        dispatch(loop, &event);
+    }
+}
+
+esp_err_t esp_event_post_to(esp_event_loop_handle_t loop_handle, esp_event_base_t base, int32_t id, const void *data, size_t size, TickType_t wait) {
+    event_loop_t *loop = loop_handle;
+    if (loop == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Data is copied as on ESP-IDF, handlers get their own buffer
+    posted_event_t event = { .base = base, .id = id, .size = size };
+    if (data != NULL && size > 0) {
+        event.data = malloc(size);
+        if (event.data == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        memcpy(event.data, data, size);
+    }
+    if (xQueueSend(loop->queue, &event, wait) != pdPASS) {
+        free(event.data);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_event_post(esp_event_base_t base, int32_t id, const void *data, size_t size, TickType_t wait) {
+    if (default_loop == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return esp_event_post_to(default_loop, base, id, data, size, wait);
+}
+
+esp_err_t esp_event_handler_instance_register_with(esp_event_loop_handle_t loop_handle, esp_event_base_t base, int32_t id, esp_event_handler_t handler, void *arg, esp_event_handler_instance_t *instance) {
+    event_loop_t *loop = loop_handle;
+    if (loop == NULL || handler == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&loop->lock);
+    if (loop->handler_count >= MOCK_EVENT_MAX_HANDLERS) {
+        pthread_mutex_unlock(&loop->lock);
+        return ESP_ERR_NO_MEM;
+    }
+    handler_entry_t *entry = &loop->handlers[loop->handler_count++];
+    entry->base = base;
+    entry->id = id;
+    entry->handler = handler;
+    entry->arg = arg;
+    pthread_mutex_unlock(&loop->lock);
+
+    if (instance != NULL) {
+        *instance = entry;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t id, esp_event_handler_t handler, void *arg, esp_event_handler_instance_t *instance) {
+    if (default_loop == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return esp_event_handler_instance_register_with(default_loop, base, id, handler, arg, instance);
+}
@@ -0,0 +1,242 @@
+// esp_err, esp_log, esp_system, esp_heap_caps, esp_timer, esp_pm and esp_sleep on the host
+#include "mock_internal.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_heap_caps.h"
+#include <malloc.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+// esp_err
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_CRC: return "ESP_ERR_INVALID_CRC";
+    case ESP_ERR_NOT_FINISHED: return "ESP_ERR_NOT_FINISHED";
+    case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+    case ESP_ERR_NVS_NO_FREE_PAGES: return "ESP_ERR_NVS_NO_FREE_PAGES";
+    case ESP_ERR_NVS_NEW_VERSION_FOUND: return "ESP_ERR_NVS_NEW_VERSION_FOUND";
+    case ESP_ERR_NVS_INVALID_LENGTH: return "ESP_ERR_NVS_INVALID_LENGTH";
+    default: return "UNKNOWN ERROR";
+    }
+}
+
+// esp_log, levels per tag with "*" as the default
+
+#define MOCK_LOG_TAGS 32
+
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+static esp_log_level_t default_level = ESP_LOG_INFO;
+static struct {
+    char tag[32];
+    esp_log_level_t level;
+} tag_levels[MOCK_LOG_TAGS];
+static int tag_level_count = 0;
+
+void esp_log_level_set(const char *tag, esp_log_level_t level) {
+    pthread_mutex_lock(&log_lock);
+    if (strcmp(tag, "*") == 0) {
+        default_level = level;
+        tag_level_count = 0;
+    } else {
+        int i;
+        for (i = 0; i < tag_level_count && strcmp(tag_levels[i].tag, tag) != 0; i++) {
+        }
+        if (i < MOCK_LOG_TAGS) {
+            strncpy(tag_levels[i].tag, tag, sizeof(tag_levels[i].tag) - 1);
+            tag_levels[i].level = level;
+            tag_level_count = i == tag_level_count ? tag_level_count + 1 : tag_level_count;
+        }
+    }
+    pthread_mutex_unlock(&log_lock);
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) {
+    static const char letters[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+
+    pthread_mutex_lock(&log_lock);
+    esp_log_level_t limit = default_level;
+    for (int i = 0; i < tag_level_count; i++) {
+        if (strcmp(tag_levels[i].tag, tag) == 0) {
+            limit = tag_levels[i].level;
+            break;
+        }
+    }
+    if (level <= limit) {
+        va_list args;
+        va_start(args, format);
+        printf("%c (%lld) %s: ", letters[level], (long long)(mock_time_us() / 1000), tag);
+        vprintf(format, args);
+        printf("\n");
+        va_end(args);
+    }
+    pthread_mutex_unlock(&log_lock);
+}
+
+// esp_system
+
+void esp_restart(void) {
+    printf("esp_restart() called, exiting the host build\n");
+    fflush(stdout);
+    exit(0);
+}
+
+// The host heap stands in for the ESP32 data RAM: glibc's usage is counted against a fixed size,
+// so leaks and fragmentation of the firmware show up in the heap_caps figures. Every capability
+// maps to the same heap.
+#define MOCK_HEAP_SIZE (320 * 1024)
+
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t heap_minimum_free = MOCK_HEAP_SIZE;
+
+// One arena for all threads, per-thread arenas would hide holes between tasks
+__attribute__((constructor)) static void mock_heap_init(void) {
+    mallopt(M_ARENA_MAX, 1);
+}
+
+static size_t mock_heap_free(struct mallinfo2 *info) {
+    *info = mallinfo2();
+    size_t used = info->uordblks + info->hblkhd;
+    size_t free_size = used < MOCK_HEAP_SIZE ? MOCK_HEAP_SIZE - used : 0;
+
+    pthread_mutex_lock(&heap_lock);
+    heap_minimum_free = free_size < heap_minimum_free ? free_size : heap_minimum_free;
+    pthread_mutex_unlock(&heap_lock);
+    return free_size;
+}
+
+uint32_t esp_get_free_heap_size(void) {
+    return heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+}
+
+uint32_t esp_get_minimum_free_heap_size(void) {
+    return heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    struct mallinfo2 info;
+    return mock_heap_free(&info);
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+    struct mallinfo2 info;
+    mock_heap_free(&info);
+    pthread_mutex_lock(&heap_lock);
+    size_t minimum = heap_minimum_free;
+    pthread_mutex_unlock(&heap_lock);
+    return minimum;
+}
+
+// Holes inside the arena are fragments, the top chunk and the unused rest of the heap are one block
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    struct mallinfo2 info;
+    size_t free_size = mock_heap_free(&info);
+    size_t holes = info.fordblks > info.keepcost ? info.fordblks - info.keepcost : 0;
+    return free_size > holes ? free_size - holes : 0;
+}
+
+// esp_timer on the shared timer service thread
+
+struct esp_timer {
+    mock_timer_t timer;
+    esp_timer_create_args_t args;
+};
+
+int64_t esp_timer_get_time(void) {
+    return mock_time_us();
+}
+
+static void esp_timer_callback(void *arg) {
+    struct esp_timer *timer = arg;
+    timer->args.callback(timer->args.arg);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct esp_timer *timer = calloc(1, sizeof(*timer));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->args = *create_args;
+    mock_timer_init(&timer->timer, esp_timer_callback, timer);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (mock_timer_is_active(&timer->timer)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    mock_timer_start(&timer->timer, timeout_us, false);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    if (mock_timer_is_active(&timer->timer)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    mock_timer_start(&timer->timer, period, true);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!mock_timer_is_active(&timer->timer)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    mock_timer_stop(&timer->timer);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    mock_timer_remove(&timer->timer);
+    free(timer);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return mock_timer_is_active(&timer->timer);
+}
+
+// esp_pm and esp_sleep, power management is not available on the host
+
+esp_err_t esp_pm_configure(const void *config) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+struct esp_pm_lock {
+    esp_pm_lock_type_t type;
+};
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t lock_type, int arg, const char *name, esp_pm_lock_handle_t *out_handle) {
+    *out_handle = calloc(1, sizeof(struct esp_pm_lock));
+    return *out_handle != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t handle) {
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t handle) {
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup(void) {
+    return ESP_OK;
+}
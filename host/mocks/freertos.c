@@ -0,0 +1,634 @@
+// FreeRTOS on POSIX threads: tasks, notifications, queues, semaphores, event groups and timers.
+// Priorities and core affinity are recorded but not enforced, the host scheduler decides.
+#include "mock_internal.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "freertos/timers.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MOCK_TASK_NAME_LEN 16
+
+struct tskTaskControlBlock {
+    pthread_t thread;
+    char name[MOCK_TASK_NAME_LEN];
+    TaskFunction_t function;
+    void *arg;
+    UBaseType_t priority;
+    uint32_t stack_size;
+    BaseType_t core_id;
+
+    // Task notification
+    pthread_mutex_t notify_lock;
+    pthread_cond_t notify_cond;
+    uint32_t notify_value;
+    bool notify_pending;
+
+    struct tskTaskControlBlock *next;
+};
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct tskTaskControlBlock *task_registry = NULL;
+static __thread struct tskTaskControlBlock *current_task = NULL;
+
+// One recursive lock stands in for every portMUX, critical sections are short
+static pthread_mutex_t critical_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+void vPortEnterCritical(portMUX_TYPE *mux) {
+    pthread_mutex_lock(&critical_lock);
+}
+
+void vPortExitCritical(portMUX_TYPE *mux) {
+    pthread_mutex_unlock(&critical_lock);
+}
+
+BaseType_t xPortGetCoreID(void) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    return task->core_id == tskNO_AFFINITY ? 0 : task->core_id;
+}
+
+void vTaskSuspendAll(void) {
+    pthread_mutex_lock(&critical_lock);
+}
+
+BaseType_t xTaskResumeAll(void) {
+    pthread_mutex_unlock(&critical_lock);
+    return pdFALSE;
+}
+
+// Tasks
+
+static struct tskTaskControlBlock *task_alloc(const char *name, UBaseType_t priority, uint32_t stack_size, BaseType_t core_id) {
+    struct tskTaskControlBlock *task = calloc(1, sizeof(*task));
+    if (task == NULL) {
+        return NULL;
+    }
+    strncpy(task->name, name != NULL ? name : "", MOCK_TASK_NAME_LEN - 1);
+    task->priority = priority;
+    task->stack_size = stack_size;
+    task->core_id = core_id;
+    pthread_mutex_init(&task->notify_lock, NULL);
+    mock_cond_init(&task->notify_cond);
+
+    pthread_mutex_lock(&registry_lock);
+    task->next = task_registry;
+    task_registry = task;
+    pthread_mutex_unlock(&registry_lock);
+    return task;
+}
+
+static void task_unregister(struct tskTaskControlBlock *task) {
+    pthread_mutex_lock(&registry_lock);
+    for (struct tskTaskControlBlock **link = &task_registry; *link != NULL; link = &(*link)->next) {
+        if (*link == task) {
+            *link = task->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+
+void mock_task_adopt_thread(const char *name, UBaseType_t priority) {
+    if (current_task == NULL) {
+        current_task = task_alloc(name, priority, 0, tskNO_AFFINITY);
+        current_task->thread = pthread_self();
+    }
+}
+
+static void *task_entry(void *arg) {
+    struct tskTaskControlBlock *task = arg;
+    current_task = task;
+    task->function(task->arg);
+    // Returning from a task function is an error on FreeRTOS, end the thread quietly here
+    task_unregister(task);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t prio, TaskHandle_t *out, BaseType_t core) {
+    struct tskTaskControlBlock *task = task_alloc(name, prio, stack, core);
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    task->function = fn;
+    task->arg = arg;
+    if (out != NULL) {
+        *out = task; // Set before the thread starts, tasks may notify each other right away
+    }
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        task_unregister(task);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t prio, TaskHandle_t *out) {
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, prio, out, tskNO_AFFINITY);
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t prio, StackType_t *stack_buf, StaticTask_t *tcb, BaseType_t core) {
+    TaskHandle_t handle = NULL;
+    xTaskCreatePinnedToCore(fn, name, stack, arg, prio, &handle, core); // Host threads bring their own stack
+    return handle;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t fn, const char *name, uint32_t stack, void *arg, UBaseType_t prio, StackType_t *stack_buf, StaticTask_t *tcb) {
+    return xTaskCreateStaticPinnedToCore(fn, name, stack, arg, prio, stack_buf, tcb, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == NULL || task == current_task) {
+        struct tskTaskControlBlock *self = xTaskGetCurrentTaskHandle();
+        task_unregister(self);
+        pthread_exit(NULL);
+    }
+    task_unregister(task);
+    pthread_cancel(task->thread);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (current_task == NULL) {
+        mock_task_adopt_thread("host", 1); // Threads not created through xTaskCreate
+    }
+    return current_task;
+}
+
+TaskHandle_t xTaskGetHandle(const char *name) {
+    TaskHandle_t found = NULL;
+    pthread_mutex_lock(&registry_lock);
+    for (struct tskTaskControlBlock *task = task_registry; task != NULL; task = task->next) {
+        if (strncmp(task->name, name, MOCK_TASK_NAME_LEN - 1) == 0) {
+            found = task;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+    return found;
+}
+
+const char *pcTaskGetName(TaskHandle_t task) {
+    return (task != NULL ? task : xTaskGetCurrentTaskHandle())->name;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+    return (task != NULL ? task : xTaskGetCurrentTaskHandle())->priority;
+}
+
+// Host threads have large stacks that cannot be inspected, report the configured size as free
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return (task != NULL ? task : xTaskGetCurrentTaskHandle())->stack_size;
+}
+
+// CPU time of the backing thread in microseconds
+uint32_t ulTaskGetRunTimeCounter(TaskHandle_t task) {
+    task = task != NULL ? task : xTaskGetCurrentTaskHandle();
+    clockid_t clock;
+    struct timespec cpu_time;
+    if (pthread_getcpuclockid(task->thread, &clock) != 0 || clock_gettime(clock, &cpu_time) != 0) {
+        return 0;
+    }
+    return (uint32_t)(cpu_time.tv_sec * 1000000ULL + cpu_time.tv_nsec / 1000);
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void) {
+    UBaseType_t count = 0;
+    pthread_mutex_lock(&registry_lock);
+    for (struct tskTaskControlBlock *task = task_registry; task != NULL; task = task->next) {
+        count++;
+    }
+    pthread_mutex_unlock(&registry_lock);
+    return count;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *array, UBaseType_t size, uint32_t *total_runtime) {
+    UBaseType_t count = 0;
+    pthread_mutex_lock(&registry_lock);
+    for (struct tskTaskControlBlock *task = task_registry; task != NULL && count < size; task = task->next) {
+        array[count] = (TaskStatus_t) {
+            .xHandle = task,
+            .pcTaskName = task->name,
+            .xTaskNumber = count,
+            .eCurrentState = task == current_task ? eRunning : eBlocked,
+            .uxCurrentPriority = task->priority,
+            .uxBasePriority = task->priority,
+            .ulRunTimeCounter = ulTaskGetRunTimeCounter(task),
+            .usStackHighWaterMark = task->stack_size,
+            .xCoreID = task->core_id,
+        };
+        count++;
+    }
+    pthread_mutex_unlock(&registry_lock);
+    if (total_runtime != NULL) {
+        *total_runtime = (uint32_t)mock_time_us();
+    }
+    return count;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        sched_yield();
+        return;
+    }
+    struct timespec delay = {
+        .tv_sec = pdTICKS_TO_MS(ticks) / 1000,
+        .tv_nsec = (pdTICKS_TO_MS(ticks) % 1000) * 1000000L,
+    };
+    while (nanosleep(&delay, &delay) != 0) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(mock_time_us() / (1000000 / configTICK_RATE_HZ));
+}
+
+TickType_t xTaskGetTickCountFromISR(void) {
+    return xTaskGetTickCount();
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *prev, TickType_t inc) {
+    TickType_t wake = *prev + inc;
+    TickType_t now = xTaskGetTickCount();
+    *prev = wake;
+    if ((int32_t)(wake - now) <= 0) {
+        return pdFALSE; // Already late
+    }
+    vTaskDelay(wake - now);
+    return pdTRUE;
+}
+
+void vTaskDelayUntil(TickType_t *prev, TickType_t inc) {
+    xTaskDelayUntil(prev, inc);
+}
+
+// Task notifications
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    BaseType_t result = pdPASS;
+    pthread_mutex_lock(&task->notify_lock);
+    switch (action) {
+    case eSetBits:
+        task->notify_value |= value;
+        break;
+    case eIncrement:
+        task->notify_value++;
+        break;
+    case eSetValueWithOverwrite:
+        task->notify_value = value;
+        break;
+    case eSetValueWithoutOverwrite:
+        if (task->notify_pending) {
+            result = pdFAIL;
+        } else {
+            task->notify_value = value;
+        }
+        break;
+    case eNoAction:
+        break;
+    }
+    task->notify_pending = true;
+    pthread_cond_broadcast(&task->notify_cond);
+    pthread_mutex_unlock(&task->notify_lock);
+    return result;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t *woken) {
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+    xTaskNotifyFromISR(task, 0, eIncrement, woken);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+    struct tskTaskControlBlock *task = xTaskGetCurrentTaskHandle();
+    struct timespec deadline;
+    bool timed = mock_deadline_from_ticks(wait, &deadline);
+
+    pthread_mutex_lock(&task->notify_lock);
+    while (task->notify_value == 0 && wait != 0) {
+        if (!mock_cond_wait(&task->notify_cond, &task->notify_lock, timed ? &deadline : NULL)) {
+            break;
+        }
+    }
+    uint32_t value = task->notify_value;
+    if (value != 0) {
+        task->notify_value = clear ? 0 : value - 1;
+    }
+    task->notify_pending = false;
+    pthread_mutex_unlock(&task->notify_lock);
+    return value;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t wait) {
+    struct tskTaskControlBlock *task = xTaskGetCurrentTaskHandle();
+    struct timespec deadline;
+    bool timed = mock_deadline_from_ticks(wait, &deadline);
+    BaseType_t result = pdTRUE;
+
+    pthread_mutex_lock(&task->notify_lock);
+    if (!task->notify_pending) {
+        task->notify_value &= ~clear_on_entry;
+        while (!task->notify_pending && wait != 0) {
+            if (!mock_cond_wait(&task->notify_cond, &task->notify_lock, timed ? &deadline : NULL)) {
+                break;
+            }
+        }
+    }
+    if (value != NULL) {
+        *value = task->notify_value;
+    }
+    if (task->notify_pending) {
+        task->notify_value &= ~clear_on_exit;
+        task->notify_pending = false;
+    } else {
+        result = pdFALSE;
+    }
+    pthread_mutex_unlock(&task->notify_lock);
+    return result;
+}
+
+// Queues, semaphores are queues with zero sized items
+
+struct QueueDefinition {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    uint8_t *storage;
+    UBaseType_t item_size;
+    UBaseType_t length;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t item_size) {
+    struct QueueDefinition *queue = calloc(1, sizeof(*queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    if (item_size > 0) {
+        queue->storage = calloc(len, item_size);
+        if (queue->storage == NULL) {
+            free(queue);
+            return NULL;
+        }
+    }
+    queue->item_size = item_size;
+    queue->length = len;
+    pthread_mutex_init(&queue->lock, NULL);
+    mock_cond_init(&queue->not_empty);
+    mock_cond_init(&queue->not_full);
+    return queue;
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t len, UBaseType_t item_size, uint8_t *storage, StaticQueue_t *buf) {
+    return xQueueCreate(len, item_size);
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    if (queue == NULL) {
+        return;
+    }
+    free(queue->storage);
+    free(queue);
+}
+
+static BaseType_t queue_send(QueueHandle_t queue, const void *item, TickType_t wait, bool overwrite) {
+    struct timespec deadline;
+    bool timed = mock_deadline_from_ticks(wait, &deadline);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count >= queue->length && !overwrite) {
+        if (wait == 0 || !mock_cond_wait(&queue->not_full, &queue->lock, timed ? &deadline : NULL)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFAIL; // errQUEUE_FULL
+        }
+    }
+    if (overwrite && queue->count >= queue->length) {
+        queue->count = queue->length - 1; // Only used on queues of length one
+    }
+    if (queue->item_size > 0 && item != NULL) { // Semaphores give without an item
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->storage + tail * queue->item_size, item, queue->item_size);
+    }
+    queue->count++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait) {
+    return queue_send(queue, item, wait, false);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken) {
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return queue_send(queue, item, 0, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item) {
+    return queue_send(queue, item, 0, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait) {
+    struct timespec deadline;
+    bool timed = mock_deadline_from_ticks(wait, &deadline);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0) {
+        if (wait == 0 || !mock_cond_wait(&queue->not_empty, &queue->lock, timed ? &deadline : NULL)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFAIL;
+        }
+    }
+    if (queue->item_size > 0 && item != NULL) {
+        memcpy(item, queue->storage + queue->head * queue->item_size, queue->item_size);
+    }
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buf) {
+    return xSemaphoreCreateBinary();
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    SemaphoreHandle_t mutex = xQueueCreate(1, 0);
+    if (mutex != NULL) {
+        mutex->count = 1; // Mutexes start available
+    }
+    return mutex;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buf) {
+    return xSemaphoreCreateMutex();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait) {
+    return xQueueReceive(semaphore, NULL, wait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    return queue_send(semaphore, NULL, 0, false);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *woken) {
+    return xQueueSendFromISR(semaphore, NULL, woken);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    vQueueDelete(semaphore);
+}
+
+// Event groups
+
+struct EventGroupDef_t {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    EventBits_t bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    struct EventGroupDef_t *group = calloc(1, sizeof(*group));
+    if (group != NULL) {
+        pthread_mutex_init(&group->lock, NULL);
+        mock_cond_init(&group->changed);
+    }
+    return group;
+}
+
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t *buf) {
+    return xEventGroupCreate();
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->lock);
+    group->bits |= bits;
+    EventBits_t result = group->bits;
+    pthread_cond_broadcast(&group->changed);
+    pthread_mutex_unlock(&group->lock);
+    return result;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->lock);
+    EventBits_t result = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->lock);
+    return result;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    pthread_mutex_lock(&group->lock);
+    EventBits_t result = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return result;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear, BaseType_t all, TickType_t wait) {
+    struct timespec deadline;
+    bool timed = mock_deadline_from_ticks(wait, &deadline);
+
+    pthread_mutex_lock(&group->lock);
+    while (1) {
+        EventBits_t set = group->bits & bits;
+        if (all ? set == bits : set != 0) {
+            break;
+        }
+        if (wait == 0 || !mock_cond_wait(&group->changed, &group->lock, timed ? &deadline : NULL)) {
+            break;
+        }
+    }
+    EventBits_t result = group->bits;
+    EventBits_t set = result & bits;
+    if (clear && (all ? set == bits : set != 0)) {
+        group->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&group->lock);
+    return result;
+}
+
+// Software timers, callbacks run on the shared timer service thread
+
+struct tmrTimerControl {
+    mock_timer_t timer;
+    TickType_t period;
+    bool reload;
+    void *id;
+    TimerCallbackFunction_t callback;
+};
+
+static void timer_callback(void *arg) {
+    struct tmrTimerControl *timer = arg;
+    timer->callback(timer);
+}
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t reload, void *id, TimerCallbackFunction_t cb) {
+    struct tmrTimerControl *timer = calloc(1, sizeof(*timer));
+    if (timer == NULL) {
+        return NULL;
+    }
+    timer->period = period;
+    timer->reload = reload;
+    timer->id = id;
+    timer->callback = cb;
+    mock_timer_init(&timer->timer, timer_callback, timer);
+    return timer;
+}
+
+TimerHandle_t xTimerCreateStatic(const char *name, TickType_t period, UBaseType_t reload, void *id, TimerCallbackFunction_t cb, StaticTimer_t *buf) {
+    return xTimerCreate(name, period, reload, id, cb);
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t wait) {
+    mock_timer_start(&timer->timer, (int64_t)pdTICKS_TO_MS(timer->period) * 1000, timer->reload);
+    return pdPASS;
+}
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t wait) {
+    return xTimerStart(timer, wait);
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t wait) {
+    mock_timer_stop(&timer->timer);
+    return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t wait) {
+    timer->period = period;
+    return xTimerStart(timer, wait); // Changing the period also starts the timer
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer) {
+    return mock_timer_is_active(&timer->timer) ? pdTRUE : pdFALSE;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t timer) {
+    return timer->id;
+}
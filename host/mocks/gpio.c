@@ -0,0 +1,158 @@
+// GPIO levels and edge interrupts, inputs are driven through mock_gpio_set_input()
+#include "mock_internal.h"
+#include "mock_host.h"
+#include "driver/gpio.h"
+
+typedef struct {
+    gpio_mode_t mode;
+    gpio_int_type_t intr_type;
+    int level;
+    uint32_t toggles;
+    gpio_isr_t isr_handler;
+    void *isr_arg;
+} gpio_state_t;
+
+static pthread_mutex_t gpio_lock = PTHREAD_MUTEX_INITIALIZER;
+static gpio_state_t pins[GPIO_NUM_MAX];
+static bool isr_service_installed = false;
+
+static bool gpio_valid(gpio_num_t gpio_num) {
+    return gpio_num >= 0 && gpio_num < GPIO_NUM_MAX;
+}
+
+esp_err_t gpio_config(const gpio_config_t *cfg) {
+    if (cfg == NULL || cfg->pin_bit_mask == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    for (int i = 0; i < GPIO_NUM_MAX; i++) {
+        if (cfg->pin_bit_mask & (1ULL << i)) {
+            pins[i].mode = cfg->mode;
+            pins[i].intr_type = cfg->intr_type;
+            if (cfg->mode & GPIO_MODE_INPUT) {
+                pins[i].level = cfg->pull_up_en == GPIO_PULLUP_ENABLE; // Idle level of an open input
+            }
+        }
+    }
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) {
+    if (!gpio_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    pins[gpio_num].mode = mode;
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (!gpio_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    if (pins[gpio_num].level != (level != 0)) {
+        pins[gpio_num].level = level != 0;
+        pins[gpio_num].toggles++;
+    }
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    if (!gpio_valid(gpio_num)) {
+        return 0;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    int level = pins[gpio_num].level;
+    pthread_mutex_unlock(&gpio_lock);
+    return level;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags) {
+    if (isr_service_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    isr_service_installed = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args) {
+    if (!gpio_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!isr_service_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    pins[gpio_num].isr_handler = isr_handler;
+    pins[gpio_num].isr_arg = args;
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num) {
+    if (!gpio_valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    pins[gpio_num].isr_handler = NULL;
+    pins[gpio_num].isr_arg = NULL;
+    pthread_mutex_unlock(&gpio_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    return gpio_valid(gpio_num) && intr_type >= GPIO_INTR_LOW_LEVEL ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+void mock_gpio_set_input(gpio_num_t gpio_num, int level) {
+    if (!gpio_valid(gpio_num)) {
+        return;
+    }
+    level = level != 0;
+
+    pthread_mutex_lock(&gpio_lock);
+    gpio_state_t *pin = &pins[gpio_num];
+    int previous = pin->level;
+    pin->level = level;
+    bool fire = false;
+    switch (pin->intr_type) {
+        case GPIO_INTR_POSEDGE:
+            fire = !previous && level;
+            break;
+        case GPIO_INTR_NEGEDGE:
+            fire = previous && !level;
+            break;
+        case GPIO_INTR_ANYEDGE:
+            fire = previous != level;
+            break;
+        case GPIO_INTR_LOW_LEVEL:
+            fire = !level;
+            break;
+        case GPIO_INTR_HIGH_LEVEL:
+            fire = level;
+            break;
+        default:
+            break;
+    }
+    gpio_isr_t handler = fire ? pin->isr_handler : NULL;
+    void *arg = pin->isr_arg;
+    pthread_mutex_unlock(&gpio_lock);
+
+    if (handler != NULL) {
+        handler(arg);
+    }
+}
+
+uint32_t mock_gpio_get_toggle_count(gpio_num_t gpio_num) {
+    if (!gpio_valid(gpio_num)) {
+        return 0;
+    }
+    pthread_mutex_lock(&gpio_lock);
+    uint32_t toggles = pins[gpio_num].toggles;
+    pthread_mutex_unlock(&gpio_lock);
+    return toggles;
+}
@@ -0,0 +1,186 @@
+// HTTP server without sockets, requests are run through the handlers with mock_httpd_request()
+#include "mock_internal.h"
+#include "mock_host.h"
+#include "esp_http_server.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    httpd_config_t config;
+    httpd_uri_t *handlers;
+    int handler_count;
+} http_server_t;
+
+// Per request state, reached through httpd_req_t.aux
+typedef struct {
+    const char *body;
+    size_t body_offset;
+    char *response;
+    size_t response_size;
+    size_t response_length;
+    int status;
+} mock_request_t;
+
+static pthread_mutex_t httpd_lock = PTHREAD_MUTEX_INITIALIZER;
+static http_server_t *running_server = NULL;
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config) {
+    if (handle == NULL || config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&httpd_lock);
+    if (running_server != NULL) {
+        pthread_mutex_unlock(&httpd_lock);
+        return ESP_ERR_INVALID_STATE; // One server per process, as the port is shared
+    }
+    http_server_t *server = calloc(1, sizeof(*server));
+    server->config = *config;
+    server->handlers = calloc(config->max_uri_handlers, sizeof(httpd_uri_t));
+    running_server = server;
+    pthread_mutex_unlock(&httpd_lock);
+    *handle = server;
+    return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle) {
+    pthread_mutex_lock(&httpd_lock);
+    if (running_server == handle) {
+        running_server = NULL;
+    }
+    pthread_mutex_unlock(&httpd_lock);
+    http_server_t *server = handle;
+    free(server->handlers);
+    free(server);
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler) {
+    http_server_t *server = handle;
+    if (server == NULL || uri_handler == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&httpd_lock);
+    esp_err_t err = ESP_OK;
+    if (server->handler_count >= server->config.max_uri_handlers) {
+        err = ESP_ERR_NO_MEM; // ESP_ERR_HTTPD_HANDLERS_FULL on the target
+    } else {
+        server->handlers[server->handler_count++] = *uri_handler;
+    }
+    pthread_mutex_unlock(&httpd_lock);
+    return err;
+}
+
+// Exact match, or a prefix match for templates ending in '*'
+static bool uri_matches(const char *template, const char *uri) {
+    size_t length = strlen(template);
+    if (length > 0 && template[length - 1] == '*') {
+        return strncmp(template, uri, length - 1) == 0;
+    }
+    return strcmp(template, uri) == 0;
+}
+
+esp_err_t mock_httpd_request(httpd_method_t method, const char *uri, const char *body,
+                             char *response, size_t response_size, int *status) {
+    pthread_mutex_lock(&httpd_lock);
+    http_server_t *server = running_server;
+    httpd_uri_t handler = { 0 };
+    bool found = false;
+    for (int i = 0; server != NULL && i < server->handler_count && !found; i++) {
+        if (server->handlers[i].method == method && uri_matches(server->handlers[i].uri, uri)) {
+            handler = server->handlers[i];
+            found = true;
+        }
+    }
+    pthread_mutex_unlock(&httpd_lock);
+
+    if (server == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (response_size > 0) {
+        response[0] = '\0';
+    }
+    if (!found) {
+        *status = 404;
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    mock_request_t request = {
+        .body = body != NULL ? body : "",
+        .response = response,
+        .response_size = response_size,
+        .status = 200,
+    };
+    httpd_req_t req = {
+        .handle = server,
+        .method = method,
+        .content_len = body != NULL ? strlen(body) : 0,
+        .aux = &request,
+        .user_ctx = handler.user_ctx,
+    };
+    strncpy((char *)req.uri, uri, sizeof(req.uri) - 1);
+
+    esp_err_t err = handler.handler(&req);
+    *status = request.status;
+    return err;
+}
+
+static void response_append(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+    mock_request_t *request = r->aux;
+    if (buf == NULL) {
+        return;
+    }
+    size_t length = buf_len == HTTPD_RESP_USE_STRLEN ? strlen(buf) : (size_t)buf_len;
+    if (request->response_size == 0) {
+        return;
+    }
+    size_t space = request->response_size - 1 - request->response_length;
+    length = length < space ? length : space;
+    memcpy(request->response + request->response_length, buf, length);
+    request->response_length += length;
+    request->response[request->response_length] = '\0';
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+    response_append(r, buf, buf_len);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len) {
+    response_append(r, buf, buf_len);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str) {
+    response_append(r, str, HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type) {
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status) {
+    mock_request_t *request = r->aux;
+    request->status = atoi(status);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value) {
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_500(httpd_req_t *r) {
+    mock_request_t *request = r->aux;
+    request->status = 500;
+    response_append(r, "Internal Server Error", HTTPD_RESP_USE_STRLEN);
+    return ESP_OK;
+}
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len) {
+    mock_request_t *request = r->aux;
+    size_t remaining = strlen(request->body + request->body_offset);
+    size_t length = remaining < buf_len ? remaining : buf_len;
+    memcpy(buf, request->body + request->body_offset, length);
+    request->body_offset += length;
+    return length;
+}
@@ -0,0 +1,199 @@
+// I2C master bus, transmitted bytes are recorded per device address
+#include "mock_internal.h"
+#include "mock_host.h"
+#include "driver/i2c_master.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MOCK_I2C_ADDRESSES 128
+#define MOCK_I2C_STREAM_MAX (16 * 1024 * 1024) // Oldest half is dropped beyond this
+
+struct i2c_master_bus_t {
+    i2c_master_bus_config_t config;
+};
+
+struct i2c_master_dev_t {
+    i2c_master_bus_handle_t bus;
+    i2c_device_config_t config;
+};
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    uint32_t transactions;
+} byte_stream_t;
+
+static pthread_mutex_t i2c_lock = PTHREAD_MUTEX_INITIALIZER;
+static byte_stream_t streams[MOCK_I2C_ADDRESSES];
+static uint8_t absent[MOCK_I2C_ADDRESSES / 8];
+static uint32_t max_speed_hz = 0;
+static mock_i2c_tx_hook_t tx_hook = NULL;
+static void *tx_hook_ctx = NULL;
+
+static bool device_present(uint16_t address) {
+    return address < MOCK_I2C_ADDRESSES && !(absent[address / 8] & (1 << (address % 8)));
+}
+
+static void stream_append(byte_stream_t *stream, const uint8_t *data, size_t size) {
+    if (stream->size + size > MOCK_I2C_STREAM_MAX) {
+        size_t drop = stream->size / 2;
+        memmove(stream->data, stream->data + drop, stream->size - drop);
+        stream->size -= drop;
+    }
+    if (stream->size + size > stream->capacity) {
+        size_t capacity = stream->capacity ? stream->capacity : 4096;
+        while (capacity < stream->size + size) {
+            capacity *= 2;
+        }
+        stream->data = realloc(stream->data, capacity);
+        stream->capacity = capacity;
+    }
+    memcpy(stream->data + stream->size, data, size);
+    stream->size += size;
+    stream->transactions++;
+}
+
+void mock_i2c_set_tx_hook(mock_i2c_tx_hook_t hook, void *ctx) {
+    pthread_mutex_lock(&i2c_lock);
+    tx_hook = hook;
+    tx_hook_ctx = ctx;
+    pthread_mutex_unlock(&i2c_lock);
+}
+
+void mock_i2c_set_max_speed_hz(uint32_t speed_hz) {
+    pthread_mutex_lock(&i2c_lock);
+    max_speed_hz = speed_hz;
+    pthread_mutex_unlock(&i2c_lock);
+}
+
+void mock_i2c_set_device_present(uint16_t address, bool present) {
+    if (address >= MOCK_I2C_ADDRESSES) {
+        return;
+    }
+    pthread_mutex_lock(&i2c_lock);
+    if (present) {
+        absent[address / 8] &= ~(1 << (address % 8));
+    } else {
+        absent[address / 8] |= 1 << (address % 8);
+    }
+    pthread_mutex_unlock(&i2c_lock);
+}
+
+size_t mock_i2c_get_stream(uint16_t address, const uint8_t **data) {
+    if (address >= MOCK_I2C_ADDRESSES) {
+        *data = NULL;
+        return 0;
+    }
+    pthread_mutex_lock(&i2c_lock);
+    *data = streams[address].data;
+    size_t size = streams[address].size;
+    pthread_mutex_unlock(&i2c_lock);
+    return size;
+}
+
+uint32_t mock_i2c_get_transaction_count(uint16_t address) {
+    if (address >= MOCK_I2C_ADDRESSES) {
+        return 0;
+    }
+    pthread_mutex_lock(&i2c_lock);
+    uint32_t transactions = streams[address].transactions;
+    pthread_mutex_unlock(&i2c_lock);
+    return transactions;
+}
+
+void mock_i2c_clear_streams(void) {
+    pthread_mutex_lock(&i2c_lock);
+    for (int i = 0; i < MOCK_I2C_ADDRESSES; i++) {
+        streams[i].size = 0;
+        streams[i].transactions = 0;
+    }
+    pthread_mutex_unlock(&i2c_lock);
+}
+
+esp_err_t mock_i2c_dump_stream(uint16_t address, const char *path) {
+    if (address >= MOCK_I2C_ADDRESSES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return ESP_FAIL;
+    }
+    pthread_mutex_lock(&i2c_lock);
+    size_t written = fwrite(streams[address].data, 1, streams[address].size, file);
+    bool complete = written == streams[address].size;
+    pthread_mutex_unlock(&i2c_lock);
+    fclose(file);
+    return complete ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *bus_config, i2c_master_bus_handle_t *ret_bus_handle) {
+    if (bus_config == NULL || ret_bus_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct i2c_master_bus_t *bus = calloc(1, sizeof(*bus));
+    if (bus == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    bus->config = *bus_config;
+    *ret_bus_handle = bus;
+    return ESP_OK;
+}
+
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t bus_handle) {
+    free(bus_handle);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle, const i2c_device_config_t *dev_config, i2c_master_dev_handle_t *ret_handle) {
+    if (bus_handle == NULL || dev_config == NULL || ret_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct i2c_master_dev_t *dev = calloc(1, sizeof(*dev));
+    if (dev == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    dev->bus = bus_handle;
+    dev->config = *dev_config;
+    *ret_handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t handle) {
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer, size_t write_size, int xfer_timeout_ms) {
+    if (i2c_dev == NULL || write_buffer == NULL || write_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint16_t address = i2c_dev->config.device_address;
+
+    pthread_mutex_lock(&i2c_lock);
+    esp_err_t err = ESP_OK;
+    if (!device_present(address)) {
+        err = ESP_ERR_INVALID_STATE; // NACK on the address byte
+    } else if (max_speed_hz != 0 && i2c_dev->config.scl_speed_hz > max_speed_hz) {
+        err = ESP_ERR_TIMEOUT; // Edges too slow for the bus capacitance, the transfer never completes
+    } else if (tx_hook != NULL) {
+        err = tx_hook(address, write_buffer, write_size, tx_hook_ctx);
+    }
+    if (err == ESP_OK) {
+        stream_append(&streams[address], write_buffer, write_size);
+    }
+    pthread_mutex_unlock(&i2c_lock);
+    return err;
+}
+
+esp_err_t i2c_master_probe(i2c_master_bus_handle_t bus_handle, uint16_t address, int xfer_timeout_ms) {
+    pthread_mutex_lock(&i2c_lock);
+    bool present = device_present(address);
+    pthread_mutex_unlock(&i2c_lock);
+    return present ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t i2c_master_bus_reset(i2c_master_bus_handle_t bus_handle) {
+    return bus_handle != NULL ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
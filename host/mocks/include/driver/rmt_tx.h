@@ -0,0 +1,17 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+typedef enum { RMT_CLK_SRC_APB = 4, RMT_CLK_SRC_REF_TICK = 10, RMT_CLK_SRC_DEFAULT = RMT_CLK_SRC_APB } rmt_clock_source_t;
+typedef union { struct { uint16_t duration0 : 15; uint16_t level0 : 1; uint16_t duration1 : 15; uint16_t level1 : 1; }; uint32_t val; } rmt_symbol_word_t;
+typedef struct rmt_channel_t *rmt_channel_handle_t;
+typedef struct rmt_encoder_t *rmt_encoder_handle_t;
+typedef struct { gpio_num_t gpio_num; rmt_clock_source_t clk_src; uint32_t resolution_hz; size_t mem_block_symbols; size_t trans_queue_depth; int intr_priority; struct { uint32_t invert_out : 1; uint32_t with_dma : 1; uint32_t io_loop_back : 1; uint32_t io_od_mode : 1; } flags; } rmt_tx_channel_config_t;
+typedef struct { int loop_count; struct { uint32_t eot_level : 1; uint32_t queue_nonblocking : 1; } flags; } rmt_transmit_config_t;
+typedef struct { int reserved; } rmt_copy_encoder_config_t;
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan);
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+esp_err_t rmt_enable(rmt_channel_handle_t channel);
+esp_err_t rmt_disable(rmt_channel_handle_t channel);
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload, size_t payload_bytes, const rmt_transmit_config_t *config);
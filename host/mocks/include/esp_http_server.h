@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+typedef void *httpd_handle_t;
+typedef enum { HTTP_DELETE = 0, HTTP_GET = 1, HTTP_HEAD = 2, HTTP_POST = 3, HTTP_PUT = 4 } httpd_method_t;
+typedef struct httpd_req { httpd_handle_t handle; int method; const char uri[513]; size_t content_len; void *aux; void *user_ctx; } httpd_req_t;
+typedef struct httpd_uri { const char *uri; httpd_method_t method; esp_err_t (*handler)(httpd_req_t *r); void *user_ctx; } httpd_uri_t;
+typedef struct { unsigned task_priority; size_t stack_size; int core_id; uint16_t server_port; uint16_t max_uri_handlers; uint16_t max_open_sockets; } httpd_config_t;
+#define HTTPD_DEFAULT_CONFIG() { .task_priority = 5, .stack_size = 4096, .core_id = 0x7FFFFFFF, .server_port = 80, .max_uri_handlers = 8, .max_open_sockets = 7 }
+#define HTTPD_RESP_USE_STRLEN -1
+#define HTTPD_SOCK_ERR_TIMEOUT -3
+#define HTTPD_200 "200 OK"
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config);
+esp_err_t httpd_stop(httpd_handle_t handle);
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler);
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len);
+esp_err_t httpd_resp_sendstr_chunk(httpd_req_t *r, const char *str);
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type);
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value);
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len);
+esp_err_t httpd_resp_send_500(httpd_req_t *r);
@@ -0,0 +1,16 @@
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+typedef struct { uint32_t addr; } esp_ip4_addr_t;
+typedef struct { esp_ip4_addr_t ip; esp_ip4_addr_t netmask; esp_ip4_addr_t gw; } esp_netif_ip_info_t;
+typedef struct esp_netif_obj esp_netif_t;
+#define IPSTR "%d.%d.%d.%d"
+#define esp_ip4_addr_get_byte(ipaddr, idx) (((const uint8_t *)(&(ipaddr)->addr))[idx])
+#define IP2STR(ipaddr) esp_ip4_addr_get_byte(ipaddr, 0), esp_ip4_addr_get_byte(ipaddr, 1), esp_ip4_addr_get_byte(ipaddr, 2), esp_ip4_addr_get_byte(ipaddr, 3)
+#define IP4_ADDR(ipaddr, a, b, c, d) (ipaddr)->addr = ((uint32_t)((d) & 0xff) << 24) | ((uint32_t)((c) & 0xff) << 16) | ((uint32_t)((b) & 0xff) << 8) | (uint32_t)((a) & 0xff)
+esp_err_t esp_netif_init(void);
+esp_netif_t *esp_netif_create_default_wifi_sta(void);
+esp_netif_t *esp_netif_create_default_wifi_ap(void);
+esp_err_t esp_netif_dhcps_stop(esp_netif_t *netif);
+esp_err_t esp_netif_dhcps_start(esp_netif_t *netif);
+esp_err_t esp_netif_set_ip_info(esp_netif_t *netif, const esp_netif_ip_info_t *ip_info);
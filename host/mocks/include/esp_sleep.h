@@ -0,0 +1,4 @@
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+esp_err_t esp_sleep_enable_gpio_wakeup(void);
@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t; // Stack sizes are in bytes as on ESP-IDF
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ CONFIG_FREERTOS_HZ
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000U))
+#define pdTICKS_TO_MS(t) ((uint32_t)(((uint64_t)(t) * 1000U) / configTICK_RATE_HZ))
+#define configMAX_PRIORITIES 25
+#define configMINIMAL_STACK_SIZE 768
+#define configNUMBER_OF_CORES 2
+#define portNUM_PROCESSORS 2
+#define tskNO_AFFINITY 0x7FFFFFFF
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define BIT0 0x01
+#define BIT1 0x02
+#define BIT2 0x04
+#define BIT3 0x08
+#define BIT4 0x10
+#define BIT5 0x20
+#define BIT6 0x40
+#define BIT7 0x80
+typedef struct { int owner; int count; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0, 0 }
+void vPortEnterCritical(portMUX_TYPE *mux);
+void vPortExitCritical(portMUX_TYPE *mux);
+#define portENTER_CRITICAL(m) vPortEnterCritical(m)
+#define portEXIT_CRITICAL(m) vPortExitCritical(m)
+#define portENTER_CRITICAL_ISR(m) vPortEnterCritical(m)
+#define portEXIT_CRITICAL_ISR(m) vPortExitCritical(m)
+#define taskENTER_CRITICAL(m) vPortEnterCritical(m)
+#define taskEXIT_CRITICAL(m) vPortExitCritical(m)
+#define portYIELD_FROM_ISR(x) ((void)(x))
+BaseType_t xPortGetCoreID(void);
+typedef struct { uint8_t dummy[96]; } StaticTask_t;
+typedef struct { uint8_t dummy[80]; } StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
+typedef struct { uint8_t dummy[48]; } StaticTimer_t;
+typedef struct { uint8_t dummy[32]; } StaticEventGroup_t;
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
@@ -0,0 +1,12 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+typedef struct tmrTimerControl *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t);
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t reload, void *id, TimerCallbackFunction_t cb);
+TimerHandle_t xTimerCreateStatic(const char *name, TickType_t period, UBaseType_t reload, void *id, TimerCallbackFunction_t cb, StaticTimer_t *buf);
+BaseType_t xTimerStart(TimerHandle_t t, TickType_t wait);
+BaseType_t xTimerStop(TimerHandle_t t, TickType_t wait);
+BaseType_t xTimerReset(TimerHandle_t t, TickType_t wait);
+BaseType_t xTimerChangePeriod(TimerHandle_t t, TickType_t period, TickType_t wait);
+BaseType_t xTimerIsTimerActive(TimerHandle_t t);
+void *pvTimerGetTimerID(TimerHandle_t t);
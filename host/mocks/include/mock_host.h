@@ -0,0 +1,82 @@
+/*
+ * Control surface of the host mocks, used by host tools and tests to feed inputs
+ * and inspect outputs of the mocked drivers.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "esp_adc/adc_continuous.h"
+#include "driver/gpio.h"
+#include "driver/rmt_tx.h"
+#include "driver/uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// I2C master: every transmitted byte is appended to a per-address stream (PCF8574 output latch)
+
+// Called for every transmit, a non ESP_OK result is returned to the caller (e.g. to emulate a NACK)
+typedef esp_err_t (*mock_i2c_tx_hook_t)(uint16_t address, const uint8_t *data, size_t size, void *ctx);
+
+void mock_i2c_set_tx_hook(mock_i2c_tx_hook_t hook, void *ctx);
+// Transmits of devices added above this speed time out, 0 (default) for no limit
+void mock_i2c_set_max_speed_hz(uint32_t speed_hz);
+// Addresses answering i2c_master_probe() and transmits, all addresses answer by default
+void mock_i2c_set_device_present(uint16_t address, bool present);
+// Recorded bytes written to an address, valid until the next transmit or clear
+size_t mock_i2c_get_stream(uint16_t address, const uint8_t **data);
+// Transmit calls that reached an address since the last clear
+uint32_t mock_i2c_get_transaction_count(uint16_t address);
+void mock_i2c_clear_streams(void);
+// Write the stream of an address to a file
+esp_err_t mock_i2c_dump_stream(uint16_t address, const char *path);
+
+// ADC continuous: frames are synthesized from per-input values or replayed from a recording
+
+// Raw value synthesized for an input, with +/- noise LSB of uniform noise
+void mock_adc_set_input(adc_unit_t unit, adc_channel_t channel, uint16_t raw);
+void mock_adc_set_noise(uint16_t noise_lsb);
+// Replay raw DMA frames (adc_digi_output_data_t entries in the configured output format), looping
+esp_err_t mock_adc_replay_load(const char *path);
+void mock_adc_replay_set(const uint8_t *data, size_t size);
+// Record every produced frame to a file, NULL stops recording
+esp_err_t mock_adc_record_to(const char *path);
+// Frames produced and frames dropped because the pool was full
+uint32_t mock_adc_get_frames_produced(void);
+uint32_t mock_adc_get_frames_dropped(void);
+
+// GPIO: inputs are driven by the host, edges run the registered ISR handler on the caller's thread
+void mock_gpio_set_input(gpio_num_t gpio, int level);
+// Number of level changes written to an output
+uint32_t mock_gpio_get_toggle_count(gpio_num_t gpio);
+
+// RMT TX: the last waveform sent on a pin, valid until the next transmit on it
+size_t mock_rmt_get_waveform(gpio_num_t gpio, const rmt_symbol_word_t **symbols, uint32_t *resolution_hz,
+                             int *loop_count);
+// Number of rmt_transmit() calls on a pin
+uint32_t mock_rmt_get_transmit_count(gpio_num_t gpio);
+
+// Wi-Fi: outcome of the next STA connection attempt
+void mock_wifi_set_sta_result(bool connect, uint8_t disconnect_reason);
+
+// HTTP server: run a request through the registered URI handlers
+esp_err_t mock_httpd_request(httpd_method_t method, const char *uri, const char *body,
+                             char *response, size_t response_size, int *status);
+
+// SPI master: bytes returned by the next transmissions
+void mock_spi_set_rx_data(const uint8_t rx_data[4]);
+
+// UART: write everything sent on a port other than the console to a file, NULL stops recording
+esp_err_t mock_uart_record_to(uart_port_t uart_num, const char *path);
+
+// NVS: drop every stored key
+void mock_nvs_erase_all(void);
+
+#ifdef __cplusplus
+}
+#endif
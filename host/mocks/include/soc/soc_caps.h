@@ -0,0 +1,5 @@
+#pragma once
+#include "esp_adc/adc_continuous.h"
+#define SOC_ADC_DIG_SUPPORTED_UNIT(UNIT) ((UNIT == 0) ? 1 : 0)
+#define SOC_RMT_MEM_WORDS_PER_CHANNEL 64
+#define SOC_RMT_TX_CANDIDATES_PER_GROUP 8
@@ -0,0 +1,43 @@
+// Helpers shared by the host mock implementations
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+
+// Microseconds since the process started, the time base of esp_timer and the tick count
+int64_t mock_time_us(void);
+
+// Absolute CLOCK_MONOTONIC deadline for a timeout in ticks, false for portMAX_DELAY
+bool mock_deadline_from_ticks(TickType_t ticks, struct timespec *deadline);
+
+// Absolute CLOCK_MONOTONIC deadline for a timeout in microseconds
+void mock_deadline_from_us(int64_t timeout_us, struct timespec *deadline);
+
+// Condition variable waiting on CLOCK_MONOTONIC
+void mock_cond_init(pthread_cond_t *cond);
+
+// Wait on a condition until a deadline, NULL waits forever. Returns false on timeout.
+bool mock_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *deadline);
+
+// Software timers run by a single service thread, shared by FreeRTOS timers and esp_timer
+typedef struct mock_timer {
+    void (*callback)(void *arg);
+    void *arg;
+    int64_t period_us;          // Reload period of periodic timers
+    int64_t expiry_us;          // Next expiry in mock_time_us()
+    bool active;
+    bool periodic;
+    struct mock_timer *next;
+} mock_timer_t;
+
+void mock_timer_init(mock_timer_t *timer, void (*callback)(void *arg), void *arg);
+void mock_timer_start(mock_timer_t *timer, int64_t timeout_us, bool periodic);
+void mock_timer_stop(mock_timer_t *timer);
+bool mock_timer_is_active(mock_timer_t *timer);
+void mock_timer_remove(mock_timer_t *timer);
+
+// Registers the calling thread as a task (timer service, host main) so task APIs work on it
+void mock_task_adopt_thread(const char *name, UBaseType_t priority);
@@ -0,0 +1,154 @@
+// Time base, deadlines and the software timer service thread
+#include "mock_internal.h"
+#include <errno.h>
+#include <string.h>
+
+static struct timespec start_time;
+static pthread_once_t start_time_once = PTHREAD_ONCE_INIT;
+
+static void mock_time_init(void) {
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+}
+
+int64_t mock_time_us(void) {
+    pthread_once(&start_time_once, mock_time_init);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)(now.tv_sec - start_time.tv_sec) * 1000000 + (now.tv_nsec - start_time.tv_nsec) / 1000;
+}
+
+void mock_deadline_from_us(int64_t timeout_us, struct timespec *deadline) {
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += timeout_us / 1000000;
+    deadline->tv_nsec += (timeout_us % 1000000) * 1000;
+    if (deadline->tv_nsec >= 1000000000) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000;
+    }
+}
+
+bool mock_deadline_from_ticks(TickType_t ticks, struct timespec *deadline) {
+    if (ticks == portMAX_DELAY) {
+        return false;
+    }
+    mock_deadline_from_us((int64_t)pdTICKS_TO_MS(ticks) * 1000, deadline);
+    return true;
+}
+
+void mock_cond_init(pthread_cond_t *cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+bool mock_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *deadline) {
+    if (deadline == NULL) {
+        pthread_cond_wait(cond, mutex);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, mutex, deadline) != ETIMEDOUT;
+}
+
+// Timer service: an unsorted list scanned for the earliest expiry, there are only a few timers
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_cond;
+static mock_timer_t *timer_list = NULL;
+static pthread_once_t timer_service_once = PTHREAD_ONCE_INIT;
+
+static void *timer_service_thread(void *arg) {
+    mock_task_adopt_thread("Tmr Svc", configMAX_PRIORITIES - 1);
+
+    pthread_mutex_lock(&timer_lock);
+    while (1) {
+        mock_timer_t *next = NULL;
+        for (mock_timer_t *timer = timer_list; timer != NULL; timer = timer->next) {
+            if (timer->active && (next == NULL || timer->expiry_us < next->expiry_us)) {
+                next = timer;
+            }
+        }
+        if (next == NULL) {
+            pthread_cond_wait(&timer_cond, &timer_lock);
+            continue;
+        }
+
+        int64_t now = mock_time_us();
+        if (next->expiry_us > now) {
+            struct timespec deadline;
+            mock_deadline_from_us(next->expiry_us - now, &deadline);
+            mock_cond_wait(&timer_cond, &timer_lock, &deadline);
+            continue; // Re-scan, timers may have changed
+        }
+
+        if (next->periodic) {
+            next->expiry_us += next->period_us;
+            if (next->expiry_us < now) {
+                next->expiry_us = now + next->period_us; // Skip missed periods
+            }
+        } else {
+            next->active = false;
+        }
+        void (*callback)(void *) = next->callback;
+        void *callback_arg = next->arg;
+        pthread_mutex_unlock(&timer_lock);
+        callback(callback_arg);
+        pthread_mutex_lock(&timer_lock);
+    }
+    return NULL;
+}
+
+static void timer_service_start(void) {
+    pthread_t thread;
+    mock_cond_init(&timer_cond);
+    pthread_create(&thread, NULL, timer_service_thread, NULL);
+    pthread_detach(thread);
+}
+
+void mock_timer_init(mock_timer_t *timer, void (*callback)(void *arg), void *arg) {
+    pthread_once(&timer_service_once, timer_service_start);
+    memset(timer, 0, sizeof(*timer));
+    timer->callback = callback;
+    timer->arg = arg;
+
+    pthread_mutex_lock(&timer_lock);
+    timer->next = timer_list;
+    timer_list = timer;
+    pthread_mutex_unlock(&timer_lock);
+}
+
+void mock_timer_start(mock_timer_t *timer, int64_t timeout_us, bool periodic) {
+    pthread_mutex_lock(&timer_lock);
+    timer->period_us = timeout_us > 0 ? timeout_us : 1;
+    timer->expiry_us = mock_time_us() + timeout_us;
+    timer->periodic = periodic;
+    timer->active = true;
+    pthread_cond_signal(&timer_cond);
+    pthread_mutex_unlock(&timer_lock);
+}
+
+void mock_timer_stop(mock_timer_t *timer) {
+    pthread_mutex_lock(&timer_lock);
+    timer->active = false;
+    pthread_cond_signal(&timer_cond);
+    pthread_mutex_unlock(&timer_lock);
+}
+
+bool mock_timer_is_active(mock_timer_t *timer) {
+    pthread_mutex_lock(&timer_lock);
+    bool active = timer->active;
+    pthread_mutex_unlock(&timer_lock);
+    return active;
+}
+
+void mock_timer_remove(mock_timer_t *timer) {
+    pthread_mutex_lock(&timer_lock);
+    for (mock_timer_t **link = &timer_list; *link != NULL; link = &(*link)->next) {
+        if (*link == timer) {
+            *link = timer->next;
+            break;
+        }
+    }
+    pthread_cond_signal(&timer_cond);
+    pthread_mutex_unlock(&timer_lock);
+}
@@ -0,0 +1,227 @@
+// NVS in memory, a flat list of namespace/key entries that lives for the process
+#include "mock_internal.h"
+#include "mock_host.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MOCK_NVS_HANDLES 16
+#define NVS_KEY_NAME_MAX_SIZE 16
+
+typedef enum {
+    NVS_ENTRY_I32,
+    NVS_ENTRY_STR,
+    NVS_ENTRY_BLOB,
+} nvs_entry_type_t;
+
+typedef struct nvs_entry {
+    char namespace_name[NVS_KEY_NAME_MAX_SIZE];
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_entry_type_t type;
+    int32_t i32;
+    uint8_t *data;          // String (with terminator) or blob
+    size_t size;
+    struct nvs_entry *next;
+} nvs_entry_t;
+
+typedef struct {
+    bool open;
+    nvs_open_mode_t mode;
+    char namespace_name[NVS_KEY_NAME_MAX_SIZE];
+} nvs_handle_state_t;
+
+static pthread_mutex_t nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+static nvs_entry_t *entries = NULL;
+static nvs_handle_state_t handles[MOCK_NVS_HANDLES + 1]; // Handle 0 is never used
+static bool nvs_initialized = false;
+
+static nvs_handle_state_t *handle_get(nvs_handle_t handle) {
+    if (handle == 0 || handle > MOCK_NVS_HANDLES || !handles[handle].open) {
+        return NULL;
+    }
+    return &handles[handle];
+}
+
+static nvs_entry_t *entry_find(const char *namespace_name, const char *key) {
+    for (nvs_entry_t *entry = entries; entry != NULL; entry = entry->next) {
+        if (strcmp(entry->namespace_name, namespace_name) == 0 && strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+// Replace or create an entry, called with nvs_lock held
+static esp_err_t entry_store(nvs_handle_t handle, const char *key, nvs_entry_type_t type, int32_t i32, const void *data, size_t size) {
+    nvs_handle_state_t *state = handle_get(handle);
+    if (state == NULL) {
+        return ESP_ERR_INVALID_ARG; // ESP_ERR_NVS_INVALID_HANDLE on the target
+    }
+    if (state->mode == NVS_READONLY) {
+        return ESP_ERR_INVALID_STATE; // ESP_ERR_NVS_READ_ONLY on the target
+    }
+    if (key == NULL || strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_entry_t *entry = entry_find(state->namespace_name, key);
+    if (entry == NULL) {
+        entry = calloc(1, sizeof(*entry));
+        if (entry == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        strcpy(entry->namespace_name, state->namespace_name);
+        strcpy(entry->key, key);
+        entry->next = entries;
+        entries = entry;
+    }
+    free(entry->data);
+    entry->data = NULL;
+    entry->type = type;
+    entry->i32 = i32;
+    entry->size = size;
+    if (size > 0) {
+        entry->data = malloc(size);
+        memcpy(entry->data, data, size);
+    }
+    return ESP_OK;
+}
+
+// Copy a string or blob out with the nvs_get_str()/nvs_get_blob() length semantics
+static esp_err_t entry_load(nvs_handle_t handle, const char *key, nvs_entry_type_t type, void *out_value, size_t *length) {
+    pthread_mutex_lock(&nvs_lock);
+    nvs_handle_state_t *state = handle_get(handle);
+    nvs_entry_t *entry = state != NULL ? entry_find(state->namespace_name, key) : NULL;
+    esp_err_t err = ESP_OK;
+    if (state == NULL) {
+        err = ESP_ERR_INVALID_ARG;
+    } else if (entry == NULL || entry->type != type) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (out_value == NULL) {
+        *length = entry->size; // Size query
+    } else if (*length < entry->size) {
+        *length = entry->size;
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out_value, entry->data, entry->size);
+        *length = entry->size;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_flash_init(void) {
+    nvs_initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    mock_nvs_erase_all();
+    return ESP_OK;
+}
+
+void mock_nvs_erase_all(void) {
+    pthread_mutex_lock(&nvs_lock);
+    while (entries != NULL) {
+        nvs_entry_t *entry = entries;
+        entries = entry->next;
+        free(entry->data);
+        free(entry);
+    }
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    if (!nvs_initialized) {
+        return ESP_ERR_INVALID_STATE; // ESP_ERR_NVS_NOT_INITIALIZED on the target
+    }
+    if (name == NULL || strlen(name) >= NVS_KEY_NAME_MAX_SIZE || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&nvs_lock);
+    // A read-only open of a namespace that was never written fails as on the target
+    bool namespace_exists = false;
+    for (nvs_entry_t *entry = entries; entry != NULL && !namespace_exists; entry = entry->next) {
+        namespace_exists = strcmp(entry->namespace_name, name) == 0;
+    }
+    esp_err_t err = ESP_ERR_NO_MEM; // ESP_ERR_NVS_NOT_ENOUGH_SPACE on the target
+    if (open_mode == NVS_READONLY && !namespace_exists) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else {
+        for (nvs_handle_t handle = 1; handle <= MOCK_NVS_HANDLES; handle++) {
+            if (!handles[handle].open) {
+                handles[handle].open = true;
+                handles[handle].mode = open_mode;
+                strcpy(handles[handle].namespace_name, name);
+                *out_handle = handle;
+                err = ESP_OK;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+void nvs_close(nvs_handle_t handle) {
+    pthread_mutex_lock(&nvs_lock);
+    nvs_handle_state_t *state = handle_get(handle);
+    if (state != NULL) {
+        state->open = false;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    pthread_mutex_lock(&nvs_lock);
+    esp_err_t err = handle_get(handle) != NULL ? ESP_OK : ESP_ERR_INVALID_ARG;
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value) {
+    pthread_mutex_lock(&nvs_lock);
+    esp_err_t err = entry_store(handle, key, NVS_ENTRY_STR, 0, value, strlen(value) + 1);
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length) {
+    return entry_load(handle, key, NVS_ENTRY_STR, out_value, length);
+}
+
+esp_err_t nvs_set_i32(nvs_handle_t handle, const char *key, int32_t value) {
+    pthread_mutex_lock(&nvs_lock);
+    esp_err_t err = entry_store(handle, key, NVS_ENTRY_I32, value, NULL, 0);
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_get_i32(nvs_handle_t handle, const char *key, int32_t *out_value) {
+    pthread_mutex_lock(&nvs_lock);
+    nvs_handle_state_t *state = handle_get(handle);
+    nvs_entry_t *entry = state != NULL ? entry_find(state->namespace_name, key) : NULL;
+    esp_err_t err = ESP_OK;
+    if (state == NULL) {
+        err = ESP_ERR_INVALID_ARG;
+    } else if (entry == NULL || entry->type != NVS_ENTRY_I32) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else {
+        *out_value = entry->i32;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    pthread_mutex_lock(&nvs_lock);
+    esp_err_t err = entry_store(handle, key, NVS_ENTRY_BLOB, 0, value, length);
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    return entry_load(handle, key, NVS_ENTRY_BLOB, out_value, length);
+}
@@ -0,0 +1,132 @@
+// RMT TX, the last waveform of each channel is kept for inspection instead of being played
+#include "mock_internal.h"
+#include "mock_host.h"
+#include "driver/rmt_tx.h"
+#include "soc/soc_caps.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct rmt_channel_t {
+    rmt_tx_channel_config_t config;
+    bool enabled;
+    rmt_symbol_word_t *symbols;
+    size_t symbol_count;
+    int loop_count;
+    uint32_t transmit_count;
+};
+
+struct rmt_encoder_t {
+    int reserved;
+};
+
+static pthread_mutex_t rmt_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct rmt_channel_t *channels[GPIO_NUM_MAX];
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan) {
+    if (config == NULL || ret_chan == NULL || config->gpio_num < 0 || config->gpio_num >= GPIO_NUM_MAX ||
+        config->resolution_hz == 0 || config->mem_block_symbols < SOC_RMT_MEM_WORDS_PER_CHANNEL ||
+        config->mem_block_symbols % SOC_RMT_MEM_WORDS_PER_CHANNEL != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct rmt_channel_t *channel = calloc(1, sizeof(*channel));
+    if (channel == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    channel->config = *config;
+    pthread_mutex_lock(&rmt_lock);
+    channels[config->gpio_num] = channel;
+    pthread_mutex_unlock(&rmt_lock);
+    *ret_chan = channel;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder) {
+    if (config == NULL || ret_encoder == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *ret_encoder = calloc(1, sizeof(struct rmt_encoder_t));
+    return *ret_encoder != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel) {
+    if (channel == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&rmt_lock);
+    esp_err_t err = channel->enabled ? ESP_ERR_INVALID_STATE : ESP_OK;
+    channel->enabled = true;
+    pthread_mutex_unlock(&rmt_lock);
+    return err;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel) {
+    if (channel == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&rmt_lock);
+    esp_err_t err = channel->enabled ? ESP_OK : ESP_ERR_INVALID_STATE;
+    channel->enabled = false;
+    channel->symbol_count = 0; // The output falls back to the idle level
+    pthread_mutex_unlock(&rmt_lock);
+    return err;
+}
+
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload,
+                       size_t payload_bytes, const rmt_transmit_config_t *config) {
+    if (tx_channel == NULL || encoder == NULL || payload == NULL || config == NULL ||
+        payload_bytes % sizeof(rmt_symbol_word_t) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t count = payload_bytes / sizeof(rmt_symbol_word_t);
+    // A looped waveform has to fit in the channel memory next to the end marker
+    if (config->loop_count != 0 && count + 1 > tx_channel->config.mem_block_symbols) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    rmt_symbol_word_t *symbols = malloc(payload_bytes);
+    if (symbols == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(symbols, payload, payload_bytes);
+
+    pthread_mutex_lock(&rmt_lock);
+    if (!tx_channel->enabled) {
+        pthread_mutex_unlock(&rmt_lock);
+        free(symbols);
+        return ESP_ERR_INVALID_STATE;
+    }
+    free(tx_channel->symbols);
+    tx_channel->symbols = symbols;
+    tx_channel->symbol_count = count;
+    tx_channel->loop_count = config->loop_count;
+    tx_channel->transmit_count++;
+    pthread_mutex_unlock(&rmt_lock);
+    return ESP_OK;
+}
+
+size_t mock_rmt_get_waveform(gpio_num_t gpio, const rmt_symbol_word_t **symbols, uint32_t *resolution_hz,
+                             int *loop_count) {
+    if (gpio < 0 || gpio >= GPIO_NUM_MAX) {
+        return 0;
+    }
+    pthread_mutex_lock(&rmt_lock);
+    struct rmt_channel_t *channel = channels[gpio];
+    size_t count = 0;
+    if (channel != NULL) {
+        count = channel->symbol_count;
+        *symbols = channel->symbols;
+        *resolution_hz = channel->config.resolution_hz;
+        *loop_count = channel->loop_count;
+    }
+    pthread_mutex_unlock(&rmt_lock);
+    return count;
+}
+
+uint32_t mock_rmt_get_transmit_count(gpio_num_t gpio) {
+    if (gpio < 0 || gpio >= GPIO_NUM_MAX) {
+        return 0;
+    }
+    pthread_mutex_lock(&rmt_lock);
+    uint32_t count = channels[gpio] != NULL ? channels[gpio]->transmit_count : 0;
+    pthread_mutex_unlock(&rmt_lock);
+    return count;
+}
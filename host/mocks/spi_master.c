@@ -0,0 +1,67 @@
+// SPI master, every transaction reads back the configured rx_data bytes
+#include "mock_internal.h"
+#include "mock_host.h"
+#include "driver/spi_master.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct spi_device_t {
+    spi_host_device_t host;
+    spi_device_interface_config_t config;
+};
+
+static pthread_mutex_t spi_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool bus_initialized[SPI3_HOST + 1];
+static uint8_t next_rx_data[4];
+
+void mock_spi_set_rx_data(const uint8_t rx_data[4]) {
+    pthread_mutex_lock(&spi_lock);
+    memcpy(next_rx_data, rx_data, sizeof(next_rx_data));
+    pthread_mutex_unlock(&spi_lock);
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_dma_chan_t dma_chan) {
+    if (host_id > SPI3_HOST || bus_config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (bus_initialized[host_id]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    bus_initialized[host_id] = true;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t *dev_config, spi_device_handle_t *handle) {
+    if (host_id > SPI3_HOST || dev_config == NULL || handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!bus_initialized[host_id]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    struct spi_device_t *device = calloc(1, sizeof(*device));
+    if (device == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    device->host = host_id;
+    device->config = *dev_config;
+    *handle = device;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t *trans_desc) {
+    if (handle == NULL || trans_desc == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t rx_bits = trans_desc->rxlength ? trans_desc->rxlength : trans_desc->length;
+    size_t rx_bytes = (rx_bits + 7) / 8;
+
+    pthread_mutex_lock(&spi_lock);
+    if (trans_desc->flags & SPI_TRANS_USE_RXDATA) {
+        memcpy(trans_desc->rx_data, next_rx_data, rx_bytes < 4 ? rx_bytes : 4);
+    } else if (trans_desc->rx_buffer != NULL) {
+        memset(trans_desc->rx_buffer, 0, rx_bytes);
+        memcpy(trans_desc->rx_buffer, next_rx_data, rx_bytes < 4 ? rx_bytes : 4);
+    }
+    pthread_mutex_unlock(&spi_lock);
+    return ESP_OK;
+}
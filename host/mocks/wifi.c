@@ -0,0 +1,143 @@
+// esp_wifi and esp_netif, connection outcomes are posted on the default event loop
+#include "mock_internal.h"
+#include "mock_host.h"
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include <stdlib.h>
+#include <string.h>
+
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+
+struct esp_netif_obj {
+    esp_netif_ip_info_t ip_info;
+    bool dhcps_running;
+};
+
+static struct esp_netif_obj sta_netif;
+static struct esp_netif_obj ap_netif;
+
+static wifi_mode_t wifi_mode = WIFI_MODE_NULL;
+static wifi_config_t sta_config;
+static wifi_ps_type_t ps_type = WIFI_PS_MIN_MODEM;
+static bool wifi_initialized = false;
+static bool wifi_started = false;
+static bool sta_connected = false;
+static bool sta_connect_succeeds = true;
+static uint8_t sta_disconnect_reason = WIFI_REASON_NO_AP_FOUND;
+
+void mock_wifi_set_sta_result(bool connect, uint8_t disconnect_reason) {
+    sta_connect_succeeds = connect;
+    sta_disconnect_reason = disconnect_reason;
+}
+
+esp_err_t esp_netif_init(void) {
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void) {
+    return &sta_netif;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_ap(void) {
+    return &ap_netif;
+}
+
+esp_err_t esp_netif_dhcps_stop(esp_netif_t *netif) {
+    netif->dhcps_running = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcps_start(esp_netif_t *netif) {
+    netif->dhcps_running = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_set_ip_info(esp_netif_t *netif, const esp_netif_ip_info_t *ip_info) {
+    netif->ip_info = *ip_info;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config) {
+    wifi_initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode) {
+    if (!wifi_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    wifi_mode = mode;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t iface, wifi_config_t *conf) {
+    if (!wifi_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (iface == WIFI_IF_STA) {
+        sta_config = *conf;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_start(void) {
+    if (!wifi_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!wifi_started && (wifi_mode == WIFI_MODE_STA || wifi_mode == WIFI_MODE_APSTA)) {
+        esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_START, NULL, 0, portMAX_DELAY);
+    }
+    wifi_started = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_stop(void) {
+    wifi_started = false;
+    sta_connected = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect(void) {
+    if (!wifi_started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // An empty SSID can never be found, as on the real stack
+    if (sta_connect_succeeds && sta_config.sta.ssid[0] != '\0') {
+        sta_connected = true;
+        ip_event_got_ip_t got_ip = { 0 };
+        IP4_ADDR(&got_ip.ip_info.ip, 192, 168, 1, 100);
+        IP4_ADDR(&got_ip.ip_info.gw, 192, 168, 1, 1);
+        IP4_ADDR(&got_ip.ip_info.netmask, 255, 255, 255, 0);
+        esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, NULL, 0, portMAX_DELAY);
+        esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &got_ip, sizeof(got_ip), portMAX_DELAY);
+    } else {
+        wifi_event_sta_disconnected_t disconnected = { .reason = sta_disconnect_reason };
+        memcpy(disconnected.ssid, sta_config.sta.ssid, sizeof(disconnected.ssid));
+        disconnected.ssid_len = strnlen((const char *)sta_config.sta.ssid, sizeof(sta_config.sta.ssid));
+        esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &disconnected, sizeof(disconnected), portMAX_DELAY);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type) {
+    ps_type = type;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_ps(wifi_ps_type_t *type) {
+    *type = ps_type;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info) {
+    if (!sta_connected) {
+        return ESP_ERR_INVALID_STATE; // ESP_ERR_WIFI_NOT_CONNECT on the target
+    }
+    memset(ap_info, 0, sizeof(*ap_info));
+    memcpy(ap_info->ssid, sta_config.sta.ssid, sizeof(sta_config.sta.ssid));
+    ap_info->primary = 6;
+    ap_info->rssi = -55;
+    return ESP_OK;
+}
@@ -0,0 +1,147 @@
+// Alarm rules on the host build: raise at the limit, hold inside the hysteresis band, clear outside it
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "mock_internal.h"
+#include "events.h"
+#include "state_manager.h"
+#include "alarm_manager.h"
+
+#define TEST_CHANNEL 0
+
+static int failures = 0;
+static int64_t sample_time_us = 1000000;
+
+#define CHECK(condition, what) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL %s:%d %s\n", __FILE__, __LINE__, (what)); \
+            failures++; \
+        } \
+    } while (0)
+
+// Publish one value on the test channel, the clock advances by step_ms first
+static bool feed(int32_t value_centi, uint32_t step_ms, alarm_type_t type) {
+    int32_t values[NTC_MAX_CHANNELS] = { 0 };
+    int64_t times[NTC_MAX_CHANNELS] = { 0 };
+    sample_time_us += (int64_t)step_ms * 1000;
+    values[TEST_CHANNEL] = value_centi;
+    times[TEST_CHANNEL] = sample_time_us;
+    alarm_process_frame(values, 1u << TEST_CHANNEL, times);
+    return (alarm_get_active_flags(TEST_CHANNEL) & ALARM_FLAG(type)) != 0;
+}
+
+static void configure(uint32_t min_duration_ms, int32_t rate_limit, int32_t rate_hysteresis) {
+    alarm_channel_config_t config = {
+        .enabled = true,
+        .high_centi = 8000,
+        .low_centi = -1000,
+        .hysteresis_centi = 100,
+        .min_duration_ms = min_duration_ms,
+        .rate_limit_centi_per_min = rate_limit,
+        .rate_hysteresis_centi_per_min = rate_hysteresis,
+    };
+    alarm_set_channel_config(TEST_CHANNEL, &config);
+}
+
+static void reset(void) {
+    alarm_channel_config_t disabled = { .enabled = false };
+    alarm_set_channel_config(TEST_CHANNEL, &disabled);
+    feed(0, 100, ALARM_TYPE_HIGH);
+    CHECK(alarm_get_active_flags(TEST_CHANNEL) == 0, "disabling the rules clears every alarm");
+}
+
+static void test_high_limit(void) {
+    configure(0, 0, 0);
+    CHECK(!feed(7999, 100, ALARM_TYPE_HIGH), "below the limit");
+    CHECK(feed(8000, 100, ALARM_TYPE_HIGH), "raised at the limit");
+    CHECK(feed(7950, 100, ALARM_TYPE_HIGH), "held inside the hysteresis band");
+    CHECK(feed(7900, 100, ALARM_TYPE_HIGH), "held at the edge of the band");
+    CHECK(!feed(7899, 100, ALARM_TYPE_HIGH), "cleared below the band");
+    CHECK(!feed(7950, 100, ALARM_TYPE_HIGH), "not raised again inside the band");
+    reset();
+}
+
+static void test_low_limit(void) {
+    configure(0, 0, 0);
+    CHECK(!feed(-999, 100, ALARM_TYPE_LOW), "above the limit");
+    CHECK(feed(-1000, 100, ALARM_TYPE_LOW), "raised at the limit");
+    CHECK(feed(-950, 100, ALARM_TYPE_LOW), "held inside the hysteresis band");
+    CHECK(!feed(-899, 100, ALARM_TYPE_LOW), "cleared above the band");
+    reset();
+}
+
+static void test_min_duration(void) {
+    configure(2000, 0, 0);
+    CHECK(!feed(8100, 100, ALARM_TYPE_HIGH), "violation starts");
+    CHECK(!feed(8100, 1000, ALARM_TYPE_HIGH), "not raised before the minimum duration");
+    CHECK(!feed(7000, 500, ALARM_TYPE_HIGH), "back below the limit restarts the wait");
+    CHECK(!feed(8100, 500, ALARM_TYPE_HIGH), "violation starts again");
+    CHECK(!feed(8100, 1999, ALARM_TYPE_HIGH), "still short of the minimum duration");
+    CHECK(feed(8100, 1, ALARM_TYPE_HIGH), "raised after the minimum duration");
+    reset();
+}
+
+static void test_rate(void) {
+    // 60 °C/min limit with 10 °C/min hysteresis, measured over CONFIG_ALARM_RATE_WINDOW_MS
+    uint32_t window_ms = CONFIG_ALARM_RATE_WINDOW_MS;
+    int32_t per_window = (int32_t)(window_ms / 600); // 0.01 °C per window for 1 °C/min
+    configure(0, 6000, 1000);
+    CHECK(!feed(2000, 100, ALARM_TYPE_RATE), "rate window starts");
+    CHECK(feed(2000 + 66 * per_window, window_ms, ALARM_TYPE_RATE), "raised at 66 C/min");
+    CHECK(feed(2000 + 120 * per_window, window_ms, ALARM_TYPE_RATE), "held at 54 C/min");
+    CHECK(!feed(2000 + 168 * per_window, window_ms, ALARM_TYPE_RATE), "cleared at 48 C/min");
+    reset();
+}
+
+static void test_rules_replaced(void) {
+    alarm_channel_config_t config;
+    configure(0, 0, 0);
+    CHECK(feed(8000, 100, ALARM_TYPE_HIGH), "raised at the limit");
+    alarm_get_channel_config(TEST_CHANNEL, &config);
+    alarm_set_channel_config(TEST_CHANNEL, &config);
+    CHECK(feed(8000, 100, ALARM_TYPE_HIGH), "identical rules keep the alarm");
+    config.high_centi = 9000;
+    alarm_set_channel_config(TEST_CHANNEL, &config);
+    CHECK(!feed(8500, 100, ALARM_TYPE_HIGH), "cleared under the new limit");
+
+    configure(2000, 0, 0);
+    CHECK(!feed(8100, 100, ALARM_TYPE_HIGH), "violation starts");
+    config.min_duration_ms = 1000;
+    alarm_set_channel_config(TEST_CHANNEL, &config);
+    CHECK(!feed(9100, 1500, ALARM_TYPE_HIGH), "new rules restart the wait");
+    CHECK(feed(9100, 1000, ALARM_TYPE_HIGH), "raised after the new minimum duration");
+    reset();
+}
+
+static void test_validation(void) {
+    // The same rule as config_validate(), limits only matter once the rules are enabled
+    alarm_channel_config_t config = { .enabled = false };
+    CHECK(alarm_set_channel_config(TEST_CHANNEL, &config) == ESP_OK, "disabled rules without limits accepted");
+    config.enabled = true;
+    CHECK(alarm_set_channel_config(TEST_CHANNEL, &config) == ESP_ERR_INVALID_ARG, "enabled rules without limits rejected");
+    config.high_centi = 100;
+    config.hysteresis_centi = -1;
+    CHECK(alarm_set_channel_config(TEST_CHANNEL, &config) == ESP_ERR_INVALID_ARG, "negative hysteresis rejected");
+    reset();
+}
+
+int main(int argc, char **argv) {
+    esp_log_level_set("*", ESP_LOG_NONE);
+    mock_task_adopt_thread("main", 1);
+    state_initialize();
+    events_init();
+    alarm_initialize();
+
+    test_high_limit();
+    test_low_limit();
+    test_min_duration();
+    test_rate();
+    test_rules_replaced();
+    test_validation();
+
+    printf("%s\n", failures == 0 ? "alarm_test passed" : "alarm_test FAILED");
+    fflush(stdout);
+    _Exit(failures == 0 ? 0 : 1); // Tasks are endless loops, do not run destructors under them
+}
@@ -0,0 +1,201 @@
+// Decode an ADC stream (CONFIG_ADC_STREAM_ENABLE) into CSV, one row per sample or frame average.
+// Reads a UART capture or a live TCP stream from stdin: nc <board> 2324 | adc_stream_decode
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "adc_stream.h"
+
+#define DECODE_BUFFER_SIZE  (64 * 1024)
+#define DECODE_MAX_PROBES   16
+#define DECODE_MAX_PAYLOAD  (DECODE_BUFFER_SIZE - ADC_STREAM_HEADER_SIZE - ADC_STREAM_CRC_SIZE)
+
+typedef struct {
+    int unit;
+    int channel;
+} probe_input_t;
+
+// Layout of the DMA frames, from the last info record
+typedef struct {
+    bool valid;
+    int format;                 // adc_digi_output_format_t + 1
+    int sample_size;
+    int probe_count;
+    uint32_t sample_freq_hz;
+    probe_input_t probes[DECODE_MAX_PROBES];
+} stream_info_t;
+
+typedef struct {
+    uint32_t records;
+    uint32_t samples;
+    uint32_t crc_errors;
+    uint32_t lost;              // Records missing from the sequence
+    uint32_t skipped_bytes;     // Bytes dropped while looking for a sync
+    uint32_t unknown;           // Records of an unknown type or before the info record
+} decode_stats_t;
+
+static stream_info_t info;
+static decode_stats_t stats;
+
+static uint32_t get_le(const uint8_t *data, int bytes) {
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+static void decode_info(const uint8_t *payload, size_t size) {
+    if (size < 8 || payload[0] != ADC_STREAM_VERSION) {
+        fprintf(stderr, "Unsupported stream version %d\n", size > 0 ? payload[0] : -1);
+        exit(1);
+    }
+    info.format = payload[1];
+    info.sample_size = payload[2];
+    info.probe_count = payload[3] < DECODE_MAX_PROBES ? payload[3] : DECODE_MAX_PROBES;
+    info.sample_freq_hz = get_le(&payload[4], 4);
+    for (int i = 0; i < info.probe_count && 8 + i * 4 + 4 <= size; i++) {
+        info.probes[i].unit = payload[8 + i * 4];
+        info.probes[i].channel = payload[8 + i * 4 + 1];
+    }
+    info.valid = true;
+    fprintf(stderr, "stream: format TYPE%d, %d bytes per sample, %d probes, %lu Hz\n", info.format,
+            info.sample_size, info.probe_count, (unsigned long)info.sample_freq_hz);
+}
+
+// Unit, channel and value of a DMA sample. 2 byte TYPE1 is the ESP32 (data:12 channel:4), 2 byte
+// TYPE2 the ESP32-S2 (data:11 channel:4 unit:1), 4 byte TYPE2 the later targets (data:12 at bit 0,
+// channel:4 at bit 13, unit:1 at bit 17).
+static void decode_sample(const uint8_t *sample, int *unit, int *channel, int *value) {
+    uint32_t word = get_le(sample, info.sample_size);
+    if (info.sample_size == 4) {
+        *value = word & 0xFFF;
+        *channel = (word >> 13) & 0xF;
+        *unit = (word >> 17) & 0x1;
+    } else if (info.format == 2) {
+        *value = word & 0x7FF;
+        *channel = (word >> 11) & 0xF;
+        *unit = (word >> 15) & 0x1;
+    } else {
+        *value = word & 0xFFF;
+        *channel = (word >> 12) & 0xF;
+        *unit = 0;
+    }
+}
+
+static int find_probe(int unit, int channel) {
+    for (int i = 0; i < info.probe_count; i++) {
+        if (info.probes[i].unit == unit && info.probes[i].channel == channel) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void decode_record(int type, uint32_t sequence, uint32_t time_us, const uint8_t *payload, size_t size) {
+    if (type == ADC_STREAM_RECORD_INFO) {
+        decode_info(payload, size);
+        return;
+    }
+    if (!info.valid || (type != ADC_STREAM_RECORD_RAW && type != ADC_STREAM_RECORD_DECIMATED)) {
+        stats.unknown++;
+        return;
+    }
+
+    if (type == ADC_STREAM_RECORD_RAW) {
+        for (size_t i = 0; i + info.sample_size <= size; i += info.sample_size) {
+            int unit, channel, value;
+            decode_sample(&payload[i], &unit, &channel, &value);
+            printf("raw,%lu,%lu,%d,%d,%d,%d,1\n", (unsigned long)sequence, (unsigned long)time_us,
+                   find_probe(unit, channel) + 1, unit, channel, value);
+            stats.samples++;
+        }
+        return;
+    }
+
+    int probe_count = size >= 2 ? payload[0] : 0;
+    for (int i = 0; i < probe_count && 2 + i * 4 + 4 <= size; i++) {
+        uint32_t mean = get_le(&payload[2 + i * 4], 2);
+        uint32_t count = get_le(&payload[4 + i * 4], 2);
+        if (mean == ADC_STREAM_NO_SAMPLES) {
+            continue;
+        }
+        const probe_input_t *input = i < info.probe_count ? &info.probes[i] : &(probe_input_t){ -1, -1 };
+        printf("decimated,%lu,%lu,%d,%d,%d,%lu,%lu\n", (unsigned long)sequence, (unsigned long)time_us, i + 1,
+               input->unit, input->channel, (unsigned long)mean, (unsigned long)count);
+        stats.samples += count;
+    }
+}
+
+// Decode the complete records at the start of the buffer, returns the bytes consumed
+static size_t decode_buffer(const uint8_t *buffer, size_t size) {
+    static bool have_sequence = false;
+    static uint32_t next_sequence = 0;
+    size_t position = 0;
+
+    while (size - position >= ADC_STREAM_HEADER_SIZE) {
+        const uint8_t *record = &buffer[position];
+        size_t payload_size = get_le(&record[4], 2);
+        if (record[0] != ADC_STREAM_SYNC_0 || record[1] != ADC_STREAM_SYNC_1 || payload_size > DECODE_MAX_PAYLOAD) {
+            position++;
+            stats.skipped_bytes++;
+            continue;
+        }
+        size_t record_size = ADC_STREAM_HEADER_SIZE + payload_size + ADC_STREAM_CRC_SIZE;
+        if (size - position < record_size) {
+            break; // Rest of the record not read yet
+        }
+
+        uint16_t crc = adc_stream_crc16(0xFFFF, &record[2], ADC_STREAM_HEADER_SIZE - 2 + payload_size);
+        if (crc != get_le(&record[ADC_STREAM_HEADER_SIZE + payload_size], ADC_STREAM_CRC_SIZE)) {
+            // A sync pattern inside the data or a corrupted record, look for the next sync
+            stats.crc_errors++;
+            position++;
+            stats.skipped_bytes++;
+            continue;
+        }
+
+        uint32_t sequence = get_le(&record[6], 4);
+        if (have_sequence && sequence != next_sequence) {
+            stats.lost += sequence - next_sequence;
+        }
+        have_sequence = true;
+        next_sequence = sequence + 1;
+        stats.records++;
+        decode_record(record[2], sequence, get_le(&record[10], 4), &record[ADC_STREAM_HEADER_SIZE], payload_size);
+        position += record_size;
+    }
+    return position;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 2) {
+        printf("Usage: %s [STREAM]\n", argv[0]);
+        return 2;
+    }
+
+    FILE *file = argc == 2 && strcmp(argv[1], "-") != 0 ? fopen(argv[1], "rb") : stdin;
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    static uint8_t buffer[DECODE_BUFFER_SIZE];
+    size_t filled = 0;
+    size_t read_size;
+    printf("type,sequence,time_us,probe,unit,channel,value,samples\n");
+    while ((read_size = fread(&buffer[filled], 1, sizeof(buffer) - filled, file)) > 0) {
+        filled += read_size;
+        size_t consumed = decode_buffer(buffer, filled);
+        memmove(buffer, &buffer[consumed], filled - consumed);
+        filled -= consumed;
+    }
+    if (file != stdin) {
+        fclose(file);
+    }
+
+    fprintf(stderr, "records:       %lu\nsamples:       %lu\nlost records:  %lu\ncrc errors:    %lu\n"
+            "skipped bytes: %lu\nunknown:       %lu\ntruncated:     %zu bytes\n",
+            (unsigned long)stats.records, (unsigned long)stats.samples, (unsigned long)stats.lost,
+            (unsigned long)stats.crc_errors, (unsigned long)stats.skipped_bytes, (unsigned long)stats.unknown, filled);
+    return stats.crc_errors == 0 && stats.lost == 0 ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+// Decode a recorded PCF8574 byte stream (ntc_host --i2c-dump) into the screen it produces
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hd44780_emu.h"
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        printf("Usage: %s STREAM\n", argv[0]);
+        return 2;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *stream = malloc(size > 0 ? size : 1);
+    if (stream == NULL || fread(stream, 1, size, file) != (size_t)size) {
+        fprintf(stderr, "Cannot read %s\n", argv[1]);
+        fclose(file);
+        return 1;
+    }
+    fclose(file);
+
+    static hd44780_emu_t emu;
+    hd44780_emu_init(&emu);
+    hd44780_emu_feed_stream(&emu, stream, size);
+    free(stream);
+
+    hd44780_emu_print(&emu, stdout);
+    hd44780_emu_stats_t stats = hd44780_emu_get_stats(&emu);
+    printf("transactions: %lu\nbytes:        %lu\ncommands:     %lu\ndata writes:  %lu (%lu CGRAM)\nbus time:     %.3f ms at %d Hz\n",
+           (unsigned long)stats.transactions, (unsigned long)stats.bytes, (unsigned long)stats.commands,
+           (unsigned long)stats.data_writes, (unsigned long)stats.cgram_writes, stats.bus_time_ns / 1e6, I2C_MASTER_FREQ_HZ);
+    return 0;
+}
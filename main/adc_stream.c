@@ -0,0 +1,359 @@
+#include "adc_stream.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "ntc_adc.h"
+#include "state_manager.h"
+#include "task_config.h"
+#include <stdatomic.h>
+#include <string.h>
+#if CONFIG_ADC_STREAM_UART
+#include "driver/uart.h"
+#endif
+#if CONFIG_ADC_STREAM_TCP
+#include "lwip/sockets.h"
+#endif
+
+static const char *mode_names[ADC_STREAM_MODE_MAX] = {
+    [ADC_STREAM_OFF] = "off",
+    [ADC_STREAM_RAW] = "raw",
+    [ADC_STREAM_DECIMATED] = "decimated",
+};
+
+// CRC-16/CCITT-FALSE, a nibble at a time
+static const uint16_t crc16_nibbles[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+uint16_t adc_stream_crc16(uint16_t crc, const uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        crc = (crc << 4) ^ crc16_nibbles[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ crc16_nibbles[(crc >> 12) ^ (data[i] & 0x0f)];
+    }
+    return crc;
+}
+
+const char *adc_stream_get_mode_name(adc_stream_mode_t mode) {
+    return mode < ADC_STREAM_MODE_MAX ? mode_names[mode] : "?";
+}
+
+#if CONFIG_ADC_STREAM_ENABLE
+
+static const char *TAG = "adc_stream";
+
+#define STREAM_RING_SIZE CONFIG_ADC_STREAM_RING_SIZE
+#define STREAM_RECORD_MAX (ADC_STREAM_HEADER_SIZE + CONFIG_NTC_ADC_CONV_FRAME_SIZE + ADC_STREAM_CRC_SIZE)
+#define STREAM_INFO_SIZE(probes) (8 + (probes) * 4)
+
+_Static_assert((STREAM_RING_SIZE & (STREAM_RING_SIZE - 1)) == 0, "ADC stream ring size must be a power of two");
+_Static_assert(STREAM_RING_SIZE >= 2 * STREAM_RECORD_MAX, "ADC stream ring must hold two raw frames");
+
+#if CONFIG_ADC_STREAM_START_RAW
+#define STREAM_START_MODE ADC_STREAM_RAW
+#elif CONFIG_ADC_STREAM_START_DECIMATED
+#define STREAM_START_MODE ADC_STREAM_DECIMATED
+#else
+#define STREAM_START_MODE ADC_STREAM_OFF
+#endif
+
+// Records in flight. The acquisition task is the only producer and moves the head, the stream
+// task the only consumer and moves the tail, so neither side takes a lock.
+static uint8_t ring[STREAM_RING_SIZE];
+static _Atomic uint32_t ring_head = 0;
+static _Atomic uint32_t ring_tail = 0;
+
+static _Atomic int stream_mode = STREAM_START_MODE;
+static _Atomic bool sink_ready = false;     // A transport takes records, nothing is queued before
+static _Atomic bool info_pending = true;    // Describe the stream before the next frame record
+static uint32_t sequence = 0;               // Producer only
+static TaskHandle_t stream_task_handle = NULL;
+static adc_stream_stats_t stats;            // Producer only
+static uint32_t record_start = 0;           // Consumer only, first record not completely sent
+static uint32_t discarded = 0;              // Consumer only, records lost with the transport
+
+#if CONFIG_ADC_STREAM_TCP
+static int listen_fd = -1;
+static int client_fd = -1;
+#endif
+
+static void stream_put_le(uint8_t *out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void ring_write(uint32_t position, const void *data, size_t size) {
+    uint32_t offset = position & (STREAM_RING_SIZE - 1);
+    size_t first = size < STREAM_RING_SIZE - offset ? size : STREAM_RING_SIZE - offset;
+    memcpy(ring + offset, data, first);
+    memcpy(ring, (const uint8_t *)data + first, size - first);
+}
+
+static void stream_put(adc_stream_record_t type, const uint8_t *payload, size_t size, int64_t time_us) {
+    // The sequence number advances for dropped records too, the decoder counts the gap
+    uint32_t total = ADC_STREAM_HEADER_SIZE + size + ADC_STREAM_CRC_SIZE;
+    uint32_t head = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    uint32_t used = head - atomic_load_explicit(&ring_tail, memory_order_acquire);
+    uint32_t number = sequence++;
+    if (STREAM_RING_SIZE - used < total) {
+        stats.dropped++;
+        return;
+    }
+
+    uint8_t header[ADC_STREAM_HEADER_SIZE] = { ADC_STREAM_SYNC_0, ADC_STREAM_SYNC_1, type, 0 };
+    stream_put_le(&header[4], size, 2);
+    stream_put_le(&header[6], number, 4);
+    stream_put_le(&header[10], (uint32_t)time_us, 4);
+    uint16_t crc = adc_stream_crc16(0xFFFF, &header[2], ADC_STREAM_HEADER_SIZE - 2);
+    crc = adc_stream_crc16(crc, payload, size);
+    uint8_t trailer[ADC_STREAM_CRC_SIZE];
+    stream_put_le(trailer, crc, ADC_STREAM_CRC_SIZE);
+
+    ring_write(head, header, sizeof(header));
+    ring_write(head + ADC_STREAM_HEADER_SIZE, payload, size);
+    ring_write(head + ADC_STREAM_HEADER_SIZE + size, trailer, sizeof(trailer));
+    atomic_store_explicit(&ring_head, head + total, memory_order_release);
+
+    stats.records++;
+    stats.ring_peak = used + total > stats.ring_peak ? used + total : stats.ring_peak;
+    xTaskNotifyGive(stream_task_handle);
+}
+
+static void stream_put_info(int64_t time_us) {
+    uint8_t info[STREAM_INFO_SIZE(NTC_MAX_CHANNELS)];
+    int probes = ntc_get_channel_count();
+    info[0] = ADC_STREAM_VERSION;
+    info[1] = NTC_ADC_OUTPUT_FORMAT + 1;
+    info[2] = sizeof(adc_digi_output_data_t);
+    info[3] = probes;
+    stream_put_le(&info[4], NTC_ADC_SAMPLE_FREQ_HZ, 4);
+    for (int i = 0; i < probes; i++) {
+        const ntc_channel_config_t *config = ntc_get_channel_config(i);
+        uint8_t *entry = &info[STREAM_INFO_SIZE(i)];
+        entry[0] = config->unit;
+        entry[1] = config->channel;
+        entry[2] = ntc_channel_is_enabled(i);
+        entry[3] = config->probe_type;
+    }
+    stream_put(ADC_STREAM_RECORD_INFO, info, STREAM_INFO_SIZE(probes), time_us);
+}
+
+// Whether frames of this mode are queued, sends the info record first when due
+static bool stream_begin(adc_stream_mode_t mode, int64_t time_us) {
+    if (!atomic_load(&sink_ready) || atomic_load(&stream_mode) != mode) {
+        return false;
+    }
+    if (atomic_exchange(&info_pending, false)) {
+        stream_put_info(time_us);
+    }
+    return true;
+}
+
+void adc_stream_push_raw(const uint8_t *frame, size_t size, int64_t time_us) {
+    if (stream_begin(ADC_STREAM_RAW, time_us)) {
+        stream_put(ADC_STREAM_RECORD_RAW, frame, size, time_us);
+    }
+}
+
+void adc_stream_push_decimated(const uint32_t *sum, const uint32_t *count, int probe_count, int64_t time_us) {
+    if (!stream_begin(ADC_STREAM_DECIMATED, time_us)) {
+        return;
+    }
+
+    uint8_t payload[2 + NTC_MAX_CHANNELS * 4];
+    probe_count = probe_count < NTC_MAX_CHANNELS ? probe_count : NTC_MAX_CHANNELS;
+    payload[0] = probe_count;
+    payload[1] = 0;
+    for (int i = 0; i < probe_count; i++) {
+        uint16_t samples = count[i] < UINT16_MAX ? count[i] : UINT16_MAX;
+        stream_put_le(&payload[2 + i * 4], samples > 0 ? sum[i] / count[i] : ADC_STREAM_NO_SAMPLES, 2);
+        stream_put_le(&payload[4 + i * 4], samples, 2);
+    }
+    stream_put(ADC_STREAM_RECORD_DECIMATED, payload, 2 + probe_count * 4, time_us);
+}
+
+// Size of the queued record starting at a position
+static uint32_t ring_record_size(uint32_t position) {
+    uint32_t length = ring[(position + 4) & (STREAM_RING_SIZE - 1)] | ring[(position + 5) & (STREAM_RING_SIZE - 1)] << 8;
+    return ADC_STREAM_HEADER_SIZE + length + ADC_STREAM_CRC_SIZE;
+}
+
+// Move the tail after sent bytes, following the record boundaries
+static void stream_advance(uint32_t tail) {
+    while (record_start != tail && tail - record_start >= ring_record_size(record_start)) {
+        record_start += ring_record_size(record_start);
+    }
+    atomic_store_explicit(&ring_tail, tail, memory_order_release);
+}
+
+// Drop what is queued, a partly sent record counts as dropped too. Only the consumer may move the tail.
+static void stream_discard(void) {
+    uint32_t head = atomic_load_explicit(&ring_head, memory_order_acquire);
+    while (record_start != head) {
+        record_start += ring_record_size(record_start);
+        discarded++;
+    }
+    atomic_store_explicit(&ring_tail, head, memory_order_release);
+}
+
+#if CONFIG_ADC_STREAM_TCP
+static bool stream_send(const uint8_t *data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = send(client_fd, data, size, 0);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+static void stream_accept(void) {
+    // One client at a time, in station mode only
+    int client = accept(listen_fd, NULL, NULL);
+    if (client < 0) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        return;
+    }
+    if (state_get_wifi_ap_mode()) {
+        close(client);
+        return;
+    }
+    int no_delay = 1;
+    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+    client_fd = client;
+    stats.connections++;
+    stream_discard();
+    atomic_store(&info_pending, true);
+    atomic_store(&sink_ready, true);
+    ESP_LOGI(TAG, "Client connected, streaming %s", adc_stream_get_mode_name(atomic_load(&stream_mode)));
+}
+#else
+static bool stream_send(const uint8_t *data, size_t size) {
+    return uart_write_bytes(CONFIG_ADC_STREAM_UART_NUM, data, size) == (int)size;
+}
+#endif
+
+static void adc_stream_task(void *pvParameter) {
+    while (1) {
+#if CONFIG_ADC_STREAM_TCP
+        if (client_fd < 0) {
+            stream_accept();
+            continue;
+        }
+#endif
+        uint32_t tail = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+        uint32_t head = atomic_load_explicit(&ring_head, memory_order_acquire);
+        if (head == tail) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        // Up to the end of the ring, the rest goes out in the next round
+        uint32_t offset = tail & (STREAM_RING_SIZE - 1);
+        uint32_t size = head - tail < STREAM_RING_SIZE - offset ? head - tail : STREAM_RING_SIZE - offset;
+        if (!stream_send(ring + offset, size)) {
+#if CONFIG_ADC_STREAM_TCP
+            atomic_store(&sink_ready, false);
+            close(client_fd);
+            client_fd = -1;
+            ESP_LOGI(TAG, "Client disconnected");
+#endif
+            stream_discard();
+            continue;
+        }
+        stats.bytes_sent += size;
+        stream_advance(tail + size);
+    }
+}
+
+void adc_stream_initialize(void) {
+#if CONFIG_ADC_STREAM_TCP
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        ESP_LOGE(TAG, "Failed to create the stream socket");
+        return;
+    }
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in address = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_ADC_STREAM_TCP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(listen_fd, 1) < 0) {
+        ESP_LOGE(TAG, "Failed to listen on port %d", CONFIG_ADC_STREAM_TCP_PORT);
+        close(listen_fd);
+        listen_fd = -1;
+        return;
+    }
+    ESP_LOGI(TAG, "Streaming on TCP port %d", CONFIG_ADC_STREAM_TCP_PORT);
+#else
+    uart_config_t uart_config = {
+        .baud_rate = CONFIG_ADC_STREAM_UART_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    // The ring buffer does the buffering, the driver only needs room for one chunk being sent
+    ESP_ERROR_CHECK(uart_driver_install(CONFIG_ADC_STREAM_UART_NUM, 256, 2048, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_param_config(CONFIG_ADC_STREAM_UART_NUM, &uart_config));
+    ESP_ERROR_CHECK(uart_set_pin(CONFIG_ADC_STREAM_UART_NUM, CONFIG_ADC_STREAM_UART_TX_GPIO, UART_PIN_NO_CHANGE,
+                                 UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+    atomic_store(&sink_ready, true);
+    ESP_LOGI(TAG, "Streaming on UART%d at %d baud", CONFIG_ADC_STREAM_UART_NUM, CONFIG_ADC_STREAM_UART_BAUD);
+#endif
+
+    task_create(TASK_ID_ADC_STREAM, adc_stream_task, NULL, &stream_task_handle);
+}
+
+esp_err_t adc_stream_set_mode(adc_stream_mode_t mode) {
+    if (mode >= ADC_STREAM_MODE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    atomic_store(&info_pending, true);
+    atomic_store(&stream_mode, mode);
+    return ESP_OK;
+}
+
+adc_stream_mode_t adc_stream_get_mode(void) {
+    return atomic_load(&sink_ready) ? atomic_load(&stream_mode) : ADC_STREAM_OFF;
+}
+
+adc_stream_stats_t adc_stream_get_stats(void) {
+    adc_stream_stats_t copy = stats;
+    copy.dropped += discarded;
+    copy.mode = atomic_load(&stream_mode);
+    copy.sink_ready = atomic_load(&sink_ready);
+    return copy;
+}
+
+#else
+
+void adc_stream_initialize(void) {
+}
+
+esp_err_t adc_stream_set_mode(adc_stream_mode_t mode) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+adc_stream_mode_t adc_stream_get_mode(void) {
+    return ADC_STREAM_OFF;
+}
+
+void adc_stream_push_raw(const uint8_t *frame, size_t size, int64_t time_us) {
+}
+
+void adc_stream_push_decimated(const uint32_t *sum, const uint32_t *count, int probe_count, int64_t time_us) {
+}
+
+adc_stream_stats_t adc_stream_get_stats(void) {
+    adc_stream_stats_t empty = { 0 };
+    return empty;
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef ADC_STREAM_H
+#define ADC_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/*
+ * Wire format, little endian. Every record:
+ *
+ *   offset  size  field
+ *        0     2  sync, ADC_STREAM_SYNC_0 ADC_STREAM_SYNC_1
+ *        2     1  type, adc_stream_record_t
+ *        3     1  reserved, 0
+ *        4     2  payload length
+ *        6     4  sequence number, +1 per record produced, a gap counts dropped records
+ *       10     4  time of the frame in microseconds since boot, low 32 bits
+ *       14     n  payload
+ *     14+n     2  CRC-16/CCITT-FALSE of bytes 2 .. 14+n-1
+ *
+ * ADC_STREAM_RECORD_INFO is sent before the first frame record of a mode or a connection:
+ *   version (1), output format (1, adc_digi_output_format_t + 1), bytes per sample (1),
+ *   probe count (1), sample frequency in Hz (4), then per probe: ADC unit (1), ADC channel (1),
+ *   enabled (1), probe type (1).
+ * ADC_STREAM_RECORD_RAW carries a DMA frame as the driver returned it, adc_digi_output_data_t[].
+ * ADC_STREAM_RECORD_DECIMATED carries the probe count (1) and a reserved byte (1), then per
+ *   probe the mean raw value of the frame (2, ADC_STREAM_NO_SAMPLES without samples) and the
+ *   number of samples averaged (2).
+ */
+#define ADC_STREAM_SYNC_0       0xA5
+#define ADC_STREAM_SYNC_1       0x5A
+#define ADC_STREAM_VERSION      1
+#define ADC_STREAM_HEADER_SIZE  14
+#define ADC_STREAM_CRC_SIZE     2
+#define ADC_STREAM_NO_SAMPLES   0xFFFF
+
+typedef enum {
+    ADC_STREAM_RECORD_INFO = 0,
+    ADC_STREAM_RECORD_RAW,
+    ADC_STREAM_RECORD_DECIMATED,
+} adc_stream_record_t;
+
+typedef enum {
+    ADC_STREAM_OFF = 0,
+    ADC_STREAM_RAW,             // Every DMA frame as is
+    ADC_STREAM_DECIMATED,       // Mean per probe of every DMA frame
+    ADC_STREAM_MODE_MAX
+} adc_stream_mode_t;
+
+typedef struct {
+    adc_stream_mode_t mode;     // Selected mode, frames only go out while a sink is ready
+    bool sink_ready;            // UART installed or a TCP client connected
+    uint32_t records;           // Records put into the ring buffer
+    uint32_t dropped;           // Records that did not fit into the ring buffer or were lost with the transport
+    uint32_t bytes_sent;        // Bytes handed to the transport
+    uint32_t ring_peak;         // Highest ring buffer fill in bytes
+    uint32_t connections;       // TCP clients served, 0 on the UART
+} adc_stream_stats_t;
+
+/**
+ * @brief Set up the ring buffer and the transport, start the stream task.
+ *
+ * Does nothing unless CONFIG_ADC_STREAM_ENABLE is set.
+ */
+void adc_stream_initialize(void);
+
+/**
+ * @brief Change what is streamed, an info record goes out before the next frame.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an unknown mode, ESP_ERR_NOT_SUPPORTED when
+ *         streaming is not built in.
+ */
+esp_err_t adc_stream_set_mode(adc_stream_mode_t mode);
+
+/**
+ * @brief Get the streaming mode, ADC_STREAM_OFF while nobody listens.
+ *
+ * Checked by the acquisition task once per DMA frame.
+ */
+adc_stream_mode_t adc_stream_get_mode(void);
+
+/**
+ * @brief Get the name of a mode.
+ */
+const char *adc_stream_get_mode_name(adc_stream_mode_t mode);
+
+/**
+ * @brief Queue a raw DMA frame, called by the acquisition task only.
+ * @param frame   DMA frame, adc_digi_output_data_t[].
+ * @param size    Bytes in the frame.
+ * @param time_us Time the frame was drained.
+ */
+void adc_stream_push_raw(const uint8_t *frame, size_t size, int64_t time_us);
+
+/**
+ * @brief Queue the per-probe means of a DMA frame, called by the acquisition task only.
+ * @param sum         Sum of the raw values per probe.
+ * @param count       Samples per probe.
+ * @param probe_count Entries in sum and count.
+ * @param time_us     Time the frame was drained.
+ */
+void adc_stream_push_decimated(const uint32_t *sum, const uint32_t *count, int probe_count, int64_t time_us);
+
+/**
+ * @brief Get the stream counters.
+ */
+adc_stream_stats_t adc_stream_get_stats(void);
+
+/**
+ * @brief Update a CRC-16/CCITT-FALSE (poly 0x1021), start with 0xFFFF.
+ */
+uint16_t adc_stream_crc16(uint16_t crc, const uint8_t *data, size_t size);
+
+#endif // ADC_STREAM_H
@@ -0,0 +1,267 @@
+#include "alarm_manager.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "alarm";
+
+#if CONFIG_ALARM_ENABLE
+#define ALARM_RATE_WINDOW_MS CONFIG_ALARM_RATE_WINDOW_MS
+#else
+#define ALARM_RATE_WINDOW_MS 10000
+#endif
+
+static const char *const alarm_type_names[ALARM_TYPE_MAX] = {
+    [ALARM_TYPE_HIGH] = "HIGH",
+    [ALARM_TYPE_LOW] = "LOW",
+    [ALARM_TYPE_RATE] = "RATE",
+};
+
+// Evaluation state of a channel, only touched by the acquisition task
+typedef struct {
+    int64_t pending_since_us[ALARM_TYPE_MAX]; // Start of a limit violation not yet raised, 0 if none
+    int32_t rate_ref_centi;                   // Value at the start of the rate window
+    int64_t rate_ref_time_us;                 // Start of the rate window, 0 if not started
+} alarm_channel_state_t;
+
+static alarm_channel_config_t channel_config[NTC_MAX_CHANNELS];
+static portMUX_TYPE channel_config_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t channel_config_changed; // Channels whose rules changed since the last frame, under channel_config_lock
+static alarm_channel_state_t channel_state[NTC_MAX_CHANNELS];
+static volatile uint32_t active_flags[NTC_MAX_CHANNELS] = { 0 };
+
+static alarm_stats_t alarm_stats = { 0 };
+static uint64_t latency_sum_us = 0;
+static portMUX_TYPE alarm_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+const char *alarm_get_type_name(alarm_type_t type) {
+    return type < ALARM_TYPE_MAX ? alarm_type_names[type] : "?";
+}
+
+// Post a transition, the event loop handler measures the latency
+static void alarm_post(int channel, alarm_type_t type, bool raised, int32_t value_centi, int64_t sample_time_us) {
+    alarm_event_t event = {
+        .channel = channel,
+        .type = type,
+        .value_centi = value_centi,
+        .sample_time_us = sample_time_us,
+    };
+
+    if (raised) {
+        active_flags[channel] |= ALARM_FLAG(type);
+        ESP_LOGW(TAG, "Channel %d %s alarm raised (%ld)", channel, alarm_type_names[type], (long)value_centi);
+        events_post(EVENT_ALARM_RAISED, &event, sizeof(event));
+    } else {
+        active_flags[channel] &= ~ALARM_FLAG(type);
+        ESP_LOGI(TAG, "Channel %d %s alarm cleared (%ld)", channel, alarm_type_names[type], (long)value_centi);
+        events_post(EVENT_ALARM_CLEARED, &event, sizeof(event));
+    }
+}
+
+// Limit rule with minimum duration and hysteresis
+static void alarm_evaluate_limit(int channel, alarm_type_t type, bool violated, bool recovered,
+                                 uint32_t min_duration_ms, int32_t value_centi, int64_t sample_time_us) {
+    alarm_channel_state_t *state = &channel_state[channel];
+
+    if (active_flags[channel] & ALARM_FLAG(type)) {
+        if (recovered) {
+            alarm_post(channel, type, false, value_centi, sample_time_us);
+        }
+        return;
+    }
+
+    if (!violated) {
+        state->pending_since_us[type] = 0;
+        return;
+    }
+    if (state->pending_since_us[type] == 0) {
+        state->pending_since_us[type] = sample_time_us;
+    }
+    if (sample_time_us - state->pending_since_us[type] >= (int64_t)min_duration_ms * 1000) {
+        state->pending_since_us[type] = 0;
+        alarm_post(channel, type, true, value_centi, sample_time_us);
+    }
+}
+
+// Rate rule, the rate is measured over a fixed window to keep the cost constant
+static void alarm_evaluate_rate(int channel, const alarm_channel_config_t *config,
+                                int32_t value_centi, int64_t sample_time_us) {
+    alarm_channel_state_t *state = &channel_state[channel];
+
+    if (state->rate_ref_time_us == 0) {
+        state->rate_ref_centi = value_centi;
+        state->rate_ref_time_us = sample_time_us;
+        return;
+    }
+
+    int64_t elapsed_us = sample_time_us - state->rate_ref_time_us;
+    if (elapsed_us < (int64_t)ALARM_RATE_WINDOW_MS * 1000) {
+        return;
+    }
+
+    int32_t rate = (int32_t)((int64_t)(value_centi - state->rate_ref_centi) * 60000000 / elapsed_us);
+    state->rate_ref_centi = value_centi;
+    state->rate_ref_time_us = sample_time_us;
+
+    int32_t magnitude = abs(rate);
+    alarm_evaluate_limit(channel, ALARM_TYPE_RATE,
+                         magnitude > config->rate_limit_centi_per_min,
+                         magnitude < config->rate_limit_centi_per_min - config->rate_hysteresis_centi_per_min,
+                         0, rate, sample_time_us);
+}
+
+// Clear every active alarm of a channel, used when its rules are disabled or replaced
+static void alarm_clear_channel(int channel, int64_t now) {
+    for (int type = 0; type < ALARM_TYPE_MAX; type++) {
+        if (active_flags[channel] & ALARM_FLAG(type)) {
+            alarm_post(channel, type, false, 0, now);
+        }
+    }
+    memset(&channel_state[channel], 0, sizeof(channel_state[channel]));
+}
+
+void alarm_process_frame(const int32_t *value_centi, uint32_t valid_mask, const int64_t *sample_time_us) {
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        if (!(valid_mask & (1 << i))) {
+            continue;
+        }
+
+        portENTER_CRITICAL(&channel_config_lock);
+        alarm_channel_config_t config = channel_config[i];
+        bool changed = (channel_config_changed & (1u << i)) != 0;
+        channel_config_changed &= ~(1u << i);
+        portEXIT_CRITICAL(&channel_config_lock);
+
+        // New rules start over, alarms raised under the old limits and pending violations are dropped
+        if (changed || (!config.enabled && active_flags[i])) {
+            alarm_clear_channel(i, sample_time_us[i]);
+        }
+        if (!config.enabled) {
+            continue;
+        }
+
+        int32_t value = value_centi[i];
+        alarm_evaluate_limit(i, ALARM_TYPE_HIGH, value >= config.high_centi,
+                             value < config.high_centi - config.hysteresis_centi,
+                             config.min_duration_ms, value, sample_time_us[i]);
+        alarm_evaluate_limit(i, ALARM_TYPE_LOW, value <= config.low_centi,
+                             value > config.low_centi + config.hysteresis_centi,
+                             config.min_duration_ms, value, sample_time_us[i]);
+        if (config.rate_limit_centi_per_min > 0) {
+            alarm_evaluate_rate(i, &config, value, sample_time_us[i]);
+        } else if (active_flags[i] & ALARM_FLAG(ALARM_TYPE_RATE)) {
+            alarm_post(i, ALARM_TYPE_RATE, false, 0, sample_time_us[i]);
+        }
+    }
+
+    // One state update per frame, it only notifies when an alarm came or went
+    uint32_t channel_mask = 0;
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        channel_mask |= active_flags[i] ? (1u << i) : 0;
+    }
+    state_set_alarms(channel_mask, alarm_get_active_count());
+}
+
+esp_err_t alarm_get_channel_config(int channel_index, alarm_channel_config_t *config) {
+    if (channel_index < 0 || channel_index >= NTC_CHANNEL_COUNT || config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&channel_config_lock);
+    *config = channel_config[channel_index];
+    portEXIT_CRITICAL(&channel_config_lock);
+    return ESP_OK;
+}
+
+bool alarm_channel_config_valid(const alarm_channel_config_t *config) {
+    // Limits of a disabled rule set are never evaluated, with alarms disabled they are left at 0
+    return config != NULL && (!config->enabled || config->low_centi < config->high_centi) &&
+           config->hysteresis_centi >= 0 && config->rate_limit_centi_per_min >= 0 &&
+           config->rate_hysteresis_centi_per_min >= 0;
+}
+
+static bool alarm_channel_config_equal(const alarm_channel_config_t *a, const alarm_channel_config_t *b) {
+    return a->enabled == b->enabled && a->high_centi == b->high_centi && a->low_centi == b->low_centi &&
+           a->hysteresis_centi == b->hysteresis_centi && a->min_duration_ms == b->min_duration_ms &&
+           a->rate_limit_centi_per_min == b->rate_limit_centi_per_min &&
+           a->rate_hysteresis_centi_per_min == b->rate_hysteresis_centi_per_min;
+}
+
+esp_err_t alarm_set_channel_config(int channel_index, const alarm_channel_config_t *config) {
+    if (channel_index < 0 || channel_index >= NTC_CHANNEL_COUNT || !alarm_channel_config_valid(config)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&channel_config_lock);
+    if (!alarm_channel_config_equal(&channel_config[channel_index], config)) {
+        channel_config[channel_index] = *config;
+        channel_config_changed |= 1u << channel_index; // The acquisition task resets the channel's state
+    }
+    portEXIT_CRITICAL(&channel_config_lock);
+    return ESP_OK;
+}
+
+uint32_t alarm_get_active_flags(int channel_index) {
+    if (channel_index < 0 || channel_index >= NTC_CHANNEL_COUNT) {
+        return 0;
+    }
+    return active_flags[channel_index];
+}
+
+uint32_t alarm_get_active_count(void) {
+    uint32_t count = 0;
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        count += __builtin_popcount(active_flags[i]);
+    }
+    return count;
+}
+
+alarm_stats_t alarm_get_stats(void) {
+    portENTER_CRITICAL(&alarm_stats_lock);
+    alarm_stats_t stats = alarm_stats;
+    portEXIT_CRITICAL(&alarm_stats_lock);
+    return stats;
+}
+
+// Runs on the event loop, measures the latency from sample acquisition to event delivery
+static void alarm_event_handler(void *handler_arg, esp_event_base_t base, int32_t id, void *event_data) {
+    const alarm_event_t *event = (const alarm_event_t *)event_data;
+    uint32_t latency_us = (uint32_t)(esp_timer_get_time() - event->sample_time_us);
+
+    portENTER_CRITICAL(&alarm_stats_lock);
+    if (id == EVENT_ALARM_RAISED) {
+        alarm_stats.raised++;
+    } else {
+        alarm_stats.cleared++;
+    }
+    latency_sum_us += latency_us;
+    alarm_stats.latency_last_us = latency_us;
+    if (latency_us > alarm_stats.latency_max_us) {
+        alarm_stats.latency_max_us = latency_us;
+    }
+    alarm_stats.latency_avg_us = latency_sum_us / (alarm_stats.raised + alarm_stats.cleared);
+    portEXIT_CRITICAL(&alarm_stats_lock);
+}
+
+void alarm_initialize(void) {
+#if CONFIG_ALARM_ENABLE
+    alarm_channel_config_t defaults = {
+        .enabled = true,
+        .high_centi = CONFIG_ALARM_HIGH_LIMIT_C * 100,
+        .low_centi = CONFIG_ALARM_LOW_LIMIT_C * 100,
+        .hysteresis_centi = CONFIG_ALARM_HYSTERESIS_DECI_C * 10,
+        .min_duration_ms = CONFIG_ALARM_MIN_DURATION_MS,
+        .rate_limit_centi_per_min = CONFIG_ALARM_RATE_LIMIT_C_PER_MIN * 100,
+        .rate_hysteresis_centi_per_min = CONFIG_ALARM_RATE_HYSTERESIS_DECI_C_PER_MIN * 10,
+    };
+#else
+    alarm_channel_config_t defaults = { .enabled = false };
+#endif
+    for (int i = 0; i < NTC_MAX_CHANNELS; i++) {
+        channel_config[i] = defaults;
+    }
+    memset(channel_state, 0, sizeof(channel_state));
+
+    events_subscribe(EVENT_ALARM_RAISED, alarm_event_handler, NULL);
+    events_subscribe(EVENT_ALARM_CLEARED, alarm_event_handler, NULL);
+    ESP_LOGI(TAG, "Alarm engine %s", defaults.enabled ? "enabled" : "disabled");
+}
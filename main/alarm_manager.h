@@ -0,0 +1,103 @@
+#ifndef ALARM_MANAGER_H
+#define ALARM_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "events.h"
+#include "ntc_adc.h"
+
+// Alarm rules, also used as bits of the per-channel active flags
+typedef enum {
+    ALARM_TYPE_HIGH = 0,
+    ALARM_TYPE_LOW,
+    ALARM_TYPE_RATE,
+    ALARM_TYPE_MAX
+} alarm_type_t;
+
+#define ALARM_FLAG(type) (1u << (type))
+
+// Per-channel alarm rules, temperatures in 0.01 °C
+typedef struct {
+    bool enabled;
+    int32_t high_centi;              // Raise when the value is at or above this limit
+    int32_t low_centi;               // Raise when the value is at or below this limit
+    int32_t hysteresis_centi;        // Clear once back inside the limit by this amount
+    uint32_t min_duration_ms;        // Limit has to be exceeded this long before raising
+    int32_t rate_limit_centi_per_min; // Absolute rate of change limit in 0.01 °C/min, 0 disables the rule
+    int32_t rate_hysteresis_centi_per_min; // Clear once the rate is below the limit by this amount, 0.01 °C/min
+} alarm_channel_config_t;
+
+// Payload of EVENT_ALARM_RAISED and EVENT_ALARM_CLEARED
+typedef struct {
+    uint8_t channel;                 // Probe index
+    uint8_t type;                    // alarm_type_t
+    int32_t value_centi;             // Temperature (or rate per minute) that triggered the transition
+    int64_t sample_time_us;          // Time the triggering sample was acquired
+} alarm_event_t;
+
+typedef struct {
+    uint32_t raised;                 // Number of EVENT_ALARM_RAISED posted
+    uint32_t cleared;                // Number of EVENT_ALARM_CLEARED posted
+    uint32_t latency_last_us;        // Sample to event handler latency of the last transition
+    uint32_t latency_max_us;         // Worst sample to event handler latency
+    uint32_t latency_avg_us;         // Average sample to event handler latency
+} alarm_stats_t;
+
+/**
+ * @brief Initialize the alarm engine with the Kconfig default rules.
+ */
+void alarm_initialize(void);
+
+/**
+ * @brief Evaluate the alarm rules on a published frame.
+ *
+ * Called from the acquisition task, constant cost per channel.
+ *
+ * @param value_centi    Temperatures in 0.01 °C, indexed by channel.
+ * @param valid_mask     Channels updated in this frame.
+ * @param sample_time_us Acquisition time of each channel's sample.
+ */
+void alarm_process_frame(const int32_t *value_centi, uint32_t valid_mask, const int64_t *sample_time_us);
+
+/**
+ * @brief Get the rules of a channel.
+ */
+esp_err_t alarm_get_channel_config(int channel_index, alarm_channel_config_t *config);
+
+/**
+ * @brief Check the rules of a channel, the limits of a disabled rule set are not checked.
+ */
+bool alarm_channel_config_valid(const alarm_channel_config_t *config);
+
+/**
+ * @brief Replace the rules of a channel, they take effect on the next published frame.
+ *
+ * Changed rules clear the channel's active alarms and pending violations on that frame,
+ * identical rules leave them alone.
+ *
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if the index is out of range or alarm_channel_config_valid() fails.
+ */
+esp_err_t alarm_set_channel_config(int channel_index, const alarm_channel_config_t *config);
+
+/**
+ * @brief Get the active alarm flags (ALARM_FLAG bits) of a channel.
+ */
+uint32_t alarm_get_active_flags(int channel_index);
+
+/**
+ * @brief Get the number of active alarms over all channels.
+ */
+uint32_t alarm_get_active_count(void);
+
+/**
+ * @brief Get the alarm transition and latency statistics, a consistent copy.
+ */
+alarm_stats_t alarm_get_stats(void);
+
+/**
+ * @brief Get a short name of an alarm type.
+ */
+const char *alarm_get_type_name(alarm_type_t type);
+
+#endif // ALARM_MANAGER_H
@@ -0,0 +1,113 @@
+#include "boot_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "task_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdbool.h>
+#include <string.h>
+
+static const char *TAG = "boot";
+
+static const boot_stage_t *boot_stages = NULL;
+static int boot_stage_count = 0;
+static boot_stage_timing_t boot_timing[BOOT_MAX_STAGES];
+static EventGroupHandle_t boot_done = NULL; // Bit n set when stage n finished
+static uint32_t boot_claimed = 0;           // Stages taken by a worker, under boot_lock
+static portMUX_TYPE boot_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int boot_claim_stage(uint32_t done) {
+    // Take the first stage that is not started and has all its dependencies done
+    int claimed = -1;
+    portENTER_CRITICAL(&boot_lock);
+    for (int i = 0; i < boot_stage_count; i++) {
+        if ((boot_claimed & BOOT_DEPENDS(i)) == 0 && (boot_stages[i].depends & ~done) == 0) {
+            boot_claimed |= BOOT_DEPENDS(i);
+            claimed = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&boot_lock);
+    return claimed;
+}
+
+static void boot_work(void) {
+    // Run stages until every stage is taken, waiting on completions instead of sleeping
+    uint32_t all = BOOT_DEPENDS(boot_stage_count) - 1;
+    while (1) {
+        uint32_t done = xEventGroupGetBits(boot_done) & all;
+        int stage = boot_claim_stage(done);
+        if (stage < 0) {
+            portENTER_CRITICAL(&boot_lock);
+            bool finished = boot_claimed == all;
+            portEXIT_CRITICAL(&boot_lock);
+            if (finished) {
+                return; // The remaining stages run on other workers
+            }
+            xEventGroupWaitBits(boot_done, all & ~done, pdFALSE, pdFALSE, portMAX_DELAY);
+            continue;
+        }
+
+        boot_timing[stage].start_us = esp_timer_get_time();
+        boot_stages[stage].init();
+        boot_timing[stage].end_us = esp_timer_get_time();
+        xEventGroupSetBits(boot_done, BOOT_DEPENDS(stage));
+    }
+}
+
+static void boot_worker_task(void *arg) {
+    boot_work();
+    vTaskDelete(NULL);
+}
+
+esp_err_t boot_run(const boot_stage_t *stages, int count) {
+    if (stages == NULL || count <= 0 || count > BOOT_MAX_STAGES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < count; i++) {
+        if (stages[i].init == NULL || (stages[i].depends & ~(BOOT_DEPENDS(i) - 1)) != 0) {
+            ESP_LOGE(TAG, "Stage %s depends on itself or a later stage", stages[i].name);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    if (boot_done == NULL) {
+        boot_done = KERNEL_EVENT_GROUP_CREATE();
+    }
+    xEventGroupClearBits(boot_done, BOOT_DEPENDS(BOOT_MAX_STAGES) - 1);
+    memset(boot_timing, 0, sizeof(boot_timing));
+    boot_stages = stages;
+    boot_stage_count = count;
+    boot_claimed = 0;
+
+    // Helpers run with the priority of the caller, some stages derive their task priorities from it
+    for (int i = 1; i < CONFIG_BOOT_WORKERS; i++) {
+        xTaskCreate(boot_worker_task, "boot_worker", CONFIG_BOOT_WORKER_STACK_SIZE, NULL, uxTaskPriorityGet(NULL), NULL);
+    }
+    boot_work();
+
+    uint32_t all = BOOT_DEPENDS(count) - 1;
+    xEventGroupWaitBits(boot_done, all, pdFALSE, pdTRUE, portMAX_DELAY);
+    return ESP_OK;
+}
+
+esp_err_t boot_get_timing(int stage, boot_stage_timing_t *timing) {
+    if (stage < 0 || stage >= boot_stage_count || timing == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *timing = boot_timing[stage];
+    return ESP_OK;
+}
+
+void boot_print_report(void) {
+    int64_t end_us = 0;
+    ESP_LOGI(TAG, "%-14s %10s %10s", "stage", "start ms", "took ms");
+    for (int i = 0; i < boot_stage_count; i++) {
+        const boot_stage_timing_t *timing = &boot_timing[i];
+        ESP_LOGI(TAG, "%-14s %10.1f %10.1f", boot_stages[i].name, timing->start_us / 1000.0,
+                 (timing->end_us - timing->start_us) / 1000.0);
+        end_us = timing->end_us > end_us ? timing->end_us : end_us;
+    }
+    ESP_LOGI(TAG, "%d stages done at %.1f ms", boot_stage_count, end_us / 1000.0);
+}
@@ -0,0 +1,47 @@
+#ifndef BOOT_MANAGER_H
+#define BOOT_MANAGER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#define BOOT_MAX_STAGES 24                        // One event group bit per stage
+#define BOOT_DEPENDS(stage) (1u << (stage))       // Dependency mask bit of a stage index
+
+// One step of the boot, started as soon as the stages it depends on are done
+typedef struct {
+    const char *name;
+    void (*init)(void);
+    uint32_t depends;                             // BOOT_DEPENDS() of earlier stages
+} boot_stage_t;
+
+// Start and end of a stage, in microseconds since boot
+typedef struct {
+    int64_t start_us;
+    int64_t end_us;                               // 0 while the stage has not finished
+} boot_stage_timing_t;
+
+/**
+ * @brief Run the boot stages, returns when all of them are done.
+ *
+ * Stages run on CONFIG_BOOT_WORKERS tasks, the calling task being one of them, with
+ * the priority of the caller. A stage only depends on stages listed before it, the
+ * table is then free of cycles and a plain sequential run is always one valid order.
+ *
+ * @param stages Stage table, kept for boot_get_timing() and boot_print_report().
+ * @param count  Number of stages, at most BOOT_MAX_STAGES.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if a stage depends on itself or a later stage.
+ */
+esp_err_t boot_run(const boot_stage_t *stages, int count);
+
+/**
+ * @brief Get the timing of a stage of the last boot_run().
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an unknown stage.
+ */
+esp_err_t boot_get_timing(int stage, boot_stage_timing_t *timing);
+
+/**
+ * @brief Log the start time and duration of every stage.
+ */
+void boot_print_report(void);
+
+#endif // BOOT_MANAGER_H
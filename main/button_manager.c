@@ -1,100 +1,288 @@
 #include "button_manager.h"
+#include "power_manager.h"
+#include "task_config.h"
+#include "soc/soc_caps.h"
+#if SOC_GPIO_SUPPORT_PIN_GLITCH_FILTER
+#include "driver/gpio_filter.h"
+#endif
 
 static const char *TAG = "button_interrupt";
 
-static QueueHandle_t gpio_evt_queue = NULL;
-static int64_t press_start_time = 0; 
-static int64_t last_isr_time = 0;  // Timestamp of the last ISR call
-static TimerHandle_t long_press_timer = NULL;
-static bool long_press_detected = false;
+// Inputs of the gesture task: debounced in the task from the ISR timestamps, timeouts from one-shot timers
+typedef enum {
+    BUTTON_INPUT_EDGE = 0,   // Level change captured by the ISR
+    BUTTON_INPUT_SETTLE,     // Debounce time over after ignored edges, read the level again
+    BUTTON_INPUT_TIMEOUT,    // Long press, double click window or hold repeat time over
+} button_input_kind_t;
 
-// Interrupt service routine (ISR)
+typedef struct {
+    uint8_t button;
+    uint8_t kind;
+    uint8_t level;
+    uint32_t generation;     // Timer arming the timeout, stale timeouts are dropped
+    int64_t time_us;
+} button_input_t;
+
+typedef enum {
+    BUTTON_PHASE_IDLE = 0,
+    BUTTON_PHASE_PRESSED,    // Down, waiting for the release or the long press time
+    BUTTON_PHASE_RELEASED,   // Clicked once, waiting for a second press
+    BUTTON_PHASE_HELD,       // Long press reported, repeating until the release
+} button_phase_t;
+
+typedef struct {
+    gpio_num_t gpio;
+    int level;                       // Debounced level, 0 while pressed
+    int64_t edge_time_us;            // Last accepted edge
+    bool settle_pending;
+    button_phase_t phase;
+    uint8_t clicks;
+    uint16_t repeat;
+    int64_t press_time_us;
+    esp_timer_handle_t timer;
+    esp_timer_handle_t settle_timer;
+    volatile uint32_t generation;
+} button_state_t;
+
+static const gpio_num_t button_gpios[BUTTON_ID_MAX] = {
+    [BUTTON_ID_MAIN] = BUTTON_GPIO,
+    [BUTTON_ID_UP] = CONFIG_BUTTON_UP_GPIO,
+    [BUTTON_ID_DOWN] = CONFIG_BUTTON_DOWN_GPIO,
+};
+
+static QueueHandle_t button_queue = NULL;
+static button_state_t buttons[BUTTON_ID_MAX];
+
+// Interrupt service routine (ISR), only captures the edge
 static void IRAM_ATTR gpio_isr_handler(void *arg) {
-    uint32_t gpio_num = (uint32_t)arg;
-    int64_t now = esp_timer_get_time();  // Get current time in microseconds
+    button_input_t input = {
+        .button = (uint8_t)(uintptr_t)arg,
+        .kind = BUTTON_INPUT_EDGE,
+        .time_us = esp_timer_get_time(),
+    };
+    input.level = gpio_get_level(buttons[input.button].gpio);
+    BaseType_t task_woken = pdFALSE;
+    xQueueSendFromISR(button_queue, &input, &task_woken);
+    portYIELD_FROM_ISR(task_woken);
+}
+
+static void button_timer_callback(void *arg) {
+    uint8_t index = (uint8_t)(uintptr_t)arg;
+    button_input_t input = {
+        .button = index,
+        .kind = BUTTON_INPUT_TIMEOUT,
+        .generation = buttons[index].generation,
+        .time_us = esp_timer_get_time(),
+    };
+    xQueueSend(button_queue, &input, 0);
+}
+
+static void button_settle_callback(void *arg) {
+    button_input_t input = {
+        .button = (uint8_t)(uintptr_t)arg,
+        .kind = BUTTON_INPUT_SETTLE,
+        .time_us = esp_timer_get_time(),
+    };
+    xQueueSend(button_queue, &input, 0);
+}
+
+static void button_arm(button_state_t *button, int64_t timeout_us) {
+    // Restart the one-shot timer, a timeout already queued from the previous arming is dropped
+    esp_timer_stop(button->timer);
+    button->generation++;
+    if (timeout_us > 0) {
+        esp_timer_start_once(button->timer, timeout_us);
+    }
+}
+
+static void button_post(button_state_t *button, int32_t event_id, const char *name) {
+    button_event_t event = {
+        .button = button - buttons,
+        .repeat = button->repeat,
+        .press_time_us = button->press_time_us,
+    };
+    ESP_LOGD(TAG, "%s on GPIO %d", name, button->gpio);
+    events_post(event_id, &event, sizeof(event));
+}
 
-    // Debounce: Ignore interrupts within X ms
-    if (now - last_isr_time > BUTTON_DEBOUNCE_TIME_US) {
-        last_isr_time = now;
-        xQueueSendFromISR(gpio_evt_queue, &gpio_num, NULL);
+static void button_on_press(button_state_t *button, int64_t time_us) {
+    if (button->phase == BUTTON_PHASE_IDLE) {
+        button->clicks = 0;
+        button->press_time_us = time_us;
     }
+    button->phase = BUTTON_PHASE_PRESSED;
+    button_arm(button, BUTTON_LONG_PRESS_TIME_US);
 }
 
-// Timer callback to check for long press
-static void long_press_timer_callback(TimerHandle_t xTimer) {
-    int64_t now = esp_timer_get_time();
-    int64_t press_duration = now - press_start_time;
+static void button_on_release(button_state_t *button) {
+    if (button->phase == BUTTON_PHASE_HELD) {
+        button->phase = BUTTON_PHASE_IDLE;
+        button_arm(button, 0);
+        return;
+    }
+    if (button->phase != BUTTON_PHASE_PRESSED) {
+        return;
+    }
 
-    if (long_press_detected) {
+    button->clicks++;
+    if (BUTTON_DOUBLE_CLICK_TIME_US == 0 || button->clicks >= 2) {
+        button->phase = BUTTON_PHASE_IDLE;
+        button_arm(button, 0);
+        if (button->clicks >= 2) {
+            button_post(button, EVENT_BUTTON_DOUBLE_CLICK, "Double click");
+        } else {
+            button_post(button, EVENT_BUTTON_SHORT_PRESS, "Short press");
+        }
         return;
     }
+    button->phase = BUTTON_PHASE_RELEASED;
+    button_arm(button, BUTTON_DOUBLE_CLICK_TIME_US);
+}
 
-    if (press_duration >= BUTTON_LONG_PRESS_TIME_US && gpio_get_level(BUTTON_GPIO) == 0) {
-        ESP_LOGD(TAG, "Long press detected in advance on GPIO %d", BUTTON_GPIO);
-        long_press_detected = true;
+static void button_on_timeout(button_state_t *button) {
+    switch (button->phase) {
+        case BUTTON_PHASE_PRESSED:
+            if (button->clicks > 0) {
+                button_post(button, EVENT_BUTTON_SHORT_PRESS, "Short press"); // Click, then a long press
+            }
+            button->repeat = 0;
+            button->phase = BUTTON_PHASE_HELD;
+            button_post(button, EVENT_BUTTON_LONG_PRESS, "Long press");
+            button_arm(button, BUTTON_REPEAT_TIME_US);
+            break;
+        case BUTTON_PHASE_HELD:
+            button->repeat++;
+            button_post(button, EVENT_BUTTON_HOLD_REPEAT, "Hold repeat");
+            button_arm(button, BUTTON_REPEAT_TIME_US);
+            break;
+        case BUTTON_PHASE_RELEASED:
+            button->phase = BUTTON_PHASE_IDLE;
+            button_post(button, EVENT_BUTTON_SHORT_PRESS, "Short press");
+            break;
+        default:
+            break;
+    }
+}
 
-        // status_led_set(LED_THREE_BLINK);
-        // Handle long press action here
-        events_post(EVENT_BUTTON_LONG_PRESS, NULL, 0);  // Post long press event
+static void button_on_level(button_state_t *button, int level, int64_t time_us) {
+    // Debounce: the first edge counts, edges within the debounce time are bounces and the
+    // level is read again once it is over
+    if (level == button->level) {
+        return;
+    }
+    if (time_us - button->edge_time_us < BUTTON_DEBOUNCE_TIME_US) {
+        if (!button->settle_pending) {
+            button->settle_pending = true;
+            esp_timer_start_once(button->settle_timer, button->edge_time_us + BUTTON_DEBOUNCE_TIME_US - time_us);
+        }
+        return;
+    }
+    button->level = level;
+    button->edge_time_us = time_us;
+    if (level == 0) {
+        button_on_press(button, time_us);
+    } else {
+        button_on_release(button);
     }
 }
 
-// Task to handle button press events
+// Task to turn the button inputs into gestures
 static void button_task(void *arg) {
-    uint32_t io_num;
+    button_input_t input;
     while (1) {
-        if (xQueueReceive(gpio_evt_queue, &io_num, portMAX_DELAY)) {
-            // Check the button state
-            if (gpio_get_level(io_num) == BUTTON_GPIO) {
-                press_start_time = esp_timer_get_time();
-                long_press_detected = false;
-
-                // Start the long press timer
-                xTimerStart(long_press_timer, 0);
-            } else {
-                int64_t press_duration = esp_timer_get_time() - press_start_time;
-
-                xTimerStop(long_press_timer, 0);
-
-                if (!long_press_detected) {  // If long press wasn't already detected
-                    if (press_duration >= BUTTON_LONG_PRESS_TIME_US) {  // Long press
-                        ESP_LOGD(TAG, "Long press detected on GPIO %ld", io_num);
-                        events_post(EVENT_BUTTON_LONG_PRESS, NULL, 0);  // Post long press event
-                    } else if (press_duration >= BUTTON_DEBOUNCE_TIME_US) {  // Short press
-                        ESP_LOGD(TAG, "Short press detected on GPIO %ld", io_num);
-                        events_post(EVENT_BUTTON_SHORT_PRESS, NULL, 0);  // Post short press event
+        if (xQueueReceive(button_queue, &input, portMAX_DELAY)) {
+            power_awake_begin(POWER_TASK_BUTTON);
+            button_state_t *button = &buttons[input.button];
+            switch (input.kind) {
+                case BUTTON_INPUT_EDGE:
+                    button_on_level(button, input.level, input.time_us);
+                    break;
+                case BUTTON_INPUT_SETTLE:
+                    button->settle_pending = false;
+                    button_on_level(button, gpio_get_level(button->gpio), input.time_us);
+                    break;
+                case BUTTON_INPUT_TIMEOUT:
+                    if (input.generation == button->generation) {
+                        button_on_timeout(button);
                     }
-                }
+                    break;
+                default:
+                    break;
             }
+            power_awake_end(POWER_TASK_BUTTON);
         }
     }
 }
 
+static void button_enable_filter(gpio_num_t gpio) {
+    // Hardware glitch filter where the chip has one, it removes spikes shorter than two clock
+    // cycles before they reach the ISR. Contact bounce is left to the debounce time.
+#if SOC_GPIO_SUPPORT_PIN_GLITCH_FILTER
+    gpio_pin_glitch_filter_config_t filter_config = {
+        .clk_src = GLITCH_FILTER_CLK_SRC_DEFAULT,
+        .gpio_num = gpio,
+    };
+    gpio_glitch_filter_handle_t filter = NULL;
+    if (gpio_new_pin_glitch_filter(&filter_config, &filter) != ESP_OK || gpio_glitch_filter_enable(filter) != ESP_OK) {
+        ESP_LOGW(TAG, "No glitch filter on GPIO %d", gpio);
+    }
+#endif
+}
+
+bool button_event_is(const void *event_data, button_id_t button) {
+    return event_data != NULL && ((const button_event_t *)event_data)->button == button;
+}
+
 void button_init(void) {
-    // Configure the button GPIO as input with pull-up
+    // Configure the button GPIOs as inputs with pull-up, interrupts on both edges
     gpio_config_t io_conf = {
-        .intr_type = GPIO_INTR_ANYEDGE,  // Trigger on falling edge (button press)
+        .intr_type = GPIO_INTR_ANYEDGE,
         .mode = GPIO_MODE_INPUT,
-        .pin_bit_mask = (1ULL << BUTTON_GPIO),
         .pull_up_en = GPIO_PULLUP_ENABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
     };
+    for (int i = 0; i < BUTTON_ID_MAX; i++) {
+        if (button_gpios[i] >= 0) {
+            io_conf.pin_bit_mask |= (1ULL << button_gpios[i]);
+        }
+    }
     gpio_config(&io_conf);
 
-    // Create a queue to handle GPIO events
-    gpio_evt_queue = xQueueCreate(10, sizeof(uint32_t));
+    // Create a queue to handle the button inputs
+    button_queue = KERNEL_QUEUE_CREATE(BUTTON_QUEUE_LENGTH, sizeof(button_input_t));
+
+    for (int i = 0; i < BUTTON_ID_MAX; i++) {
+        button_state_t *button = &buttons[i];
+        button->gpio = button_gpios[i];
+        if (button->gpio < 0) {
+            continue;
+        }
+        button->level = gpio_get_level(button->gpio);
+        button->edge_time_us = -BUTTON_DEBOUNCE_TIME_US;
 
-    // Create the long press timer
-    long_press_timer = xTimerCreate("LongPressTimer", pdMS_TO_TICKS(100), pdTRUE, NULL, long_press_timer_callback);
+        esp_timer_create_args_t timer_args = {
+            .callback = button_timer_callback,
+            .arg = (void *)(uintptr_t)i,
+            .name = "button",
+        };
+        esp_timer_create(&timer_args, &button->timer);
+        timer_args.callback = button_settle_callback;
+        timer_args.name = "button_settle";
+        esp_timer_create(&timer_args, &button->settle_timer);
+        button_enable_filter(button->gpio);
+    }
 
     // Start the button task
-    xTaskCreate(button_task, "button_task", 2048, NULL, 10, NULL);
+    task_create(TASK_ID_BUTTON, button_task, NULL, NULL);
 
     // Install the ISR service
     gpio_install_isr_service(ESP_INTR_FLAG_LEVEL3);
 
-    // Attach the interrupt handler
-    gpio_isr_handler_add(BUTTON_GPIO, gpio_isr_handler, (void *)BUTTON_GPIO);
-
-    ESP_LOGI(TAG, "Button interrupt initialized on GPIO %d", BUTTON_GPIO);
-}
\ No newline at end of file
+    // Attach the interrupt handlers
+    for (int i = 0; i < BUTTON_ID_MAX; i++) {
+        if (buttons[i].gpio >= 0) {
+            gpio_isr_handler_add(buttons[i].gpio, gpio_isr_handler, (void *)(uintptr_t)i);
+            ESP_LOGI(TAG, "Button %d interrupt initialized on GPIO %d", i, buttons[i].gpio);
+        }
+    }
+}
@@ -10,9 +10,31 @@
 #include "events.h"
 
 #define BUTTON_GPIO GPIO_NUM_0  // IO0 button
-#define BUTTON_DEBOUNCE_TIME_US 90000  // 90ms debounce time
-#define BUTTON_LONG_PRESS_TIME_US 3000000  // 3 seconds long press time
+#define BUTTON_DEBOUNCE_TIME_US (CONFIG_BUTTON_DEBOUNCE_MS * 1000)
+#define BUTTON_LONG_PRESS_TIME_US (CONFIG_BUTTON_LONG_PRESS_MS * 1000)
+#define BUTTON_DOUBLE_CLICK_TIME_US (CONFIG_BUTTON_DOUBLE_CLICK_MS * 1000)
+#define BUTTON_REPEAT_TIME_US (CONFIG_BUTTON_REPEAT_MS * 1000)
+#define BUTTON_QUEUE_LENGTH 16
 
+// Buttons, the main button is always present, the others when their GPIO is configured
+typedef enum {
+    BUTTON_ID_MAIN = 0,
+    BUTTON_ID_UP,
+    BUTTON_ID_DOWN,
+    BUTTON_ID_MAX
+} button_id_t;
+
+// Data of the EVENT_BUTTON_* events
+typedef struct {
+    uint8_t button;                  // button_id_t
+    uint16_t repeat;                 // EVENT_BUTTON_HOLD_REPEAT count, starting at 1
+    int64_t press_time_us;           // Time of the press edge that started the gesture
+} button_event_t;
+
+// Configure the button inputs and start the gesture task.
 void button_init(void);
 
+// Check whether a button event comes from a button, for handlers subscribed to EVENT_BUTTON_*.
+bool button_event_is(const void *event_data, button_id_t button);
+
 #endif // BUTTON_MANAGER_H
\ No newline at end of file
@@ -1,11 +1,36 @@
 #include "captive_portal.h"
 #include "esp_log.h"
+#include "heap_monitor.h"
+#include "instrumentation.h"
+#include "ntc_adc.h"
+#include "task_config.h"
+#include <stdlib.h>
 
 static const char *TAG = "CAPTIVE_PORTAL";
 static const char *DNS_TAG = "DNS_SERVER";
 static const char *HTML_CONTENT = PORTAL_SRC;
 static httpd_handle_t http_server = NULL;
 
+int cp_dns_build_response(char *packet, int query_len, size_t packet_size) {
+    // Answer section pointing to the ESP32's AP IP address
+    static const uint8_t answer[] = {
+        0xc0, 0x0c, // Pointer to the query name
+        0x00, 0x01, // Type A
+        0x00, 0x01, // Class IN
+        0x00, 0x00, 0x00, 0x3c, // TTL (60 seconds)
+        0x00, 0x04, // Data length
+        192, 168, 4, 1 // IP address (192.168.4.1)
+    };
+
+    if (query_len < 12 || query_len + sizeof(answer) > packet_size) {
+        return -1;
+    }
+    packet[2] |= 0x80; // Set response flag
+    packet[3] |= 0x80; // Set authoritative answer flag
+    memcpy(packet + query_len, answer, sizeof(answer));
+    return query_len + sizeof(answer);
+}
+
 static void dns_server_task(void *arg) {
     struct sockaddr_in server_addr, client_addr;
     socklen_t addr_len = sizeof(client_addr);
@@ -48,22 +73,11 @@ static void dns_server_task(void *arg) {
             continue;
         }
 
-        // Respond to the DNS query
-        buffer[2] |= 0x80; // Set response flag
-        buffer[3] |= 0x80; // Set authoritative answer flag
-
-        // Set the answer section to point to the ESP32's AP IP address
-        uint8_t response[] = {
-            0xc0, 0x0c, // Pointer to the query name
-            0x00, 0x01, // Type A
-            0x00, 0x01, // Class IN
-            0x00, 0x00, 0x00, 0x3c, // TTL (60 seconds)
-            0x00, 0x04, // Data length
-            192, 168, 4, 1 // IP address (192.168.4.1)
-        };
-
-        memcpy(buffer + len, response, sizeof(response));
-        len += sizeof(response);
+        len = cp_dns_build_response(buffer, len, sizeof(buffer));
+        if (len < 0) {
+            ESP_LOGW(DNS_TAG, "DNS query too long to answer");
+            continue;
+        }
 
         // Send the response
         sendto(sock, buffer, len, 0, (struct sockaddr *)&client_addr, addr_len);
@@ -74,7 +88,7 @@ static void dns_server_task(void *arg) {
 }
 
 void cp_start_dns_server(void) {
-    xTaskCreate(dns_server_task, "dns_server_task", 4096, NULL, 5, NULL);
+    task_create(TASK_ID_DNS_SERVER, dns_server_task, NULL, NULL);
 }
 
 static esp_err_t handle_root_get(httpd_req_t *req) {
@@ -112,6 +126,57 @@ static esp_err_t handle_redirect(httpd_req_t *req) {
     return ESP_OK;
 }
 
+// Sends the JSON of a report formatter, the buffer is accounted to the HTTP heap tag
+static esp_err_t cp_send_json(httpd_req_t *req, size_t (*format)(char *buffer, size_t size)) {
+    const size_t size = 2048;
+#if CONFIG_STATIC_ALLOCATION
+    static char json[2048]; // Handlers run one at a time on the server task
+#else
+    char *json = heap_tag_malloc(HEAP_TAG_HTTP, size);
+    if (json == NULL) {
+        return httpd_resp_send_500(req);
+    }
+#endif
+    size_t length = format(json, size);
+    httpd_resp_set_type(req, "application/json");
+    esp_err_t err = httpd_resp_send(req, json, length);
+#if !CONFIG_STATIC_ALLOCATION
+    heap_tag_free(json);
+#endif
+    return err;
+}
+
+static esp_err_t handle_instrumentation_get(httpd_req_t *req) {
+    return cp_send_json(req, instr_format_json);
+}
+
+static esp_err_t handle_heap_get(httpd_req_t *req) {
+    return cp_send_json(req, heap_monitor_format_json);
+}
+
+static esp_err_t handle_probes_get(httpd_req_t *req) {
+    return cp_send_json(req, ntc_format_json);
+}
+
+#if CONFIG_INSTR_ENABLE
+// Times the handler stored in user_ctx
+static esp_err_t handle_instrumented(httpd_req_t *req) {
+    esp_err_t (*handler)(httpd_req_t *req) = req->user_ctx;
+    INSTR_BEGIN(handler_start);
+    esp_err_t err = handler(req);
+    INSTR_END(INSTR_PATH_HTTP_HANDLER, handler_start);
+    return err;
+}
+#endif
+
+static void cp_register_uri_handler(httpd_uri_t *uri) {
+#if CONFIG_INSTR_ENABLE
+    uri->user_ctx = uri->handler;
+    uri->handler = handle_instrumented;
+#endif
+    httpd_register_uri_handler(http_server, uri);
+}
+
 void cp_start_http_server(void) {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     httpd_start(&http_server, &config);
@@ -121,14 +186,14 @@ void cp_start_http_server(void) {
         .method = HTTP_GET,
         .handler = handle_root_get,
     };
-    httpd_register_uri_handler(http_server, &root_uri);
+    cp_register_uri_handler(&root_uri);
 
     httpd_uri_t configure_uri = {
         .uri = "/configure",
         .method = HTTP_POST,
         .handler = handle_configure_post,
     };
-    httpd_register_uri_handler(http_server, &configure_uri);
+    cp_register_uri_handler(&configure_uri);
 
     // Handle captive portal detection URIs
     httpd_uri_t captive_check_uri = {
@@ -136,14 +201,35 @@ void cp_start_http_server(void) {
         .method = HTTP_GET,
         .handler = handle_captive_check,
     };
-    httpd_register_uri_handler(http_server, &captive_check_uri);
+    cp_register_uri_handler(&captive_check_uri);
 
     httpd_uri_t apple_captive_check_uri = {
         .uri = "/hotspot-detect.html", // iOS captive portal check
         .method = HTTP_GET,
         .handler = handle_captive_check,
     };
-    httpd_register_uri_handler(http_server, &apple_captive_check_uri);
+    cp_register_uri_handler(&apple_captive_check_uri);
+
+    httpd_uri_t instrumentation_uri = {
+        .uri = "/api/instrumentation",
+        .method = HTTP_GET,
+        .handler = handle_instrumentation_get,
+    };
+    cp_register_uri_handler(&instrumentation_uri);
+
+    httpd_uri_t heap_uri = {
+        .uri = "/api/heap",
+        .method = HTTP_GET,
+        .handler = handle_heap_get,
+    };
+    cp_register_uri_handler(&heap_uri);
+
+    httpd_uri_t probes_uri = {
+        .uri = "/api/probes",
+        .method = HTTP_GET,
+        .handler = handle_probes_get,
+    };
+    cp_register_uri_handler(&probes_uri);
 
     // Handle wildcard URI for redirection
     httpd_uri_t wildcard_uri = {
@@ -151,7 +237,7 @@ void cp_start_http_server(void) {
         .method = HTTP_GET,
         .handler = handle_redirect,
     };
-    httpd_register_uri_handler(http_server, &wildcard_uri);
+    cp_register_uri_handler(&wildcard_uri);
 }
 void cp_stop_http_server(void) {
     if (http_server) {
@@ -12,4 +12,8 @@ void cp_start_http_server(void);
 void cp_stop_http_server(void);
 void cp_start_dns_server(void);
 
+// Turn the DNS query in packet into an answer pointing to the AP address.
+// Returns the response length, or -1 if the query is malformed or does not fit.
+int cp_dns_build_response(char *packet, int query_len, size_t packet_size);
+
 #endif /* CAPTIVE_PORTAL_H */
\ No newline at end of file
@@ -0,0 +1,500 @@
+#include "cli.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "driver/uart.h"
+#include "driver/uart_vfs.h"
+#include "lwip/sockets.h"
+#include "ntc_adc.h"
+#include "alarm_manager.h"
+#include "history_manager.h"
+#include "config_manager.h"
+#include "state_manager.h"
+#include "nvs_manager.h"
+#include "lcd.h"
+#include "instrumentation.h"
+#include "heap_monitor.h"
+#include "adc_stream.h"
+#include "task_config.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+static const char *TAG = "cli";
+
+#define CLI_PROMPT "ntc> "
+
+// A console connection: the UART or the TCP client
+typedef struct {
+    int fd;                     // Read side, -1 while closed
+    FILE *out;                  // Where commands print to
+    bool echo;                  // Terminal expects the characters back (UART)
+    bool read_only;             // Commands changing the configuration are refused (TCP)
+    char line[CLI_LINE_LENGTH];
+    size_t length;
+} cli_session_t;
+
+static cli_session_t uart_session = { .fd = -1 };
+static cli_session_t tcp_session = { .fd = -1 };
+static int listen_fd = -1;
+
+// Stream of the command being run, commands run one at a time on the console task
+static FILE *cli_out = NULL;
+static bool cli_read_only = false; // Session of the command being run is read-only
+
+// Commands that change the configuration call this first
+static bool cli_writable(void) {
+    if (cli_read_only) {
+        fprintf(cli_out, "read-only over TCP, use the UART console\n");
+    }
+    return !cli_read_only;
+}
+
+static int cli_cmd_help(int argc, char **argv);
+
+static int cli_cmd_channels(int argc, char **argv) {
+    fprintf(cli_out, "%-4s %-3s %-16s %5s %8s %7s %-10s %s\n", "ch", "on", "probe", "raw", "temp_c", "offset",
+            "fault", "alarms");
+    for (int i = 0; i < ntc_get_channel_count(); i++) {
+        const ntc_channel_config_t *config = ntc_get_channel_config(i);
+        float temperature = ntc_get_channel_temperature(i);
+        char value[12];
+        if (isnan(temperature)) {
+            snprintf(value, sizeof(value), "-");
+        } else {
+            snprintf(value, sizeof(value), "%.2f", temperature);
+        }
+        int32_t offset = ntc_get_channel_offset(i);
+        fprintf(cli_out, "%-4s %-3s %-16s %5d %8s %7.2f %-10s 0x%02lx\n", config->name,
+                ntc_channel_is_enabled(i) ? "y" : "n", ntc_sensor_get_probe_name(config->probe_type),
+                ntc_get_channel_data(i), value, offset / 100.0, ntc_sensor_get_fault_name(ntc_get_channel_fault(i)),
+                (unsigned long)alarm_get_active_flags(i));
+    }
+    return 0;
+}
+
+static int cli_cmd_acq(int argc, char **argv) {
+    ntc_acq_config_t config = ntc_adc_get_acquisition_config();
+    ntc_adc_stats_t stats = ntc_adc_get_stats();
+    running_state_t state;
+    state_get_snapshot(&state);
+
+    if (config.mode == NTC_ACQ_MODE_BURST) {
+        fprintf(cli_out, "mode:        burst, %lu samples every %lu ms\n", (unsigned long)config.burst_samples,
+                (unsigned long)config.burst_interval_ms);
+    } else {
+        fprintf(cli_out, "mode:        continuous\n");
+    }
+    fprintf(cli_out, "rate:        %lu.%02lu Hz\n", (unsigned long)(state.sample_rate_centi_hz / 100),
+            (unsigned long)(state.sample_rate_centi_hz % 100));
+    fprintf(cli_out, "frames:      %lu converted, %lu processed, %lu pool overflows\n",
+            (unsigned long)stats.frames_converted, (unsigned long)stats.frames_processed,
+            (unsigned long)stats.pool_overflows);
+    fprintf(cli_out, "samples:     %lu\n", (unsigned long)stats.samples_processed);
+    fprintf(cli_out, "publishes:   %lu\n", (unsigned long)stats.publish_count);
+    for (int fault = NTC_FAULT_NONE + 1; fault < NTC_FAULT_MAX; fault++) {
+        fprintf(cli_out, "%-12s %lu\n", ntc_sensor_get_fault_name(fault), (unsigned long)stats.faults_detected[fault]);
+    }
+    fprintf(cli_out, "faulted:     0x%02lx\n", (unsigned long)state.fault_channel_mask);
+    fprintf(cli_out, "alarms:      %lu on 0x%02lx\n", (unsigned long)state.alarm_count,
+            (unsigned long)state.alarm_channel_mask);
+    return 0;
+}
+
+static int cli_cmd_history(int argc, char **argv) {
+    fprintf(cli_out, "points:      %lu closed, %d kept, one per %d s\n", (unsigned long)history_get_point_count(),
+            HISTORY_DEPTH, HISTORY_PERIOD_MS / 1000);
+    for (int i = 0; i < ntc_get_channel_count(); i++) {
+        int16_t low = 0;
+        int16_t high = 0;
+        int valid = history_get_range(i, &low, &high);
+        if (valid == 0) {
+            fprintf(cli_out, "%-4s no valid points\n", ntc_get_channel_config(i)->name);
+            continue;
+        }
+        fprintf(cli_out, "%-4s %4d valid, %.1f .. %.1f C\n", ntc_get_channel_config(i)->name, valid, low / 10.0,
+                high / 10.0);
+    }
+    return 0;
+}
+
+static int cli_cmd_filter(int argc, char **argv) {
+    ntc_adc_stats_t stats = ntc_adc_get_stats();
+    fprintf(cli_out, "publish interval %.1f ms, stuck after %d unchanged publishes\n",
+            stats.publish_interval_us / 1000.0, CONFIG_NTC_FAULT_STUCK_PUBLISHES);
+    fprintf(cli_out, "%-4s %7s %5s %5s %5s %6s %5s\n", "ch", "samples", "raw", "min", "max", "spread", "stuck");
+    for (int i = 0; i < ntc_get_channel_count(); i++) {
+        ntc_filter_state_t filter;
+        ntc_get_channel_filter(i, &filter);
+        if (filter.samples == 0) {
+            // Disabled, polled or not published yet
+            fprintf(cli_out, "%-4s %7s %5d\n", ntc_get_channel_config(i)->name, "-", ntc_get_channel_data(i));
+            continue;
+        }
+        fprintf(cli_out, "%-4s %7lu %5d %5u %5u %6u %5lu\n", ntc_get_channel_config(i)->name,
+                (unsigned long)filter.samples, ntc_get_channel_data(i), filter.raw_min, filter.raw_max,
+                filter.raw_max - filter.raw_min, (unsigned long)filter.stuck_publishes);
+    }
+    return 0;
+}
+
+static int cli_cmd_tasks(int argc, char **argv) {
+    instr_print_report(cli_out);
+    return 0;
+}
+
+static int cli_cmd_heap(int argc, char **argv) {
+    heap_monitor_sample();
+    heap_monitor_print_report(cli_out);
+    return 0;
+}
+
+static int cli_cmd_i2c(int argc, char **argv) {
+    for (int d = 0; d < lcd_get_display_count(); d++) {
+        lcd_bus_stats_t bus;
+        if (lcd_get_bus_stats(d, &bus) != ESP_OK) {
+            continue;
+        }
+        fprintf(cli_out, "display %d:   0x%02x at %lu Hz, %lu recoveries\n", d, bus.address,
+                (unsigned long)bus.speed_hz, (unsigned long)bus.recoveries);
+        for (int i = 0; i < LCD_I2C_SPEED_COUNT; i++) {
+            fprintf(cli_out, "  %6lu Hz:  %lu transfers, %lu errors\n", (unsigned long)bus.speeds[i].speed_hz,
+                    (unsigned long)bus.speeds[i].transactions, (unsigned long)bus.speeds[i].errors);
+        }
+    }
+    return 0;
+}
+
+static int cli_cmd_config(int argc, char **argv) {
+    device_config_t config;
+    config_get(&config);
+    running_config_t *running = get_running_config();
+
+    fprintf(cli_out, "generation:  %lu\n", (unsigned long)config_get_generation());
+    fprintf(cli_out, "station:     \"%s\", password %s\n", running->sta_ssid, running->sta_pass[0] ? "set" : "empty");
+    fprintf(cli_out, "access point: \"%s\" on channel %ld, password %s\n", running->ap_ssid,
+            (long)running->ap_channel, running->ap_pass[0] ? "set" : "empty");
+    fprintf(cli_out, "channels:    0x%02lx\n", (unsigned long)config.channel_enable_mask);
+    if (config.acq_mode == NTC_ACQ_MODE_BURST) {
+        fprintf(cli_out, "sampling:    burst every %lu ms\n", (unsigned long)config.burst_interval_ms);
+    } else {
+        fprintf(cli_out, "sampling:    continuous\n");
+    }
+    fprintf(cli_out, "backlight:   %lu s\n", (unsigned long)config.backlight_timeout_s);
+    for (int i = 0; i < ntc_get_channel_count(); i++) {
+        const alarm_channel_config_t *alarm = &config.alarms[i];
+        fprintf(cli_out, "%-4s offset %.2f, alarm %s %.2f .. %.2f C, hysteresis %.2f, %lu ms\n",
+                ntc_get_channel_config(i)->name, config.offset_centi[i] / 100.0, alarm->enabled ? "on" : "off",
+                alarm->low_centi / 100.0, alarm->high_centi / 100.0, alarm->hysteresis_centi / 100.0,
+                (unsigned long)alarm->min_duration_ms);
+    }
+    return 0;
+}
+
+static int cli_cmd_rate(int argc, char **argv) {
+    // Same setting as the sample period of the menu: 0 samples continuously, else bursts this far apart
+    char *end = NULL;
+    unsigned long interval_ms = argc == 2 ? strtoul(argv[1], &end, 10) : 0;
+    if (argc != 2 || end == argv[1] || *end != '\0') {
+        fprintf(cli_out, "usage: rate <burst interval ms, 0 for continuous>\n");
+        return 1;
+    }
+    if (!cli_writable()) {
+        return 1;
+    }
+
+    config_transaction_t transaction;
+    config_begin(&transaction);
+    transaction.config.acq_mode = interval_ms == 0 ? NTC_ACQ_MODE_CONTINUOUS : NTC_ACQ_MODE_BURST;
+    if (interval_ms > 0) {
+        transaction.config.burst_interval_ms = interval_ms;
+    }
+    esp_err_t err = config_commit(&transaction);
+    if (err != ESP_OK) {
+        config_abort(&transaction);
+        fprintf(cli_out, "rejected: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    return 0;
+}
+
+static int cli_cmd_name(int argc, char **argv) {
+    // Probes are numbered from 1 like the Kconfig options, the name is stored in NVS right away
+    char *end = NULL;
+    long probe = argc == 3 ? strtol(argv[1], &end, 10) : 0;
+    if (argc != 3 || end == argv[1] || *end != '\0') {
+        fprintf(cli_out, "usage: name <probe 1-%d> <name>\n", ntc_get_channel_count());
+        return 1;
+    }
+    if (!cli_writable()) {
+        return 1;
+    }
+
+    esp_err_t err = probe >= 1 && probe <= ntc_get_channel_count() ? ntc_set_channel_name(probe - 1, argv[2])
+                                                                    : ESP_ERR_INVALID_ARG;
+    if (err != ESP_OK) {
+        fprintf(cli_out, "rejected: %s\n", esp_err_to_name(err));
+        return 1;
+    }
+    return 0;
+}
+
+static int cli_cmd_stream(int argc, char **argv) {
+    if (argc == 2) {
+        if (!cli_writable()) {
+            return 1;
+        }
+        adc_stream_mode_t mode = ADC_STREAM_MODE_MAX;
+        for (adc_stream_mode_t i = 0; i < ADC_STREAM_MODE_MAX; i++) {
+            if (strcmp(argv[1], adc_stream_get_mode_name(i)) == 0) {
+                mode = i;
+            }
+        }
+        esp_err_t err = adc_stream_set_mode(mode);
+        if (err != ESP_OK) {
+            fprintf(cli_out, "rejected: %s\n", esp_err_to_name(err));
+            return 1;
+        }
+    } else if (argc != 1) {
+        fprintf(cli_out, "usage: stream [off|raw|decimated]\n");
+        return 1;
+    }
+
+    adc_stream_stats_t stats = adc_stream_get_stats();
+    fprintf(cli_out, "mode %s, %s\n", adc_stream_get_mode_name(stats.mode),
+            stats.sink_ready ? "sink ready" : "no sink");
+    fprintf(cli_out, "records %lu, dropped %lu, sent %lu bytes, ring peak %lu bytes, connections %lu\n",
+            (unsigned long)stats.records, (unsigned long)stats.dropped, (unsigned long)stats.bytes_sent,
+            (unsigned long)stats.ring_peak, (unsigned long)stats.connections);
+    return 0;
+}
+
+static int cli_cmd_redraw(int argc, char **argv) {
+    lcd_invalidate();
+    lcd_refresh();
+    return 0;
+}
+
+static const esp_console_cmd_t cli_commands[] = {
+    { .command = "help", .help = "List the commands", .func = cli_cmd_help },
+    { .command = "channels", .help = "Raw values, temperatures, faults and alarms of the probes", .func = cli_cmd_channels },
+    { .command = "acq", .help = "Acquisition mode, rate and DMA frame counters", .func = cli_cmd_acq },
+    { .command = "history", .help = "History points and the range of each probe", .func = cli_cmd_history },
+    { .command = "filter", .help = "Samples averaged, their spread and stuck counters of the probes", .func = cli_cmd_filter },
+    { .command = "tasks", .help = "Latency histograms, task stacks and core load", .func = cli_cmd_tasks },
+    { .command = "heap", .help = "Heap capacity, fragmentation and tagged allocations", .func = cli_cmd_heap },
+    { .command = "i2c", .help = "Display bus speed, transfers and errors", .func = cli_cmd_i2c },
+    { .command = "config", .help = "Configuration stored in NVS", .func = cli_cmd_config },
+    { .command = "rate", .help = "Set the sample period, 0 samples continuously", .hint = "<ms>", .func = cli_cmd_rate },
+    { .command = "name", .help = "Rename a probe, up to two characters", .hint = "<n> <name>", .func = cli_cmd_name },
+    { .command = "stream", .help = "Raw ADC streaming mode and counters", .hint = "[mode]", .func = cli_cmd_stream },
+    { .command = "redraw", .help = "Send the whole screen to the displays again", .func = cli_cmd_redraw },
+};
+
+static int cli_cmd_help(int argc, char **argv) {
+    for (size_t i = 0; i < sizeof(cli_commands) / sizeof(cli_commands[0]); i++) {
+        fprintf(cli_out, "%-9s %-10s %s\n", cli_commands[i].command, cli_commands[i].hint ? cli_commands[i].hint : "",
+                cli_commands[i].help);
+    }
+    return 0;
+}
+
+int cli_run(const char *line, FILE *out) {
+    int ret = -1;
+    cli_out = out;
+    esp_err_t err = esp_console_run(line, &ret);
+    if (err == ESP_ERR_NOT_FOUND) {
+        fprintf(out, "unknown command, try help\n");
+    } else if (err != ESP_OK) {
+        ret = err == ESP_ERR_INVALID_ARG ? 0 : -1; // An empty line is not an error
+    }
+    fflush(out);
+    cli_out = stdout;
+    return ret;
+}
+
+static void cli_close(cli_session_t *session) {
+    if (session == &tcp_session && session->out != NULL) {
+        fclose(session->out); // Closes the socket too
+    }
+    session->fd = -1;
+    session->out = NULL;
+    session->length = 0;
+}
+
+static void cli_read(cli_session_t *session) {
+    char chunk[32];
+    ssize_t count = read(session->fd, chunk, sizeof(chunk));
+    if (count <= 0) {
+        ESP_LOGI(TAG, "%s session closed", session == &tcp_session ? "TCP" : "UART");
+        cli_close(session);
+        return;
+    }
+
+    for (ssize_t i = 0; i < count; i++) {
+        char c = chunk[i];
+        if (c == '\r' || c == '\n') {
+            if (session->echo) {
+                fputs("\n", session->out);
+            }
+            if (session->length > 0) {
+                session->line[session->length] = '\0';
+                session->length = 0;
+                cli_read_only = session->read_only;
+                cli_run(session->line, session->out);
+                cli_read_only = false;
+                fputs(CLI_PROMPT, session->out);
+                if (ferror(session->out)) {
+                    break; // Do not run the rest of the input into a failed stream
+                }
+            }
+        } else if ((c == '\b' || c == 0x7f) && session->length > 0) {
+            session->length--;
+            if (session->echo) {
+                fputs("\b \b", session->out);
+            }
+        } else if (c >= ' ' && c < 0x7f && session->length < CLI_LINE_LENGTH - 1) {
+            session->line[session->length++] = c;
+            if (session->echo) {
+                fputc(c, session->out);
+            }
+        }
+    }
+    if ((fflush(session->out) != 0 || ferror(session->out)) && session == &tcp_session) {
+        // The client stopped reading and the send timeout expired
+        ESP_LOGW(TAG, "TCP client not reading, closing the session");
+        cli_close(session);
+    }
+}
+
+static void cli_accept(void) {
+    int client = accept(listen_fd, NULL, NULL);
+    if (client < 0) {
+        return;
+    }
+    // One client at a time, and not on the access point the portal opens to anyone
+    const char *refusal = tcp_session.fd >= 0 ? "busy\n" : state_get_wifi_ap_mode() ? "not in AP mode\n" : NULL;
+    FILE *out = refusal == NULL ? fdopen(client, "w") : NULL;
+    if (out == NULL) {
+        if (refusal != NULL) {
+            send(client, refusal, strlen(refusal), 0);
+        }
+        close(client);
+        return;
+    }
+
+    // A client that stops reading must not block the console task, and the UART console with it
+    struct timeval send_timeout = {
+        .tv_sec = CLI_TCP_SEND_TIMEOUT_MS / 1000,
+        .tv_usec = (CLI_TCP_SEND_TIMEOUT_MS % 1000) * 1000,
+    };
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
+    tcp_session.fd = client;
+    tcp_session.out = out;
+    tcp_session.echo = false;
+    tcp_session.read_only = true;
+    tcp_session.length = 0;
+    ESP_LOGI(TAG, "TCP session opened");
+    fputs("ntc console (read-only), try help\n" CLI_PROMPT, out);
+    fflush(out);
+}
+
+static void cli_task(void *pvParameter) {
+    if (uart_session.fd >= 0) {
+        fputs(CLI_PROMPT, uart_session.out);
+        fflush(uart_session.out);
+    }
+    while (1) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        int max_fd = -1;
+        const int fds[] = { uart_session.fd, listen_fd, tcp_session.fd };
+        for (size_t i = 0; i < sizeof(fds) / sizeof(fds[0]); i++) {
+            if (fds[i] >= 0) {
+                FD_SET(fds[i], &readable);
+                max_fd = fds[i] > max_fd ? fds[i] : max_fd;
+            }
+        }
+        if (max_fd < 0) {
+            break; // Nothing left to serve
+        }
+
+        if (select(max_fd + 1, &readable, NULL, NULL, NULL) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ESP_LOGE(TAG, "select failed: %d", errno);
+            break;
+        }
+        if (uart_session.fd >= 0 && FD_ISSET(uart_session.fd, &readable)) {
+            cli_read(&uart_session);
+        }
+        if (tcp_session.fd >= 0 && FD_ISSET(tcp_session.fd, &readable)) {
+            cli_read(&tcp_session);
+        }
+        if (listen_fd >= 0 && FD_ISSET(listen_fd, &readable)) {
+            cli_accept();
+        }
+    }
+    vTaskDelete(NULL);
+}
+
+#if CONFIG_CLI_TCP
+static int cli_listen(void) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Failed to create socket");
+        return -1;
+    }
+    int reuse = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address = {
+        .sin_family = AF_INET,
+        .sin_port = htons(CONFIG_CLI_TCP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(sock, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(sock, 1) < 0) {
+        ESP_LOGE(TAG, "Failed to listen on port %d", CONFIG_CLI_TCP_PORT);
+        close(sock);
+        return -1;
+    }
+    ESP_LOGI(TAG, "Console on TCP port %d", CONFIG_CLI_TCP_PORT);
+    return sock;
+}
+#endif
+
+void cli_initialize(void) {
+    esp_console_config_t console_config = ESP_CONSOLE_CONFIG_DEFAULT();
+    console_config.max_cmdline_length = CLI_LINE_LENGTH;
+    console_config.max_cmdline_args = 8;
+    ESP_ERROR_CHECK(esp_console_init(&console_config));
+    for (size_t i = 0; i < sizeof(cli_commands) / sizeof(cli_commands[0]); i++) {
+        ESP_ERROR_CHECK(esp_console_cmd_register(&cli_commands[i]));
+    }
+    cli_out = stdout;
+
+#if CONFIG_CLI_UART
+    // Blocking reads through the driver instead of polling the UART FIFO
+    ESP_ERROR_CHECK(uart_driver_install(CONFIG_ESP_CONSOLE_UART_NUM, 256, 0, 0, NULL, 0));
+    uart_vfs_dev_use_driver(CONFIG_ESP_CONSOLE_UART_NUM);
+    uart_session.fd = fileno(stdin);
+    uart_session.out = stdout;
+    uart_session.echo = true;
+    ESP_LOGI(TAG, "Console on UART%d", CONFIG_ESP_CONSOLE_UART_NUM);
+#endif
+#if CONFIG_CLI_TCP
+    listen_fd = cli_listen();
+#endif
+
+    if (uart_session.fd < 0 && listen_fd < 0) {
+        return;
+    }
+    task_create(TASK_ID_CLI, cli_task, NULL, NULL);
+}
@@ -0,0 +1,26 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <stdio.h>
+
+#define CLI_LINE_LENGTH CONFIG_CLI_LINE_LENGTH // Longest command line, longer input is cut
+#define CLI_TCP_SEND_TIMEOUT_MS 1000            // A TCP client not reading for this long is disconnected
+
+/**
+ * @brief Register the diagnostic commands and start serving the console on the UART and TCP.
+ *
+ * One task waits in select() on the UART, the listening socket and the connected client, so an
+ * idle console costs no CPU, and commands print straight to the session without buffering a
+ * report on the heap. Call once the modules the commands read from are initialized.
+ */
+void cli_initialize(void);
+
+/**
+ * @brief Run a command line as if it was typed into a console session.
+ * @param line Command line.
+ * @param out  Stream the command prints to.
+ * @return The return code of the command, or -1 if there is no such command.
+ */
+int cli_run(const char *line, FILE *out);
+
+#endif // CLI_H
@@ -0,0 +1,169 @@
+#include "config_manager.h"
+#include "nvs_manager.h"
+#include "power_manager.h"
+#include "task_config.h"
+#include "esp_log.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "config";
+
+// NVS layout of the configuration, a single blob so that a commit is stored at once
+typedef struct {
+    uint32_t version;
+    device_config_t config;
+} config_store_t;
+
+static SemaphoreHandle_t config_mutex = NULL;
+static volatile uint32_t config_generation = 0;
+
+// Keeps the first failure, every failed setting is logged, a negative channel index marks a global setting
+static void config_apply_result(esp_err_t *result, esp_err_t err, const char *setting, int channel_index) {
+    if (err == ESP_OK) {
+        return;
+    }
+    if (channel_index < 0) {
+        ESP_LOGE(TAG, "Cannot apply the %s: %s", setting, esp_err_to_name(err));
+    } else {
+        ESP_LOGE(TAG, "Cannot apply the %s of channel %d: %s", setting, channel_index, esp_err_to_name(err));
+    }
+    if (*result == ESP_OK) {
+        *result = err;
+    }
+}
+
+static esp_err_t config_apply(const device_config_t *config) {
+    // Only settings that differ are applied, enabling a channel or the backlight timeout have side effects
+    // Nothing is persisted here, the committed blob is the only stored copy
+    esp_err_t result = ESP_OK;
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        bool enabled = (config->channel_enable_mask & (1u << i)) != 0;
+        if (ntc_channel_is_enabled(i) != enabled) {
+            config_apply_result(&result, ntc_set_channel_enabled(i, enabled), "enable", i);
+        }
+        config_apply_result(&result, alarm_set_channel_config(i, &config->alarms[i]), "alarm rules", i);
+        config_apply_result(&result, ntc_set_channel_offset(i, config->offset_centi[i]), "offset", i);
+    }
+
+    ntc_acq_config_t acq_config = ntc_adc_get_acquisition_config();
+    if (acq_config.mode != config->acq_mode || acq_config.burst_interval_ms != config->burst_interval_ms) {
+        acq_config.mode = config->acq_mode;
+        acq_config.burst_interval_ms = config->burst_interval_ms;
+        config_apply_result(&result, ntc_adc_set_acquisition_config(&acq_config), "acquisition mode", -1);
+    }
+
+    if (power_get_backlight_timeout() != config->backlight_timeout_s) {
+        power_set_backlight_timeout(config->backlight_timeout_s);
+    }
+    return result;
+}
+
+void config_get(device_config_t *config) {
+    // Read back from the modules, so that changes made through their own API are not lost
+    memset(config, 0, sizeof(*config));
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        if (ntc_channel_is_enabled(i)) {
+            config->channel_enable_mask |= (1u << i);
+        }
+        alarm_get_channel_config(i, &config->alarms[i]);
+        config->offset_centi[i] = ntc_get_channel_offset(i);
+    }
+    ntc_acq_config_t acq_config = ntc_adc_get_acquisition_config();
+    config->acq_mode = acq_config.mode;
+    config->burst_interval_ms = acq_config.burst_interval_ms;
+    config->backlight_timeout_s = power_get_backlight_timeout();
+}
+
+esp_err_t config_validate(const device_config_t *config) {
+    if (config == NULL || (config->channel_enable_mask >> NTC_CHANNEL_COUNT) != 0 ||
+        config->acq_mode >= NTC_ACQ_MODE_MAX || config->burst_interval_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        if (!alarm_channel_config_valid(&config->alarms[i]) || abs(config->offset_centi[i]) > DEVICE_CONFIG_OFFSET_LIMIT_CENTI) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    return ESP_OK;
+}
+
+void config_begin(config_transaction_t *transaction) {
+    xSemaphoreTake(config_mutex, portMAX_DELAY);
+    config_get(&transaction->config);
+    transaction->generation = config_generation;
+    xSemaphoreGive(config_mutex);
+    transaction->open = true;
+}
+
+esp_err_t config_commit(config_transaction_t *transaction) {
+    if (transaction == NULL || !transaction->open) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = config_validate(&transaction->config);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    xSemaphoreTake(config_mutex, portMAX_DELAY);
+    if (transaction->generation != config_generation) {
+        // The draft was taken before another commit, applying it would silently undo that one
+        xSemaphoreGive(config_mutex);
+        transaction->open = false;
+        ESP_LOGW(TAG, "Commit rejected, configuration changed since the transaction started");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    config_store_t store = {
+        .version = DEVICE_CONFIG_VERSION,
+        .config = transaction->config,
+    };
+    err = store_blob(DEVICE_CONFIG_KEY, &store, sizeof(store));
+    if (err != ESP_OK) {
+        xSemaphoreGive(config_mutex);
+        ESP_LOGE(TAG, "Cannot store the configuration: %s", esp_err_to_name(err));
+        return err;
+    }
+    // The draft is stored, the generation moves on even if a setting could not be applied
+    err = config_apply(&transaction->config);
+    config_generation++;
+    xSemaphoreGive(config_mutex);
+
+    transaction->open = false;
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Configuration stored but not fully applied (generation %lu)", (unsigned long)config_generation);
+        return err;
+    }
+    ESP_LOGI(TAG, "Configuration committed (generation %lu)", (unsigned long)config_generation);
+    return ESP_OK;
+}
+
+void config_abort(config_transaction_t *transaction) {
+    if (transaction != NULL) {
+        transaction->open = false;
+    }
+}
+
+uint32_t config_get_generation(void) {
+    return config_generation;
+}
+
+void config_initialize(void) {
+    config_mutex = KERNEL_MUTEX_CREATE();
+
+    config_store_t store = { 0 };
+    esp_err_t err = read_blob(DEVICE_CONFIG_KEY, &store, sizeof(store));
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGI(TAG, "No stored configuration, using defaults");
+        return;
+    }
+    if (err != ESP_OK || store.version != DEVICE_CONFIG_VERSION || config_validate(&store.config) != ESP_OK) {
+        ESP_LOGW(TAG, "Stored configuration ignored (%s, version %lu)", esp_err_to_name(err), (unsigned long)store.version);
+        return;
+    }
+    if (config_apply(&store.config) != ESP_OK) {
+        ESP_LOGW(TAG, "Stored configuration partially applied");
+        return;
+    }
+    ESP_LOGI(TAG, "Stored configuration applied");
+}
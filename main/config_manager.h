@@ -0,0 +1,74 @@
+#ifndef CONFIG_MANAGER_H
+#define CONFIG_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "ntc_adc.h"
+#include "alarm_manager.h"
+
+#define DEVICE_CONFIG_VERSION 2            // Bumped when device_config_t changes, older blobs are ignored
+#define DEVICE_CONFIG_OFFSET_LIMIT_CENTI 2000 // Largest calibration offset accepted, 20 °C
+
+// Settings changed from the device: applied to the modules and persisted together
+typedef struct {
+    uint32_t channel_enable_mask;                    // Bit n enables probe n
+    alarm_channel_config_t alarms[NTC_MAX_CHANNELS];
+    int32_t offset_centi[NTC_MAX_CHANNELS];          // Calibration offsets in 0.01 °C
+    ntc_acq_mode_t acq_mode;
+    uint32_t burst_interval_ms;                      // Sample period in burst mode
+    uint32_t backlight_timeout_s;                    // 0 keeps the backlight on
+} device_config_t;
+
+// An edit of the configuration, nothing is applied before config_commit()
+typedef struct {
+    device_config_t config;                          // Draft, edited freely by the owner
+    uint32_t generation;                             // Commit the draft was taken from
+    bool open;
+} config_transaction_t;
+
+/**
+ * @brief Apply the stored configuration, call once the modules it configures are initialized.
+ */
+void config_initialize(void);
+
+/**
+ * @brief Get the configuration the modules are running with.
+ */
+void config_get(device_config_t *config);
+
+/**
+ * @brief Start a transaction with a draft of the running configuration.
+ */
+void config_begin(config_transaction_t *transaction);
+
+/**
+ * @brief Validate, persist and apply the draft, then close the transaction.
+ *
+ * The draft is stored as one NVS entry before anything is applied, a failed commit
+ * leaves both the stored and the running configuration unchanged.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the draft is invalid or the NVS error
+ *         (the transaction stays open for a retry), ESP_ERR_INVALID_STATE if the transaction
+ *         is closed or another commit happened since config_begin() (the transaction is closed),
+ *         or the error of a setting the modules rejected after the draft was stored (logged,
+ *         the transaction is closed).
+ */
+esp_err_t config_commit(config_transaction_t *transaction);
+
+/**
+ * @brief Drop the draft and close the transaction.
+ */
+void config_abort(config_transaction_t *transaction);
+
+/**
+ * @brief Check a configuration without applying it.
+ */
+esp_err_t config_validate(const device_config_t *config);
+
+/**
+ * @brief Get the number of successful commits since boot.
+ */
+uint32_t config_get_generation(void);
+
+#endif // CONFIG_MANAGER_H
@@ -0,0 +1,191 @@
+#include "display_driver.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const char *TAG = "display";
+
+static const uint32_t I2C_SPEED_LADDER_HZ[LCD_I2C_SPEED_COUNT] = LCD_I2C_SPEED_LADDER;
+
+static const display_driver_t *drivers[DISPLAY_TYPE_MAX] = {
+    [DISPLAY_TYPE_HD44780] = &display_hd44780_driver,
+    [DISPLAY_TYPE_SSD1306] = &display_ssd1306_driver,
+};
+
+// Fixed addresses of configured displays, never taken by probing
+static uint8_t reserved_addresses[128 / 8];
+
+// Addresses displays were found at, a display releases its address before probing again
+static uint8_t claimed_addresses[128 / 8];
+
+static bool address_is_reserved(uint16_t address) {
+    return address < 128 && (reserved_addresses[address / 8] & (1 << (address % 8)));
+}
+
+static bool address_is_claimed(uint16_t address) {
+    return address < 128 && (claimed_addresses[address / 8] & (1 << (address % 8)));
+}
+
+static void address_set_claimed(uint16_t address, bool claimed) {
+    if (address == 0 || address >= 128) {
+        return;
+    }
+    if (claimed) {
+        claimed_addresses[address / 8] |= 1 << (address % 8);
+    } else {
+        claimed_addresses[address / 8] &= ~(1 << (address % 8));
+    }
+}
+
+// Another display owns the address: it was found there, or it is the fixed address of another display
+static bool address_is_taken(const display_t *display, uint16_t address) {
+    return address_is_claimed(address) || (display->probe && address_is_reserved(address));
+}
+
+const display_driver_t *display_get_driver(display_type_t type) {
+    return type < DISPLAY_TYPE_MAX ? drivers[type] : NULL;
+}
+
+void display_setup(display_t *display, uint8_t index, display_type_t type, uint16_t address, bool probe,
+                   i2c_master_bus_handle_t bus) {
+    memset(display, 0, sizeof(*display));
+    display->index = index;
+    display->type = type;
+    display->preferred_address = address;
+    display->probe = probe;
+    display->bus = bus;
+    display->failed = true; // Connected by the first display_connect()
+
+    // Start at the highest speed of the ladder allowed by the configuration
+    while (display->speed_index + 1 < LCD_I2C_SPEED_COUNT && I2C_SPEED_LADDER_HZ[display->speed_index] > I2C_MASTER_FREQ_HZ) {
+        display->speed_index++;
+    }
+    for (int i = 0; i < LCD_I2C_SPEED_COUNT; i++) {
+        display->stats.speeds[i].speed_hz = I2C_SPEED_LADDER_HZ[i];
+    }
+    if (!probe && address < 128) {
+        reserved_addresses[address / 8] |= 1 << (address % 8);
+    }
+}
+
+static uint16_t display_probe_address(const display_t *display) {
+    // The preferred address first, then the PCF8574 (0x20-0x27) and PCF8574A (0x38-0x3F) ranges
+    if (!address_is_taken(display, display->preferred_address) &&
+        i2c_master_probe(display->bus, display->preferred_address, LCD_I2C_TIMEOUT_MS) == ESP_OK) {
+        return display->preferred_address;
+    }
+    if (!display->probe) {
+        return 0;
+    }
+    for (uint16_t address = 0x20; address <= 0x3F; address++) {
+        if (address == 0x28) {
+            address = 0x38;
+        }
+        if (address != display->preferred_address && !address_is_taken(display, address) &&
+            i2c_master_probe(display->bus, address, LCD_I2C_TIMEOUT_MS) == ESP_OK) {
+            return address;
+        }
+    }
+    return 0;
+}
+
+static esp_err_t display_attach(display_t *display) {
+    // Find the device and add it at the current speed, replacing the previous device
+    if (display->device != NULL) {
+        i2c_master_bus_rm_device(display->device);
+        display->device = NULL;
+    }
+    address_set_claimed(display->stats.address, false);
+
+    uint16_t address = display_probe_address(display);
+    display->stats.address = address;
+    display->stats.speed_hz = I2C_SPEED_LADDER_HZ[display->speed_index];
+    if (address == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    address_set_claimed(address, true);
+
+    i2c_device_config_t device_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = address,
+        .scl_speed_hz = I2C_SPEED_LADDER_HZ[display->speed_index],
+    };
+    return i2c_master_bus_add_device(display->bus, &device_config, &display->device);
+}
+
+static void display_schedule_retry(display_t *display) {
+    // Back off from LCD_RECONNECT_MIN_MS, doubling up to LCD_RECONNECT_MAX_MS
+    display->retry_delay_ms = display->retry_delay_ms == 0 ? LCD_RECONNECT_MIN_MS : display->retry_delay_ms * 2;
+    if (display->retry_delay_ms > LCD_RECONNECT_MAX_MS) {
+        display->retry_delay_ms = LCD_RECONNECT_MAX_MS;
+    }
+    display->retry_time_us = esp_timer_get_time() + (int64_t)display->retry_delay_ms * 1000;
+}
+
+esp_err_t display_connect(display_t *display) {
+    const display_driver_t *driver = display_get_driver(display->type);
+    if (driver == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (display->retry_delay_ms > 0 && esp_timer_get_time() < display->retry_time_us) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+
+    if (display->speed_errors >= CONFIG_LCD_I2C_FALLBACK_ERRORS && display->speed_index + 1 < LCD_I2C_SPEED_COUNT) {
+        display->speed_index++;
+        display->speed_errors = 0;
+        display->clean_transfers = 0;
+        ESP_LOGW(TAG, "%s %d: repeated I2C errors, falling back to %lu Hz", driver->name, display->index,
+                 (unsigned long)I2C_SPEED_LADDER_HZ[display->speed_index]);
+    }
+    if (display->connected_once) {
+        i2c_master_bus_reset(display->bus); // Release a slave holding SDA low
+    }
+
+    esp_err_t err = display_attach(display);
+    if (err != ESP_OK) {
+        display_schedule_retry(display);
+        return err;
+    }
+    display->failed = false;
+    err = driver->init(display);
+    if (err != ESP_OK || display->failed) {
+        display->failed = true;
+        display_schedule_retry(display);
+        return err != ESP_OK ? err : ESP_FAIL;
+    }
+    display->retry_delay_ms = 0;
+
+    if (display->connected_once) {
+        display->stats.recoveries++;
+        ESP_LOGI(TAG, "%s %d recovered at 0x%02x", driver->name, display->index, display->stats.address);
+    } else {
+        ESP_LOGI(TAG, "%s %d at 0x%02x, %lu Hz", driver->name, display->index, display->stats.address,
+                 (unsigned long)display->stats.speed_hz);
+    }
+    display->connected_once = true;
+    return ESP_OK;
+}
+
+esp_err_t display_transmit(display_t *display, const uint8_t *data, size_t size) {
+    if (display->failed || display->device == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t err = i2c_master_transmit(display->device, data, size, LCD_I2C_TIMEOUT_MS);
+    display->stats.speeds[display->speed_index].transactions++;
+    if (err == ESP_OK) {
+        if (display->speed_errors > 0 && ++display->clean_transfers >= LCD_I2C_ERROR_DECAY) {
+            display->speed_errors--;
+            display->clean_transfers = 0;
+        }
+    } else {
+        display->stats.speeds[display->speed_index].errors++;
+        display->speed_errors++;
+        display->clean_transfers = 0;
+        display->failed = true;
+        ESP_LOGW(TAG, "I2C transfer to 0x%02x failed at %lu Hz: %s", display->stats.address,
+                 (unsigned long)I2C_SPEED_LADDER_HZ[display->speed_index], esp_err_to_name(err));
+    }
+    return err;
+}
@@ -0,0 +1,107 @@
+#ifndef DISPLAY_DRIVER_H
+#define DISPLAY_DRIVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/i2c_master.h"
+#include "lcd.h"
+
+#define DISPLAY_MAX 3
+
+// Display types, all of them show the LCD_COLS x LCD_ROWS text buffer of lcd.c
+typedef enum {
+    DISPLAY_TYPE_HD44780 = 0,   // HD44780 character LCD behind a PCF8574 backpack
+    DISPLAY_TYPE_SSD1306,       // 128x64 OLED, characters drawn in double height
+    DISPLAY_TYPE_MAX
+} display_type_t;
+
+// A display on the shared I2C bus, the device handling (probing, speed fallback, error
+// accounting) is common to the drivers
+typedef struct {
+    uint8_t index;                   // Position in the display list, drivers keep their state per index
+    display_type_t type;
+    uint16_t preferred_address;      // Probed first
+    bool probe;                      // Scan the PCF8574/PCF8574A ranges if the preferred address does not answer
+    i2c_master_bus_handle_t bus;
+    i2c_master_dev_handle_t device;
+    uint8_t speed_index;             // Position in LCD_I2C_SPEED_LADDER
+    uint32_t speed_errors;           // Errors counting towards the next speed change, see LCD_I2C_ERROR_DECAY
+    uint32_t clean_transfers;        // Successful transfers since the last error or decay step
+    bool failed;                     // Not initialized or a transfer failed, cleared by display_connect()
+    bool connected_once;
+    uint32_t retry_delay_ms;         // Backoff after failed connects, 0 while connected
+    int64_t retry_time_us;           // No connect attempt before this time
+    lcd_bus_stats_t stats;
+} display_t;
+
+// Display driver. Called from the display task only, transfer errors are latched in display->failed
+// and the calls after a failure return without touching the bus.
+typedef struct {
+    const char *name;
+    // Initialize the controller, also after a bus recovery. The display is blank afterwards.
+    esp_err_t (*init)(display_t *display);
+    esp_err_t (*set_cursor)(display_t *display, uint8_t col, uint8_t row);
+    // Write characters at the cursor, codes 0-7 are the custom glyphs
+    esp_err_t (*write_run)(display_t *display, const char *text, size_t length);
+    esp_err_t (*define_glyph)(display_t *display, uint8_t slot, const uint8_t bitmap[LCD_GLYPH_ROWS]);
+    esp_err_t (*set_backlight)(display_t *display, bool on);
+    // Optional, send what the previous calls buffered
+    esp_err_t (*flush)(display_t *display);
+} display_driver_t;
+
+/**
+ * @brief Get the driver of a display type.
+ * @param type Display type.
+ * @return Driver, NULL for unknown types.
+ */
+const display_driver_t *display_get_driver(display_type_t type);
+
+/**
+ * @brief Set up a display entry, it is connected by the first display_connect().
+ *
+ * Addresses of displays that are not probed are reserved, the probing of other
+ * displays skips them, as well as the addresses other displays were found at.
+ *
+ * @param display Display entry.
+ * @param index Position in the display list.
+ * @param type Display type.
+ * @param address Preferred (or fixed) 7-bit address.
+ * @param probe Scan the PCF8574/PCF8574A ranges when the address does not answer.
+ * @param bus Shared I2C bus.
+ */
+void display_setup(display_t *display, uint8_t index, display_type_t type, uint16_t address, bool probe,
+                   i2c_master_bus_handle_t bus);
+
+/**
+ * @brief Connect a display that is not initialized or failed.
+ *
+ * Steps down the bus speed after LCD_I2C_FALLBACK_ERRORS errors, resets the bus
+ * after a failure, finds the device, adds it at the current speed and initializes
+ * the controller. After a failed attempt the next one waits LCD_RECONNECT_MIN_MS,
+ * doubling up to LCD_RECONNECT_MAX_MS.
+ *
+ * @param display Display entry.
+ * @return ESP_OK when the display is ready, it is blank and has no custom glyphs.
+ *         ESP_ERR_NOT_FINISHED while waiting for the next attempt.
+ */
+esp_err_t display_connect(display_t *display);
+
+/**
+ * @brief Write to a display, the error is counted at the current speed and latched.
+ *
+ * Every LCD_I2C_ERROR_DECAY successful transfers forgive one error, so only errors
+ * that keep occurring step the bus speed down.
+ *
+ * @param display Display entry.
+ * @param data Bytes to send.
+ * @param size Number of bytes.
+ * @return ESP_OK, the transfer error, or ESP_ERR_INVALID_STATE after an earlier failure.
+ */
+esp_err_t display_transmit(display_t *display, const uint8_t *data, size_t size);
+
+extern const display_driver_t display_hd44780_driver;
+extern const display_driver_t display_ssd1306_driver;
+
+#endif // DISPLAY_DRIVER_H
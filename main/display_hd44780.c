@@ -0,0 +1,108 @@
+// HD44780 character LCD behind a PCF8574 I2C backpack, 4-bit interface
+#include "display_driver.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const uint8_t COMMAND_8BIT_MODE = 0b00110000;
+static const uint8_t COMMAND_4BIT_MODE = 0b00100000;
+static const uint8_t INIT_COMMANDS[] = {
+    0b00101000, // Function set: 4-bit mode, 2 lines, 5x8 dots
+    0b00001100, // Display control: display on, cursor off, blink off
+    0b00000001, // Clear display
+    0b00000110, // Entry mode set: increment cursor, no shift
+    0b00000010, // Set cursor to home position
+    0b10000000  // Set cursor to first line
+};
+static const uint8_t ROW_OFFSETS[LCD_ROWS] = LCD_ROW_OFFSET;
+
+// Expander outputs are shared by the backlight and the data lines, kept per display
+static uint8_t backlight_bits[DISPLAY_MAX] = { [0 ... DISPLAY_MAX - 1] = LCD_BACKLIGHT };
+
+static esp_err_t hd44780_send_with_toggle(display_t *display, uint8_t data) {
+    // Pulse the enable bit, one byte on the bus is longer than the minimum pulse width
+    uint8_t pulse[2] = { data | LCD_ENABLE, data & ~LCD_ENABLE };
+    return display_transmit(display, pulse, sizeof(pulse));
+}
+
+// Both nibbles of a byte, each latched by a pulse of the enable bit
+static size_t hd44780_encode(uint8_t *out, uint8_t data, uint8_t rs, uint8_t backlight) {
+    uint8_t high = (data & 0xF0) | rs | backlight | LCD_RW_WRITE;
+    uint8_t low = ((data << 4) & 0xF0) | rs | backlight | LCD_RW_WRITE;
+    out[0] = high | LCD_ENABLE;
+    out[1] = high;
+    out[2] = low | LCD_ENABLE;
+    out[3] = low;
+    return 4;
+}
+
+static esp_err_t hd44780_send_byte(display_t *display, uint8_t data, uint8_t rs) {
+    uint8_t pulses[4];
+    hd44780_encode(pulses, data, rs, backlight_bits[display->index]);
+    return display_transmit(display, pulses, sizeof(pulses));
+}
+
+static esp_err_t hd44780_init(display_t *display) {
+    // Power-on initialization by instruction, also resynchronizes the 4-bit interface after a bus recovery
+    uint8_t command = backlight_bits[display->index] | LCD_ENABLE_OFF | LCD_RW_WRITE | LCD_RS_CMD;
+    hd44780_send_with_toggle(display, command);
+    hd44780_send_with_toggle(display, COMMAND_8BIT_MODE | command);
+    vTaskDelay(pdMS_TO_TICKS(5)); // Over 4.1 ms after the first function set
+    hd44780_send_with_toggle(display, COMMAND_8BIT_MODE | command);
+    vTaskDelay(pdMS_TO_TICKS(1));
+    hd44780_send_with_toggle(display, COMMAND_8BIT_MODE | command);
+    hd44780_send_with_toggle(display, COMMAND_4BIT_MODE | command);
+
+    for (uint8_t i = 0; i < sizeof(INIT_COMMANDS); i++) {
+        hd44780_send_byte(display, INIT_COMMANDS[i], LCD_RS_CMD);
+        vTaskDelay(pdMS_TO_TICKS(2)); // Clear and home take 1.52 ms
+    }
+    return display->failed ? ESP_FAIL : ESP_OK;
+}
+
+static esp_err_t hd44780_set_cursor(display_t *display, uint8_t col, uint8_t row) {
+    if (col >= LCD_COLS || row >= LCD_ROWS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return hd44780_send_byte(display, 0x80 | (col + ROW_OFFSETS[row]), LCD_RS_CMD);
+}
+
+static esp_err_t hd44780_write_run(display_t *display, const char *text, size_t length) {
+    // The whole run in one transfer, 4 expander writes per character
+    uint8_t pulses[LCD_COLS * 4];
+    size_t size = 0;
+    for (size_t i = 0; i < length; i++) {
+        size += hd44780_encode(pulses + size, text[i], LCD_RS_DATA, backlight_bits[display->index]);
+        if (size == sizeof(pulses) || i + 1 == length) {
+            esp_err_t err = display_transmit(display, pulses, size);
+            if (err != ESP_OK) {
+                return err;
+            }
+            size = 0;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t hd44780_define_glyph(display_t *display, uint8_t slot, const uint8_t bitmap[LCD_GLYPH_ROWS]) {
+    // Set the CGRAM address and write the pixel rows, the next set_cursor() returns to DDRAM
+    uint8_t pulses[(1 + LCD_GLYPH_ROWS) * 4];
+    size_t size = hd44780_encode(pulses, 0x40 | (slot * LCD_GLYPH_ROWS), LCD_RS_CMD, backlight_bits[display->index]);
+    for (uint8_t row = 0; row < LCD_GLYPH_ROWS; row++) {
+        size += hd44780_encode(pulses + size, bitmap[row] & 0x1F, LCD_RS_DATA, backlight_bits[display->index]);
+    }
+    return display_transmit(display, pulses, size);
+}
+
+static esp_err_t hd44780_set_backlight(display_t *display, bool on) {
+    backlight_bits[display->index] = on ? LCD_BACKLIGHT : 0;
+    return display_transmit(display, &backlight_bits[display->index], 1);
+}
+
+const display_driver_t display_hd44780_driver = {
+    .name = "HD44780",
+    .init = hd44780_init,
+    .set_cursor = hd44780_set_cursor,
+    .write_run = hd44780_write_run,
+    .define_glyph = hd44780_define_glyph,
+    .set_backlight = hd44780_set_backlight,
+};
@@ -0,0 +1,186 @@
+// SSD1306 128x64 OLED, the text grid in 6x16 cells: 5x8 characters drawn in double height
+#include "display_driver.h"
+#include <string.h>
+
+#define SSD1306_WIDTH 128
+#define SSD1306_CELL_WIDTH 6 // 5 pixel columns and a blank one
+#define SSD1306_LEFT_MARGIN ((SSD1306_WIDTH - LCD_COLS * SSD1306_CELL_WIDTH) / 2)
+#define SSD1306_CONTROL_COMMANDS 0x00
+#define SSD1306_CONTROL_DATA 0x40
+
+static const uint8_t INIT_COMMANDS[] = {
+    SSD1306_CONTROL_COMMANDS,
+    0xAE,       // Display off
+    0xD5, 0x80, // Clock divide ratio and oscillator frequency
+    0xA8, 0x3F, // Multiplex ratio, 64 lines
+    0xD3, 0x00, // No display offset
+    0x40,       // Start line 0
+    0x8D, 0x14, // Charge pump on
+    0x20, 0x00, // Horizontal addressing mode
+    0xA1,       // Segment remap, column 127 is SEG0
+    0xC8,       // COM scan from COM63 to COM0
+    0xDA, 0x12, // Alternative COM pin configuration
+    0x81, 0xCF, // Contrast
+    0xD9, 0xF1, // Pre-charge period
+    0xDB, 0x40, // VCOMH deselect level
+    0xA4,       // Output follows RAM
+    0xA6,       // Normal, not inverted
+    0xAF,       // Display on
+};
+
+// 5x7 font of the printable ASCII range, one byte per column, bit 0 at the top
+static const uint8_t FONT_5X7[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00}, // ' ' ! "
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, // # $ %
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00}, // & ' (
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08}, // ) * +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00}, // , - .
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, // / 0 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10}, // 2 3 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03}, // 5 6 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00}, // 8 9 :
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, // ; < =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E}, // > ? @
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22}, // A B C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x01, 0x01}, // D E F
+    {0x3E, 0x41, 0x41, 0x51, 0x32}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, // G H I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40}, // J K L
+    {0x7F, 0x02, 0x04, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E}, // M N O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46}, // P Q R
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, // S T U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x7F, 0x20, 0x18, 0x20, 0x7F}, {0x63, 0x14, 0x08, 0x14, 0x63}, // V W X
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x00, 0x7F, 0x41, 0x41}, // Y Z [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x41, 0x41, 0x7F, 0x00, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04}, // \ ] ^
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, // _ ` a
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F}, // b c d
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x08, 0x14, 0x54, 0x54, 0x3C}, // e f g
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00}, // h i j
+    {0x00, 0x7F, 0x10, 0x28, 0x44}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78}, // k l m
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08}, // n o p
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20}, // q r s
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C}, // t u v
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C}, // w x y
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00}, // z { |
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x10, 0x08, 0x08, 0x10, 0x08},                                 // } ~
+};
+
+// Cursor and custom glyphs (converted to font columns) per display
+typedef struct {
+    uint8_t col;
+    uint8_t row;
+    uint8_t glyphs[LCD_GLYPH_SLOTS][5];
+} ssd1306_state_t;
+
+static ssd1306_state_t states[DISPLAY_MAX];
+
+static esp_err_t ssd1306_command(display_t *display, const uint8_t *commands, size_t size) {
+    uint8_t buffer[8] = { SSD1306_CONTROL_COMMANDS };
+    memcpy(buffer + 1, commands, size);
+    return display_transmit(display, buffer, size + 1);
+}
+
+static const uint8_t *ssd1306_columns(const ssd1306_state_t *state, char c) {
+    uint8_t code = (uint8_t)c;
+    if (code < LCD_GLYPH_SLOTS) {
+        return state->glyphs[code];
+    }
+    if (code < 0x20 || code > 0x7E) {
+        code = '?';
+    }
+    return FONT_5X7[code - 0x20];
+}
+
+// Stretch a font column to 16 pixels, each pixel row doubled
+static uint16_t ssd1306_double(uint8_t column) {
+    uint16_t doubled = 0;
+    for (int bit = 0; bit < 8; bit++) {
+        if (column & (1 << bit)) {
+            doubled |= 3 << (bit * 2);
+        }
+    }
+    return doubled;
+}
+
+static esp_err_t ssd1306_clear(display_t *display) {
+    // Whole RAM, 8 pages of 128 columns, one page per transfer
+    static const uint8_t window[] = { 0x21, 0, SSD1306_WIDTH - 1, 0x22, 0, 7 };
+    uint8_t page[1 + SSD1306_WIDTH] = { SSD1306_CONTROL_DATA };
+    ssd1306_command(display, window, sizeof(window));
+    for (int i = 0; i < 8; i++) {
+        display_transmit(display, page, sizeof(page));
+    }
+    return display->failed ? ESP_FAIL : ESP_OK;
+}
+
+static esp_err_t ssd1306_init(display_t *display) {
+    memset(&states[display->index], 0, sizeof(states[display->index]));
+    display_transmit(display, INIT_COMMANDS, sizeof(INIT_COMMANDS));
+    return ssd1306_clear(display);
+}
+
+static esp_err_t ssd1306_set_cursor(display_t *display, uint8_t col, uint8_t row) {
+    if (col >= LCD_COLS || row >= LCD_ROWS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    states[display->index].col = col;
+    states[display->index].row = row;
+    return ESP_OK;
+}
+
+static esp_err_t ssd1306_write_run(display_t *display, const char *text, size_t length) {
+    // Column window over the cells, filled page by page: top halves, then bottom halves
+    ssd1306_state_t *state = &states[display->index];
+    if (length > LCD_COLS - state->col) {
+        length = LCD_COLS - state->col;
+    }
+    uint8_t first_column = SSD1306_LEFT_MARGIN + state->col * SSD1306_CELL_WIDTH;
+    uint8_t window[] = {
+        0x21, first_column, first_column + length * SSD1306_CELL_WIDTH - 1,
+        0x22, state->row * 2, state->row * 2 + 1,
+    };
+    uint8_t data[1 + LCD_COLS * SSD1306_CELL_WIDTH * 2] = { SSD1306_CONTROL_DATA };
+    size_t page_size = length * SSD1306_CELL_WIDTH;
+
+    for (size_t i = 0; i < length; i++) {
+        const uint8_t *columns = ssd1306_columns(state, text[i]);
+        for (int x = 0; x < SSD1306_CELL_WIDTH; x++) {
+            uint16_t doubled = x < 5 ? ssd1306_double(columns[x]) : 0;
+            data[1 + i * SSD1306_CELL_WIDTH + x] = doubled & 0xFF;
+            data[1 + page_size + i * SSD1306_CELL_WIDTH + x] = doubled >> 8;
+        }
+    }
+
+    ssd1306_command(display, window, sizeof(window));
+    esp_err_t err = display_transmit(display, data, 1 + page_size * 2);
+    state->col += length;
+    return err;
+}
+
+static esp_err_t ssd1306_define_glyph(display_t *display, uint8_t slot, const uint8_t bitmap[LCD_GLYPH_ROWS]) {
+    // Convert the HD44780 pixel rows (bit 4 at the left) to font columns, shown from the next write
+    uint8_t *columns = states[display->index].glyphs[slot];
+    for (int x = 0; x < 5; x++) {
+        columns[x] = 0;
+        for (int y = 0; y < LCD_GLYPH_ROWS; y++) {
+            if (bitmap[y] & (0x10 >> x)) {
+                columns[x] |= 1 << y;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t ssd1306_set_backlight(display_t *display, bool on) {
+    // No backlight, the panel is switched off instead
+    uint8_t command = on ? 0xAF : 0xAE;
+    return ssd1306_command(display, &command, 1);
+}
+
+const display_driver_t display_ssd1306_driver = {
+    .name = "SSD1306",
+    .init = ssd1306_init,
+    .set_cursor = ssd1306_set_cursor,
+    .write_run = ssd1306_write_run,
+    .define_glyph = ssd1306_define_glyph,
+    .set_backlight = ssd1306_set_backlight,
+};
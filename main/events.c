@@ -1,8 +1,14 @@
 #include "events.h"
 #include "esp_log.h"
+#include "instrumentation.h"
+#include "task_config.h"
 
 static const char *TAG = "events";
 static esp_event_loop_handle_t custom_event_loop = NULL; // Custom event loop handle
+static volatile uint32_t dropped_events = 0; // Posts that found the queue full
+
+// Alarm transitions are not repeated, so they wait for room behind a burst of state changes
+#define EVENTS_ALARM_POST_TIMEOUT_MS 100
 
 ESP_EVENT_DEFINE_BASE(CUSTOM_EVENTS); // Define the event base for custom events
 
@@ -19,12 +25,17 @@ static void application_task(void* args)
 
 // Initialize the event system
 void events_init(void) {
+    const task_config_t *loop_task = task_get_config(TASK_ID_EVENT_LOOP);
     esp_event_loop_args_t loop_args = {
         .queue_size = 10, // Adjust the queue size as needed
-        .task_name = "custom_evt_loop", // Name of the event loop task
-        .task_stack_size = 3072, // Stack size for the event loop task
-        .task_priority = uxTaskPriorityGet(NULL), // Priority for the event loop task
-        .task_core_id = tskNO_AFFINITY // Core to run the event loop task
+#if CONFIG_STATIC_ALLOCATION
+        .task_name = NULL, // The loop task would be allocated by esp_event, the application task runs the loop
+#else
+        .task_name = loop_task->name, // Name of the event loop task
+#endif
+        .task_stack_size = loop_task->stack_size, // Stack size for the event loop task
+        .task_priority = loop_task->priority, // Priority for the event loop task
+        .task_core_id = loop_task->core // Core to run the event loop task
     };
 
     esp_err_t err = esp_event_loop_create(&loop_args, &custom_event_loop);
@@ -35,7 +46,7 @@ void events_init(void) {
     // Create the application task
     TaskHandle_t task_handle;
     ESP_LOGI(TAG, "starting application task");
-    xTaskCreate(application_task, "application_task", 3072, NULL, uxTaskPriorityGet(NULL) + 1, &task_handle);
+    task_create(TASK_ID_APPLICATION, application_task, NULL, &task_handle);
 
     // Start the application task to run the event handlers
     xTaskNotifyGive(task_handle);
@@ -48,12 +59,23 @@ void events_post(int32_t event_id, const void* event_data, size_t event_data_siz
         return;
     }
 
-    esp_err_t err = esp_event_post_to(custom_event_loop, CUSTOM_EVENTS, event_id, event_data, event_data_size, 0);
-    if (err != ESP_OK) {
+    bool alarm = event_id == EVENT_ALARM_RAISED || event_id == EVENT_ALARM_CLEARED;
+    TickType_t timeout = alarm ? pdMS_TO_TICKS(EVENTS_ALARM_POST_TIMEOUT_MS) : 0;
+    INSTR_BEGIN(post_start);
+    esp_err_t err = esp_event_post_to(custom_event_loop, CUSTOM_EVENTS, event_id, event_data, event_data_size, timeout);
+    INSTR_END(INSTR_PATH_EVENT_POST, post_start);
+    if (err == ESP_ERR_TIMEOUT) {
+        dropped_events++;
+        ESP_LOGW(TAG, "Event queue full, event %ld dropped (%lu dropped)", (long)event_id, (unsigned long)dropped_events);
+    } else if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to post event: %s", esp_err_to_name(err));
     }
 }
 
+uint32_t events_get_dropped_count(void) {
+    return dropped_events;
+}
+
 void events_subscribe(int32_t event_id, esp_event_handler_t event_handler, void* event_handler_arg) {
     if (custom_event_loop == NULL) {
         ESP_LOGE(TAG, "Custom event loop not initialized");
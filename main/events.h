@@ -15,13 +15,19 @@ ESP_EVENT_DECLARE_BASE(CUSTOM_EVENTS);        // declaration of the timer events
 enum {
     EVENT_WIFI_CONNECTED,               // Event for WiFi connection established
     EVENT_WIFI_DISCONNECTED,            // Event for WiFi disconnection
-    EVENT_BUTTON_LONG_PRESS,            // Event for button long press
-    EVENT_BUTTON_SHORT_PRESS,           // Event for button short press
+    EVENT_BUTTON_LONG_PRESS,            // Event for button long press (button_event_t)
+    EVENT_BUTTON_SHORT_PRESS,           // Event for button short press, a single click (button_event_t)
+    EVENT_ALARM_RAISED,                 // Event for a temperature alarm raised (alarm_event_t)
+    EVENT_ALARM_CLEARED,                // Event for a temperature alarm cleared (alarm_event_t)
+    EVENT_BUTTON_DOUBLE_CLICK,          // Event for two clicks within the double click window (button_event_t)
+    EVENT_BUTTON_HOLD_REPEAT,           // Event repeated while a button is held after a long press (button_event_t)
+    EVENT_STATE_CHANGED,                // Event for a running state change (state_change_t)
 };
 
 // Function prototypes
 void events_init(void);
 void events_post(int32_t event_id, const void* event_data, size_t event_data_size);
 void events_subscribe(int32_t event_id, esp_event_handler_t event_handler, void* event_handler_arg);
+uint32_t events_get_dropped_count(void); // Events lost because the queue was full
 
 #endif // EVENTS_H
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include "heap_monitor.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "heap";
+
+static const uint32_t cap_flags[HEAP_CAP_MAX] = {
+    [HEAP_CAP_INTERNAL] = MALLOC_CAP_INTERNAL,
+    [HEAP_CAP_DMA] = MALLOC_CAP_DMA,
+    [HEAP_CAP_8BIT] = MALLOC_CAP_8BIT,
+};
+
+static const char *cap_names[HEAP_CAP_MAX] = {
+    [HEAP_CAP_INTERNAL] = "internal",
+    [HEAP_CAP_DMA] = "dma",
+    [HEAP_CAP_8BIT] = "8bit",
+};
+
+static const char *tag_names[HEAP_TAG_MAX] = {
+    [HEAP_TAG_HTTP] = "http",
+};
+
+// Ring of samples per capability, written by the sampling timer, read by reports
+static heap_sample_t samples[HEAP_CAP_MAX][HEAP_MONITOR_HISTORY];
+static heap_cap_stats_t cap_stats[HEAP_CAP_MAX];
+static uint16_t head = 0;               // Next sample to be written
+static uint16_t filled = 0;             // Valid entries in the ring
+static heap_tag_stats_t tag_stats[HEAP_TAG_MAX];
+static portMUX_TYPE heap_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t sample_timer = NULL;
+
+// Header in front of a tagged block, sized to keep the block aligned like malloc() does
+typedef struct {
+    uint32_t size;
+    uint16_t tag;
+    uint16_t magic;
+} heap_tag_header_t;
+
+#define HEAP_TAG_MAGIC 0x7A6B
+#define HEAP_TAG_HEADER_SIZE \
+    ((sizeof(heap_tag_header_t) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1))
+
+static void heap_sample_cap(heap_cap_id_t cap, int64_t now, heap_sample_t *sample) {
+    uint32_t flags = cap_flags[cap];
+    sample->time_us = now;
+    sample->free_bytes = heap_caps_get_free_size(flags);
+    sample->minimum_free_bytes = heap_caps_get_minimum_free_size(flags);
+    sample->largest_block = heap_caps_get_largest_free_block(flags);
+    sample->fragmentation_pct = 0;
+    if (sample->free_bytes > 0 && sample->largest_block < sample->free_bytes) {
+        sample->fragmentation_pct = 100 - (uint8_t)((uint64_t)sample->largest_block * 100 / sample->free_bytes);
+    }
+}
+
+void heap_monitor_sample(void) {
+    int64_t now = esp_timer_get_time();
+    heap_sample_t sample[HEAP_CAP_MAX];
+    bool spike[HEAP_CAP_MAX] = { false };
+
+    // Queried outside of the lock, the heap takes its own
+    for (int cap = 0; cap < HEAP_CAP_MAX; cap++) {
+        heap_sample_cap(cap, now, &sample[cap]);
+    }
+
+    portENTER_CRITICAL(&heap_lock);
+    for (int cap = 0; cap < HEAP_CAP_MAX; cap++) {
+        heap_cap_stats_t *stats = &cap_stats[cap];
+        bool above = sample[cap].fragmentation_pct >= CONFIG_HEAP_FRAG_SPIKE_PCT;
+        bool was_above = filled > 0 && stats->current.fragmentation_pct >= CONFIG_HEAP_FRAG_SPIKE_PCT;
+        spike[cap] = above && !was_above;
+        stats->spike_count += spike[cap] ? 1 : 0;
+        if (filled == 0 || sample[cap].largest_block < stats->lowest_largest_block) {
+            stats->lowest_largest_block = sample[cap].largest_block;
+        }
+        if (sample[cap].fragmentation_pct > stats->peak_fragmentation_pct) {
+            stats->peak_fragmentation_pct = sample[cap].fragmentation_pct;
+        }
+        stats->current = sample[cap];
+        samples[cap][head] = sample[cap];
+    }
+    head = (head + 1) % HEAP_MONITOR_HISTORY;
+    filled = filled < HEAP_MONITOR_HISTORY ? filled + 1 : filled;
+    portEXIT_CRITICAL(&heap_lock);
+
+    for (int cap = 0; cap < HEAP_CAP_MAX; cap++) {
+        if (spike[cap]) {
+            ESP_LOGW(TAG, "%s heap fragmented: %u%%, largest block %lu of %lu free", cap_names[cap],
+                     sample[cap].fragmentation_pct, (unsigned long)sample[cap].largest_block,
+                     (unsigned long)sample[cap].free_bytes);
+        }
+    }
+}
+
+static void heap_sample_timer_callback(void *arg) {
+    heap_monitor_sample();
+}
+
+void heap_monitor_initialize(void) {
+    heap_monitor_sample();
+
+    if (CONFIG_HEAP_MONITOR_INTERVAL_S > 0 && sample_timer == NULL) {
+        esp_timer_create_args_t timer_args = {
+            .callback = heap_sample_timer_callback,
+            .name = "heap_sample",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &sample_timer));
+        ESP_ERROR_CHECK(esp_timer_start_periodic(sample_timer, (uint64_t)CONFIG_HEAP_MONITOR_INTERVAL_S * 1000000));
+    }
+}
+
+esp_err_t heap_monitor_get_stats(heap_cap_id_t cap, heap_cap_stats_t *stats) {
+    if (cap >= HEAP_CAP_MAX || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&heap_lock);
+    *stats = cap_stats[cap];
+    portEXIT_CRITICAL(&heap_lock);
+    return ESP_OK;
+}
+
+int heap_monitor_get_history(heap_cap_id_t cap, heap_sample_t *out, int max_samples) {
+    if (cap >= HEAP_CAP_MAX || out == NULL || max_samples <= 0) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&heap_lock);
+    int count = filled < max_samples ? filled : max_samples;
+    int start = (head - count + HEAP_MONITOR_HISTORY) % HEAP_MONITOR_HISTORY;
+    for (int n = 0; n < count; n++) {
+        out[n] = samples[cap][(start + n) % HEAP_MONITOR_HISTORY];
+    }
+    portEXIT_CRITICAL(&heap_lock);
+    return count;
+}
+
+const char *heap_monitor_get_cap_name(heap_cap_id_t cap) {
+    return cap < HEAP_CAP_MAX ? cap_names[cap] : "?";
+}
+
+void *heap_tag_malloc(heap_tag_t tag, size_t size) {
+    if (tag >= HEAP_TAG_MAX || size > UINT32_MAX - HEAP_TAG_HEADER_SIZE) {
+        return NULL;
+    }
+
+    heap_tag_header_t *header = malloc(HEAP_TAG_HEADER_SIZE + size);
+    heap_tag_stats_t *stats = &tag_stats[tag];
+    portENTER_CRITICAL(&heap_lock);
+    if (header == NULL) {
+        stats->failed_count++;
+    } else {
+        stats->alloc_count++;
+        stats->current_bytes += size;
+        stats->peak_bytes = stats->current_bytes > stats->peak_bytes ? stats->current_bytes : stats->peak_bytes;
+    }
+    portEXIT_CRITICAL(&heap_lock);
+    if (header == NULL) {
+        return NULL;
+    }
+
+    header->size = size;
+    header->tag = tag;
+    header->magic = HEAP_TAG_MAGIC;
+    return (uint8_t *)header + HEAP_TAG_HEADER_SIZE;
+}
+
+void heap_tag_free(void *block) {
+    if (block == NULL) {
+        return;
+    }
+
+    heap_tag_header_t *header = (heap_tag_header_t *)((uint8_t *)block - HEAP_TAG_HEADER_SIZE);
+    if (header->magic != HEAP_TAG_MAGIC || header->tag >= HEAP_TAG_MAX) {
+        ESP_LOGE(TAG, "Block %p was not allocated by heap_tag_malloc()", block);
+        abort();
+    }
+    heap_tag_stats_t *stats = &tag_stats[header->tag];
+    portENTER_CRITICAL(&heap_lock);
+    stats->free_count++;
+    stats->current_bytes -= header->size;
+    portEXIT_CRITICAL(&heap_lock);
+    header->magic = 0; // A second free is caught above
+    free(header);
+}
+
+esp_err_t heap_tag_get_stats(heap_tag_t tag, heap_tag_stats_t *stats) {
+    if (tag >= HEAP_TAG_MAX || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&heap_lock);
+    *stats = tag_stats[tag];
+    portEXIT_CRITICAL(&heap_lock);
+    return ESP_OK;
+}
+
+const char *heap_tag_get_name(heap_tag_t tag) {
+    return tag < HEAP_TAG_MAX ? tag_names[tag] : "?";
+}
+
+void heap_monitor_log(void) {
+    for (int cap = 0; cap < HEAP_CAP_MAX; cap++) {
+        heap_cap_stats_t stats;
+        heap_monitor_get_stats(cap, &stats);
+        ESP_LOGI(TAG, "%-8s %lu bytes free, largest block %lu, minimum %lu, fragmentation %u%%", cap_names[cap],
+                 (unsigned long)stats.current.free_bytes, (unsigned long)stats.current.largest_block,
+                 (unsigned long)stats.current.minimum_free_bytes, stats.current.fragmentation_pct);
+    }
+}
+
+size_t heap_monitor_format_json(char *buffer, size_t size) {
+    size_t length = 0;
+
+#define HEAP_APPEND(...)                                                          \
+    do {                                                                          \
+        if (length < size) {                                                      \
+            int written = snprintf(buffer + length, size - length, __VA_ARGS__);  \
+            length += written > 0 ? written : 0;                                  \
+        }                                                                         \
+    } while (0)
+
+    HEAP_APPEND("{\"caps\":{");
+    for (int cap = 0; cap < HEAP_CAP_MAX; cap++) {
+        heap_cap_stats_t stats;
+        heap_monitor_get_stats(cap, &stats);
+        HEAP_APPEND("%s\"%s\":{\"free\":%lu,\"min_free\":%lu,\"largest_block\":%lu,\"lowest_largest_block\":%lu,"
+                    "\"fragmentation\":%u,\"peak_fragmentation\":%u,\"spikes\":%lu}",
+                    cap > 0 ? "," : "", cap_names[cap], (unsigned long)stats.current.free_bytes,
+                    (unsigned long)stats.current.minimum_free_bytes, (unsigned long)stats.current.largest_block,
+                    (unsigned long)stats.lowest_largest_block, stats.current.fragmentation_pct,
+                    stats.peak_fragmentation_pct, (unsigned long)stats.spike_count);
+    }
+    HEAP_APPEND("},\"tags\":{");
+    for (int tag = 0; tag < HEAP_TAG_MAX; tag++) {
+        heap_tag_stats_t stats;
+        heap_tag_get_stats(tag, &stats);
+        HEAP_APPEND("%s\"%s\":{\"bytes\":%lu,\"peak\":%lu,\"allocs\":%lu,\"frees\":%lu,\"failed\":%lu}",
+                    tag > 0 ? "," : "", tag_names[tag], (unsigned long)stats.current_bytes,
+                    (unsigned long)stats.peak_bytes, (unsigned long)stats.alloc_count,
+                    (unsigned long)stats.free_count, (unsigned long)stats.failed_count);
+    }
+    HEAP_APPEND("}}");
+
+#undef HEAP_APPEND
+    return length < size ? length : (size > 0 ? size - 1 : 0);
+}
+
+void heap_monitor_print_report(FILE *out) {
+    fprintf(out, "%-10s %10s %10s %10s %10s %6s %6s %7s\n", "heap", "free", "min_free", "largest", "lowest", "frag%",
+                 "peak%", "spikes");
+    for (int cap = 0; cap < HEAP_CAP_MAX; cap++) {
+        heap_cap_stats_t stats;
+        heap_monitor_get_stats(cap, &stats);
+        fprintf(out, "%-10s %10lu %10lu %10lu %10lu %6u %6u %7lu\n", cap_names[cap],
+                     (unsigned long)stats.current.free_bytes, (unsigned long)stats.current.minimum_free_bytes,
+                     (unsigned long)stats.current.largest_block, (unsigned long)stats.lowest_largest_block,
+                     stats.current.fragmentation_pct, stats.peak_fragmentation_pct, (unsigned long)stats.spike_count);
+    }
+
+    fprintf(out, "\n%-10s %10s %10s %10s %10s %7s\n", "tag", "bytes", "peak", "allocs", "frees", "failed");
+    for (int tag = 0; tag < HEAP_TAG_MAX; tag++) {
+        heap_tag_stats_t stats;
+        heap_tag_get_stats(tag, &stats);
+        fprintf(out, "%-10s %10lu %10lu %10lu %10lu %7lu\n", tag_names[tag], (unsigned long)stats.current_bytes,
+                     (unsigned long)stats.peak_bytes, (unsigned long)stats.alloc_count, (unsigned long)stats.free_count,
+                     (unsigned long)stats.failed_count);
+    }
+}
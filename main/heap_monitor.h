@@ -0,0 +1,119 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "esp_err.h"
+
+#define HEAP_MONITOR_HISTORY CONFIG_HEAP_MONITOR_HISTORY // Samples kept per capability
+
+// Heap capabilities followed over time
+typedef enum {
+    HEAP_CAP_INTERNAL = 0,      // Internal RAM
+    HEAP_CAP_DMA,               // DMA capable RAM (ADC pool, I2C and SPI buffers)
+    HEAP_CAP_8BIT,              // Byte addressable RAM, what malloc() returns
+    HEAP_CAP_MAX
+} heap_cap_id_t;
+
+// Allocations of the firmware's own modules, counted by heap_tag_malloc()
+typedef enum {
+    HEAP_TAG_HTTP = 0,          // Captive portal and API responses
+    HEAP_TAG_MAX
+} heap_tag_t;
+
+typedef struct {
+    int64_t time_us;            // Time of the sample
+    uint32_t free_bytes;
+    uint32_t minimum_free_bytes; // Lowest free size since boot
+    uint32_t largest_block;     // Largest block one allocation can get
+    uint8_t fragmentation_pct;  // Share of the free size not in the largest block
+} heap_sample_t;
+
+typedef struct {
+    heap_sample_t current;
+    uint32_t lowest_largest_block; // Since boot
+    uint8_t peak_fragmentation_pct;
+    uint32_t spike_count;       // Samples crossing CONFIG_HEAP_FRAG_SPIKE_PCT upwards
+} heap_cap_stats_t;
+
+typedef struct {
+    uint32_t current_bytes;     // Allocated and not freed
+    uint32_t peak_bytes;
+    uint32_t alloc_count;
+    uint32_t free_count;
+    uint32_t failed_count;      // Allocations the heap refused
+} heap_tag_stats_t;
+
+/**
+ * @brief Take a first sample and sample every CONFIG_HEAP_MONITOR_INTERVAL_S.
+ */
+void heap_monitor_initialize(void);
+
+/**
+ * @brief Sample every capability now, a fragmentation spike is logged once per crossing.
+ */
+void heap_monitor_sample(void);
+
+/**
+ * @brief Get the last sample and the extremes of a capability.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an unknown capability.
+ */
+esp_err_t heap_monitor_get_stats(heap_cap_id_t cap, heap_cap_stats_t *stats);
+
+/**
+ * @brief Copy the newest samples of a capability, oldest first.
+ * @param cap         Capability.
+ * @param samples     Output.
+ * @param max_samples Capacity of samples.
+ * @return int Number of samples copied.
+ */
+int heap_monitor_get_history(heap_cap_id_t cap, heap_sample_t *samples, int max_samples);
+
+/**
+ * @brief Get the name of a capability.
+ */
+const char *heap_monitor_get_cap_name(heap_cap_id_t cap);
+
+/**
+ * @brief Allocate memory accounted to a module, release it with heap_tag_free().
+ * @return The block, NULL if the heap has no room.
+ */
+void *heap_tag_malloc(heap_tag_t tag, size_t size);
+
+/**
+ * @brief Release a block of heap_tag_malloc(), NULL is ignored.
+ */
+void heap_tag_free(void *block);
+
+/**
+ * @brief Get the allocation counters of a module.
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for an unknown tag.
+ */
+esp_err_t heap_tag_get_stats(heap_tag_t tag, heap_tag_stats_t *stats);
+
+/**
+ * @brief Get the name of a tag.
+ */
+const char *heap_tag_get_name(heap_tag_t tag);
+
+/**
+ * @brief Log one line per capability with the last sample.
+ */
+void heap_monitor_log(void);
+
+/**
+ * @brief Format the capability statistics and tag counters as JSON.
+ * @param buffer Output buffer.
+ * @param size Size of the buffer.
+ * @return Length of the JSON, truncated to size - 1.
+ */
+size_t heap_monitor_format_json(char *buffer, size_t size);
+
+/**
+ * @brief Print the capability statistics and tag counters.
+ * @param out Stream to print to, stdout or a console session.
+ */
+void heap_monitor_print_report(FILE *out);
+
+#endif // HEAP_MONITOR_H
@@ -0,0 +1,130 @@
+#include "history_manager.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "history";
+
+// Ring of closed points per channel, written by the acquisition task, read by the display
+static int16_t points[NTC_MAX_CHANNELS][HISTORY_DEPTH];
+static uint16_t head = 0;             // Next point to be written
+static uint16_t filled = 0;           // Valid entries in the ring
+static uint32_t point_count = 0;
+static portMUX_TYPE history_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Average of the open point, only touched by the acquisition task
+static int64_t sum_centi[NTC_MAX_CHANNELS];
+static uint32_t sample_count[NTC_MAX_CHANNELS];
+static int64_t period_start_us = 0;
+
+static int16_t centi_to_deci(int64_t value_centi) {
+    int64_t value_deci = value_centi >= 0 ? (value_centi + 5) / 10 : (value_centi - 5) / 10;
+    if (value_deci > INT16_MAX) {
+        return INT16_MAX;
+    }
+    return value_deci <= HISTORY_INVALID ? HISTORY_INVALID + 1 : (int16_t)value_deci;
+}
+
+// Close the open point, then add an invalid point for every further period without frames
+static void history_close_points(uint32_t periods) {
+    if (periods > HISTORY_DEPTH) {
+        periods = HISTORY_DEPTH;
+    }
+
+    taskENTER_CRITICAL(&history_lock);
+    for (uint32_t n = 0; n < periods; n++) {
+        for (int i = 0; i < NTC_MAX_CHANNELS; i++) {
+            if (n == 0 && sample_count[i] > 0) {
+                points[i][head] = centi_to_deci(sum_centi[i] / (int64_t)sample_count[i]);
+            } else {
+                points[i][head] = HISTORY_INVALID;
+            }
+        }
+        head = (head + 1) % HISTORY_DEPTH;
+        if (filled < HISTORY_DEPTH) {
+            filled++;
+        }
+        point_count++;
+    }
+    taskEXIT_CRITICAL(&history_lock);
+
+    memset(sum_centi, 0, sizeof(sum_centi));
+    memset(sample_count, 0, sizeof(sample_count));
+}
+
+void history_initialize(void) {
+    taskENTER_CRITICAL(&history_lock);
+    for (int i = 0; i < NTC_MAX_CHANNELS; i++) {
+        for (int n = 0; n < HISTORY_DEPTH; n++) {
+            points[i][n] = HISTORY_INVALID;
+        }
+    }
+    head = 0;
+    filled = 0;
+    point_count = 0;
+    taskEXIT_CRITICAL(&history_lock);
+
+    memset(sum_centi, 0, sizeof(sum_centi));
+    memset(sample_count, 0, sizeof(sample_count));
+    period_start_us = 0;
+    ESP_LOGI(TAG, "History of %d points every %d s", HISTORY_DEPTH, CONFIG_HISTORY_PERIOD_S);
+}
+
+void history_process_frame(const int32_t *value_centi, uint32_t valid_mask, int64_t now_us) {
+    if (period_start_us == 0) {
+        period_start_us = now_us;
+    }
+
+    int64_t elapsed_us = now_us - period_start_us;
+    if (elapsed_us >= (int64_t)HISTORY_PERIOD_MS * 1000) {
+        uint32_t periods = elapsed_us / ((int64_t)HISTORY_PERIOD_MS * 1000);
+        history_close_points(periods);
+        period_start_us += (int64_t)periods * HISTORY_PERIOD_MS * 1000;
+    }
+
+    for (int i = 0; i < NTC_MAX_CHANNELS; i++) {
+        if (valid_mask & (1 << i)) {
+            sum_centi[i] += value_centi[i];
+            sample_count[i]++;
+        }
+    }
+}
+
+int history_get_channel(int channel_index, int16_t *out, int max_points) {
+    if (channel_index < 0 || channel_index >= NTC_MAX_CHANNELS || out == NULL || max_points <= 0) {
+        return 0;
+    }
+
+    taskENTER_CRITICAL(&history_lock);
+    int count = filled < max_points ? filled : max_points;
+    int start = (head - count + HISTORY_DEPTH) % HISTORY_DEPTH;
+    for (int n = 0; n < count; n++) {
+        out[n] = points[channel_index][(start + n) % HISTORY_DEPTH];
+    }
+    taskEXIT_CRITICAL(&history_lock);
+    return count;
+}
+
+int history_get_range(int channel_index, int16_t *low, int16_t *high) {
+    if (channel_index < 0 || channel_index >= NTC_MAX_CHANNELS || low == NULL || high == NULL) {
+        return 0;
+    }
+
+    // Scanned in place, a copy of a deep history would not fit on the caller's stack
+    int valid = 0;
+    taskENTER_CRITICAL(&history_lock);
+    for (int n = 0; n < filled; n++) {
+        int16_t point = points[channel_index][(head - 1 - n + HISTORY_DEPTH) % HISTORY_DEPTH];
+        if (point == HISTORY_INVALID) {
+            continue;
+        }
+        *low = valid == 0 || point < *low ? point : *low;
+        *high = valid == 0 || point > *high ? point : *high;
+        valid++;
+    }
+    taskEXIT_CRITICAL(&history_lock);
+    return valid;
+}
+
+uint32_t history_get_point_count(void) {
+    return point_count;
+}
@@ -0,0 +1,54 @@
+#ifndef HISTORY_MANAGER_H
+#define HISTORY_MANAGER_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "ntc_adc.h"
+
+#define HISTORY_DEPTH CONFIG_HISTORY_DEPTH
+#define HISTORY_PERIOD_MS (CONFIG_HISTORY_PERIOD_S * 1000)
+#define HISTORY_INVALID INT16_MIN // Point without a valid sample, e.g. a faulted probe
+
+/**
+ * @brief Initialize the history ring buffer, all points invalid.
+ */
+void history_initialize(void);
+
+/**
+ * @brief Accumulate a published frame into the current history point.
+ *
+ * Called from the acquisition task, the point is closed every HISTORY_PERIOD_MS
+ * with the average of the frames received in the period.
+ *
+ * @param value_centi Temperatures in 0.01 °C, indexed by channel.
+ * @param valid_mask  Channels with a valid temperature in this frame.
+ * @param now_us      Publish time.
+ */
+void history_process_frame(const int32_t *value_centi, uint32_t valid_mask, int64_t now_us);
+
+/**
+ * @brief Copy the newest points of a channel, oldest first.
+ *
+ * @param channel_index Probe index.
+ * @param points        Output, temperatures in 0.1 °C or HISTORY_INVALID.
+ * @param max_points    Capacity of points.
+ * @return int Number of points copied, less than max_points until the history has filled up.
+ */
+int history_get_channel(int channel_index, int16_t *points, int max_points);
+
+/**
+ * @brief Get the lowest and highest valid point of a channel.
+ *
+ * @param channel_index Probe index.
+ * @param low           Output, lowest point in 0.1 °C, untouched without valid points.
+ * @param high          Output, highest point in 0.1 °C, untouched without valid points.
+ * @return int Number of valid points in the history.
+ */
+int history_get_range(int channel_index, int16_t *low, int16_t *high);
+
+/**
+ * @brief Get the number of points closed since initialization.
+ */
+uint32_t history_get_point_count(void);
+
+#endif // HISTORY_MANAGER_H
@@ -0,0 +1,261 @@
+#include "instrumentation.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *path_names[INSTR_PATH_MAX] = {
+    [INSTR_PATH_ADC_FRAME] = "adc_frame",
+    [INSTR_PATH_LCD_RENDER] = "lcd_render",
+    [INSTR_PATH_EVENT_POST] = "event_post",
+    [INSTR_PATH_HTTP_HANDLER] = "http_handler",
+};
+
+static instr_histogram_t histograms[INSTR_PATH_MAX];
+static portMUX_TYPE histogram_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Previous run time sample, for the CPU share between two samples
+static uint64_t last_run_time_us[TASK_ID_MAX];
+static int64_t last_sample_time_us = 0;
+
+// Previous run time of every task, for the core load between two samples
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+static TaskStatus_t system_tasks[INSTR_MAX_SYSTEM_TASKS];
+static TaskHandle_t last_system_handles[INSTR_MAX_SYSTEM_TASKS];
+static uint32_t last_system_run_time[INSTR_MAX_SYSTEM_TASKS];
+static UBaseType_t last_system_count = 0;
+static int64_t last_core_sample_time_us = 0;
+#endif
+
+const char *instr_get_path_name(instr_path_t path) {
+    return path < INSTR_PATH_MAX ? path_names[path] : "?";
+}
+
+void instr_record(instr_path_t path, uint32_t latency_us) {
+#if CONFIG_INSTR_ENABLE
+    if (path >= INSTR_PATH_MAX) {
+        return;
+    }
+
+    // Bucket n holds [2^n, 2^(n+1)) us, bucket 0 also holds 0 us
+    int bucket = latency_us == 0 ? 0 : 31 - __builtin_clz(latency_us);
+    if (bucket >= INSTR_HISTOGRAM_BUCKETS) {
+        bucket = INSTR_HISTOGRAM_BUCKETS - 1;
+    }
+
+    instr_histogram_t *histogram = &histograms[path];
+    portENTER_CRITICAL(&histogram_lock);
+    if (histogram->count == 0 || latency_us < histogram->min_us) {
+        histogram->min_us = latency_us;
+    }
+    if (latency_us > histogram->max_us) {
+        histogram->max_us = latency_us;
+    }
+    histogram->count++;
+    histogram->total_us += latency_us;
+    histogram->buckets[bucket]++;
+    portEXIT_CRITICAL(&histogram_lock);
+#endif
+}
+
+instr_histogram_t instr_get_histogram(instr_path_t path) {
+    instr_histogram_t histogram = { 0 };
+    if (path < INSTR_PATH_MAX) {
+        portENTER_CRITICAL(&histogram_lock);
+        histogram = histograms[path];
+        portEXIT_CRITICAL(&histogram_lock);
+    }
+    return histogram;
+}
+
+void instr_reset(void) {
+    portENTER_CRITICAL(&histogram_lock);
+    memset(histograms, 0, sizeof(histograms));
+    portEXIT_CRITICAL(&histogram_lock);
+}
+
+void instr_sample_tasks(instr_task_stats_t *stats) {
+    int64_t now = esp_timer_get_time();
+
+    for (int i = 0; i < TASK_ID_MAX; i++) {
+        const task_config_t *config = task_get_config(i);
+        instr_task_stats_t *entry = &stats[i];
+        TaskHandle_t handle = xTaskGetHandle(config->name);
+
+        memset(entry, 0, sizeof(*entry));
+        entry->name = config->name;
+        entry->cpu_percent = -1;
+        entry->core = config->core == tskNO_AFFINITY ? -1 : config->core;
+        entry->priority = config->priority;
+        if (handle == NULL) {
+            last_run_time_us[i] = 0;
+            continue; // Not started, e.g. the DNS server outside of AP mode
+        }
+        entry->running = true;
+        entry->priority = uxTaskPriorityGet(handle);
+        entry->stack_free_bytes = uxTaskGetStackHighWaterMark(handle) * sizeof(StackType_t);
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+        int64_t elapsed_us = last_sample_time_us != 0 ? now - last_sample_time_us : 0;
+        entry->run_time_us = ulTaskGetRunTimeCounter(handle);
+        if (elapsed_us > 0 && last_run_time_us[i] != 0 && entry->run_time_us >= last_run_time_us[i]) {
+            entry->cpu_percent = (entry->run_time_us - last_run_time_us[i]) * 100.0f / elapsed_us;
+        }
+        last_run_time_us[i] = entry->run_time_us;
+#endif
+    }
+    last_sample_time_us = now;
+}
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+static int instr_core_slot(const TaskStatus_t *status) {
+    // Core a task runs on, tasks without affinity share the last slot
+    BaseType_t core = tskNO_AFFINITY;
+#if CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+    core = status->xCoreID;
+#else
+    for (int i = 0; i < TASK_ID_MAX; i++) {
+        if (strcmp(status->pcTaskName, task_get_config(i)->name) == 0) {
+            core = task_get_config(i)->core;
+        }
+    }
+#endif
+    return core >= 0 && core < portNUM_PROCESSORS ? core : INSTR_CORE_ANY;
+}
+
+void instr_sample_cores(instr_core_stats_t *cores) {
+    // uxTaskGetSystemState() needs the trace facility, enabled in sdkconfig.defaults
+    int64_t now = esp_timer_get_time();
+    uint64_t busy_us[INSTR_CORE_SLOTS] = { 0 };
+
+    memset(cores, 0, sizeof(*cores) * INSTR_CORE_SLOTS);
+    UBaseType_t count = uxTaskGetSystemState(system_tasks, INSTR_MAX_SYSTEM_TASKS, NULL);
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t *status = &system_tasks[i];
+        if (strncmp(status->pcTaskName, "IDLE", 4) == 0) {
+            continue; // Idle time is what is left of the load
+        }
+        int slot = instr_core_slot(status);
+        cores[slot].task_count++;
+        for (UBaseType_t j = 0; j < last_system_count; j++) {
+            if (last_system_handles[j] == status->xHandle) {
+                busy_us[slot] += (uint32_t)(status->ulRunTimeCounter - last_system_run_time[j]); // Wraps like the counter
+                break;
+            }
+        }
+    }
+
+    for (int slot = 0; slot < INSTR_CORE_SLOTS; slot++) {
+        cores[slot].load_percent = -1;
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+        int64_t elapsed_us = last_core_sample_time_us != 0 ? now - last_core_sample_time_us : 0;
+        if (elapsed_us > 0) {
+            cores[slot].load_percent = busy_us[slot] * 100.0f / elapsed_us;
+        }
+#endif
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        last_system_handles[i] = system_tasks[i].xHandle;
+        last_system_run_time[i] = system_tasks[i].ulRunTimeCounter;
+    }
+    last_system_count = count;
+    last_core_sample_time_us = now;
+}
+#else
+void instr_sample_cores(instr_core_stats_t *cores) {
+    // Without the trace facility there is no list of the system tasks to sum up
+    memset(cores, 0, sizeof(*cores) * INSTR_CORE_SLOTS);
+    for (int slot = 0; slot < INSTR_CORE_SLOTS; slot++) {
+        cores[slot].load_percent = -1;
+    }
+}
+#endif
+
+size_t instr_format_json(char *buffer, size_t size) {
+    instr_task_stats_t tasks[TASK_ID_MAX];
+    instr_core_stats_t cores[INSTR_CORE_SLOTS];
+    size_t length = 0;
+
+    instr_sample_tasks(tasks);
+    instr_sample_cores(cores);
+
+#define INSTR_APPEND(...)                                                         \
+    do {                                                                          \
+        if (length < size) {                                                      \
+            int written = snprintf(buffer + length, size - length, __VA_ARGS__);  \
+            length += written > 0 ? written : 0;                                  \
+        }                                                                         \
+    } while (0)
+
+    INSTR_APPEND("{\"enabled\":%s,\"paths\":{", INSTR_ENABLED ? "true" : "false");
+    for (int p = 0; p < INSTR_PATH_MAX; p++) {
+        instr_histogram_t histogram = instr_get_histogram(p);
+        INSTR_APPEND("%s\"%s\":{\"count\":%lu,\"min_us\":%lu,\"max_us\":%lu,\"avg_us\":%lu,\"buckets\":[",
+                     p > 0 ? "," : "", path_names[p], (unsigned long)histogram.count,
+                     (unsigned long)histogram.min_us, (unsigned long)histogram.max_us,
+                     (unsigned long)(histogram.count > 0 ? histogram.total_us / histogram.count : 0));
+        for (int b = 0; b < INSTR_HISTOGRAM_BUCKETS; b++) {
+            INSTR_APPEND("%s%lu", b > 0 ? "," : "", (unsigned long)histogram.buckets[b]);
+        }
+        INSTR_APPEND("]}");
+    }
+    INSTR_APPEND("},\"tasks\":{");
+    for (int t = 0; t < TASK_ID_MAX; t++) {
+        INSTR_APPEND("%s\"%s\":{\"running\":%s,\"stack_free\":%lu,\"run_time_us\":%llu,\"cpu\":%.1f,"
+                     "\"core\":%d,\"prio\":%u}",
+                     t > 0 ? "," : "", tasks[t].name, tasks[t].running ? "true" : "false",
+                     (unsigned long)tasks[t].stack_free_bytes, (unsigned long long)tasks[t].run_time_us,
+                     tasks[t].cpu_percent, tasks[t].core, tasks[t].priority);
+    }
+    INSTR_APPEND("},\"cores\":[");
+    for (int c = 0; c < INSTR_CORE_SLOTS; c++) {
+        INSTR_APPEND("%s{\"core\":%d,\"load\":%.1f,\"tasks\":%lu}", c > 0 ? "," : "",
+                     c == INSTR_CORE_ANY ? -1 : c, cores[c].load_percent, (unsigned long)cores[c].task_count);
+    }
+    INSTR_APPEND("]}");
+
+#undef INSTR_APPEND
+    return length < size ? length : (size > 0 ? size - 1 : 0);
+}
+
+void instr_print_report(FILE *out) {
+    instr_task_stats_t tasks[TASK_ID_MAX];
+    instr_core_stats_t cores[INSTR_CORE_SLOTS];
+    instr_sample_tasks(tasks);
+    instr_sample_cores(cores);
+
+    fprintf(out, "%-14s %8s %8s %8s %8s\n", "path", "count", "min_us", "avg_us", "max_us");
+    for (int p = 0; p < INSTR_PATH_MAX; p++) {
+        instr_histogram_t histogram = instr_get_histogram(p);
+        fprintf(out, "%-14s %8lu %8lu %8lu %8lu\n", path_names[p], (unsigned long)histogram.count,
+                     (unsigned long)histogram.min_us,
+                     (unsigned long)(histogram.count > 0 ? histogram.total_us / histogram.count : 0),
+                     (unsigned long)histogram.max_us);
+        if (histogram.count == 0) {
+            continue;
+        }
+        for (int b = 0; b < INSTR_HISTOGRAM_BUCKETS; b++) {
+            if (histogram.buckets[b] > 0) {
+                fprintf(out, "  %8lu us+ %8lu\n", 1UL << b, (unsigned long)histogram.buckets[b]);
+            }
+        }
+    }
+
+    fprintf(out, "\n%-18s %4s %4s %10s %12s %6s\n", "task", "core", "prio", "stack_free", "run_time_us", "cpu%");
+    for (int t = 0; t < TASK_ID_MAX; t++) {
+        if (!tasks[t].running) {
+            fprintf(out, "%-18s %4d %4u %10s\n", tasks[t].name, tasks[t].core, tasks[t].priority, "-");
+            continue;
+        }
+        fprintf(out, "%-18s %4d %4u %10lu %12llu %6.1f\n", tasks[t].name, tasks[t].core, tasks[t].priority,
+                     (unsigned long)tasks[t].stack_free_bytes, (unsigned long long)tasks[t].run_time_us,
+                     tasks[t].cpu_percent);
+    }
+
+    fprintf(out, "\n%-6s %6s %6s\n", "core", "load%", "tasks");
+    for (int c = 0; c < INSTR_CORE_SLOTS; c++) {
+        char name[8];
+        snprintf(name, sizeof(name), c == INSTR_CORE_ANY ? "any" : "%d", c);
+        fprintf(out, "%-6s %6.1f %6lu\n", name, cores[c].load_percent, (unsigned long)cores[c].task_count);
+    }
+}
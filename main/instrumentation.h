@@ -0,0 +1,123 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "sdkconfig.h"
+#include "esp_timer.h"
+#include "task_config.h"
+
+#if CONFIG_INSTR_ENABLE
+#define INSTR_ENABLED 1
+#define INSTR_HISTOGRAM_BUCKETS CONFIG_INSTR_HISTOGRAM_BUCKETS
+#else
+#define INSTR_ENABLED 0
+#define INSTR_HISTOGRAM_BUCKETS 1
+#endif
+
+// Paths with a latency histogram
+typedef enum {
+    INSTR_PATH_ADC_FRAME = 0,   // Decoding one DMA frame
+    INSTR_PATH_LCD_RENDER,      // lcd_render(), buffer to display over I2C
+    INSTR_PATH_EVENT_POST,      // events_post(), queueing an event on the custom loop
+    INSTR_PATH_HTTP_HANDLER,    // HTTP URI handlers
+    INSTR_PATH_MAX
+} instr_path_t;
+
+// Load slots: one per core, then the tasks without affinity
+#define INSTR_CORE_ANY portNUM_PROCESSORS
+#define INSTR_CORE_SLOTS (portNUM_PROCESSORS + 1)
+#define INSTR_MAX_SYSTEM_TASKS 32 // Tasks of the whole system followed for the core load
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[INSTR_HISTOGRAM_BUCKETS]; // Bucket n: [2^n, 2^(n+1)) us
+} instr_histogram_t;
+
+typedef struct {
+    const char *name;
+    bool running;               // Task exists
+    uint32_t stack_free_bytes;  // Stack high water mark
+    uint64_t run_time_us;       // Total run time, 0 without CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    float cpu_percent;          // Share of one core since the previous sample, -1 if unknown
+    int8_t core;                // Planned core, -1 without affinity
+    uint8_t priority;           // Current priority
+} instr_task_stats_t;
+
+typedef struct {
+    float load_percent;         // Run time of the non-idle tasks since the previous sample, -1 if unknown
+    uint32_t task_count;        // Tasks counted in the slot
+} instr_core_stats_t;
+
+// Probes, compiled out without CONFIG_INSTR_ENABLE
+#if CONFIG_INSTR_ENABLE
+#define INSTR_BEGIN(start) int64_t start = esp_timer_get_time()
+#define INSTR_END(path, start) instr_record((path), (uint32_t)(esp_timer_get_time() - (start)))
+#else
+#define INSTR_BEGIN(start) do { } while (0)
+#define INSTR_END(path, start) do { } while (0)
+#endif
+
+/**
+ * @brief Record a latency sample of a path.
+ * @param path Instrumented path.
+ * @param latency_us Latency in microseconds.
+ */
+void instr_record(instr_path_t path, uint32_t latency_us);
+
+/**
+ * @brief Get a copy of the histogram of a path.
+ */
+instr_histogram_t instr_get_histogram(instr_path_t path);
+
+/**
+ * @brief Get the name of a path.
+ */
+const char *instr_get_path_name(instr_path_t path);
+
+/**
+ * @brief Sample the stack watermark and run time of the tasks of the task table.
+ *
+ * The CPU share is computed against the previous call.
+ *
+ * @param stats Array of TASK_ID_MAX entries, indexed by task_id_t.
+ */
+void instr_sample_tasks(instr_task_stats_t *stats);
+
+/**
+ * @brief Sample the load of each core from the run time of all tasks.
+ *
+ * The load is computed against the previous call. Idle tasks are not counted, tasks
+ * without affinity go to the INSTR_CORE_ANY slot as their core is not known. Needs
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS; without CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+ * only the tasks of the task table are placed on their core.
+ *
+ * @param cores Array of INSTR_CORE_SLOTS entries.
+ */
+void instr_sample_cores(instr_core_stats_t *cores);
+
+/**
+ * @brief Clear the histograms.
+ */
+void instr_reset(void);
+
+/**
+ * @brief Format the histograms and task statistics as JSON.
+ * @param buffer Output buffer.
+ * @param size Size of the buffer.
+ * @return Length of the JSON, truncated to size - 1.
+ */
+size_t instr_format_json(char *buffer, size_t size);
+
+/**
+ * @brief Print the histograms and task statistics.
+ * @param out Stream to print to, stdout or a console session.
+ */
+void instr_print_report(FILE *out);
+
+#endif // INSTRUMENTATION_H
@@ -1,73 +1,139 @@
 #include "lcd.h"
+#include "display_driver.h"
 #include "ntc_adc.h"
+#include "power_manager.h"
+#include "alarm_manager.h"
+#include "instrumentation.h"
+#include "history_manager.h"
+#include "lcd_layout.h"
+#include "button_manager.h"
+#include "menu.h"
+#include "config_manager.h"
+#include "state_manager.h"
+#include "task_config.h"
+#include <stdio.h>
 #include <string.h>
 #include "esp_netif.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "I2C_LCD";
-static const uint8_t COMMAND_8BIT_MODE = 0b00110000;
-static const uint8_t COMMAND_4BIT_MODE = 0b00100000;
-static const uint8_t INIT_COMMANDS[] = {
-    0b00101000, // Function set: 4-bit mode, 2 lines, 5x8 dots
-    0b00001100, // Display control: display on, cursor off, blink off
-    0b00000001, // Clear display
-    0b00000110, // Entry mode set: increment cursor, no shift
-    0b00000010, // Set cursor to home position
-    0b10000000  // Set cursor to first line
-};
 
-static i2c_master_dev_handle_t i2c_device_handle = NULL;
 static i2c_master_bus_handle_t i2c_bus_handle = NULL;
-static uint8_t lcd_backlight_status = LCD_BACKLIGHT;
+static TaskHandle_t lcd_task_handle = NULL;
+
+// A display on the bus and what it shows, only touched by the display task
+typedef struct
+{
+    display_t display;
+    char shadow[LCD_BUFFER_SIZE];                       // Characters on the glass
+    uint8_t glyphs[LCD_GLYPH_SLOTS][LCD_GLYPH_ROWS];    // Custom characters on the controller
+    uint8_t glyph_valid_mask;                           // Slots whose content is known
+    bool backlight_on;
+    bool backlight_valid;
+    bool lost_logged;
+} lcd_output_t;
 
+static lcd_output_t outputs[DISPLAY_MAX];
+static uint8_t output_count = 0;
+static uint32_t glyph_upload_count = 0;
+
+// The frame every display shows: text, custom characters and backlight
 static char lcd_buffer[LCD_BUFFER_SIZE]; // 80-byte buffer for the LCD
+static lcd_glyph_set_t frame_glyphs = {0};
+static bool lcd_backlight_on = true;
+static volatile bool lcd_redraw = false; // Set by lcd_invalidate(), resends every character
+
 static char status_line_buffer[LCD_COLS];
+static volatile uint32_t status_line_version = 0; // Bumped on every status line change
 
 static uint8_t cursor_col = 0;
 static uint8_t cursor_row = 0;
 
 static lcd_screen_state_t lcd_screen_state = LCD_SCREEN_SPLASH;
+static running_state_t frame_state; // State snapshot the status screens are drawn from
 
-static esp_err_t i2c_send_with_toggle(uint8_t data)
-{
-    // Helper function to toggle the enable bit
-    uint8_t data_with_enable = data | LCD_ENABLE;
-    ESP_ERROR_CHECK(i2c_master_transmit(i2c_device_handle, &data_with_enable, 1, -1));
-    vTaskDelay(pdMS_TO_TICKS(1));
+// Serializes the frame between the update task, event handlers and the backlight timer.
+// The displays are only written by the update task, from a snapshot taken under the lock.
+static SemaphoreHandle_t lcd_mutex = NULL;
 
-    data_with_enable &= ~LCD_ENABLE;
-    ESP_ERROR_CHECK(i2c_master_transmit(i2c_device_handle, &data_with_enable, 1, -1));
-    vTaskDelay(pdMS_TO_TICKS(1));
+// Sparkline levels, glyph n fills the bottom n + 1 pixel rows
+static const lcd_glyph_set_t SPARKLINE_GLYPHS = {
+    .slot_mask = 0xFF,
+    .bitmaps = {
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F},
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F},
+        {0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F},
+        {0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F},
+        {0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+        {0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+        {0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+        {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+    },
+};
 
-    return ESP_OK;
+// Bar graph partial cells of 1-4 pixel columns in slots 0-3, the full cell shares slot 7 with the sparklines
+#define BAR_GLYPH_FULL 7
+static const lcd_glyph_set_t BAR_GLYPHS = {
+    .slot_mask = 0x8F,
+    .bitmaps = {
+        {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10},
+        {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},
+        {0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C},
+        {0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E},
+        [BAR_GLYPH_FULL] = {0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+    },
+};
+
+static void lcd_draw_screen(void);
+
+static void lcd_lock(void)
+{
+    if (lcd_mutex != NULL)
+    {
+        xSemaphoreTake(lcd_mutex, portMAX_DELAY);
+    }
 }
 
-static esp_err_t i2c_send_4bit_data(uint8_t data, uint8_t rs)
+static void lcd_unlock(void)
 {
-    // Send a byte of data to the LCD in 4-bit mode
-    uint8_t nibbles[2] = {
-        (data & 0xF0) | rs | lcd_backlight_status | LCD_RW_WRITE,
-        ((data << 4) & 0xF0) | rs | lcd_backlight_status | LCD_RW_WRITE};
-    ESP_ERROR_CHECK(i2c_send_with_toggle(nibbles[0]));
-    ESP_ERROR_CHECK(i2c_send_with_toggle(nibbles[1]));
+    if (lcd_mutex != NULL)
+    {
+        xSemaphoreGive(lcd_mutex);
+    }
+}
 
-    return ESP_OK;
+static void lcd_wake_task(void)
+{
+    // Let the update task send the change now instead of at the next refresh
+    if (lcd_task_handle != NULL)
+    {
+        xTaskNotifyGive(lcd_task_handle);
+    }
 }
 
 static void lcd_event_handler(void *handler_arg, esp_event_base_t base, int32_t id, void *event_data)
 {
     if (base == CUSTOM_EVENTS)
     {
+        if (menu_handle_button(id, event_data))
+        {
+            return; // Gesture used by the settings menu
+        }
         switch (id)
         {
         case EVENT_BUTTON_SHORT_PRESS:
             ESP_LOGI(TAG, "Short button press detected");
-            if (lcd_screen_state != LCD_SCREEN_AP_MODE)
+            if (button_event_is(event_data, BUTTON_ID_MAIN) && lcd_screen_state != LCD_SCREEN_AP_MODE)
             {
                 lcd_next_screen(); // Cycle to the next screen
             }
             break;
         case EVENT_BUTTON_LONG_PRESS:
             ESP_LOGI(TAG, "Long button press detected");
+            if (!button_event_is(event_data, BUTTON_ID_MAIN))
+            {
+                break;
+            }
             if (lcd_screen_state != LCD_SCREEN_AP_MODE)
             {
                 lcd_set_screen_state(LCD_SCREEN_AP_MODE); // Set to AP mode screen
@@ -81,6 +147,7 @@ static void lcd_event_handler(void *handler_arg, esp_event_base_t base, int32_t
             esp_ip4_addr_t *ip_addr = (esp_ip4_addr_t *)event_data;
             sprintf(status_line_buffer, "IP: "IPSTR, IP2STR(ip_addr));
             ESP_LOGI(TAG, "WiFi connected, IP: "IPSTR, IP2STR(ip_addr));
+            status_line_version++;
             break;
         case EVENT_WIFI_DISCONNECTED:
             uint8_t disc_reason = *(uint8_t *)event_data;
@@ -99,12 +166,66 @@ static void lcd_event_handler(void *handler_arg, esp_event_base_t base, int32_t
                     sprintf(reason_buffer, "%3d", disc_reason);
                     memcpy(status_line_buffer + 15, reason_buffer, 3);
             }
+            status_line_version++;
+            break;
+        case EVENT_ALARM_RAISED:
+            if (lcd_screen_state != LCD_SCREEN_AP_MODE && lcd_screen_state != LCD_SCREEN_MENU)
+            {
+                lcd_set_screen_state(LCD_SCREEN_ALARM); // Bring the alarms to the front
+            }
+            break;
+        case EVENT_ALARM_CLEARED:
+            if (lcd_screen_state == LCD_SCREEN_ALARM && alarm_get_active_count() == 0)
+            {
+                lcd_set_screen_state(LCD_SCREEN_TEMP_AND_STATUS); // Last alarm cleared
+            }
+            break;
+        case EVENT_STATE_CHANGED:
+            if (lcd_screen_state >= LCD_SCREEN_STATUS_1 && lcd_screen_state <= LCD_SCREEN_STATUS_3)
+            {
+                lcd_wake_task(); // Show the change without waiting for the next refresh
+            }
+            break;
         default:
             break;
         }
     }
 }
 
+static void lcd_add_output(display_type_t type, uint16_t address, bool probe)
+{
+    if (output_count >= DISPLAY_MAX)
+    {
+        ESP_LOGE(TAG, "Only %d displays are supported", DISPLAY_MAX);
+        return;
+    }
+    lcd_output_t *output = &outputs[output_count];
+    memset(output, 0, sizeof(*output));
+    display_setup(&output->display, output_count, type, address, probe, i2c_bus_handle);
+    output_count++;
+}
+
+static bool lcd_connect_output(lcd_output_t *output)
+{
+    // (Re)connect a display, it comes back blank with an unknown CGRAM
+    display_t *display = &output->display;
+    if (display_connect(display) != ESP_OK)
+    {
+        if (!output->lost_logged)
+        {
+            ESP_LOGE(TAG, "%s display %d not found, retrying every %d to %d s", display_get_driver(display->type)->name,
+                     display->index, LCD_RECONNECT_MIN_MS / 1000, LCD_RECONNECT_MAX_MS / 1000);
+            output->lost_logged = true;
+        }
+        return false;
+    }
+    memset(output->shadow, ' ', LCD_BUFFER_SIZE);
+    output->glyph_valid_mask = 0;
+    output->backlight_valid = false;
+    output->lost_logged = false;
+    return true;
+}
+
 void i2c_initialize(void)
 {
     // Initialize the I2C master
@@ -118,56 +239,50 @@ void i2c_initialize(void)
     ESP_ERROR_CHECK(i2c_new_master_bus(&i2c_bus_config, &i2c_bus_handle));
     ESP_LOGI(TAG, "I2C bus initialized");
 
-    i2c_device_config_t i2c_device_config = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .device_address = LCD_I2C_ADDRESS,
-        .scl_speed_hz = I2C_MASTER_FREQ_HZ};
-    ESP_ERROR_CHECK(i2c_master_bus_add_device(i2c_bus_handle, &i2c_device_config, &i2c_device_handle));
-    ESP_LOGI(TAG, "I2C device added");
-    vTaskDelay(pdMS_TO_TICKS(50)); // Wait for LCD to power up
-    ESP_LOGI(TAG, "I2C device initialized");
-}
-
-static void lcd_init_cycle(void)
-{
-    // Initialize the LCD
-    ESP_ERROR_CHECK(i2c_send_with_toggle(lcd_backlight_status | LCD_ENABLE_OFF | LCD_RW_WRITE | LCD_RS_CMD));
-    ESP_ERROR_CHECK(i2c_send_with_toggle(COMMAND_8BIT_MODE | lcd_backlight_status | LCD_ENABLE_OFF | LCD_RW_WRITE | LCD_RS_CMD));
-    ESP_ERROR_CHECK(i2c_send_with_toggle(COMMAND_8BIT_MODE | lcd_backlight_status | LCD_ENABLE_OFF | LCD_RW_WRITE | LCD_RS_CMD));
-    ESP_ERROR_CHECK(i2c_send_with_toggle(COMMAND_8BIT_MODE | lcd_backlight_status | LCD_ENABLE_OFF | LCD_RW_WRITE | LCD_RS_CMD));
-    ESP_ERROR_CHECK(i2c_send_with_toggle(COMMAND_4BIT_MODE | lcd_backlight_status | LCD_ENABLE_OFF | LCD_RW_WRITE | LCD_RS_CMD));
+    // Fixed addresses are set up first, the main display probing skips them
+    output_count = 0;
+    lcd_add_output(DISPLAY_TYPE_HD44780, LCD_I2C_ADDRESS, true);
+#if CONFIG_LCD_SECOND_I2C_ADDRESS
+    lcd_add_output(DISPLAY_TYPE_HD44780, CONFIG_LCD_SECOND_I2C_ADDRESS, false);
+#endif
+#if CONFIG_LCD_SSD1306_ENABLE
+    lcd_add_output(DISPLAY_TYPE_SSD1306, CONFIG_LCD_SSD1306_I2C_ADDRESS, false);
+#endif
 
-    for (uint8_t i = 0; i < sizeof(INIT_COMMANDS); i++)
+    vTaskDelay(pdMS_TO_TICKS(50)); // Wait for the displays to power up
+    for (int i = output_count - 1; i >= 0; i--)
     {
-        ESP_ERROR_CHECK(i2c_send_4bit_data(INIT_COMMANDS[i], LCD_RS_CMD));
-        vTaskDelay(pdMS_TO_TICKS(1));
+        lcd_connect_output(&outputs[i]); // A missing display is retried by the update task
     }
-
-    lcd_toggle_backlight(true);
-    lcd_clear_buffer();
 }
 
 void lcd_initialize(void)
 {
     memset(status_line_buffer, ' ', LCD_COLS);
+    lcd_mutex = KERNEL_MUTEX_CREATE();
+    menu_initialize();
 
-    lcd_init_cycle(); // Initialize the LCD
-
-    lcd_render();
+    lcd_clear_buffer();
     lcd_render_cycle();
 
     events_subscribe(EVENT_BUTTON_SHORT_PRESS, lcd_event_handler, NULL); // Subscribe to button short press event
     events_subscribe(EVENT_BUTTON_LONG_PRESS, lcd_event_handler, NULL);  // Subscribe to button long press event
+    events_subscribe(EVENT_BUTTON_DOUBLE_CLICK, lcd_event_handler, NULL); // Subscribe to button double click event (menu)
+    events_subscribe(EVENT_BUTTON_HOLD_REPEAT, lcd_event_handler, NULL); // Subscribe to button hold repeat event (menu)
     events_subscribe(EVENT_WIFI_CONNECTED, lcd_event_handler, NULL);     // Subscribe to WiFi connected event
     events_subscribe(EVENT_WIFI_DISCONNECTED, lcd_event_handler, NULL);  // Subscribe to WiFi disconnected event
+    events_subscribe(EVENT_ALARM_RAISED, lcd_event_handler, NULL);       // Subscribe to alarm raised event
+    events_subscribe(EVENT_ALARM_CLEARED, lcd_event_handler, NULL);      // Subscribe to alarm cleared event
+    events_subscribe(EVENT_STATE_CHANGED, lcd_event_handler, NULL);      // Subscribe to running state changes (status screens)
 
-    // Create LCD update task
-    xTaskCreatePinnedToCore(lcd_update_task, "lcd_update_task", 4096, NULL, 5, NULL, 0);
+    // Create LCD update task, the only one writing to the displays
+    task_create(TASK_ID_LCD_UPDATE, lcd_update_task, NULL, &lcd_task_handle);
 }
 
 void lcd_set_screen_state(lcd_screen_state_t state)
 {
-    // Set the current screen state
+    // Set the current screen state, drawn by the update task
+    lcd_lock();
     if (state < LCD_SCREEN_MAX)
     {
         lcd_screen_state = state;
@@ -176,14 +291,20 @@ void lcd_set_screen_state(lcd_screen_state_t state)
     {
         lcd_screen_state = LCD_SCREEN_TEMP_AND_STATUS; // Default to temperature and average screen
     }
-    lcd_clear_buffer(); // Clear the buffer for the new screen
-    lcd_render_cycle(); // Render the new screen
+    lcd_layout_invalidate(); // Redraw the new screen from scratch
+    lcd_unlock();
+    lcd_wake_task();
 }
 
 void lcd_next_screen(void)
 {
-    // Cycle through the screens
-    if (lcd_screen_state >= LCD_SCREEN_TEMP_AND_STATUS)
+    // Cycle through the screens, leaving the alarm screen acknowledges it
+    lcd_lock();
+    if (lcd_screen_state == LCD_SCREEN_ALARM)
+    {
+        lcd_screen_state = LCD_SCREEN_TEMP_AND_STATUS;
+    }
+    else if (lcd_screen_state >= LCD_SCREEN_TEMP_AND_STATUS)
     {
         lcd_screen_state++;
     }
@@ -191,8 +312,9 @@ void lcd_next_screen(void)
     {
         lcd_screen_state = LCD_SCREEN_TEMP_AND_STATUS; // Loop back to the first screen
     }
-    lcd_clear_buffer(); // Clear the buffer for the new screen
-    lcd_render_cycle(); // Render the new screen
+    lcd_layout_invalidate(); // Redraw the new screen from scratch
+    lcd_unlock();
+    lcd_wake_task();
 }
 
 lcd_screen_state_t lcd_get_screen_state(void)
@@ -201,19 +323,6 @@ lcd_screen_state_t lcd_get_screen_state(void)
     return lcd_screen_state;
 }
 
-void lcd_set_cursor_position(uint8_t col, uint8_t row)
-{
-    // Set the cursor position on the LCD
-    if (col >= LCD_COLS)
-        col = LCD_COLS - 1;
-    if (row >= LCD_ROWS)
-        row = LCD_ROWS - 1;
-
-    static const uint8_t row_offsets[] = LCD_ROW_OFFSET;
-    uint8_t data = 0x80 | (col + row_offsets[row]);
-    ESP_ERROR_CHECK(i2c_send_4bit_data(data, LCD_RS_CMD));
-}
-
 void lcd_set_cursor(uint8_t col, uint8_t row)
 {
     // Update the cursor position in the buffer
@@ -284,31 +393,188 @@ void lcd_clear_buffer(void)
     lcd_set_cursor(0, 0);
 }
 
-void lcd_render(void)
+static bool lcd_flush_glyphs(lcd_output_t *output, const lcd_glyph_set_t *glyphs, uint8_t *changed_mask)
 {
-    // Render the buffer content to the LCD
-    for (uint8_t row = 0; row < LCD_ROWS; row++)
+    // Upload the custom characters the controller does not hold yet
+    display_t *display = &output->display;
+    const display_driver_t *driver = display_get_driver(display->type);
+    for (uint8_t slot = 0; slot < LCD_GLYPH_SLOTS; slot++)
     {
-        lcd_set_cursor_position(0, row);
-        for (uint8_t col = 0; col < LCD_COLS; col++)
+        if (!(glyphs->slot_mask & (1 << slot)) ||
+            ((output->glyph_valid_mask & (1 << slot)) && memcmp(output->glyphs[slot], glyphs->bitmaps[slot], LCD_GLYPH_ROWS) == 0))
         {
-            ESP_ERROR_CHECK(i2c_send_4bit_data(lcd_buffer[row * LCD_COLS + col], LCD_RS_DATA));
+            continue;
         }
+        driver->define_glyph(display, slot, glyphs->bitmaps[slot]);
+        if (display->failed)
+        {
+            return false; // CGRAM content unknown, uploaded again after the recovery
+        }
+        memcpy(output->glyphs[slot], glyphs->bitmaps[slot], LCD_GLYPH_ROWS);
+        output->glyph_valid_mask |= (1 << slot);
+        *changed_mask |= (1 << slot);
+        glyph_upload_count++;
     }
+    return true;
 }
 
-void lcd_toggle_backlight(bool state)
+static bool lcd_cell_is_dirty(const lcd_output_t *output, const char *frame, int index, uint8_t glyphs_changed)
+{
+    // Characters drawn with a redefined glyph are resent, a graphic display does not redraw them by itself
+    uint8_t c = (uint8_t)frame[index];
+    return c != (uint8_t)output->shadow[index] || (c < LCD_GLYPH_SLOTS && (glyphs_changed & (1 << c)));
+}
+
+static void lcd_flush_output(lcd_output_t *output, const char *frame, const lcd_glyph_set_t *glyphs, bool backlight)
 {
-    // Control the LCD backlight
-    if (state)
+    // Bring one display to the frame with the fewest transfers: changed runs only, a
+    // single unchanged character between two runs is resent instead of moving the cursor
+    display_t *display = &output->display;
+    const display_driver_t *driver = display_get_driver(display->type);
+    uint8_t glyphs_changed = 0;
+
+    if (display->failed && !lcd_connect_output(output))
     {
-        lcd_backlight_status |= LCD_BACKLIGHT;
+        return; // Display unreachable, retried on the next refresh
     }
-    else
+    if (lcd_redraw)
     {
-        lcd_backlight_status &= ~LCD_BACKLIGHT;
+        memset(output->shadow, 0xFF, LCD_BUFFER_SIZE);
     }
-    ESP_ERROR_CHECK(i2c_master_transmit(i2c_device_handle, &lcd_backlight_status, 1, -1));
+    if (!lcd_flush_glyphs(output, glyphs, &glyphs_changed))
+    {
+        return;
+    }
+    if (!output->backlight_valid || output->backlight_on != backlight)
+    {
+        driver->set_backlight(display, backlight);
+        output->backlight_on = backlight;
+        output->backlight_valid = !display->failed;
+    }
+
+    for (uint8_t row = 0; row < LCD_ROWS && !display->failed; row++)
+    {
+        int base = row * LCD_COLS;
+        uint8_t col = 0;
+        while (col < LCD_COLS && !display->failed)
+        {
+            if (!lcd_cell_is_dirty(output, frame, base + col, glyphs_changed))
+            {
+                col++;
+                continue;
+            }
+            uint8_t end = col + 1;
+            while (end < LCD_COLS)
+            {
+                if (lcd_cell_is_dirty(output, frame, base + end, glyphs_changed))
+                {
+                    end++;
+                }
+                else if (end + 1 < LCD_COLS && lcd_cell_is_dirty(output, frame, base + end + 1, glyphs_changed))
+                {
+                    end += 2;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            driver->set_cursor(display, col, row);
+            driver->write_run(display, frame + base + col, end - col);
+            if (!display->failed)
+            {
+                memcpy(output->shadow + base + col, frame + base + col, end - col);
+            }
+            col = end;
+        }
+    }
+    if (driver->flush != NULL && !display->failed)
+    {
+        driver->flush(display);
+    }
+}
+
+void lcd_render(void)
+{
+    // Send the frame to every display. The frame is copied under the lock, the transfers run without it.
+    char frame[LCD_BUFFER_SIZE];
+    lcd_glyph_set_t glyphs;
+    bool backlight;
+
+    lcd_lock();
+    memcpy(frame, lcd_buffer, LCD_BUFFER_SIZE);
+    glyphs = frame_glyphs;
+    backlight = lcd_backlight_on;
+    lcd_unlock();
+
+    INSTR_BEGIN(render_start);
+    for (uint8_t i = 0; i < output_count; i++)
+    {
+        lcd_flush_output(&outputs[i], frame, &glyphs, backlight);
+    }
+    lcd_redraw = false;
+    INSTR_END(INSTR_PATH_LCD_RENDER, render_start);
+}
+
+void lcd_invalidate(void)
+{
+    lcd_redraw = true;
+}
+
+void lcd_refresh(void)
+{
+    lcd_wake_task();
+}
+
+void lcd_define_glyph(uint8_t slot, const uint8_t bitmap[LCD_GLYPH_ROWS])
+{
+    // Set a custom character of the frame, uploaded by the next lcd_render() where it differs
+    if (slot >= LCD_GLYPH_SLOTS)
+    {
+        return;
+    }
+    memcpy(frame_glyphs.bitmaps[slot], bitmap, LCD_GLYPH_ROWS);
+    frame_glyphs.slot_mask |= (1 << slot);
+}
+
+void lcd_load_glyph_set(const lcd_glyph_set_t *set)
+{
+    for (uint8_t slot = 0; slot < LCD_GLYPH_SLOTS; slot++)
+    {
+        if (set->slot_mask & (1 << slot))
+        {
+            lcd_define_glyph(slot, set->bitmaps[slot]);
+        }
+    }
+}
+
+int lcd_get_display_count(void)
+{
+    return output_count;
+}
+
+esp_err_t lcd_get_bus_stats(int display_index, lcd_bus_stats_t *stats)
+{
+    if (display_index < 0 || display_index >= output_count || stats == NULL)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = outputs[display_index].display.stats;
+    return ESP_OK;
+}
+
+uint32_t lcd_get_glyph_upload_count(void)
+{
+    return glyph_upload_count;
+}
+
+void lcd_toggle_backlight(bool state)
+{
+    // Control the LCD backlight, switched by the update task
+    lcd_lock();
+    lcd_backlight_on = state;
+    lcd_unlock();
+    lcd_wake_task();
 }
 
 void lcd_format_temperature(float temp, char *buffer, size_t buffer_size)
@@ -335,159 +601,585 @@ void lcd_format_temperature(float temp, char *buffer, size_t buffer_size)
 
 void lcd_render_cycle()
 {
-    switch (lcd_screen_state)
+    // Draw the current screen into the frame and send it
+    lcd_lock();
+    lcd_draw_screen();
+    lcd_unlock();
+    lcd_render();
+}
+
+// Temperature field values: 0.1 °C, or a fault code below every possible temperature
+#define TEMP_KEY_FAULT(fault) (INT32_MIN + 1 + (fault))
+#define TEMP_KEY_IS_FAULT(key) ((key) < INT32_MIN + 1 + NTC_FAULT_MAX)
+
+typedef enum
+{
+    STATISTIC_MIN = 0,
+    STATISTIC_AVG,
+    STATISTIC_MAX
+} lcd_statistic_t;
+
+static void lcd_pad_text(const char *text, char *out, uint8_t width)
+{
+    // Copy text into a field, filling the rest with spaces
+    size_t length = strnlen(text, width);
+    memcpy(out, text, length);
+    memset(out + length, ' ', width - length);
+}
+
+static void lcd_format_deci(int32_t deci, char *buffer)
+{
+    // Same text as lcd_format_temperature() from a value in 0.1 °C
+    int32_t magnitude = deci < 0 ? -deci : deci;
+    buffer[0] = deci < 0 ? '-' : (magnitude >= 1000 ? (magnitude / 1000) % 10 + '0' : ' ');
+    buffer[1] = magnitude < 100 ? ' ' : (magnitude / 100) % 10 + '0';
+    buffer[2] = (magnitude / 10) % 10 + '0';
+    buffer[3] = '.';
+    buffer[4] = magnitude % 10 + '0';
+}
+
+static int lcd_slot_channel(int slot)
+{
+    // Probe shown in a slot, disabled probes do not take a slot
+    for (int i = 0; i < ntc_get_channel_count(); i++)
     {
-    case LCD_SCREEN_SPLASH:
-        lcd_splash_screen();
-        break;
-    case LCD_SCREEN_AP_MODE:
-        lcd_ap_mode_screen();
-        break;
-    case LCD_SCREEN_TEMP_AND_AVG:
-        lcd_temperaure_screen(true);
-        break;
-    case LCD_SCREEN_TEMP_AND_STATUS:
-        lcd_temperaure_screen(false);
-        lcd_status_line();
-        break;
-    case LCD_SCREEN_STATUS_1:
-    case LCD_SCREEN_STATUS_2:
-    case LCD_SCREEN_STATUS_3:
-        lcd_status_screen(lcd_screen_state - LCD_SCREEN_STATUS_1);
-        break;
-    default:
-        break;
+        if (ntc_channel_is_enabled(i) && slot-- == 0)
+        {
+            return i;
+        }
     }
-    lcd_render(); // Render the current screen
+    return -1;
 }
 
-void lcd_splash_screen(void)
+static int32_t lcd_temperature_key(int channel)
 {
-    // Display the splash screen on the LCD
-    lcd_clear_buffer();
-    lcd_set_cursor(0, 0);
-    lcd_write_text("   Splash Screen    ");
-    lcd_set_cursor(0, 1);
-    lcd_write_text("LCD Temperature test");
-    lcd_set_cursor(0, 2);
-    lcd_write_text("   Splash Screen    ");
-    lcd_set_cursor(0, 3);
-    lcd_write_text("LCD Test            ");
+    ntc_fault_t fault = ntc_get_channel_fault(channel);
+    float temp = ntc_get_channel_temperature(channel);
+    if (fault != NTC_FAULT_NONE)
+    {
+        return TEMP_KEY_FAULT(fault);
+    }
+    return isnan(temp) ? LCD_FIELD_BLANK : (int32_t)(temp * 10); // Truncated like lcd_format_temperature()
 }
 
-void lcd_ap_mode_screen(void)
+static int32_t lcd_slot_name_source(int slot)
 {
-    running_config_t *running_config = get_running_config(); // Get the running configuration
-    // Display the AP mode screen on the LCD
-    lcd_clear_buffer();
-    lcd_set_cursor(0, 0);
-    lcd_write_text(" AP Mode - SSID:");
-    lcd_set_cursor(0, 1);
-    lcd_write_text(running_config->ap_ssid);
-    lcd_set_cursor(0, 2);
-    lcd_write_text(" Password: ");
-    lcd_set_cursor(0, 3);
-    lcd_write_text(running_config->ap_pass);
+    int channel = lcd_slot_channel(slot);
+    return channel < 0 ? LCD_FIELD_BLANK : channel;
 }
 
-void lcd_status_screen(int8_t index)
+static void lcd_probe_name_format(int32_t channel, int slot, char *out, uint8_t width)
 {
-    //running_config_t *running_config = get_running_config(); // Get the running configuration
-    // Display the status screen on the LCD
-    lcd_clear_buffer();
-    lcd_set_cursor(0, 0);
-    lcd_write_text("WiFi STA: ");
-    lcd_write_character(index + '1');
-    lcd_set_cursor(0, 1);
-    lcd_write_text("WiFi: ");
-    
-    /*EventBits_t bits = xEventGroupGetBits(get_event_group());
-    if (bits & WIFI_CONNECTED_BIT) {
-        lcd_write_text("Connected");
-    } else {
-        lcd_write_text("Disconnected");
-    }*/
+    // "T1:"
+    char text[LCD_COLS + 1];
+    snprintf(text, sizeof(text), "%s:", ntc_get_channel_config(channel)->name);
+    lcd_pad_text(text, out, width);
 }
 
-void lcd_status_line(void)
+static int32_t lcd_slot_temperature_source(int slot)
 {
-    // Display the status line on the LCD
-    memcpy(lcd_buffer + 3 * LCD_COLS, status_line_buffer, LCD_COLS);
+    int channel = lcd_slot_channel(slot);
+    return channel < 0 ? LCD_FIELD_BLANK : lcd_temperature_key(channel);
 }
 
-void lcd_temperaure_screen(bool bottom_statistics)
+static void lcd_temperature_format(int32_t key, int slot, char *out, uint8_t width)
 {
-    // Display temperature data on the LCD
-    lcd_clear_buffer();
-
-    char bgBuffer[] = "T1:     C  T4:     C";
-    lcd_set_cursor(0, 0);
-    lcd_copy_to_buffer(bgBuffer, strlen(bgBuffer), 0, 0);
-    bgBuffer[1] = '2';
-    bgBuffer[12] = '5';
-    lcd_set_cursor(0, 1);
-    lcd_copy_to_buffer(bgBuffer, strlen(bgBuffer), 0, 1);
-    bgBuffer[1] = '3';
-    bgBuffer[12] = '6';
-    lcd_set_cursor(0, 2);
-    lcd_copy_to_buffer(bgBuffer, strlen(bgBuffer), 0, 2);
-    if (bottom_statistics)
-    {
-        static const char avgBuffer[] = "     C<     C<     C";
-        lcd_set_cursor(0, 3);
-        lcd_copy_to_buffer(avgBuffer, strlen(avgBuffer), 0, 3);
+    // " 23.4C" when the field has room for the unit, faults in place of the value, e.g. " OPEN"
+    char text[LCD_COLS + 1];
+    if (TEMP_KEY_IS_FAULT(key))
+    {
+        snprintf(text, sizeof(text), "%5s", ntc_sensor_get_fault_name(key - TEMP_KEY_FAULT(0)));
     }
+    else
+    {
+        lcd_format_deci(key, text);
+        text[5] = 'C';
+        text[width > 5 ? 6 : 5] = '\0';
+    }
+    lcd_pad_text(text, out, width);
+}
 
-    char buffer[6] = {0};
+static int32_t lcd_statistic_source(int statistic)
+{
+    // Minimum, average or maximum of the probes on the temperature screen, faulted probes left out
     float min_temp = 200.0;
     float max_temp = -20.0;
     float avg_temp = 0.0;
+    int valid_count = 0;
+
+    for (int slot = 0; slot < LCD_TEMP_SLOTS; slot++)
+    {
+        int channel = lcd_slot_channel(slot);
+        if (channel < 0)
+        {
+            break;
+        }
+        float temp = ntc_get_channel_temperature(channel);
+        if (ntc_get_channel_fault(channel) != NTC_FAULT_NONE || isnan(temp))
+        {
+            continue;
+        }
+        min_temp = temp < min_temp ? temp : min_temp;
+        max_temp = temp > max_temp ? temp : max_temp;
+        avg_temp += temp;
+        valid_count++;
+    }
+    if (valid_count == 0)
+    {
+        return LCD_FIELD_BLANK;
+    }
+
+    switch (statistic)
+    {
+    case STATISTIC_MIN:
+        return (int32_t)(min_temp * 10);
+    case STATISTIC_MAX:
+        return (int32_t)(max_temp * 10);
+    default:
+        return (int32_t)(avg_temp / valid_count * 10);
+    }
+}
+
+static void lcd_deci_format(int32_t deci, int arg, char *out, uint8_t width)
+{
+    char text[6] = {0};
+    lcd_format_deci(deci, text);
+    lcd_pad_text(text, out, width);
+}
+
+static int32_t lcd_status_line_source(int arg)
+{
+    return status_line_version;
+}
+
+static void lcd_status_line_format(int32_t version, int arg, char *out, uint8_t width)
+{
+    lcd_pad_text(status_line_buffer, out, width); // The IP text is NUL terminated
+}
+
+static const char *lcd_ap_text(int index)
+{
+    running_config_t *running_config = get_running_config();
+    return index == 0 ? running_config->ap_ssid : running_config->ap_pass;
+}
+
+static int32_t lcd_ap_text_source(int index)
+{
+    // FNV-1a of the shown text, the running configuration has no change counter
+    uint32_t hash = 2166136261u;
+    for (const char *c = lcd_ap_text(index); *c != '\0'; c++)
+    {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    return hash == (uint32_t)LCD_FIELD_BLANK ? hash + 1 : hash;
+}
+
+static void lcd_ap_text_format(int32_t hash, int index, char *out, uint8_t width)
+{
+    lcd_pad_text(lcd_ap_text(index), out, width);
+}
+
+typedef enum
+{
+    STATUS_WIFI = 0,
+    STATUS_IP,
+    STATUS_RSSI,
+    STATUS_AP_MODE,
+    STATUS_SAMPLE_RATE,
+    STATUS_ALARMS,
+    STATUS_FAULTS,
+    STATUS_UPTIME,
+    STATUS_STATE_VERSION,
+    STATUS_CONFIG_GENERATION,
+    STATUS_PUBLISHES,
+} lcd_status_item_t;
+
+static int32_t lcd_status_source(int item)
+{
+    // Values of the running state snapshot taken for this frame
+    const running_state_t *state = &frame_state;
+    switch (item)
+    {
+    case STATUS_WIFI:
+        return state->ip_address != 0 ? -1 : state->wifi_sta_connection_state;
+    case STATUS_IP:
+        return (int32_t)state->ip_address;
+    case STATUS_RSSI:
+        return state->rssi;
+    case STATUS_AP_MODE:
+        return state->wifi_ap_mode;
+    case STATUS_SAMPLE_RATE:
+        return (int32_t)state->sample_rate_centi_hz;
+    case STATUS_ALARMS:
+        return (int32_t)((state->alarm_count << 16) | (state->alarm_channel_mask & 0xFFFF));
+    case STATUS_FAULTS:
+        return (int32_t)state->fault_channel_mask;
+    case STATUS_UPTIME:
+        return (int32_t)state->uptime_s;
+    case STATUS_STATE_VERSION:
+        return (int32_t)state->version;
+    case STATUS_CONFIG_GENERATION:
+        return (int32_t)config_get_generation();
+    case STATUS_PUBLISHES:
+        return (int32_t)ntc_get_publish_count();
+    default:
+        return LCD_FIELD_BLANK;
+    }
+}
+
+static void lcd_status_probe_list(uint32_t mask, char *text, size_t size)
+{
+    // Names of the probes in a mask, e.g. "T1 T4"
+    size_t length = 0;
+    text[0] = '\0';
+    for (int i = 0; i < ntc_get_channel_count() && length < size; i++)
+    {
+        if (mask & (1u << i))
+        {
+            length += snprintf(text + length, size - length, "%s%s", length > 0 ? " " : "", ntc_get_channel_config(i)->name);
+        }
+    }
+}
+
+static void lcd_status_format(int32_t value, int item, char *out, uint8_t width)
+{
+    char text[LCD_COLS + 8] = ""; // Room for a 16-bit count before a full probe list, cut to the width below
+    char probes[LCD_COLS + 1];
+    uint32_t u = (uint32_t)value;
+
+    switch (item)
+    {
+    case STATUS_WIFI:
+        if (value < 0)
+        {
+            snprintf(text, sizeof(text), "connected");
+        }
+        else if (value == 0)
+        {
+            snprintf(text, sizeof(text), "connecting");
+        }
+        else if (value == 201) // WIFI_REASON_NO_AP_FOUND
+        {
+            snprintf(text, sizeof(text), "No AP found");
+        }
+        else if (value == 202) // WIFI_REASON_AUTH_FAIL
+        {
+            snprintf(text, sizeof(text), "Auth failed");
+        }
+        else
+        {
+            snprintf(text, sizeof(text), "disconn. %3ld", (long)value);
+        }
+        break;
+    case STATUS_IP:
+        if (u == 0)
+        {
+            snprintf(text, sizeof(text), "-");
+        }
+        else
+        {
+            esp_ip4_addr_t ip_addr = {.addr = u};
+            snprintf(text, sizeof(text), IPSTR, IP2STR(&ip_addr));
+        }
+        break;
+    case STATUS_RSSI:
+        snprintf(text, sizeof(text), value == 0 ? "-" : "%ld dBm", (long)value);
+        break;
+    case STATUS_AP_MODE:
+        snprintf(text, sizeof(text), value ? "on" : "off");
+        break;
+    case STATUS_SAMPLE_RATE:
+        snprintf(text, sizeof(text), "%lu.%02lu/s", (unsigned long)(u / 100), (unsigned long)(u % 100));
+        break;
+    case STATUS_ALARMS:
+        lcd_status_probe_list(u & 0xFFFF, probes, sizeof(probes));
+        snprintf(text, sizeof(text), "%lu %s", (unsigned long)(u >> 16), probes);
+        break;
+    case STATUS_FAULTS:
+        lcd_status_probe_list(u, probes, sizeof(probes));
+        snprintf(text, sizeof(text), "%s", u == 0 ? "none" : probes);
+        break;
+    case STATUS_UPTIME:
+        snprintf(text, sizeof(text), "%lud %02lu:%02lu:%02lu", (unsigned long)(u / 86400), (unsigned long)(u / 3600 % 24),
+                 (unsigned long)(u / 60 % 60), (unsigned long)(u % 60));
+        break;
+    default:
+        snprintf(text, sizeof(text), "%lu", (unsigned long)u);
+        break;
+    }
+    lcd_pad_text(text, out, width);
+}
 
-    for (int i = 0; i < 6; i++)
+static int32_t lcd_sparkline_source(int slot)
+{
+    // The sparkline only changes when a history point is closed
+    int channel = lcd_slot_channel(slot);
+    return channel < 0 ? LCD_FIELD_BLANK : (int32_t)(history_get_point_count() * NTC_MAX_CHANNELS + channel);
+}
+
+static void lcd_sparkline_format(int32_t key, int slot, char *out, uint8_t width)
+{
+    // Newest point on the right, scaled between the lowest and highest point shown
+    int16_t points[LCD_COLS];
+    int count = history_get_channel(key % NTC_MAX_CHANNELS, points, width);
+    int16_t low = INT16_MAX;
+    int16_t high = INT16_MIN;
+
+    for (int i = 0; i < count; i++)
     {
-        float temp = ntc_adc_raw_to_temperature(ntc_get_channel_data(i));
-        if (bottom_statistics && temp < min_temp)
+        if (points[i] == HISTORY_INVALID)
         {
-            min_temp = temp;
+            continue;
         }
-        if (bottom_statistics && temp > max_temp)
+        low = points[i] < low ? points[i] : low;
+        high = points[i] > high ? points[i] : high;
+    }
+    if (high - low < 10)
+    {
+        low = (low + high) / 2 - 5; // Keep a 1 °C span, sensor noise should not fill the scale
+        high = low + 10;
+    }
+
+    memset(out, ' ', width);
+    for (int i = 0; i < count; i++)
+    {
+        if (points[i] == HISTORY_INVALID)
         {
-            max_temp = temp;
+            continue; // Gaps stay blank
         }
-        if (bottom_statistics)
+        int level = ((points[i] - low) * (LCD_GLYPH_SLOTS - 1) + (high - low) / 2) / (high - low);
+        out[width - count + i] = (char)level;
+    }
+}
+
+static int32_t lcd_bar_source(int slot)
+{
+    // Filled pixel columns, scaled between the alarm limits or the range of the history if the channel has no rules
+    int channel = lcd_slot_channel(slot);
+    if (channel < 0 || ntc_get_channel_fault(channel) != NTC_FAULT_NONE || isnan(ntc_get_channel_temperature(channel)))
+    {
+        return LCD_FIELD_BLANK;
+    }
+
+    float temp = ntc_get_channel_temperature(channel);
+    alarm_channel_config_t alarm_config;
+    float low;
+    float high;
+
+    if (alarm_get_channel_config(channel, &alarm_config) == ESP_OK && alarm_config.enabled)
+    {
+        low = alarm_config.low_centi / 100.0f;
+        high = alarm_config.high_centi / 100.0f;
+    }
+    else
+    {
+        int16_t low_deci;
+        int16_t high_deci;
+        low = temp;
+        high = temp;
+        if (history_get_range(channel, &low_deci, &high_deci) > 0)
         {
-            avg_temp += temp;
+            low = low_deci / 10.0f < low ? low_deci / 10.0f : low;
+            high = high_deci / 10.0f > high ? high_deci / 10.0f : high;
         }
-        lcd_set_cursor(i < 3 ? 3 : 14, i % 3);
-        lcd_format_temperature(temp, buffer, sizeof(buffer));
-        lcd_write_text(buffer);
+    }
+    if (high - low < 1.0f)
+    {
+        high = low + 1.0f;
     }
 
-    if (!bottom_statistics)
+    int pixels = (int)((temp - low) * LCD_GRAPH_CELLS * 5 / (high - low) + 0.5f);
+    if (pixels < 0)
     {
-        return; // No statistics to display
+        pixels = 0;
     }
+    return pixels > LCD_GRAPH_CELLS * 5 ? LCD_GRAPH_CELLS * 5 : pixels;
+}
 
-    avg_temp /= 6.0;
-    lcd_set_cursor(0, 3);
-    lcd_format_temperature(min_temp, buffer, sizeof(buffer));
-    lcd_write_text(buffer);
+static void lcd_bar_format(int32_t pixels, int slot, char *out, uint8_t width)
+{
+    for (int cell = 0; cell < width; cell++, pixels -= 5)
+    {
+        char c = ' ';
+        if (pixels >= 5)
+        {
+            c = BAR_GLYPH_FULL;
+        }
+        else if (pixels > 0)
+        {
+            c = (char)(pixels - 1); // Partial cell of 1-4 columns
+        }
+        out[cell] = c;
+    }
+}
 
-    lcd_set_cursor(7, 3);
-    lcd_format_temperature(avg_temp, buffer, sizeof(buffer));
-    lcd_write_text(buffer);
+// Probe slot of the temperature screens: "T1: 23.4C" in the left (slots 0-2) or right (slots 3-5) column
+#define TEMP_SLOT(slot) \
+    LCD_FIELD((slot) < 3 ? 0 : 11, (slot) % 3, 3, lcd_slot_name_source, lcd_probe_name_format, (slot), 1000), \
+    LCD_FIELD(((slot) < 3 ? 0 : 11) + 3, (slot) % 3, 6, lcd_slot_temperature_source, lcd_temperature_format, (slot), 0)
 
-    lcd_set_cursor(14, 3);
-    lcd_format_temperature(max_temp, buffer, sizeof(buffer));
-    lcd_write_text(buffer);
+// Probe row of the history screens: "T1:<12 graph cells> 23.4"
+#define GRAPH_ROW(row, source, format, refresh_ms) \
+    LCD_FIELD(0, (row), 3, lcd_slot_name_source, lcd_probe_name_format, (row), 1000), \
+    LCD_FIELD(3, (row), LCD_GRAPH_CELLS, (source), (format), (row), (refresh_ms)), \
+    LCD_FIELD(3 + LCD_GRAPH_CELLS, (row), 5, lcd_slot_temperature_source, lcd_temperature_format, (row), 0)
+
+static const lcd_widget_t splash_widgets[] = {
+    LCD_LABEL(0, 0, "   Splash Screen    "),
+    LCD_LABEL(0, 1, "LCD Temperature test"),
+    LCD_LABEL(0, 2, "   Splash Screen    "),
+    LCD_LABEL(0, 3, "LCD Test            "),
+};
+
+static const lcd_widget_t ap_mode_widgets[] = {
+    LCD_LABEL(0, 0, " AP Mode - SSID:"),
+    LCD_FIELD(0, 1, LCD_COLS, lcd_ap_text_source, lcd_ap_text_format, 0, 1000),
+    LCD_LABEL(0, 2, " Password: "),
+    LCD_FIELD(0, 3, LCD_COLS, lcd_ap_text_source, lcd_ap_text_format, 1, 1000),
+};
+
+static const lcd_widget_t temp_and_status_widgets[] = {
+    TEMP_SLOT(0), TEMP_SLOT(1), TEMP_SLOT(2), TEMP_SLOT(3), TEMP_SLOT(4), TEMP_SLOT(5),
+    LCD_FIELD(0, 3, LCD_COLS, lcd_status_line_source, lcd_status_line_format, 0, 0),
+};
+
+static const lcd_widget_t temp_and_avg_widgets[] = {
+    TEMP_SLOT(0), TEMP_SLOT(1), TEMP_SLOT(2), TEMP_SLOT(3), TEMP_SLOT(4), TEMP_SLOT(5),
+    LCD_LABEL(0, 3, "     C<     C<     C"),
+    LCD_FIELD(0, 3, 5, lcd_statistic_source, lcd_deci_format, STATISTIC_MIN, 0),
+    LCD_FIELD(7, 3, 5, lcd_statistic_source, lcd_deci_format, STATISTIC_AVG, 0),
+    LCD_FIELD(14, 3, 5, lcd_statistic_source, lcd_deci_format, STATISTIC_MAX, 0),
+};
+
+static const lcd_widget_t trend_widgets[] = {
+    GRAPH_ROW(0, lcd_sparkline_source, lcd_sparkline_format, 1000),
+    GRAPH_ROW(1, lcd_sparkline_source, lcd_sparkline_format, 1000),
+    GRAPH_ROW(2, lcd_sparkline_source, lcd_sparkline_format, 1000),
+    GRAPH_ROW(3, lcd_sparkline_source, lcd_sparkline_format, 1000),
+};
+
+static const lcd_widget_t bar_widgets[] = {
+    GRAPH_ROW(0, lcd_bar_source, lcd_bar_format, 0),
+    GRAPH_ROW(1, lcd_bar_source, lcd_bar_format, 0),
+    GRAPH_ROW(2, lcd_bar_source, lcd_bar_format, 0),
+    GRAPH_ROW(3, lcd_bar_source, lcd_bar_format, 0),
+};
+
+#define STATUS_ROW(row, label, item, refresh_ms) \
+    LCD_LABEL(0, (row), label), \
+    LCD_FIELD(sizeof(label) - 1, (row), LCD_COLS - (sizeof(label) - 1), lcd_status_source, lcd_status_format, (item), (refresh_ms))
+
+static const lcd_widget_t status_network_widgets[] = {
+    STATUS_ROW(0, "WiFi: ", STATUS_WIFI, 0),
+    STATUS_ROW(1, "IP: ", STATUS_IP, 0),
+    STATUS_ROW(2, "RSSI: ", STATUS_RSSI, 0),
+    STATUS_ROW(3, "AP mode: ", STATUS_AP_MODE, 0),
+};
+
+static const lcd_widget_t status_acquisition_widgets[] = {
+    STATUS_ROW(0, "Rate: ", STATUS_SAMPLE_RATE, 0),
+    STATUS_ROW(1, "Alarms: ", STATUS_ALARMS, 0),
+    STATUS_ROW(2, "Faults: ", STATUS_FAULTS, 0),
+    STATUS_ROW(3, "Publishes: ", STATUS_PUBLISHES, 1000),
+};
+
+static const lcd_widget_t status_system_widgets[] = {
+    STATUS_ROW(0, "Uptime: ", STATUS_UPTIME, 1000),
+    STATUS_ROW(1, "State changes: ", STATUS_STATE_VERSION, 0),
+    STATUS_ROW(2, "Config saves: ", STATUS_CONFIG_GENERATION, 0),
+};
+
+// Screens described by a layout, the others are built by hand on every frame
+static const lcd_layout_t screen_layouts[LCD_SCREEN_MAX] = {
+    [LCD_SCREEN_SPLASH] = LCD_LAYOUT(splash_widgets, NULL),
+    [LCD_SCREEN_AP_MODE] = LCD_LAYOUT(ap_mode_widgets, NULL),
+    [LCD_SCREEN_TEMP_AND_STATUS] = LCD_LAYOUT(temp_and_status_widgets, NULL),
+    [LCD_SCREEN_TEMP_AND_AVG] = LCD_LAYOUT(temp_and_avg_widgets, NULL),
+    [LCD_SCREEN_TREND] = LCD_LAYOUT(trend_widgets, &SPARKLINE_GLYPHS),
+    [LCD_SCREEN_BARS] = LCD_LAYOUT(bar_widgets, &BAR_GLYPHS),
+    [LCD_SCREEN_STATUS_1] = LCD_LAYOUT(status_network_widgets, NULL),
+    [LCD_SCREEN_STATUS_2] = LCD_LAYOUT(status_acquisition_widgets, NULL),
+    [LCD_SCREEN_STATUS_3] = LCD_LAYOUT(status_system_widgets, NULL),
+};
+
+static void lcd_draw_screen(void)
+{
+    // Fill the buffer for the current screen, called with the display locked
+    const lcd_layout_t *layout = lcd_screen_state == LCD_SCREEN_MENU ? menu_get_layout() : &screen_layouts[lcd_screen_state];
+    state_get_snapshot(&frame_state); // One consistent state for every field of the frame
+    if (layout->widgets != NULL)
+    {
+        lcd_layout_render(layout); // Unchanged fields are not formatted again
+        return;
+    }
+
+    lcd_layout_invalidate(); // Whatever was drawn, the next layout starts from scratch
+    switch (lcd_screen_state)
+    {
+    case LCD_SCREEN_ALARM:
+        lcd_alarm_screen();
+        break;
+    default:
+        break;
+    }
+}
+
+void lcd_alarm_screen(void)
+{
+    // Display the active alarms, one per row below the header
+    char buffer[6] = {0};
+    char header[LCD_COLS + 1];
+    uint8_t row = 1;
+    uint32_t active_count = alarm_get_active_count();
+
+    lcd_clear_buffer();
+    snprintf(header, sizeof(header), "!! ALARM !! %2u act.", (unsigned)(active_count < 99 ? active_count : 99));
+    lcd_set_cursor(0, 0);
+    lcd_write_text(header);
+
+    for (int i = 0; i < ntc_get_channel_count() && row < LCD_ROWS; i++)
+    {
+        uint32_t flags = alarm_get_active_flags(i);
+        for (int type = 0; type < ALARM_TYPE_MAX && row < LCD_ROWS; type++)
+        {
+            if (!(flags & ALARM_FLAG(type)))
+            {
+                continue;
+            }
+            // Row layout: "T1 HIGH      87.3C", a latched alarm of a faulted probe shows the fault
+            float temp = ntc_get_channel_temperature(i);
+            lcd_set_cursor(0, row);
+            lcd_write_text(ntc_get_channel_config(i)->name);
+            lcd_set_cursor(3, row);
+            lcd_write_text(alarm_get_type_name(type));
+            lcd_set_cursor(13, row);
+            if (isnan(temp))
+            {
+                lcd_write_text(ntc_sensor_get_fault_name(ntc_get_channel_fault(i)));
+            }
+            else
+            {
+                lcd_format_temperature(temp, buffer, sizeof(buffer));
+                lcd_write_text(buffer);
+                lcd_write_character('C');
+            }
+            row++;
+        }
+    }
 }
 
 void lcd_update_task(void *pvParameter)
 {
-    // Periodically update the LCD
+    // Periodically update the displays, woken early by screen and backlight changes. With the
+    // backlight off nobody reads the screen, so the task sleeps until it is woken.
     while (1)
     {
+        power_awake_begin(POWER_TASK_LCD);
         lcd_render_cycle();
-        vTaskDelay(pdMS_TO_TICKS(500)); // Update every second
+        power_awake_end(POWER_TASK_LCD);
+        lcd_lock();
+        bool backlight = lcd_backlight_on;
+        lcd_unlock();
+        ulTaskNotifyTake(pdTRUE, backlight ? pdMS_TO_TICKS(LCD_REFRESH_PERIOD_MS) : portMAX_DELAY);
     }
 }
\ No newline at end of file
@@ -12,8 +12,14 @@
 #define I2C_MASTER_NUM        I2C_NUM_0
 #define I2C_MASTER_SDA_IO     14
 #define I2C_MASTER_SCL_IO     15
-#define I2C_MASTER_FREQ_HZ    100000
-#define LCD_I2C_ADDRESS       0x27    // Adjust to your PCF8574 address
+#define I2C_MASTER_FREQ_HZ    CONFIG_LCD_I2C_FREQ_HZ    // Highest speed tried, see LCD_I2C_SPEED_LADDER
+#define LCD_I2C_ADDRESS       CONFIG_LCD_I2C_ADDRESS    // Main display, probed first, see lcd_get_bus_stats() for the detected one
+#define LCD_I2C_TIMEOUT_MS    CONFIG_LCD_I2C_TIMEOUT_MS
+#define LCD_I2C_SPEED_COUNT   3
+#define LCD_I2C_SPEED_LADDER  {400000, 100000, 50000} // Fallback order on repeated transfer errors
+#define LCD_I2C_ERROR_DECAY   256                       // Clean transfers that forgive one error counted towards the fallback
+#define LCD_RECONNECT_MIN_MS  1000                      // Delay after the first failed reconnect, doubled on each failure
+#define LCD_RECONNECT_MAX_MS  60000                     // Longest delay between reconnects of a missing display
 
 // LCD commands
 #define WRITE_BIT           I2C_MASTER_WRITE
@@ -36,27 +42,60 @@
 #define LCD_ROWS 4
 #define LCD_ROW_OFFSET {0x00, 0x40, 0x14, 0x54} // Row offsets for 20x4 LCD
 #define LCD_BUFFER_SIZE (LCD_COLS * LCD_ROWS)
+#define LCD_TEMP_SLOTS 6 // Probes shown on the temperature screens (2 columns x 3 rows)
+#define LCD_GRAPH_CELLS 12 // Sparkline points / bar graph cells per probe row
+#define LCD_GLYPH_SLOTS 8 // CGRAM characters 0-7
+#define LCD_GLYPH_ROWS 8  // 5x8 font, one byte per pixel row, bits 4-0 from left to right
+
+#if CONFIG_POWER_LOW_POWER_MODE
+#define LCD_REFRESH_PERIOD_MS CONFIG_POWER_LCD_REFRESH_MS
+#else
+#define LCD_REFRESH_PERIOD_MS 500
+#endif
 
 typedef enum {
     LCD_SCREEN_SPLASH = 0,
     LCD_SCREEN_AP_MODE,
+    LCD_SCREEN_ALARM,                   // Shown while alarms are active, not part of the rotation
+    LCD_SCREEN_MENU,                    // Settings menu, drawn from the menu layout, not part of the rotation
     LCD_SCREEN_TEMP_AND_STATUS,
     LCD_SCREEN_TEMP_AND_AVG,
+    LCD_SCREEN_TREND,                   // History sparklines
+    LCD_SCREEN_BARS,                    // Bar graphs of the current values
     LCD_SCREEN_STATUS_1,
     LCD_SCREEN_STATUS_2,
     LCD_SCREEN_STATUS_3,
     LCD_SCREEN_MAX
 } lcd_screen_state_t;
 
-// Initialize the I2C master.
+typedef struct
+{
+    uint32_t speed_hz;
+    uint32_t transactions;           // Transfers attempted at this speed
+    uint32_t errors;                 // NACKs, timeouts and bus errors at this speed
+} lcd_bus_speed_stats_t;
+
+typedef struct
+{
+    uint16_t address;                // Detected display address, 0 while it does not answer
+    uint32_t speed_hz;               // Current bus speed
+    uint32_t recoveries;             // Reconnections that brought the display back
+    lcd_bus_speed_stats_t speeds[LCD_I2C_SPEED_COUNT];
+} lcd_bus_stats_t;
+
+// Custom characters for CGRAM, slots outside of slot_mask are left as they are
+typedef struct
+{
+    uint8_t slot_mask;
+    uint8_t bitmaps[LCD_GLYPH_SLOTS][LCD_GLYPH_ROWS];
+} lcd_glyph_set_t;
+
+// Initialize the I2C master and connect the configured displays.
 void i2c_initialize(void);
 
 // Initialize the LCD.
 void lcd_initialize(void);
 
-// Set the cursor position on the LCD.
-void lcd_set_cursor_position(uint8_t col, uint8_t row);
-
 // Update the cursor position in the buffer.
 void lcd_set_cursor(uint8_t col, uint8_t row);
 
@@ -75,32 +114,42 @@ void lcd_copy_to_buffer(const char *data, size_t size, int8_t col, int8_t row);
 // Clear the LCD buffer.
 void lcd_clear_buffer(void);
 
-// Render the buffer content to the LCD.
+// Set a custom character of the frame, displays get it on the next render unless they hold it. Called with the display locked.
+void lcd_define_glyph(uint8_t slot, const uint8_t bitmap[LCD_GLYPH_ROWS]);
+
+// Set the slots of a glyph set in the frame. Called with the display locked.
+void lcd_load_glyph_set(const lcd_glyph_set_t *set);
+
+// Get the number of glyphs uploaded to the displays since initialization.
+uint32_t lcd_get_glyph_upload_count(void);
+
+// Send the buffer to every display, only the characters that differ from what a display shows.
+// Called from the update task only, without the display lock.
 void lcd_render(void);
 
+// Make the next lcd_render() send every character.
+void lcd_invalidate(void);
+
+// Draw and send the current screen now instead of at the next refresh.
+void lcd_refresh(void);
+
 // Control the LCD backlight.
 void lcd_toggle_backlight(bool state);
 
 // Format temperature as a string.
 void lcd_format_temperature(float temp, char *buffer, size_t buffer_size);
 
-// Render the LCD cycle.
-void lcd_render_cycle(void);
-
-// Display an array of temperatures on the LCD.
-void lcd_temperaure_screen(bool bottom_statistics);
+// Get the number of configured displays, the main display is index 0.
+int lcd_get_display_count(void);
 
-// Display the status line on the LCD.
-void lcd_status_line(void);
+// Get the bus state and the per-speed transfer counters of a display.
+esp_err_t lcd_get_bus_stats(int display_index, lcd_bus_stats_t *stats);
 
-// Display a list of status messages on the LCD.
-void lcd_status_screen(int8_t index);
-
-// Display the splash screen on the LCD.
-void lcd_splash_screen(void);
+// Draw the current screen and send it to the displays.
+void lcd_render_cycle(void);
 
-// Display the access point mode screen on the LCD.
-void lcd_ap_mode_screen(void);
+// Display the active alarms on the LCD.
+void lcd_alarm_screen(void);
 
 // Get the current screen state.
 lcd_screen_state_t lcd_get_screen_state(void);
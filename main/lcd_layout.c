@@ -0,0 +1,95 @@
+#include "lcd_layout.h"
+#include "esp_timer.h"
+#include <string.h>
+
+static const char *TAG = "LCD_LAYOUT";
+
+// Field cache of the layout on the screen, indexed like its widgets
+static const lcd_layout_t *active_layout = NULL;
+static int32_t field_value[LCD_LAYOUT_MAX_WIDGETS];
+static int64_t field_read_us[LCD_LAYOUT_MAX_WIDGETS];
+static uint32_t format_count = 0;
+
+static void lcd_layout_format_field(const lcd_widget_t *widget, int32_t value)
+{
+    char text[LCD_COLS];
+    uint8_t width = widget->width <= LCD_COLS ? widget->width : LCD_COLS;
+
+    if (value == LCD_FIELD_BLANK)
+    {
+        memset(text, ' ', width);
+    }
+    else
+    {
+        widget->format(value, widget->arg, text, width);
+    }
+    lcd_copy_to_buffer(text, width, widget->col, widget->row);
+    format_count++;
+}
+
+static void lcd_layout_enter(const lcd_layout_t *layout, int64_t now)
+{
+    // Labels are drawn once, every field is formatted from a fresh read
+    lcd_clear_buffer();
+    if (layout->glyphs != NULL)
+    {
+        lcd_load_glyph_set(layout->glyphs);
+    }
+    for (uint8_t i = 0; i < layout->widget_count && i < LCD_LAYOUT_MAX_WIDGETS; i++)
+    {
+        const lcd_widget_t *widget = &layout->widgets[i];
+        if (widget->label != NULL)
+        {
+            lcd_copy_to_buffer(widget->label, widget->width, widget->col, widget->row);
+            continue;
+        }
+        field_value[i] = widget->source(widget->arg);
+        field_read_us[i] = now;
+        lcd_layout_format_field(widget, field_value[i]);
+    }
+    if (layout->widget_count > LCD_LAYOUT_MAX_WIDGETS)
+    {
+        ESP_LOGW(TAG, "Layout has %d widgets, only %d are drawn", layout->widget_count, LCD_LAYOUT_MAX_WIDGETS);
+    }
+    active_layout = layout;
+}
+
+void lcd_layout_invalidate(void)
+{
+    active_layout = NULL;
+}
+
+bool lcd_layout_render(const lcd_layout_t *layout)
+{
+    int64_t now = esp_timer_get_time();
+    bool changed = false;
+
+    if (layout != active_layout)
+    {
+        lcd_layout_enter(layout, now);
+        return true;
+    }
+
+    for (uint8_t i = 0; i < layout->widget_count && i < LCD_LAYOUT_MAX_WIDGETS; i++)
+    {
+        const lcd_widget_t *widget = &layout->widgets[i];
+        if (widget->label != NULL || now - field_read_us[i] < (int64_t)widget->refresh_ms * 1000)
+        {
+            continue;
+        }
+        field_read_us[i] = now;
+        int32_t value = widget->source(widget->arg);
+        if (value != field_value[i])
+        {
+            field_value[i] = value;
+            lcd_layout_format_field(widget, value);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+uint32_t lcd_layout_get_format_count(void)
+{
+    return format_count;
+}
@@ -0,0 +1,53 @@
+#ifndef LCD_LAYOUT_H
+#define LCD_LAYOUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lcd.h"
+
+#define LCD_LAYOUT_MAX_WIDGETS 32
+#define LCD_FIELD_BLANK INT32_MIN // Source value of a field drawn as spaces
+
+// Value that fully determines the text of a field, e.g. a temperature in 0.1 °C
+typedef int32_t (*lcd_field_source_t)(int arg);
+
+// Write exactly width characters for a source value, CGRAM codes 0-7 are allowed
+typedef void (*lcd_field_format_t)(int32_t value, int arg, char *out, uint8_t width);
+
+// A static label (label set) or a dynamic field (source and format set) of a screen
+typedef struct
+{
+    uint8_t col;
+    uint8_t row;
+    uint8_t width;
+    const char *label;           // Drawn once when the screen is entered
+    lcd_field_source_t source;
+    lcd_field_format_t format;
+    int arg;                     // Passed to source and format, e.g. a probe slot
+    uint16_t refresh_ms;         // Minimum time between source reads, 0 reads on every frame
+} lcd_widget_t;
+
+typedef struct
+{
+    const lcd_widget_t *widgets;
+    uint8_t widget_count;
+    const lcd_glyph_set_t *glyphs; // Loaded when the screen is entered, NULL if the screen has none
+} lcd_layout_t;
+
+#define LCD_LABEL(c, r, text) \
+    { .col = (c), .row = (r), .width = sizeof(text) - 1, .label = (text) }
+#define LCD_FIELD(c, r, w, src, fmt, a, period_ms) \
+    { .col = (c), .row = (r), .width = (w), .source = (src), .format = (fmt), .arg = (a), .refresh_ms = (period_ms) }
+#define LCD_LAYOUT(table, glyph_set) \
+    { .widgets = (table), .widget_count = sizeof(table) / sizeof((table)[0]), .glyphs = (glyph_set) }
+
+// Force the next lcd_layout_render() to redraw the whole screen.
+void lcd_layout_invalidate(void);
+
+// Update the LCD buffer from a layout, called with the display locked. Returns true if the buffer changed.
+bool lcd_layout_render(const lcd_layout_t *layout);
+
+// Get the number of fields formatted since initialization.
+uint32_t lcd_layout_get_format_count(void);
+
+#endif // LCD_LAYOUT_H
@@ -12,56 +12,101 @@
 #include "events.h"
 #include "wifi_manager.h"
 #include "state_manager.h"
+#include "power_manager.h"
+#include "alarm_manager.h"
+#include "history_manager.h"
+#include "config_manager.h"
+#include "boot_manager.h"
+#include "heap_monitor.h"
+#include "cli.h"
+#include "adc_stream.h"
+#include "esp_log.h"
 
-void app_main() {
-    esp_log_level_set("wifi", ESP_LOG_VERBOSE);
-    // Initialize the state manager
-    state_initialize(); // Initialize state manager
+static const char *TAG = "main";
+
+// Boot stages, a stage starts once the stages it depends on are done
+enum {
+    STAGE_STATE,
+    STAGE_NVS,
+    STAGE_EVENTS,
+    STAGE_STATUS_LED,
+    STAGE_LCD,
+    STAGE_POWER,
+    STAGE_ALARM,
+    STAGE_HISTORY,
+    STAGE_ADC,
+    STAGE_CONFIG,
+    STAGE_FIRST_SCREEN,
+    STAGE_WIFI,
+    STAGE_BUTTON,
+    STAGE_CLI,
+    STAGE_ADC_STREAM,
+    STAGE_MAX
+};
+
+static void boot_nvs(void) {
     nvs_initialize(); // Initialize NVS
     read_running_config(); // Read running configuration
-    events_init(); // Initialize event system
-    wifi_initialize(); // Initialize WiFi
-    
-    // Initialize Event Manager
-    vTaskDelay(pdMS_TO_TICKS(100)); // Delay to allow event system to stabilize
+}
 
-    // Initialize status LED
+static void boot_status_led(void) {
     status_led_init();
     status_led_set(LED_OK); // Set LED to OK state
-    vTaskDelay(pdMS_TO_TICKS(100)); // Delay to allow LED to stabilize
-
-    // Initialize button
-    button_init();
-    vTaskDelay(pdMS_TO_TICKS(100)); // Delay to allow button to stabilize
-
-    // Initialize NVS and read configuration
-    //nvs_initialize(); // Initialize NVS
-    vTaskDelay(pdMS_TO_TICKS(100)); // Delay to allow NVS to stabilize
-    //read_running_config(); // Read running configuration
-    vTaskDelay(pdMS_TO_TICKS(100)); // Delay to allow config to stabilize
+}
 
-    //return;
-    // Initialize thread safety in NTC ADC
-    ntc_init_mutex(); // Initialize mutex for thread safety
-    vTaskDelay(pdMS_TO_TICKS(100)); // Delay to allow mutex to stabilize
-
-    // Initialize i2c and LCD
+static void boot_lcd(void) {
     i2c_initialize();
-    lcd_initialize();
-    vTaskDelay(pdMS_TO_TICKS(100)); // Delay to allow LCD to stabilize
+    lcd_initialize(); // Shows the splash screen until the first reading
+}
 
-    // Initialize NTC on ADC channels
-    ntc_adc_initialize(); // Initialize ADC
-    vTaskDelay(pdMS_TO_TICKS(2000)); // Delay to allow ADC to stabilize
+static void boot_adc(void) {
+    ntc_init_mutex(); // Initialize mutex for thread safety
+    ntc_adc_initialize(); // The first frame is published as soon as the DMA delivers it
+}
 
+static void boot_first_screen(void) {
+    // Leave the splash screen for the temperatures once they are there
+    if (!ntc_adc_wait_first_reading(CONFIG_BOOT_FIRST_READING_TIMEOUT_MS)) {
+        ESP_LOGW(TAG, "No reading after %d ms", CONFIG_BOOT_FIRST_READING_TIMEOUT_MS);
+    }
+    if (lcd_get_screen_state() == LCD_SCREEN_SPLASH) {
+        lcd_set_screen_state(LCD_SCREEN_TEMP_AND_STATUS); // Set initial screen state
+    }
+}
 
-    lcd_set_screen_state(LCD_SCREEN_TEMP_AND_STATUS); // Set initial screen state
-    
-    // Create task to report temperature data
-    // xTaskCreatePinnedToCore(report_temperature_task, "report_temperature_task", 4096, NULL, 5, NULL, 1);
+static const boot_stage_t boot_stages[STAGE_MAX] = {
+    [STAGE_STATE] = { "state", state_initialize, 0 },
+    [STAGE_NVS] = { "nvs", boot_nvs, 0 },
+    [STAGE_EVENTS] = { "events", events_init, 0 },
+    [STAGE_STATUS_LED] = { "status_led", boot_status_led, BOOT_DEPENDS(STAGE_EVENTS) },
+    [STAGE_LCD] = { "lcd", boot_lcd, BOOT_DEPENDS(STAGE_STATE) | BOOT_DEPENDS(STAGE_NVS) | BOOT_DEPENDS(STAGE_EVENTS) },
+    [STAGE_POWER] = { "power", power_initialize, BOOT_DEPENDS(STAGE_LCD) }, // Backlight timeout
+    [STAGE_ALARM] = { "alarm", alarm_initialize, BOOT_DEPENDS(STAGE_EVENTS) },
+    [STAGE_HISTORY] = { "history", history_initialize, 0 },
+    // Alarm rules and trend history are fed by the acquisition task
+    [STAGE_ADC] = { "adc", boot_adc, BOOT_DEPENDS(STAGE_STATE) | BOOT_DEPENDS(STAGE_NVS) | BOOT_DEPENDS(STAGE_EVENTS) |
+                                     BOOT_DEPENDS(STAGE_ALARM) | BOOT_DEPENDS(STAGE_HISTORY) },
+    // Apply the settings saved from the menu
+    [STAGE_CONFIG] = { "config", config_initialize, BOOT_DEPENDS(STAGE_ADC) | BOOT_DEPENDS(STAGE_POWER) },
+    // The first reading shown has the calibration of the saved settings
+    [STAGE_FIRST_SCREEN] = { "first_screen", boot_first_screen, BOOT_DEPENDS(STAGE_LCD) | BOOT_DEPENDS(STAGE_CONFIG) },
+    // Connection events are posted once the LCD and the LED listen to them
+    [STAGE_WIFI] = { "wifi", wifi_initialize, BOOT_DEPENDS(STAGE_NVS) | BOOT_DEPENDS(STAGE_STATUS_LED) | BOOT_DEPENDS(STAGE_LCD) },
+    // Gestures are reported once every button handler is registered, the menu commits through the config lock
+    [STAGE_BUTTON] = { "button", button_init, BOOT_DEPENDS(STAGE_STATUS_LED) | BOOT_DEPENDS(STAGE_POWER) | BOOT_DEPENDS(STAGE_WIFI) |
+                                              BOOT_DEPENDS(STAGE_CONFIG) },
+    // Commands read every module, the TCP console needs the network stack
+    [STAGE_CLI] = { "cli", cli_initialize, BOOT_DEPENDS(STAGE_FIRST_SCREEN) | BOOT_DEPENDS(STAGE_WIFI) },
+    // Streams the frames of the acquisition task, TCP needs the network stack
+    [STAGE_ADC_STREAM] = { "adc_stream", adc_stream_initialize, BOOT_DEPENDS(STAGE_ADC) | BOOT_DEPENDS(STAGE_WIFI) },
+};
 
-    vTaskDelay(pdMS_TO_TICKS(4000)); 
+void app_main() {
+    esp_log_level_set("wifi", ESP_LOG_VERBOSE);
+    ESP_ERROR_CHECK(boot_run(boot_stages, STAGE_MAX));
+    boot_print_report();
 
-    //wifi_initialize(); // Initialize WiFi
-    vTaskDelay(pdMS_TO_TICKS(100)); // Delay to allow WiFi to stabilize
-}
\ No newline at end of file
+    // Whatever the firmware still takes from the heap after this is allocated at runtime
+    heap_monitor_initialize();
+    heap_monitor_log();
+}
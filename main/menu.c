@@ -0,0 +1,652 @@
+#include "menu.h"
+#include "config_manager.h"
+#include "alarm_manager.h"
+#include "ntc_adc.h"
+#include "task_config.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "MENU";
+
+#define MENU_VISIBLE_ROWS (LCD_ROWS - 1)  // Item rows below the header
+#define MENU_LABEL_WIDTH 11
+#define MENU_VALUE_WIDTH (LCD_COLS - 1 - MENU_LABEL_WIDTH)
+#define MENU_GLOBAL_ITEMS 2               // Sampling and backlight
+#define MENU_CHANNEL_ITEMS 5              // Enable, alarm enable, high limit, low limit and calibration of a probe
+#define MENU_EXIT_ITEMS 2                 // Save and discard
+#define MENU_ITEM_COUNT (MENU_GLOBAL_ITEMS + MENU_CHANNEL_ITEMS * NTC_CHANNEL_COUNT + MENU_EXIT_ITEMS)
+
+#define MENU_ALARM_STEP_CENTI 50
+#define MENU_ALARM_MIN_CENTI -4000
+#define MENU_ALARM_MAX_CENTI 15000
+#define MENU_CALIBRATION_STEP_CENTI 10
+
+// Value field keys: item index, editing flag and a 23-bit value, so that the layout
+// formats a value field again only when one of them changes
+#define MENU_VALUE_KEY(index, editing, value) \
+    ((int32_t)(((uint32_t)(index) << 24) | ((uint32_t)(editing) << 23) | ((uint32_t)(value) & 0x7FFFFF)))
+#define MENU_VALUE_KEY_INDEX(key) ((uint32_t)(key) >> 24)
+#define MENU_VALUE_KEY_EDITING(key) (((uint32_t)(key) >> 23) & 1)
+#define MENU_VALUE_KEY_VALUE(key) ((int32_t)((uint32_t)(key) << 9) >> 9)
+
+typedef enum
+{
+    MENU_ITEM_SAMPLING = 0,  // Continuous or burst interval
+    MENU_ITEM_BACKLIGHT,     // Backlight timeout
+    MENU_ITEM_CHANNEL_ENABLE,
+    MENU_ITEM_ALARM_ENABLE,  // High and low limit rules of the probe
+    MENU_ITEM_ALARM_HIGH,
+    MENU_ITEM_ALARM_LOW,
+    MENU_ITEM_CALIBRATION,   // Edited as the reference temperature, shown as the offset
+    MENU_ITEM_SAVE,
+    MENU_ITEM_DISCARD,
+} menu_item_kind_t;
+
+typedef struct
+{
+    menu_item_kind_t kind;
+    int channel;             // Probe of the channel items, -1 for the others
+} menu_item_t;
+
+typedef enum
+{
+    MENU_MESSAGE_NONE = 0,
+    MENU_MESSAGE_NO_READING,
+    MENU_MESSAGE_INVALID,
+    MENU_MESSAGE_CONFLICT,
+    MENU_MESSAGE_STORE_FAILED,
+    MENU_MESSAGE_MAX
+} menu_message_t;
+
+static const char *const message_texts[MENU_MESSAGE_MAX] = {
+    [MENU_MESSAGE_NO_READING] = "No probe reading",
+    [MENU_MESSAGE_INVALID] = "Invalid settings",
+    [MENU_MESSAGE_CONFLICT] = "Changed, reloaded",
+    [MENU_MESSAGE_STORE_FAILED] = "Save failed, retry",
+};
+
+// Value lists of the option items, sampling 0 is continuous acquisition, backlight 0 always on
+static const int32_t sampling_options[] = {0, 250, 500, 1000, 2000, 5000, 10000, 30000, 60000};
+static const int32_t backlight_options[] = {0, 10, 30, 60, 120, 300, 600};
+
+// Menu state, changed by the event loop and the timeout timer, read by the LCD task
+static SemaphoreHandle_t menu_mutex = NULL;
+static esp_timer_handle_t menu_timer = NULL;
+static volatile bool menu_active = false;
+static volatile int64_t closing_press_time_us = -1; // Gesture that closed the menu, still the menu's for later handlers
+static config_transaction_t transaction;
+static uint8_t selected = 0;
+static uint8_t top = 0;                  // First item row on the screen
+static bool editing = false;
+static int32_t edit_value = 0;
+static int32_t capture_centi = 0;        // Uncalibrated reading of the probe being calibrated
+static bool dirty = false;               // Draft differs from what the menu started with
+static menu_message_t message = MENU_MESSAGE_NONE;
+static bool save_requested = false;       // Save item activated, the event handler commits the draft
+
+static void menu_lock(void)
+{
+    xSemaphoreTake(menu_mutex, portMAX_DELAY);
+}
+
+static void menu_unlock(void)
+{
+    xSemaphoreGive(menu_mutex);
+}
+
+static menu_item_t menu_item_at(int index)
+{
+    // Global settings, then one group per probe, then the exit items
+    if (index < MENU_GLOBAL_ITEMS)
+    {
+        return (menu_item_t){MENU_ITEM_SAMPLING + index, -1};
+    }
+    index -= MENU_GLOBAL_ITEMS;
+    if (index < MENU_CHANNEL_ITEMS * NTC_CHANNEL_COUNT)
+    {
+        return (menu_item_t){MENU_ITEM_CHANNEL_ENABLE + index % MENU_CHANNEL_ITEMS, index / MENU_CHANNEL_ITEMS};
+    }
+    index -= MENU_CHANNEL_ITEMS * NTC_CHANNEL_COUNT;
+    return (menu_item_t){index == 0 ? MENU_ITEM_SAVE : MENU_ITEM_DISCARD, -1};
+}
+
+static int32_t menu_clamp(int32_t value, int32_t min, int32_t max)
+{
+    return value < min ? min : (value > max ? max : value);
+}
+
+static int32_t menu_option_step(const int32_t *options, int count, int32_t value, int direction)
+{
+    // Next or previous entry of a value list, wrapping around, a value not in the list starts from the first
+    int index = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (options[i] == value)
+        {
+            index = i;
+        }
+    }
+    return options[(index + direction + count) % count];
+}
+
+static int32_t menu_item_value(const device_config_t *config, menu_item_t item)
+{
+    // Value of an item in the draft
+    switch (item.kind)
+    {
+    case MENU_ITEM_SAMPLING:
+        return config->acq_mode == NTC_ACQ_MODE_CONTINUOUS ? 0 : (int32_t)config->burst_interval_ms;
+    case MENU_ITEM_BACKLIGHT:
+        return config->backlight_timeout_s;
+    case MENU_ITEM_CHANNEL_ENABLE:
+        return (config->channel_enable_mask >> item.channel) & 1;
+    case MENU_ITEM_ALARM_ENABLE:
+        return config->alarms[item.channel].enabled;
+    case MENU_ITEM_ALARM_HIGH:
+        return config->alarms[item.channel].high_centi;
+    case MENU_ITEM_ALARM_LOW:
+        return config->alarms[item.channel].low_centi;
+    case MENU_ITEM_CALIBRATION:
+        return config->offset_centi[item.channel];
+    default:
+        return 0;
+    }
+}
+
+static void menu_item_store(device_config_t *config, menu_item_t item, int32_t value)
+{
+    // Write an edited value into the draft
+    switch (item.kind)
+    {
+    case MENU_ITEM_SAMPLING:
+        config->acq_mode = value == 0 ? NTC_ACQ_MODE_CONTINUOUS : NTC_ACQ_MODE_BURST;
+        if (value != 0)
+        {
+            config->burst_interval_ms = value;
+        }
+        break;
+    case MENU_ITEM_BACKLIGHT:
+        config->backlight_timeout_s = value;
+        break;
+    case MENU_ITEM_CHANNEL_ENABLE:
+        config->channel_enable_mask = (config->channel_enable_mask & ~(1u << item.channel)) | ((uint32_t)(value != 0) << item.channel);
+        break;
+    case MENU_ITEM_ALARM_ENABLE:
+        config->alarms[item.channel].enabled = value != 0;
+        if (value != 0 && config->alarms[item.channel].low_centi >= config->alarms[item.channel].high_centi)
+        {
+            // Rules that were never set have no limits, start from the widest range the menu edits
+            config->alarms[item.channel].low_centi = MENU_ALARM_MIN_CENTI;
+            config->alarms[item.channel].high_centi = MENU_ALARM_MAX_CENTI;
+        }
+        break;
+    case MENU_ITEM_ALARM_HIGH:
+        config->alarms[item.channel].high_centi = value;
+        break;
+    case MENU_ITEM_ALARM_LOW:
+        config->alarms[item.channel].low_centi = value;
+        break;
+    case MENU_ITEM_CALIBRATION:
+        config->offset_centi[item.channel] = value - capture_centi; // Reference minus the uncalibrated reading
+        break;
+    default:
+        return;
+    }
+    dirty = true;
+}
+
+static int32_t menu_item_step(menu_item_t item, int32_t value, int direction)
+{
+    // Change an edited value by one step, limits keep the draft valid
+    const alarm_channel_config_t *alarm = item.channel >= 0 ? &transaction.config.alarms[item.channel] : NULL;
+    switch (item.kind)
+    {
+    case MENU_ITEM_SAMPLING:
+        return menu_option_step(sampling_options, sizeof(sampling_options) / sizeof(sampling_options[0]), value, direction);
+    case MENU_ITEM_BACKLIGHT:
+        return menu_option_step(backlight_options, sizeof(backlight_options) / sizeof(backlight_options[0]), value, direction);
+    case MENU_ITEM_ALARM_HIGH:
+        return menu_clamp(value + direction * MENU_ALARM_STEP_CENTI, alarm->low_centi + MENU_ALARM_STEP_CENTI, MENU_ALARM_MAX_CENTI);
+    case MENU_ITEM_ALARM_LOW:
+        return menu_clamp(value + direction * MENU_ALARM_STEP_CENTI, MENU_ALARM_MIN_CENTI, alarm->high_centi - MENU_ALARM_STEP_CENTI);
+    case MENU_ITEM_CALIBRATION:
+        return menu_clamp(value + direction * MENU_CALIBRATION_STEP_CENTI, capture_centi - DEVICE_CONFIG_OFFSET_LIMIT_CENTI,
+                          capture_centi + DEVICE_CONFIG_OFFSET_LIMIT_CENTI);
+    default:
+        return value;
+    }
+}
+
+static bool menu_capture(int channel)
+{
+    // Calibration capture: remember the probe's reading without its running offset, the
+    // reference temperature is edited starting from the reading with the draft offset
+    float temperature = ntc_get_channel_temperature(channel);
+    if (isnan(temperature))
+    {
+        message = MENU_MESSAGE_NO_READING;
+        return false;
+    }
+    capture_centi = (int32_t)lroundf(temperature * 100.0f) - ntc_get_channel_offset(channel);
+    edit_value = capture_centi + transaction.config.offset_centi[channel];
+    return true;
+}
+
+static void menu_select(int index)
+{
+    selected = (index + MENU_ITEM_COUNT) % MENU_ITEM_COUNT;
+    if (selected < top)
+    {
+        top = selected;
+    }
+    else if (selected >= top + MENU_VISIBLE_ROWS)
+    {
+        top = selected - MENU_VISIBLE_ROWS + 1;
+    }
+}
+
+static void menu_open(void)
+{
+    config_begin(&transaction);
+    menu_active = true;
+    editing = false;
+    dirty = false;
+    message = MENU_MESSAGE_NONE;
+    top = 0;
+    menu_select(0);
+    ESP_LOGI(TAG, "Menu opened");
+}
+
+static bool menu_save_result(esp_err_t err, bool draft_open)
+{
+    // Outcome of committing the draft, returns true if the menu can close. Called with the menu locked.
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE && !draft_open)
+    {
+        // Stored, but a module rejected one of the settings, the commit logged which
+        config_abort(&transaction);
+        ESP_LOGW(TAG, "Settings saved, not all of them applied");
+        return true;
+    }
+    switch (err)
+    {
+    case ESP_OK:
+        config_abort(&transaction); // A copy of the draft was committed
+        ESP_LOGI(TAG, "Settings saved");
+        return true;
+    case ESP_ERR_INVALID_STATE:
+        config_begin(&transaction); // Another commit happened, start over from the running settings
+        dirty = false;
+        message = MENU_MESSAGE_CONFLICT;
+        return false;
+    case ESP_ERR_INVALID_ARG:
+        message = MENU_MESSAGE_INVALID;
+        return false;
+    default:
+        message = MENU_MESSAGE_STORE_FAILED;
+        return false;
+    }
+}
+
+static bool menu_activate(void)
+{
+    // Long press on the selected item, returns true if the menu closes
+    menu_item_t item = menu_item_at(selected);
+    if (editing)
+    {
+        menu_item_store(&transaction.config, item, edit_value);
+        editing = false;
+        return false;
+    }
+
+    switch (item.kind)
+    {
+    case MENU_ITEM_CHANNEL_ENABLE:
+    case MENU_ITEM_ALARM_ENABLE:
+        menu_item_store(&transaction.config, item, !menu_item_value(&transaction.config, item));
+        return false;
+    case MENU_ITEM_SAVE:
+        save_requested = true; // Committed after unlocking, applying may take the display lock
+        return false;
+    case MENU_ITEM_DISCARD:
+        config_abort(&transaction);
+        ESP_LOGI(TAG, "Settings discarded");
+        return true;
+    case MENU_ITEM_CALIBRATION:
+        editing = menu_capture(item.channel);
+        return false;
+    default:
+        edit_value = menu_item_value(&transaction.config, item);
+        editing = true;
+        return false;
+    }
+}
+
+static bool menu_navigate(int32_t id, uint8_t button)
+{
+    // Apply a gesture, returns true if the menu closes. Called with the menu locked.
+    int direction = 0;
+    int steps = 1;
+    switch (button)
+    {
+    case BUTTON_ID_MAIN:
+        if (id == EVENT_BUTTON_LONG_PRESS)
+        {
+            return menu_activate();
+        }
+        direction = id == EVENT_BUTTON_SHORT_PRESS ? 1 : (id == EVENT_BUTTON_DOUBLE_CLICK ? -1 : 0);
+        break;
+    case BUTTON_ID_UP:
+    case BUTTON_ID_DOWN:
+        // Up moves to the previous item but increases a value, every gesture is a step
+        direction = (button == BUTTON_ID_UP) == editing ? 1 : -1;
+        steps = id == EVENT_BUTTON_DOUBLE_CLICK ? 2 : 1;
+        break;
+    default:
+        break;
+    }
+
+    for (int i = 0; i < steps && direction != 0; i++)
+    {
+        if (editing)
+        {
+            edit_value = menu_item_step(menu_item_at(selected), edit_value, direction);
+        }
+        else
+        {
+            menu_select(selected + direction);
+        }
+    }
+    return false;
+}
+
+static void menu_leave_screen(void)
+{
+    lcd_set_screen_state(alarm_get_active_count() > 0 ? LCD_SCREEN_ALARM : LCD_SCREEN_TEMP_AND_STATUS);
+}
+
+static void menu_timer_callback(void *arg)
+{
+    // Nothing pressed for a while, the changes are dropped
+    menu_lock();
+    bool was_active = menu_active;
+    if (was_active)
+    {
+        config_abort(&transaction);
+        menu_active = false;
+        editing = false;
+    }
+    menu_unlock();
+
+    if (was_active)
+    {
+        ESP_LOGI(TAG, "Menu closed after %d s without input, changes dropped", CONFIG_MENU_TIMEOUT_S);
+        menu_leave_screen();
+    }
+}
+
+bool menu_handle_button(int32_t id, const void *event_data)
+{
+    const button_event_t *event = (const button_event_t *)event_data;
+    if (event == NULL || menu_mutex == NULL ||
+        (id != EVENT_BUTTON_SHORT_PRESS && id != EVENT_BUTTON_LONG_PRESS &&
+         id != EVENT_BUTTON_DOUBLE_CLICK && id != EVENT_BUTTON_HOLD_REPEAT))
+    {
+        return false;
+    }
+
+    // The screen is changed and the settings saved after unlocking, the LCD task takes the menu
+    // lock while it holds the display lock
+    menu_lock();
+    bool opened = false;
+    bool closed = false;
+    if (!menu_active)
+    {
+        opened = id == EVENT_BUTTON_DOUBLE_CLICK && event->button == BUTTON_ID_MAIN &&
+                 lcd_get_screen_state() != LCD_SCREEN_AP_MODE;
+        if (opened)
+        {
+            menu_open();
+        }
+    }
+    else if (id != EVENT_BUTTON_HOLD_REPEAT || event->button != BUTTON_ID_MAIN)
+    {
+        message = MENU_MESSAGE_NONE;
+        closed = menu_navigate(id, event->button);
+        if (closed)
+        {
+            closing_press_time_us = event->press_time_us;
+        }
+        menu_active = !closed;
+        editing = editing && !closed;
+    }
+    static config_transaction_t draft; // Handlers run one at a time on the event loop
+    bool save = save_requested;
+    if (save)
+    {
+        draft = transaction;
+    }
+    save_requested = false;
+    bool used = opened || menu_active || closed;
+    esp_timer_stop(menu_timer);
+    if (menu_active)
+    {
+        esp_timer_start_once(menu_timer, MENU_TIMEOUT_US);
+    }
+    menu_unlock();
+
+    if (save)
+    {
+        // Applying the settings can toggle the backlight under the display lock, which the LCD
+        // task holds while it reads the menu, so the copy of the draft is committed unlocked
+        esp_err_t err = config_commit(&draft);
+        menu_lock();
+        if (menu_active && menu_save_result(err, draft.open))
+        {
+            closing_press_time_us = event->press_time_us;
+            menu_active = false;
+            editing = false;
+            closed = true;
+            esp_timer_stop(menu_timer);
+        }
+        menu_unlock();
+    }
+
+    if (opened)
+    {
+        lcd_set_screen_state(LCD_SCREEN_MENU);
+    }
+    else if (closed)
+    {
+        menu_leave_screen();
+    }
+    else if (used)
+    {
+        lcd_refresh();
+    }
+    return used;
+}
+
+bool menu_is_active(void)
+{
+    return menu_active;
+}
+
+bool menu_owns_button(const void *event_data)
+{
+    const button_event_t *event = (const button_event_t *)event_data;
+    return menu_active || (event != NULL && event->press_time_us == closing_press_time_us);
+}
+
+// Field sources and formats of the menu screen, called by the LCD task with the display locked
+
+static void menu_pad_text(const char *text, char *out, uint8_t width, bool right)
+{
+    size_t length = strnlen(text, width);
+    memset(out, ' ', width);
+    memcpy(out + (right ? width - length : 0), text, length);
+}
+
+static void menu_format_centi(int32_t centi, bool sign, char *out, size_t size)
+{
+    // 0.1 °C with rounding, e.g. "-12.5C" or "+0.3C"
+    int32_t deci = (centi >= 0 ? centi + 5 : centi - 5) / 10;
+    const char *prefix = deci < 0 ? "-" : (sign ? "+" : "");
+    snprintf(out, size, "%s%ld.%ldC", prefix, (long)(labs(deci) / 10), (long)(labs(deci) % 10));
+}
+
+static int32_t menu_header_source(int arg)
+{
+    menu_lock();
+    int32_t key = ((int32_t)message << 16) | ((int32_t)dirty << 15) | selected;
+    menu_unlock();
+    return key;
+}
+
+static void menu_header_format(int32_t key, int arg, char *out, uint8_t width)
+{
+    char text[LCD_COLS + 1];
+    menu_message_t shown = (menu_message_t)(key >> 16);
+    if (shown != MENU_MESSAGE_NONE && shown < MENU_MESSAGE_MAX)
+    {
+        menu_pad_text(message_texts[shown], out, width, false);
+        return;
+    }
+    // "Settings *     12/38"
+    snprintf(text, sizeof(text), "Settings %c", (key >> 15) & 1 ? '*' : ' ');
+    menu_pad_text(text, out, width, false);
+    snprintf(text, sizeof(text), "%d/%d", (int)(key & 0xFF) + 1, MENU_ITEM_COUNT);
+    size_t length = strlen(text);
+    if (length <= width)
+    {
+        memcpy(out + width - length, text, length);
+    }
+}
+
+static int32_t menu_cursor_source(int row)
+{
+    menu_lock();
+    int index = top + row;
+    int32_t key = index == selected ? (editing ? 2 : 1) : 0;
+    menu_unlock();
+    return index < MENU_ITEM_COUNT ? key : LCD_FIELD_BLANK;
+}
+
+static void menu_cursor_format(int32_t key, int row, char *out, uint8_t width)
+{
+    memset(out, ' ', width);
+    out[0] = " >*"[key];
+}
+
+static int32_t menu_label_source(int row)
+{
+    menu_lock();
+    int index = top + row;
+    menu_unlock();
+    return index < MENU_ITEM_COUNT ? index : LCD_FIELD_BLANK;
+}
+
+static void menu_label_format(int32_t index, int row, char *out, uint8_t width)
+{
+    static const char *const labels[] = {
+        [MENU_ITEM_SAMPLING] = "Sampling",
+        [MENU_ITEM_BACKLIGHT] = "Backlight",
+        [MENU_ITEM_CHANNEL_ENABLE] = "%s probe",
+        [MENU_ITEM_ALARM_ENABLE] = "%s alarm",
+        [MENU_ITEM_ALARM_HIGH] = "%s high",
+        [MENU_ITEM_ALARM_LOW] = "%s low",
+        [MENU_ITEM_CALIBRATION] = "%s calib.",
+        [MENU_ITEM_SAVE] = "Save & exit",
+        [MENU_ITEM_DISCARD] = "Discard",
+    };
+    char text[LCD_COLS + 1];
+    menu_item_t item = menu_item_at(index);
+    snprintf(text, sizeof(text), labels[item.kind], item.channel >= 0 ? ntc_get_channel_config(item.channel)->name : "");
+    menu_pad_text(text, out, width, false);
+}
+
+static int32_t menu_value_source(int row)
+{
+    menu_lock();
+    int index = top + row;
+    if (index >= MENU_ITEM_COUNT)
+    {
+        menu_unlock();
+        return LCD_FIELD_BLANK;
+    }
+    bool edited = editing && index == selected;
+    int32_t value = edited ? edit_value : menu_item_value(&transaction.config, menu_item_at(index));
+    menu_unlock();
+    return MENU_VALUE_KEY(index, edited, value);
+}
+
+static void menu_value_format(int32_t key, int row, char *out, uint8_t width)
+{
+    char text[LCD_COLS + 1] = "";
+    menu_item_t item = menu_item_at(MENU_VALUE_KEY_INDEX(key));
+    int32_t value = MENU_VALUE_KEY_VALUE(key);
+
+    switch (item.kind)
+    {
+    case MENU_ITEM_SAMPLING:
+        if (value == 0)
+        {
+            snprintf(text, sizeof(text), "cont.");
+        }
+        else
+        {
+            snprintf(text, sizeof(text), "%ld.%lds", (long)(value / 1000), (long)(value % 1000 / 100));
+        }
+        break;
+    case MENU_ITEM_BACKLIGHT:
+        snprintf(text, sizeof(text), value == 0 ? "on" : "%lds", (long)value);
+        break;
+    case MENU_ITEM_CHANNEL_ENABLE:
+    case MENU_ITEM_ALARM_ENABLE:
+        snprintf(text, sizeof(text), value ? "on" : "off");
+        break;
+    case MENU_ITEM_ALARM_HIGH:
+    case MENU_ITEM_ALARM_LOW:
+        menu_format_centi(value, false, text, sizeof(text));
+        break;
+    case MENU_ITEM_CALIBRATION:
+        // The reference temperature while editing, the offset otherwise
+        menu_format_centi(value, !MENU_VALUE_KEY_EDITING(key), text, sizeof(text));
+        break;
+    default:
+        break;
+    }
+    menu_pad_text(text, out, width, true);
+}
+
+#define MENU_ROW(row) \
+    LCD_FIELD(0, (row), 1, menu_cursor_source, menu_cursor_format, (row) - 1, 0), \
+    LCD_FIELD(1, (row), MENU_LABEL_WIDTH, menu_label_source, menu_label_format, (row) - 1, 0), \
+    LCD_FIELD(1 + MENU_LABEL_WIDTH, (row), MENU_VALUE_WIDTH, menu_value_source, menu_value_format, (row) - 1, 0)
+
+static const lcd_widget_t menu_widgets[] = {
+    LCD_FIELD(0, 0, LCD_COLS, menu_header_source, menu_header_format, 0, 0),
+    MENU_ROW(1),
+    MENU_ROW(2),
+    MENU_ROW(3),
+};
+
+static const lcd_layout_t menu_layout = LCD_LAYOUT(menu_widgets, NULL);
+
+const lcd_layout_t *menu_get_layout(void)
+{
+    return &menu_layout;
+}
+
+void menu_initialize(void)
+{
+    menu_mutex = KERNEL_MUTEX_CREATE();
+    esp_timer_create_args_t timer_args = {
+        .callback = menu_timer_callback,
+        .name = "menu_timeout",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &menu_timer));
+}
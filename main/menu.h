@@ -0,0 +1,31 @@
+#ifndef MENU_H
+#define MENU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lcd_layout.h"
+#include "button_manager.h"
+
+#define MENU_TIMEOUT_US ((int64_t)CONFIG_MENU_TIMEOUT_S * 1000000) // Inactivity before the menu drops its changes
+
+// Create the menu state, the menu is opened by a double click on the main button.
+// Navigation in the list: short press next item, double click previous item, long press
+// edit / toggle / run the item. While editing: short press increases, double click
+// decreases, long press keeps the value. Up and down buttons move or step when present.
+// Changes are kept in a config transaction until "Save & exit".
+void menu_initialize(void);
+
+// Handle an EVENT_BUTTON_* event. Returns true if the menu used it and the screens should ignore it.
+bool menu_handle_button(int32_t id, const void *event_data);
+
+// Check whether the menu is open.
+bool menu_is_active(void);
+
+// Check whether a button event belongs to the menu: it is open, or the gesture closed it. Other
+// handlers of EVENT_BUTTON_* ignore these events whether they run before or after the LCD handler.
+bool menu_owns_button(const void *event_data);
+
+// Get the layout of the menu screen, drawn with lcd_layout_render().
+const lcd_layout_t *menu_get_layout(void);
+
+#endif // MENU_H
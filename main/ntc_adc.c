@@ -1,16 +1,206 @@
 #include "ntc_adc.h"
+#include "power_manager.h"
+#include "alarm_manager.h"
+#include "adc_stream.h"
+#include "history_manager.h"
+#include "instrumentation.h"
+#include "state_manager.h"
+#include "task_config.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "soc/soc_caps.h"
+#include "freertos/event_groups.h"
+#include <ctype.h>
+#include <string.h>
+
+static const char *TAG = "ntc_adc";
 
 // Static variables for ADC handle and mutex
 static adc_continuous_handle_t adc_handle;
 static SemaphoreHandle_t channel_data_mutex;
 
 // Array to store ADC channel data
-static int channel_data[6] = { 0, 0, 0, 0, 0, 0 };
+static int channel_data[NTC_MAX_CHANNELS] = { 0 };
+static uint32_t publish_count = 0;
+static EventGroupHandle_t ready_events = NULL; // NTC_READY_FIRST_READING once the first frame was published
+
+// Default ADC inputs of the probes from Kconfig
+static const adc_channel_t default_adc_channels[NTC_CHANNEL_COUNT] = {
+    CONFIG_NTC_CHANNEL_1_ADC_CHANNEL,
+    CONFIG_NTC_CHANNEL_2_ADC_CHANNEL,
+#if CONFIG_NTC_CHANNEL_COUNT >= 3
+    CONFIG_NTC_CHANNEL_3_ADC_CHANNEL,
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 4
+    CONFIG_NTC_CHANNEL_4_ADC_CHANNEL,
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 5
+    CONFIG_NTC_CHANNEL_5_ADC_CHANNEL,
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 6
+    CONFIG_NTC_CHANNEL_6_ADC_CHANNEL,
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 7
+    CONFIG_NTC_CHANNEL_7_ADC_CHANNEL,
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 8
+    CONFIG_NTC_CHANNEL_8_ADC_CHANNEL,
+#endif
+};
+
+// Default names of the probes from Kconfig
+static const char *const default_channel_names[NTC_CHANNEL_COUNT] = {
+    CONFIG_NTC_CHANNEL_1_NAME,
+    CONFIG_NTC_CHANNEL_2_NAME,
+#if CONFIG_NTC_CHANNEL_COUNT >= 3
+    CONFIG_NTC_CHANNEL_3_NAME,
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 4
+    CONFIG_NTC_CHANNEL_4_NAME,
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 5
+    CONFIG_NTC_CHANNEL_5_NAME,
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 6
+    CONFIG_NTC_CHANNEL_6_NAME,
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 7
+    CONFIG_NTC_CHANNEL_7_NAME,
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 8
+    CONFIG_NTC_CHANNEL_8_NAME,
+#endif
+};
+
+// Default ADC units of the probes, ADC2 can only be selected on targets sampling both units by DMA
+#define NTC_CHANNEL_UNIT(n) (CONFIG_NTC_CHANNEL_##n##_ADC_UNIT == 2 ? ADC_UNIT_2 : ADC_UNIT_1)
+#ifndef CONFIG_NTC_CHANNEL_1_ADC_UNIT
+#define CONFIG_NTC_CHANNEL_1_ADC_UNIT 1
+#define CONFIG_NTC_CHANNEL_2_ADC_UNIT 1
+#define CONFIG_NTC_CHANNEL_3_ADC_UNIT 1
+#define CONFIG_NTC_CHANNEL_4_ADC_UNIT 1
+#define CONFIG_NTC_CHANNEL_5_ADC_UNIT 1
+#define CONFIG_NTC_CHANNEL_6_ADC_UNIT 1
+#define CONFIG_NTC_CHANNEL_7_ADC_UNIT 1
+#define CONFIG_NTC_CHANNEL_8_ADC_UNIT 1
+#endif
+
+static const adc_unit_t default_adc_units[NTC_CHANNEL_COUNT] = {
+    NTC_CHANNEL_UNIT(1),
+    NTC_CHANNEL_UNIT(2),
+#if CONFIG_NTC_CHANNEL_COUNT >= 3
+    NTC_CHANNEL_UNIT(3),
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 4
+    NTC_CHANNEL_UNIT(4),
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 5
+    NTC_CHANNEL_UNIT(5),
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 6
+    NTC_CHANNEL_UNIT(6),
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 7
+    NTC_CHANNEL_UNIT(7),
+#endif
+#if CONFIG_NTC_CHANNEL_COUNT >= 8
+    NTC_CHANNEL_UNIT(8),
+#endif
+};
+
+#ifdef SOC_ADC_DIG_SUPPORTED_UNIT
+#define NTC_ADC_DMA_UNIT_SUPPORTED(unit) SOC_ADC_DIG_SUPPORTED_UNIT(unit)
+#else
+#define NTC_ADC_DMA_UNIT_SUPPORTED(unit) 1
+#endif
+
+// Last published temperatures, converted once per publish by the probe drivers
+static float channel_temperature[NTC_MAX_CHANNELS];
+
+// Polled drivers are throttled to their sample rate hint
+static int64_t last_poll_time[NTC_MAX_CHANNELS];
+
+// Channel map, applied to the ADC by the temperature task when dirty
+static ntc_channel_config_t channel_map[NTC_MAX_CHANNELS];
+static volatile bool channel_map_dirty = false;
+static int32_t channel_offset_centi[NTC_MAX_CHANNELS]; // Calibration, added to the converted temperature
+
+// ADC unit/channel -> logical index lookup, -1 for inputs that are not sampled.
+// Only touched by the temperature task.
+static int8_t channel_lut[SOC_ADC_PERIPH_NUM][NTC_ADC_LUT_SIZE];
+static uint32_t active_channel_mask = 0;    // Probes sampled by the ADC DMA
+static uint32_t polled_channel_mask = 0;    // Probes read through a polled driver
+static ntc_channel_config_t configured_map[NTC_MAX_CHANNELS]; // Channel map the masks were built from
+
+// Acquisition scheduler state
+static TaskHandle_t temperature_task_handle = NULL;
+static portMUX_TYPE acq_config_lock = portMUX_INITIALIZER_UNLOCKED;
+static ntc_acq_config_t acq_config = {
+#if CONFIG_NTC_ADC_ACQ_BURST
+    .mode = NTC_ACQ_MODE_BURST,
+#else
+    .mode = NTC_ACQ_MODE_CONTINUOUS,
+#endif
+    .burst_samples = CONFIG_NTC_ADC_BURST_SAMPLES,
+    .burst_interval_ms = CONFIG_NTC_ADC_BURST_INTERVAL_MS,
+};
+
+// Publish rate reported to the running state, only touched by the temperature task
+#define NTC_RATE_SMOOTHING      8   // Publish interval averaged over about this many publishes
+#define NTC_RATE_HYSTERESIS_PCT 5   // Smaller rate changes are not reported
+#define NTC_STUCK_MIN_SAMPLES   4   // Fewer samples in a publish say nothing about a stuck input
+static int64_t last_publish_time = 0;
+static int64_t publish_interval_avg_us = 0;
+static uint32_t reported_rate_centi_hz = 0;
+
+// Per-channel accumulators, only touched by the temperature task
+static uint32_t sample_sum[NTC_CHANNEL_COUNT];
+static uint32_t sample_count[NTC_CHANNEL_COUNT];
+static uint16_t sample_min[NTC_CHANNEL_COUNT];
+static uint16_t sample_max[NTC_CHANNEL_COUNT];
+
+// Fault detection state, only touched by the temperature task
+static ntc_fault_t channel_fault[NTC_MAX_CHANNELS];     // Published with the snapshot, under the mutex
+static int32_t stuck_raw[NTC_MAX_CHANNELS];             // Reading the stuck detection compares against
+static uint32_t stuck_publishes[NTC_MAX_CHANNELS];      // Consecutive publishes without any change
+static uint32_t faults_detected[NTC_FAULT_MAX];         // Transitions into each fault
+static ntc_filter_state_t channel_filter[NTC_MAX_CHANNELS]; // Published with the snapshot, under the mutex
+
+// Frames are drained from the driver pool into this buffer and decoded there
+static uint8_t frame_buffer[CONFIG_NTC_ADC_CONV_FRAME_SIZE];
+
+// DMA statistics, the ISR counters have a single writer each
+static volatile uint32_t frames_converted = 0;
+static volatile uint32_t pool_overflows = 0;
+static int64_t last_frame_time = 0; // Time the last DMA frame was drained, sample time of the averages
+static uint32_t frames_processed = 0;
+static uint32_t samples_processed = 0;
+
+_Static_assert(CONFIG_NTC_ADC_CONV_FRAME_SIZE % SOC_ADC_DIGI_DATA_BYTES_PER_CONV == 0,
+               "ADC frame size must be a multiple of SOC_ADC_DIGI_DATA_BYTES_PER_CONV");
+_Static_assert(CONFIG_NTC_ADC_POOL_SIZE >= CONFIG_NTC_ADC_CONV_FRAME_SIZE,
+               "ADC pool must hold at least one frame");
+
+// Conversion frame done callback (ISR context)
+static bool IRAM_ATTR ntc_adc_on_conv_done(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data) {
+    BaseType_t task_woken = pdFALSE;
+    frames_converted++;
+    xTaskNotifyFromISR(temperature_task_handle, NTC_NOTIFY_FRAME, eSetBits, &task_woken);
+    return task_woken == pdTRUE;
+}
+
+// Conversion pool overflow callback (ISR context)
+static bool IRAM_ATTR ntc_adc_on_pool_ovf(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *user_data) {
+    BaseType_t task_woken = pdFALSE;
+    pool_overflows++;
+    xTaskNotifyFromISR(temperature_task_handle, NTC_NOTIFY_FRAME, eSetBits, &task_woken);
+    return task_woken == pdTRUE;
+}
 
 // Retrieve ADC data for a specific channel
 int ntc_get_channel_data(int channel_index) {
-    if (channel_index < 0 || channel_index >= 6) {
-        return -1; // Invalid channel index
+    if (!ntc_channel_is_enabled(channel_index)) {
+        return -1; // Invalid or disabled channel
     }
 
     if (xSemaphoreTake(channel_data_mutex, portMAX_DELAY)) {
@@ -21,30 +211,355 @@ int ntc_get_channel_data(int channel_index) {
     return -1; // Failed to take mutex
 }
 
-// Convert raw ADC value to temperature in Celsius
-float ntc_adc_raw_to_temperature(int adc_raw) {
-    // Convert ADC value to voltage (12-bit ADC, 0 dB attenuation = 0–1.1V range)
-    float voltage_mv = (adc_raw * 1100) / 4095.0; // Convert to mV
+// Retrieve the temperature of a specific channel
+float ntc_get_channel_temperature(int channel_index) {
+    if (!ntc_channel_is_enabled(channel_index)) {
+        return NAN;
+    }
 
-    // Calculate NTC resistance
-    float R_ntc = R_FIXED * (V_SUPPLY / voltage_mv - 1.0);
+    float temperature = NAN;
+    if (xSemaphoreTake(channel_data_mutex, portMAX_DELAY)) {
+        temperature = channel_temperature[channel_index];
+        xSemaphoreGive(channel_data_mutex);
+    }
+    return temperature;
+}
 
-    // Convert resistance to temperature using Steinhart-Hart equation
-    float t_kelvin = 1.0 / ((1.0 / T0_KELVIN) + (1.0 / NTC_BETA) * log(R_ntc / NTC_R25));
-    float temperature = t_kelvin - 273.15; // Convert to Celsius
+// Retrieve the filter state of a specific channel at its last publish
+esp_err_t ntc_get_channel_filter(int channel_index, ntc_filter_state_t *state) {
+    if (channel_index < 0 || channel_index >= NTC_CHANNEL_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
 
-    return temperature;
+    memset(state, 0, sizeof(*state));
+    if (ntc_channel_is_enabled(channel_index) && xSemaphoreTake(channel_data_mutex, portMAX_DELAY)) {
+        *state = channel_filter[channel_index];
+        xSemaphoreGive(channel_data_mutex);
+    }
+    return ESP_OK;
+}
+
+// Retrieve the fault state of a specific channel
+ntc_fault_t ntc_get_channel_fault(int channel_index) {
+    if (!ntc_channel_is_enabled(channel_index)) {
+        return NTC_FAULT_NONE;
+    }
+
+    ntc_fault_t fault = NTC_FAULT_NONE;
+    if (xSemaphoreTake(channel_data_mutex, portMAX_DELAY)) {
+        fault = channel_fault[channel_index];
+        xSemaphoreGive(channel_data_mutex);
+    }
+    return fault;
+}
+
+// Number of probe inputs on the board
+int ntc_get_channel_count() {
+    return NTC_CHANNEL_COUNT;
+}
+
+// Channel map entry of a probe
+const ntc_channel_config_t *ntc_get_channel_config(int channel_index) {
+    if (channel_index < 0 || channel_index >= NTC_CHANNEL_COUNT) {
+        return NULL;
+    }
+    return &channel_map[channel_index];
+}
+
+// Check whether a probe is sampled
+bool ntc_channel_is_enabled(int channel_index) {
+    if (channel_index < 0 || channel_index >= NTC_CHANNEL_COUNT) {
+        return false;
+    }
+    return channel_map[channel_index].enabled;
+}
+
+// Enable or disable a probe, the mask is persisted with the device configuration
+esp_err_t ntc_set_channel_enabled(int channel_index, bool enabled) {
+    if (channel_index < 0 || channel_index >= NTC_CHANNEL_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&acq_config_lock);
+    channel_map[channel_index].enabled = enabled;
+    channel_map_dirty = true;
+    portEXIT_CRITICAL(&acq_config_lock);
+
+    if (temperature_task_handle != NULL) {
+        xTaskNotify(temperature_task_handle, NTC_NOTIFY_CONFIG, eSetBits);
+    }
+    return ESP_OK;
+}
+
+// Change the probe type of a channel
+esp_err_t ntc_set_channel_probe_type(int channel_index, ntc_probe_type_t probe_type) {
+    if (channel_index < 0 || channel_index >= NTC_CHANNEL_COUNT || probe_type >= NTC_PROBE_TYPE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ntc_sensor_get_driver(probe_type) == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    running_config_t *running_config = get_running_config();
+    portENTER_CRITICAL(&acq_config_lock);
+    channel_map[channel_index].probe_type = probe_type;
+    // The NVS field is signed, the nibbles are shifted unsigned so the eighth probe cannot overflow it
+    uint32_t probe_types = (uint32_t)running_config->channel_probe_types;
+    probe_types &= ~(0xFu << (channel_index * 4));
+    probe_types |= (uint32_t)probe_type << (channel_index * 4);
+    running_config->channel_probe_types = (int32_t)probe_types;
+    channel_map_dirty = true; // The driver may change between ADC and polled
+    portEXIT_CRITICAL(&acq_config_lock);
+
+    store_int(CHANNEL_PROBE_KEY, running_config->channel_probe_types);
+    if (temperature_task_handle != NULL) {
+        xTaskNotify(temperature_task_handle, NTC_NOTIFY_CONFIG, eSetBits);
+    }
+    return ESP_OK;
+}
+
+// Check whether a probe name fits the LCD and can be printed in JSON and console output unquoted
+bool ntc_channel_name_valid(const char *name) {
+    size_t length = name != NULL ? strlen(name) : 0;
+    if (length == 0 || length >= NTC_CHANNEL_NAME_LEN) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (!isgraph((unsigned char)name[i]) || name[i] == '"' || name[i] == '\\') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rename a probe, all names are persisted together
+esp_err_t ntc_set_channel_name(int channel_index, const char *name) {
+    if (channel_index < 0 || channel_index >= NTC_CHANNEL_COUNT || !ntc_channel_name_valid(name)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char names[NTC_MAX_CHANNELS][NTC_CHANNEL_NAME_LEN] = { 0 };
+    portENTER_CRITICAL(&acq_config_lock);
+    memcpy(channel_map[channel_index].name, name, strlen(name) + 1);
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        memcpy(names[i], channel_map[i].name, sizeof(names[i]));
+    }
+    portEXIT_CRITICAL(&acq_config_lock);
+
+    return store_blob(CHANNEL_NAME_KEY, names, sizeof(names));
+}
+
+// Set the calibration offset of a channel, applied from the next publish
+esp_err_t ntc_set_channel_offset(int channel_index, int32_t offset_centi) {
+    if (channel_index < 0 || channel_index >= NTC_CHANNEL_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&acq_config_lock);
+    channel_offset_centi[channel_index] = offset_centi;
+    portEXIT_CRITICAL(&acq_config_lock);
+    return ESP_OK;
+}
+
+// Get the calibration offset of a channel
+int32_t ntc_get_channel_offset(int channel_index) {
+    if (channel_index < 0 || channel_index >= NTC_CHANNEL_COUNT) {
+        return 0;
+    }
+    portENTER_CRITICAL(&acq_config_lock);
+    int32_t offset_centi = channel_offset_centi[channel_index];
+    portEXIT_CRITICAL(&acq_config_lock);
+    return offset_centi;
+}
+
+// Format the probes as JSON for the web API, returns the length written
+size_t ntc_format_json(char *buffer, size_t size) {
+    size_t length = 0;
+
+#define NTC_APPEND(...)                                                           \
+    do {                                                                          \
+        if (length < size) {                                                      \
+            int written = snprintf(buffer + length, size - length, __VA_ARGS__);  \
+            length += written > 0 ? written : 0;                                  \
+        }                                                                         \
+    } while (0)
+
+    // Names are validated to need no escaping
+    NTC_APPEND("{\"probes\":[");
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        float temperature = ntc_get_channel_temperature(i);
+        NTC_APPEND("%s{\"name\":\"%s\",\"enabled\":%s,\"type\":\"%s\",\"fault\":\"%s\",\"temperature\":",
+                   i > 0 ? "," : "", channel_map[i].name, ntc_channel_is_enabled(i) ? "true" : "false",
+                   ntc_sensor_get_probe_name(channel_map[i].probe_type),
+                   ntc_sensor_get_fault_name(ntc_get_channel_fault(i)));
+        if (isnan(temperature)) {
+            NTC_APPEND("null}");
+        } else {
+            NTC_APPEND("%.2f}", temperature);
+        }
+    }
+    NTC_APPEND("]}");
+
+#undef NTC_APPEND
+    return length < size ? length : (size > 0 ? size - 1 : 0);
+}
+
+// Convert raw ADC value to temperature in Celsius
+float ntc_adc_raw_to_temperature(int adc_raw) {
+    return ntc_adc_raw_to_temperature_probe(adc_raw, NTC_PROBE_NTC_100K_B3950);
+}
+
+// Convert raw value to temperature in Celsius with the driver of a probe type
+float ntc_adc_raw_to_temperature_probe(int adc_raw, ntc_probe_type_t probe_type) {
+    ntc_channel_config_t config = { .probe_type = probe_type };
+    const ntc_sensor_driver_t *driver = ntc_sensor_get_driver(probe_type);
+    return driver != NULL ? driver->convert(adc_raw, &config) : NAN;
 }
 
 // Initialize the mutex for thread safety
 void ntc_init_mutex() {
-    channel_data_mutex = xSemaphoreCreateMutex();
-    if (channel_data_mutex == NULL) {
+    channel_data_mutex = KERNEL_MUTEX_CREATE();
+    ready_events = KERNEL_EVENT_GROUP_CREATE();
+    if (channel_data_mutex == NULL || ready_events == NULL) {
         printf("Failed to create mutex\n");
         abort();
     }
 }
 
+// Build the channel map from Kconfig defaults and the running configuration
+static void ntc_adc_build_channel_map() {
+    running_config_t *running_config = get_running_config();
+    char names[NTC_MAX_CHANNELS][NTC_CHANNEL_NAME_LEN];
+    bool names_stored = read_blob(CHANNEL_NAME_KEY, names, sizeof(names)) == ESP_OK;
+
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        ntc_channel_config_t *entry = &channel_map[i];
+        entry->unit = default_adc_units[i];
+        entry->channel = default_adc_channels[i];
+        names[i][NTC_CHANNEL_NAME_LEN - 1] = '\0';
+        if (names_stored && ntc_channel_name_valid(names[i])) {
+            memcpy(entry->name, names[i], strlen(names[i]) + 1);
+        } else if (ntc_channel_name_valid(default_channel_names[i])) {
+            memcpy(entry->name, default_channel_names[i], strlen(default_channel_names[i]) + 1);
+        } else {
+            ESP_LOGW(TAG, "Invalid name \"%s\" for probe %d, using T%d", default_channel_names[i], i + 1, i + 1);
+            snprintf(entry->name, sizeof(entry->name), "T%d", i + 1);
+        }
+        entry->enabled = (CONFIG_NTC_CHANNEL_ENABLE_MASK >> i) & 0x01; // Until the stored configuration is applied
+        entry->probe_type = ((uint32_t)running_config->channel_probe_types >> (i * 4)) & 0x0F;
+        if (entry->probe_type >= NTC_PROBE_TYPE_MAX) {
+            entry->probe_type = NTC_PROBE_NTC_100K_B3950;
+        }
+        channel_temperature[i] = NAN;
+    }
+    channel_map_dirty = true;
+}
+
+// Latch the fault of probes whose type has no driver, they are never sampled or published
+static void ntc_adc_mark_unsupported(uint32_t unsupported_mask) {
+    uint32_t fault_mask = 0;
+    if (xSemaphoreTake(channel_data_mutex, portMAX_DELAY)) {
+        for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+            if (unsupported_mask & (1 << i)) {
+                faults_detected[NTC_FAULT_UNSUPPORTED] += channel_fault[i] != NTC_FAULT_UNSUPPORTED ? 1 : 0;
+                channel_fault[i] = NTC_FAULT_UNSUPPORTED;
+                channel_temperature[i] = NAN;
+            } else if (channel_fault[i] == NTC_FAULT_UNSUPPORTED) {
+                channel_fault[i] = NTC_FAULT_NONE; // Type changed, the next publish classifies it
+            }
+            fault_mask |= channel_fault[i] != NTC_FAULT_NONE ? (1u << i) : 0;
+        }
+        xSemaphoreGive(channel_data_mutex);
+    }
+    state_set_fault_mask(fault_mask);
+}
+
+// Apply the channel map to the drivers, the ADC pattern table and lookup table (ADC must be stopped)
+static void ntc_adc_configure_channels() {
+    adc_digi_pattern_config_t patterns[NTC_MAX_CHANNELS];
+    uint32_t pattern_num = 0;
+    bool uses_unit[SOC_ADC_PERIPH_NUM] = { false };
+    ntc_channel_config_t map[NTC_MAX_CHANNELS];
+    uint32_t unsupported_mask = 0;
+
+    portENTER_CRITICAL(&acq_config_lock);
+    channel_map_dirty = false;
+    memcpy(map, channel_map, sizeof(map));
+    portEXIT_CRITICAL(&acq_config_lock);
+
+    memcpy(configured_map, map, sizeof(configured_map));
+    memset(channel_lut, -1, sizeof(channel_lut));
+    memset(stuck_publishes, 0, sizeof(stuck_publishes));
+    active_channel_mask = 0;
+    polled_channel_mask = 0;
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        const ntc_channel_config_t *entry = &map[i];
+        if (!entry->enabled) {
+            continue;
+        }
+
+        const ntc_sensor_driver_t *driver = ntc_sensor_get_driver(entry->probe_type);
+        if (driver == NULL) {
+            ESP_LOGE(TAG, "Probe %s: no %s driver in this firmware", entry->name,
+                     ntc_sensor_get_probe_name(entry->probe_type));
+            unsupported_mask |= (1 << i);
+            continue;
+        }
+        if (driver->init != NULL && driver->init(i, entry) != ESP_OK) {
+            ESP_LOGE(TAG, "Probe %s: %s driver failed to initialize", entry->name, driver->name);
+            continue;
+        }
+        if (driver->source == NTC_SENSOR_SOURCE_POLLED) {
+            polled_channel_mask |= (1 << i);
+            last_poll_time[i] = 0;
+            continue;
+        }
+
+        if (entry->unit >= SOC_ADC_PERIPH_NUM || !NTC_ADC_DMA_UNIT_SUPPORTED(entry->unit)) {
+            ESP_LOGE(TAG, "Probe %s: ADC unit %d cannot be sampled by DMA", entry->name, entry->unit + 1);
+            continue;
+        }
+        if (entry->channel >= NTC_ADC_LUT_SIZE || channel_lut[entry->unit][entry->channel] >= 0) {
+            continue; // Invalid, or input already used by another probe
+        }
+        channel_lut[entry->unit][entry->channel] = i;
+        active_channel_mask |= (1 << i);
+        uses_unit[entry->unit] = true;
+        patterns[pattern_num++] = (adc_digi_pattern_config_t){
+            .atten = ADC_ATTEN_DB_0,
+            .channel = entry->channel,
+            .unit = entry->unit,
+            .bit_width = ADC_BITWIDTH_12,
+        };
+    }
+
+    ntc_adc_mark_unsupported(unsupported_mask);
+
+    if (pattern_num == 0) {
+        if (polled_channel_mask == 0) {
+            ESP_LOGW(TAG, "No probes enabled, sampling paused");
+        }
+        return;
+    }
+
+    adc_digi_convert_mode_t conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    if (uses_unit[ADC_UNIT_1] && SOC_ADC_PERIPH_NUM > 1 && uses_unit[SOC_ADC_PERIPH_NUM - 1]) {
+        conv_mode = ADC_CONV_BOTH_UNIT;
+    } else if (!uses_unit[ADC_UNIT_1]) {
+        conv_mode = ADC_CONV_SINGLE_UNIT_2;
+    }
+
+    adc_continuous_config_t channel_config = {
+        .sample_freq_hz = NTC_ADC_SAMPLE_FREQ_HZ, // Sampling frequency
+        .conv_mode = conv_mode,
+        .format = NTC_ADC_OUTPUT_FORMAT,
+        .pattern_num = pattern_num,
+        .adc_pattern = patterns,
+    };
+    ESP_ERROR_CHECK(adc_continuous_config(adc_handle, &channel_config));
+    ESP_LOGI(TAG, "Sampling %lu probes (ADC mask 0x%02lx, polled mask 0x%02lx)", (unsigned long)pattern_num,
+             (unsigned long)active_channel_mask, (unsigned long)polled_channel_mask);
+}
+
 // Initialize the ADC
 esp_err_t ntc_adc_initialize() {
     if (channel_data_mutex == NULL) {
@@ -53,34 +568,24 @@ esp_err_t ntc_adc_initialize() {
 
     // ADC configuration
     adc_continuous_handle_cfg_t adc_config = {
-        .max_store_buf_size = 1024,
-        .conv_frame_size = 256,
+        .max_store_buf_size = CONFIG_NTC_ADC_POOL_SIZE,
+        .conv_frame_size = CONFIG_NTC_ADC_CONV_FRAME_SIZE,
     };
     ESP_ERROR_CHECK(adc_continuous_new_handle(&adc_config, &adc_handle));
 
-    // Configure channels
-    adc_continuous_config_t channel_config = {
-        .sample_freq_hz = SOC_ADC_SAMPLE_FREQ_THRES_LOW, // Sampling frequency
-        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
-        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
-    };
+    // Configure channels from the channel map
+    ntc_adc_build_channel_map();
+    ntc_adc_configure_channels();
 
-    adc_digi_pattern_config_t patterns[6] = {
-        {.atten = ADC_ATTEN_DB_0, .channel = ADC_USED_CHANNEL_1, .unit = ADC_UNIT_1, .bit_width = ADC_BITWIDTH_12},
-        {.atten = ADC_ATTEN_DB_0, .channel = ADC_USED_CHANNEL_2, .unit = ADC_UNIT_1, .bit_width = ADC_BITWIDTH_12},
-        {.atten = ADC_ATTEN_DB_0, .channel = ADC_USED_CHANNEL_3, .unit = ADC_UNIT_1, .bit_width = ADC_BITWIDTH_12},
-        {.atten = ADC_ATTEN_DB_0, .channel = ADC_USED_CHANNEL_4, .unit = ADC_UNIT_1, .bit_width = ADC_BITWIDTH_12},
-        {.atten = ADC_ATTEN_DB_0, .channel = ADC_USED_CHANNEL_5, .unit = ADC_UNIT_1, .bit_width = ADC_BITWIDTH_12},
-        {.atten = ADC_ATTEN_DB_0, .channel = ADC_USED_CHANNEL_6, .unit = ADC_UNIT_1, .bit_width = ADC_BITWIDTH_12}
+    // Notify the task from the DMA interrupt instead of blocking in a read
+    adc_continuous_evt_cbs_t callbacks = {
+        .on_conv_done = ntc_adc_on_conv_done,
+        .on_pool_ovf = ntc_adc_on_pool_ovf,
     };
+    ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(adc_handle, &callbacks, NULL));
 
-    channel_config.pattern_num = 6;
-    channel_config.adc_pattern = patterns;
-
-    ESP_ERROR_CHECK(adc_continuous_config(adc_handle, &channel_config));
-    
-    // Create temperature reading task
-    xTaskCreatePinnedToCore(ntc_temperature_task, "temperature_task", 4096, NULL, 5, NULL, 1);
+    // Create temperature reading task, the ADC is started by the task itself
+    task_create(TASK_ID_TEMPERATURE, ntc_temperature_task, NULL, &temperature_task_handle);
 
     return ESP_OK;
 }
@@ -95,50 +600,353 @@ void ntc_adc_stop() {
     ESP_ERROR_CHECK(adc_continuous_stop(adc_handle));
 }
 
-// Process ADC data and update channel data
-void ntc_adc_process_data() {
-    uint8_t buffer[256];
+// Stop ADC and drop samples left over in the driver pool
+void ntc_adc_stop_and_flush() {
+    ESP_ERROR_CHECK(adc_continuous_stop(adc_handle));
+    ESP_ERROR_CHECK(adc_continuous_flush_pool(adc_handle));
+}
+
+// Get a copy of the acquisition configuration
+ntc_acq_config_t ntc_adc_get_acquisition_config() {
+    portENTER_CRITICAL(&acq_config_lock);
+    ntc_acq_config_t config = acq_config;
+    portEXIT_CRITICAL(&acq_config_lock);
+    return config;
+}
+
+// Change the acquisition configuration
+esp_err_t ntc_adc_set_acquisition_config(const ntc_acq_config_t *config) {
+    if (config == NULL || config->mode >= NTC_ACQ_MODE_MAX ||
+        config->burst_samples == 0 || config->burst_interval_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&acq_config_lock);
+    acq_config = *config;
+    portEXIT_CRITICAL(&acq_config_lock);
+
+    // Wake the scheduler so the change takes effect without waiting for the interval
+    if (temperature_task_handle != NULL) {
+        xTaskNotify(temperature_task_handle, NTC_NOTIFY_CONFIG, eSetBits);
+    }
+    return ESP_OK;
+}
+
+// Switch between continuous and burst acquisition
+esp_err_t ntc_adc_set_acquisition_mode(ntc_acq_mode_t mode) {
+    ntc_acq_config_t config = ntc_adc_get_acquisition_config();
+    config.mode = mode;
+    return ntc_adc_set_acquisition_config(&config);
+}
+
+// Block until the first temperatures were published
+bool ntc_adc_wait_first_reading(uint32_t timeout_ms) {
+    if (ready_events == NULL) {
+        return false;
+    }
+    EventBits_t bits = xEventGroupWaitBits(ready_events, NTC_READY_FIRST_READING, pdFALSE, pdTRUE, pdMS_TO_TICKS(timeout_ms));
+    return (bits & NTC_READY_FIRST_READING) != 0;
+}
+
+// Number of times averaged channel data was published
+uint32_t ntc_get_publish_count() {
+    return publish_count;
+}
+
+// Get the DMA frame statistics
+ntc_adc_stats_t ntc_adc_get_stats() {
+    ntc_adc_stats_t stats = {
+        .frames_converted = frames_converted,
+        .frames_processed = frames_processed,
+        .samples_processed = samples_processed,
+        .pool_overflows = pool_overflows,
+        .publish_count = publish_count,
+        .publish_interval_us = (uint32_t)publish_interval_avg_us,
+    };
+    memcpy(stats.faults_detected, faults_detected, sizeof(stats.faults_detected));
+    return stats;
+}
+
+// Wait for a notification from the DMA callbacks or a configuration change
+uint32_t ntc_adc_wait_notification(TickType_t timeout) {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, NTC_NOTIFY_FRAME | NTC_NOTIFY_CONFIG, &bits, timeout);
+    return bits;
+}
+
+// Drain and process the frames available in the driver pool
+uint32_t ntc_adc_process_frames(uint32_t max_frames) {
     adc_digi_output_data_t *data;
+    uint32_t frames_read = 0;
 
-    while (1) {
+    while (frames_read < max_frames) {
         uint32_t read_size = 0;
-        esp_err_t ret = adc_continuous_read(adc_handle, buffer, sizeof(buffer), &read_size, pdMS_TO_TICKS(1000));
-        if (ret == ESP_OK) {
-            for (int i = 0; i < read_size; i += sizeof(adc_digi_output_data_t)) {
-                data = (adc_digi_output_data_t *)&buffer[i];
-                if (data->type1.channel >= 8) {
-                    continue; // Skip invalid channels
-                }
-                int index = 0;
-                switch (data->type1.channel) {
-                    case ADC_USED_CHANNEL_1: index = 0; break;
-                    case ADC_USED_CHANNEL_2: index = 1; break;
-                    case ADC_USED_CHANNEL_3: index = 2; break;
-                    case ADC_USED_CHANNEL_4: index = 3; break;
-                    case ADC_USED_CHANNEL_5: index = 4; break;
-                    case ADC_USED_CHANNEL_6: index = 5; break;
-                    default: continue;
-                }
-                if (xSemaphoreTake(channel_data_mutex, portMAX_DELAY)) {
-                    channel_data[index] = data->type1.data;
-                    xSemaphoreGive(channel_data_mutex);
-                }
+        esp_err_t ret = adc_continuous_read(adc_handle, frame_buffer, sizeof(frame_buffer), &read_size, 0);
+        if (ret != ESP_OK) {
+            break; // Pool is empty
+        }
+        frames_read++;
+        last_frame_time = esp_timer_get_time();
+        power_awake_begin(POWER_TASK_ADC);
+        INSTR_BEGIN(frame_start);
+        adc_stream_mode_t stream_mode = adc_stream_get_mode();
+        uint32_t frame_sum[NTC_CHANNEL_COUNT] = { 0 };
+        uint32_t frame_count[NTC_CHANNEL_COUNT] = { 0 };
+        for (int i = 0; i < read_size; i += sizeof(adc_digi_output_data_t)) {
+            data = (adc_digi_output_data_t *)&frame_buffer[i];
+            int index = channel_lut[NTC_SAMPLE_UNIT(data)][NTC_SAMPLE_CHANNEL(data)]; // 4-bit field, always within the table
+            if (index < 0) {
+                continue; // Skip inputs that are not mapped
+            }
+            uint16_t value = NTC_SAMPLE_DATA(data);
+            sample_sum[index] += value;
+            sample_min[index] = sample_count[index] == 0 || value < sample_min[index] ? value : sample_min[index];
+            sample_max[index] = sample_count[index] == 0 || value > sample_max[index] ? value : sample_max[index];
+            sample_count[index]++;
+            if (stream_mode == ADC_STREAM_DECIMATED) {
+                frame_sum[index] += value;
+                frame_count[index]++;
             }
         }
+        samples_processed += read_size / sizeof(adc_digi_output_data_t);
+        if (stream_mode == ADC_STREAM_RAW) {
+            adc_stream_push_raw(frame_buffer, read_size, last_frame_time);
+        } else if (stream_mode == ADC_STREAM_DECIMATED) {
+            adc_stream_push_decimated(frame_sum, frame_count, NTC_CHANNEL_COUNT, last_frame_time);
+        }
+        INSTR_END(INSTR_PATH_ADC_FRAME, frame_start);
+        power_awake_end(POWER_TASK_ADC);
     }
+    frames_processed += frames_read;
+    return frames_read;
 }
 
-// Task to start ADC and process data
-void ntc_temperature_task(void *pvParameter) {
+// Lowest number of samples accumulated on any channel
+static uint32_t ntc_adc_min_sample_count() {
+    uint32_t min_count = UINT32_MAX;
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        if ((active_channel_mask & (1 << i)) && sample_count[i] < min_count) {
+            min_count = sample_count[i];
+        }
+    }
+    return min_count;
+}
+
+// Classify the samples averaged into one ADC reading
+static ntc_fault_t ntc_adc_classify(int channel_index, const ntc_sensor_driver_t *driver, int32_t raw) {
+    const ntc_channel_config_t *entry = &configured_map[channel_index];
+    ntc_fault_t fault = NTC_FAULT_NONE;
+
+    if (driver->classify != NULL) {
+        fault = driver->classify(sample_min[channel_index], sample_max[channel_index], entry);
+    }
+    if (fault != NTC_FAULT_NONE || CONFIG_NTC_FAULT_STUCK_PUBLISHES == 0) {
+        stuck_publishes[channel_index] = 0;
+        return fault;
+    }
+
+    // ADC noise always moves the samples, identical readings over many publishes mean a stuck input.
+    // A publish of a few samples neither counts nor clears, unless its reading moved.
+    if (raw != stuck_raw[channel_index] || sample_min[channel_index] != sample_max[channel_index]) {
+        stuck_publishes[channel_index] = 0;
+    } else if (sample_count[channel_index] >= NTC_STUCK_MIN_SAMPLES &&
+               stuck_publishes[channel_index] < CONFIG_NTC_FAULT_STUCK_PUBLISHES) {
+        stuck_publishes[channel_index]++;
+    }
+    stuck_raw[channel_index] = raw;
+    return stuck_publishes[channel_index] >= CONFIG_NTC_FAULT_STUCK_PUBLISHES ? NTC_FAULT_STUCK : NTC_FAULT_NONE;
+}
+
+// Average the publish interval and report the rate when it moved, so that jitter does not notify
+static void ntc_adc_update_rate(int64_t now) {
+    if (last_publish_time != 0) {
+        int64_t interval_us = now - last_publish_time;
+        publish_interval_avg_us = publish_interval_avg_us == 0
+            ? interval_us
+            : publish_interval_avg_us + (interval_us - publish_interval_avg_us) / NTC_RATE_SMOOTHING;
+        uint32_t rate = publish_interval_avg_us > 0 ? (uint32_t)(100000000LL / publish_interval_avg_us) : 0;
+        uint32_t delta = rate > reported_rate_centi_hz ? rate - reported_rate_centi_hz : reported_rate_centi_hz - rate;
+        if (delta * 100 > reported_rate_centi_hz * NTC_RATE_HYSTERESIS_PCT) {
+            reported_rate_centi_hz = rate;
+            state_set_sample_rate(rate);
+        }
+    }
+    last_publish_time = now;
+}
+
+// Publish the averaged accumulators and polled drivers, then reset the accumulators
+void ntc_adc_publish() {
+    int32_t raw[NTC_MAX_CHANNELS];
+    float temperature[NTC_MAX_CHANNELS];
+    ntc_fault_t fault[NTC_MAX_CHANNELS];
+    int32_t temperature_centi[NTC_MAX_CHANNELS];
+    int64_t sample_time[NTC_MAX_CHANNELS];
+    int32_t offset_centi[NTC_MAX_CHANNELS];
+    ntc_filter_state_t filter[NTC_MAX_CHANNELS] = { 0 };
+    uint32_t updated_mask = 0;
+    uint32_t alarm_mask = 0;
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&acq_config_lock);
+    memcpy(offset_centi, channel_offset_centi, sizeof(offset_centi));
+    portEXIT_CRITICAL(&acq_config_lock);
+
+    // Read and convert outside of the mutex, polled drivers may block on their bus
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        const ntc_channel_config_t *entry = &configured_map[i];
+        const ntc_sensor_driver_t *driver = ntc_sensor_get_driver(entry->probe_type);
+
+        if (active_channel_mask & (1 << i)) {
+            if (sample_count[i] == 0) {
+                continue;
+            }
+            raw[i] = (sample_sum[i] + sample_count[i] / 2) / sample_count[i];
+            sample_time[i] = last_frame_time;
+            fault[i] = ntc_adc_classify(i, driver, raw[i]);
+            filter[i] = (ntc_filter_state_t){
+                .samples = sample_count[i],
+                .raw_min = sample_min[i],
+                .raw_max = sample_max[i],
+                .stuck_publishes = stuck_publishes[i],
+            };
+        } else if (polled_channel_mask & (1 << i)) {
+            int64_t period_us = driver->sample_rate_hint_hz > 0 ? 1000000 / driver->sample_rate_hint_hz : 0;
+            if (last_poll_time[i] != 0 && now - last_poll_time[i] < period_us) {
+                continue; // Throttled to the driver's sample rate hint
+            }
+            last_poll_time[i] = now;
+            esp_err_t err = driver->read_raw(i, entry, &raw[i]);
+            if (err == ESP_ERR_INVALID_RESPONSE) {
+                fault[i] = raw[i] > NTC_FAULT_NONE && raw[i] < NTC_FAULT_MAX ? raw[i] : NTC_FAULT_OPEN;
+            } else if (err != ESP_OK) {
+                continue;
+            } else {
+                fault[i] = NTC_FAULT_NONE;
+            }
+            sample_time[i] = now;
+        } else {
+            continue;
+        }
+        // Faulted readings never reach the snapshot, statistics or alarms
+        temperature[i] = fault[i] == NTC_FAULT_NONE ? driver->convert(raw[i], entry) + offset_centi[i] / 100.0f : NAN;
+        updated_mask |= (1 << i);
+        if (fault[i] != channel_fault[i]) {
+            if (fault[i] != NTC_FAULT_NONE) {
+                faults_detected[fault[i]]++;
+                ESP_LOGW(TAG, "Probe %s fault: %s (raw %ld)", entry->name, ntc_sensor_get_fault_name(fault[i]), (long)raw[i]);
+            } else {
+                ESP_LOGI(TAG, "Probe %s fault cleared", entry->name);
+            }
+        }
+        if (!isnan(temperature[i]) && entry->enabled) {
+            // Alarm rules are evaluated in fixed point, 0.01 °C
+            temperature_centi[i] = (int32_t)lroundf(temperature[i] * 100.0f);
+            alarm_mask |= (1 << i);
+        }
+    }
+
+    if (xSemaphoreTake(channel_data_mutex, portMAX_DELAY)) {
+        for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+            if (updated_mask & (1 << i)) {
+                channel_data[i] = raw[i];
+                channel_temperature[i] = temperature[i];
+                channel_fault[i] = fault[i];
+                channel_filter[i] = filter[i];
+            }
+        }
+        publish_count++;
+        xSemaphoreGive(channel_data_mutex);
+        xEventGroupSetBits(ready_events, NTC_READY_FIRST_READING);
+    }
+    memset(sample_sum, 0, sizeof(sample_sum));
+    memset(sample_count, 0, sizeof(sample_count));
+
+    alarm_process_frame(temperature_centi, alarm_mask, sample_time);
+    history_process_frame(temperature_centi, alarm_mask, now);
+
+    // Running state, notified only when a fault comes or goes or the rate moves
+    uint32_t fault_mask = 0;
+    for (int i = 0; i < NTC_CHANNEL_COUNT; i++) {
+        fault_mask |= channel_fault[i] != NTC_FAULT_NONE ? (1u << i) : 0;
+    }
+    state_set_fault_mask(fault_mask);
+    ntc_adc_update_rate(now);
+}
+
+// Run a single burst: sample until every channel has enough samples, then stop
+bool ntc_adc_run_burst(uint32_t samples_per_channel) {
+    if (active_channel_mask == 0) {
+        ntc_adc_publish(); // Only polled probes
+        return false;
+    }
+
+    bool reconfigured = false;
     ntc_adc_start();
-    ntc_adc_process_data();
+    while (ntc_adc_min_sample_count() < samples_per_channel) {
+        uint32_t bits = ntc_adc_wait_notification(pdMS_TO_TICKS(1000));
+        reconfigured = (bits & NTC_NOTIFY_CONFIG) != 0;
+        if (bits == 0 || reconfigured) {
+            break; // Timeout or reconfiguration, publish what we have
+        }
+        ntc_adc_process_frames(UINT32_MAX);
+    }
+    ntc_adc_stop_and_flush();
+    ntc_adc_publish();
+    return reconfigured;
+}
+
+// Process ADC data continuously until the acquisition mode changes
+void ntc_adc_process_data() {
+    while (ntc_adc_get_acquisition_config().mode == NTC_ACQ_MODE_CONTINUOUS && !channel_map_dirty) {
+        if (active_channel_mask == 0) {
+            // Only polled probes, publish at the polling granularity
+            ntc_adc_wait_notification(pdMS_TO_TICKS(NTC_POLL_PERIOD_MS));
+            ntc_adc_publish();
+            continue;
+        }
+        uint32_t bits = ntc_adc_wait_notification(pdMS_TO_TICKS(1000));
+        if ((bits & NTC_NOTIFY_FRAME) && ntc_adc_process_frames(UINT32_MAX) > 0) {
+            ntc_adc_publish();
+        }
+    }
 }
 
-// Task to report temperature data to stdout
-void ntc_report_temperature_task(void *pvParameter) {
+// Task running the acquisition scheduler
+void ntc_temperature_task(void *pvParameter) {
     while (1) {
-        float temp = ntc_adc_raw_to_temperature(ntc_get_channel_data(1));
-        printf("%.2f\n", temp);
-        vTaskDelay(pdMS_TO_TICKS(100)); // Report every second
+        if (channel_map_dirty) {
+            ntc_adc_configure_channels(); // The ADC is stopped between acquisitions
+        }
+        if (active_channel_mask == 0 && polled_channel_mask == 0) {
+            ntc_adc_wait_notification(portMAX_DELAY); // Nothing to sample until reconfigured
+            continue;
+        }
+
+        ntc_acq_config_t config = ntc_adc_get_acquisition_config();
+        if (config.mode == NTC_ACQ_MODE_CONTINUOUS) {
+            if (active_channel_mask != 0) {
+                ntc_adc_start();
+            }
+            ntc_adc_process_data();
+            if (active_channel_mask != 0) {
+                ntc_adc_stop_and_flush();
+            }
+            continue;
+        }
+
+        // Burst mode: the ADC (and its PM lock) is only active while sampling
+        TickType_t burst_start = xTaskGetTickCount();
+        if (ntc_adc_run_burst(config.burst_samples) || channel_map_dirty) {
+            continue; // The notification was consumed by the burst, apply the change now
+        }
+        TickType_t interval = pdMS_TO_TICKS(config.burst_interval_ms);
+        TickType_t elapsed = xTaskGetTickCount() - burst_start;
+        while (elapsed < interval) {
+            // Idle until the next burst, a configuration change wakes the task early
+            if (ntc_adc_wait_notification(interval - elapsed) & NTC_NOTIFY_CONFIG) {
+                break;
+            }
+            elapsed = xTaskGetTickCount() - burst_start;
+        }
     }
-}
\ No newline at end of file
+}
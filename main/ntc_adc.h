@@ -4,23 +4,71 @@
 #include <stdio.h>
 #include <math.h>
 #include "esp_adc/adc_continuous.h"
+#include "soc/soc_caps.h"
 #include "freertos/FreeRTOS.h"
 #include "driver/gpio.h" // Include for GPIO functionality
+#include "nvs_manager.h"
+#include "ntc_sensor.h"
 
-// ADC channel definitions
-#define ADC_USED_CHANNEL_1  ADC_CHANNEL_0  // ADC1 Channel 0
-#define ADC_USED_CHANNEL_2  ADC_CHANNEL_3  // ADC1 Channel 3
-#define ADC_USED_CHANNEL_3  ADC_CHANNEL_6  // ADC1 Channel 6
-#define ADC_USED_CHANNEL_4  ADC_CHANNEL_7  // ADC1 Channel 7
-#define ADC_USED_CHANNEL_5  ADC_CHANNEL_4  // ADC1 Channel 4
-#define ADC_USED_CHANNEL_6  ADC_CHANNEL_5  // ADC1 Channel 5
+// Channel map limits
+#define NTC_MAX_CHANNELS        8                           // Maximum number of probe inputs
+#define NTC_CHANNEL_COUNT       CONFIG_NTC_CHANNEL_COUNT    // Probe inputs on this board
+#define NTC_ADC_LUT_SIZE        16                          // 4-bit channel field of a DMA sample
+#define NTC_POLL_PERIOD_MS      100                         // Publish period without ADC probes in continuous mode
+#define NTC_ADC_SAMPLE_FREQ_HZ  SOC_ADC_SAMPLE_FREQ_THRES_LOW // Conversions per second over all ADC probes
 
-// Constants for NTC thermistor calculations
-#define R_FIXED 10000.0            // 10kΩ fixed resistor
-#define V_SUPPLY 3300.0            // Supply voltage in mV
-#define NTC_BETA 3950.0            // Beta value for NTC thermistor
-#define NTC_R25 100000.0           // Resistance at 25°C in ohms
-#define T0_KELVIN 298.15           // 25°C in Kelvin
+// DMA output format: ESP32 only supports TYPE1 (no unit field), newer targets TYPE2
+#if CONFIG_IDF_TARGET_ESP32
+#define NTC_ADC_OUTPUT_FORMAT       ADC_DIGI_OUTPUT_FORMAT_TYPE1
+#define NTC_SAMPLE_UNIT(d)          0
+#define NTC_SAMPLE_CHANNEL(d)       ((d)->type1.channel)
+#define NTC_SAMPLE_DATA(d)          ((d)->type1.data)
+#else
+#define NTC_ADC_OUTPUT_FORMAT       ADC_DIGI_OUTPUT_FORMAT_TYPE2
+#define NTC_SAMPLE_UNIT(d)          ((d)->type2.unit)
+#define NTC_SAMPLE_CHANNEL(d)       ((d)->type2.channel)
+#define NTC_SAMPLE_DATA(d)          ((d)->type2.data)
+#endif
+
+// Temperature task notification bits
+#define NTC_NOTIFY_FRAME    BIT0   // DMA frame ready (or pool overflow)
+#define NTC_NOTIFY_CONFIG   BIT1   // Acquisition configuration changed
+
+// Readiness bits
+#define NTC_READY_FIRST_READING BIT0 // Temperatures were published at least once
+
+// Acquisition modes
+typedef enum {
+    NTC_ACQ_MODE_CONTINUOUS = 0, // DMA runs all the time, data published after every frame
+    NTC_ACQ_MODE_BURST,          // DMA runs for a burst, averaged data published, then idles
+    NTC_ACQ_MODE_MAX
+} ntc_acq_mode_t;
+
+// Acquisition scheduler configuration
+typedef struct {
+    ntc_acq_mode_t mode;
+    uint32_t burst_samples;     // Samples per channel averaged in a burst
+    uint32_t burst_interval_ms; // Time between the start of two bursts
+} ntc_acq_config_t;
+
+// DMA frame statistics
+typedef struct {
+    uint32_t frames_converted;  // Frames completed by the DMA (conversion done callbacks)
+    uint32_t frames_processed;  // Frames read from the pool and decoded
+    uint32_t samples_processed; // Samples decoded
+    uint32_t pool_overflows;    // Frames lost because the pool was full
+    uint32_t publish_count;     // Times averaged channel data was published
+    uint32_t faults_detected[NTC_FAULT_MAX]; // Probe transitions into each fault
+    uint32_t publish_interval_us; // Publish interval, smoothed over about 8 publishes
+} ntc_adc_stats_t;
+
+// Averaging and fault filter of a probe at its last publish
+typedef struct {
+    uint32_t samples;           // ADC samples averaged into the published value, 0 for polled probes
+    uint16_t raw_min;           // Lowest of the averaged samples
+    uint16_t raw_max;           // Highest of the averaged samples, max - min is the noise the average removed
+    uint32_t stuck_publishes;   // Publishes without any change, NTC_FAULT_STUCK at CONFIG_NTC_FAULT_STUCK_PUBLISHES
+} ntc_filter_state_t;
 
 /**
  * @brief Initialize the ADC for continuous sampling.
@@ -44,35 +92,207 @@ void ntc_adc_start();
 void ntc_adc_stop();
 
 /**
- * @brief Process ADC data and update channel data.
+ * @brief Stop the ADC and flush the samples left in the driver pool.
+ */
+void ntc_adc_stop_and_flush();
+
+/**
+ * @brief Wait for a DMA frame or configuration change notification.
+ * @param timeout Maximum time to wait in ticks.
+ * @return Received NTC_NOTIFY_* bits, 0 on timeout.
+ */
+uint32_t ntc_adc_wait_notification(TickType_t timeout);
+
+/**
+ * @brief Drain frames from the driver pool into the channel accumulators.
+ * @param max_frames Maximum number of frames to process.
+ * @return Number of frames processed.
+ */
+uint32_t ntc_adc_process_frames(uint32_t max_frames);
+
+/**
+ * @brief Publish the averaged accumulators as channel data and reset them.
+ */
+void ntc_adc_publish();
+
+/**
+ * @brief Run a single burst and publish the averaged result.
+ * @param samples_per_channel Samples to collect on every channel before stopping.
+ * @return true if a configuration change cut the burst short, the scheduler then skips the idle wait.
+ */
+bool ntc_adc_run_burst(uint32_t samples_per_channel);
+
+/**
+ * @brief Process ADC data continuously until the acquisition mode changes.
  */
 void ntc_adc_process_data();
 
+/**
+ * @brief Get a copy of the acquisition configuration.
+ * @return Current acquisition configuration.
+ */
+ntc_acq_config_t ntc_adc_get_acquisition_config();
+
+/**
+ * @brief Change the acquisition configuration, takes effect immediately.
+ * @param config New configuration.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on invalid configuration.
+ */
+esp_err_t ntc_adc_set_acquisition_config(const ntc_acq_config_t *config);
+
+/**
+ * @brief Switch between continuous and burst acquisition.
+ * @param mode New acquisition mode.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on invalid mode.
+ */
+esp_err_t ntc_adc_set_acquisition_mode(ntc_acq_mode_t mode);
+
+/**
+ * @brief Wait until the first temperatures are published.
+ * @param timeout_ms Longest wait.
+ * @return true once a reading is available, false on timeout or before ntc_init_mutex().
+ */
+bool ntc_adc_wait_first_reading(uint32_t timeout_ms);
+
+/**
+ * @brief Get the number of times channel data was published.
+ * @return Publish counter.
+ */
+uint32_t ntc_get_publish_count();
+
+/**
+ * @brief Get the DMA frame statistics (converted, processed, overflowed frames).
+ * @return Copy of the statistics counters.
+ */
+ntc_adc_stats_t ntc_adc_get_stats();
+
 /**
  * @brief Retrieve the ADC data for a specific channel.
- * @param channel_index Index of the channel (0-5).
+ * @param channel_index Index of the channel (0 to NTC_CHANNEL_COUNT - 1).
  * @return ADC data for the channel, or -1 on error.
  */
 int ntc_get_channel_data(int channel_index);
 
 /**
- * @brief Convert raw ADC value to temperature in Celsius.
+ * @brief Retrieve the last published temperature of a specific channel.
+ * @param channel_index Index of the channel (0 to NTC_CHANNEL_COUNT - 1).
+ * @return Temperature in Celsius, NAN on error or before the first reading.
+ */
+float ntc_get_channel_temperature(int channel_index);
+
+/**
+ * @brief Retrieve the averaging and fault filter state of a channel at its last publish.
+ * @param channel_index Index of the channel (0 to NTC_CHANNEL_COUNT - 1).
+ * @param state Filled with the filter state, zeroed for disabled channels.
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG on invalid index.
+ */
+esp_err_t ntc_get_channel_filter(int channel_index, ntc_filter_state_t *state);
+
+/**
+ * @brief Retrieve the fault state of a specific channel.
+ * @param channel_index Index of the channel (0 to NTC_CHANNEL_COUNT - 1).
+ * @return Fault classified at the last publish, NTC_FAULT_NONE for disabled channels.
+ */
+ntc_fault_t ntc_get_channel_fault(int channel_index);
+
+/**
+ * @brief Get the number of probe inputs on the board.
+ * @return Number of channels in the channel map.
+ */
+int ntc_get_channel_count();
+
+/**
+ * @brief Get the channel map entry of a probe.
+ * @param channel_index Index of the channel (0 to NTC_CHANNEL_COUNT - 1).
+ * @return Pointer to the channel configuration, NULL on invalid index.
+ */
+const ntc_channel_config_t *ntc_get_channel_config(int channel_index);
+
+/**
+ * @brief Check whether a probe is enabled.
+ * @param channel_index Index of the channel.
+ * @return true if the channel exists and is sampled.
+ */
+bool ntc_channel_is_enabled(int channel_index);
+
+/**
+ * @brief Enable or disable a probe, applied by the scheduler.
+ *
+ * Not persisted: the enable mask is stored with the device configuration, commit it
+ * through config_manager to keep it across reboots.
+ * @param channel_index Index of the channel.
+ * @param enabled New state.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on invalid index.
+ */
+esp_err_t ntc_set_channel_enabled(int channel_index, bool enabled);
+
+/**
+ * @brief Change the probe type (sensor driver) of a channel, persisted to NVS.
+ * @param channel_index Index of the channel.
+ * @param probe_type New probe type.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on invalid arguments.
+ */
+esp_err_t ntc_set_channel_probe_type(int channel_index, ntc_probe_type_t probe_type);
+
+/**
+ * @brief Check whether a probe name is valid: 1 to NTC_CHANNEL_NAME_LEN - 1 printable characters,
+ *        no spaces, quotes or backslashes.
+ * @param name Name to check, may be NULL.
+ * @return true if the name can be set.
+ */
+bool ntc_channel_name_valid(const char *name);
+
+/**
+ * @brief Rename a probe, persisted to NVS.
+ * @param channel_index Index of the channel.
+ * @param name New name, see ntc_channel_name_valid().
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on invalid arguments, or the NVS error.
+ */
+esp_err_t ntc_set_channel_name(int channel_index, const char *name);
+
+/**
+ * @brief Set the calibration offset added to the converted temperature of a channel.
+ * @param channel_index Index of the channel.
+ * @param offset_centi Offset in 0.01 °C, applied from the next publish.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on invalid index.
+ */
+esp_err_t ntc_set_channel_offset(int channel_index, int32_t offset_centi);
+
+/**
+ * @brief Get the calibration offset of a channel.
+ * @param channel_index Index of the channel.
+ * @return Offset in 0.01 °C, 0 on invalid index.
+ */
+int32_t ntc_get_channel_offset(int channel_index);
+
+/**
+ * @brief Format the name, state and temperature of every probe as JSON, for the web API.
+ * @param buffer Output buffer.
+ * @param size Size of the buffer.
+ * @return Length of the JSON, truncated to size - 1.
+ */
+size_t ntc_format_json(char *buffer, size_t size);
+
+/**
+ * @brief Convert raw ADC value to temperature in Celsius (100 kOhm B3950 NTC).
  * @param adc_raw Raw ADC value.
  * @return Temperature in Celsius.
  */
 float ntc_adc_raw_to_temperature(int adc_raw);
 
 /**
- * @brief Task to start ADC and process temperature data.
- * @param pvParameter Task parameter (unused).
+ * @brief Convert a raw value to temperature in Celsius with the driver of a probe type.
+ * @param adc_raw Raw value (averaged ADC reading or polled driver value).
+ * @param probe_type Probe type of the channel.
+ * @return Temperature in Celsius.
  */
-void ntc_temperature_task(void *pvParameter);
+float ntc_adc_raw_to_temperature_probe(int adc_raw, ntc_probe_type_t probe_type);
 
 /**
- * @brief Task to report temperature data to stdout.
+ * @brief Task running the acquisition scheduler.
  * @param pvParameter Task parameter (unused).
  */
-void ntc_report_temperature_task(void *pvParameter);
+void ntc_temperature_task(void *pvParameter);
 
 
 #endif // NTC_ADC_H
\ No newline at end of file
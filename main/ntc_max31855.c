@@ -0,0 +1,127 @@
+#include "ntc_sensor.h"
+#include "sdkconfig.h"
+
+#if CONFIG_NTC_MAX31855_ENABLE
+
+#include <stdlib.h>
+#include <string.h>
+#include "driver/spi_master.h"
+#include "esp_log.h"
+
+#define MAX31855_CLOCK_HZ       4000000     // Max 5 MHz
+#define MAX31855_FAULT_BIT      (1 << 16)
+#define MAX31855_FAULT_MASK     0x07        // OC, SCG, SCV
+#define MAX31855_FAULT_OC       (1 << 0)    // Open circuit
+
+static const char *TAG = "max31855";
+
+static bool bus_initialized = false;
+static spi_device_handle_t devices[8] = { NULL };
+
+// Chip select GPIO of a probe from the comma separated Kconfig list indexed by probe, -1 if missing
+static int max31855_get_cs_gpio(int n) {
+    const char *list = CONFIG_NTC_MAX31855_CS_GPIOS;
+    for (int i = 0; *list != '\0'; i++) {
+        char *end;
+        long gpio = strtol(list, &end, 10);
+        if (end == list) {
+            break; // Not a number
+        }
+        if (i == n) {
+            return (int)gpio;
+        }
+        list = (*end == ',') ? end + 1 : end;
+    }
+    return -1;
+}
+
+static esp_err_t max31855_init(int channel_index, const ntc_channel_config_t *config) {
+    if (channel_index < 0 || channel_index >= (int)(sizeof(devices) / sizeof(devices[0]))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (devices[channel_index] != NULL) {
+        return ESP_OK; // Already added
+    }
+
+    spi_host_device_t host = (spi_host_device_t)(CONFIG_NTC_MAX31855_SPI_HOST - 1);
+    if (!bus_initialized) {
+        spi_bus_config_t bus_config = {
+            .miso_io_num = CONFIG_NTC_MAX31855_MISO_GPIO,
+            .mosi_io_num = -1, // Read-only device
+            .sclk_io_num = CONFIG_NTC_MAX31855_SCLK_GPIO,
+            .quadwp_io_num = -1,
+            .quadhd_io_num = -1,
+            .max_transfer_sz = 4,
+        };
+        esp_err_t err = spi_bus_initialize(host, &bus_config, SPI_DMA_DISABLED);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to initialize SPI bus: %s", esp_err_to_name(err));
+            return err;
+        }
+        bus_initialized = true;
+    }
+
+    int cs_gpio = max31855_get_cs_gpio(channel_index);
+    if (cs_gpio < 0) {
+        ESP_LOGE(TAG, "No chip select GPIO configured for probe %s", config->name);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    spi_device_interface_config_t device_config = {
+        .clock_speed_hz = MAX31855_CLOCK_HZ,
+        .mode = 0,
+        .spics_io_num = cs_gpio,
+        .queue_size = 1,
+    };
+    esp_err_t err = spi_bus_add_device(host, &device_config, &devices[channel_index]);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add MAX31855 on CS %d: %s", cs_gpio, esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGI(TAG, "Probe %s: MAX31855 on CS GPIO %d", config->name, cs_gpio);
+    return ESP_OK;
+}
+
+static esp_err_t max31855_read_raw(int channel_index, const ntc_channel_config_t *config, int32_t *raw) {
+    if (channel_index < 0 || channel_index >= (int)(sizeof(devices) / sizeof(devices[0])) ||
+        devices[channel_index] == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    spi_transaction_t transaction = {
+        .flags = SPI_TRANS_USE_RXDATA,
+        .length = 32,
+        .rxlength = 32,
+    };
+    esp_err_t err = spi_device_polling_transmit(devices[channel_index], &transaction);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    uint32_t frame = ((uint32_t)transaction.rx_data[0] << 24) | ((uint32_t)transaction.rx_data[1] << 16) |
+                     ((uint32_t)transaction.rx_data[2] << 8) | transaction.rx_data[3];
+    if (frame & MAX31855_FAULT_BIT) {
+        ESP_LOGD(TAG, "Probe %s fault 0x%lx", config->name, (unsigned long)(frame & MAX31855_FAULT_MASK));
+        *raw = (frame & MAX31855_FAULT_OC) ? NTC_FAULT_OPEN : NTC_FAULT_SHORT; // SCG / SCV
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    *raw = (frame >> 18) & 0x3FFF; // 14-bit two's complement, 0.25°C per LSB
+    return ESP_OK;
+}
+
+static float max31855_convert(int32_t raw, const ntc_channel_config_t *config) {
+    int32_t value = (raw & 0x2000) ? raw - 0x4000 : raw; // Sign extend 14 bits
+    return value * 0.25;
+}
+
+const ntc_sensor_driver_t ntc_max31855_driver = {
+    .name = "MAX31855",
+    .source = NTC_SENSOR_SOURCE_POLLED,
+    .sample_rate_hint_hz = 10, // 100 ms conversion time
+    .init = max31855_init,
+    .read_raw = max31855_read_raw,
+    .convert = max31855_convert,
+};
+
+#endif // CONFIG_NTC_MAX31855_ENABLE
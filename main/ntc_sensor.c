@@ -0,0 +1,168 @@
+#include "ntc_sensor.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+// Beta curve parameters per NTC probe type
+typedef struct {
+    float r25;  // Resistance at 25°C in ohms
+    float beta; // Beta value
+} ntc_beta_params_t;
+
+static const ntc_beta_params_t ntc_params[] = {
+    [NTC_PROBE_NTC_100K_B3950] = { NTC_R25, NTC_BETA },
+    [NTC_PROBE_NTC_10K_B3950] = { 10000.0, 3950.0 },
+    [NTC_PROBE_NTC_10K_B3435] = { 10000.0, 3435.0 },
+};
+
+#define ADC_RAW_MAX 4095
+
+// Convert a raw ADC reading to the input voltage (12-bit ADC, 0 dB attenuation = 0–1.1V range)
+static float raw_to_millivolts(int32_t raw) {
+    return (raw * 1100) / 4095.0;
+}
+
+// NTC on the high side of a divider with R_FIXED to ground
+static float ntc_convert(int32_t raw, const ntc_channel_config_t *config) {
+    const ntc_beta_params_t *params = &ntc_params[NTC_PROBE_NTC_100K_B3950];
+    if (config != NULL && config->probe_type <= NTC_PROBE_NTC_10K_B3435) {
+        params = &ntc_params[config->probe_type];
+    }
+
+    float voltage_mv = raw_to_millivolts(raw);
+    if (voltage_mv <= 0) {
+        return NAN; // Open probe, the resistance would be infinite
+    }
+
+    // Calculate NTC resistance
+    float R_ntc = R_FIXED * (V_SUPPLY / voltage_mv - 1.0);
+
+    // Convert resistance to temperature using the Beta equation
+    float t_kelvin = 1.0 / ((1.0 / T0_KELVIN) + (1.0 / params->beta) * log(R_ntc / params->r25));
+    return t_kelvin - 273.15; // Convert to Celsius
+}
+
+// NTC on the high side: an open probe pulls the input to ground, a short (or a hot
+// probe, 0 dB attenuation only covers 0-1.1V) drives it to full scale
+static ntc_fault_t ntc_classify(int32_t raw_min, int32_t raw_max, const ntc_channel_config_t *config) {
+    if (raw_max <= CONFIG_NTC_FAULT_RAW_MARGIN) {
+        return NTC_FAULT_OPEN;
+    }
+    if (raw_min >= ADC_RAW_MAX - CONFIG_NTC_FAULT_RAW_MARGIN) {
+        return NTC_FAULT_SATURATED;
+    }
+    return NTC_FAULT_NONE;
+}
+
+// RTD on the low side: an open probe reads full scale, a shorted one reads ground
+static ntc_fault_t rtd_classify(int32_t raw_min, int32_t raw_max, const ntc_channel_config_t *config) {
+    if (raw_min >= ADC_RAW_MAX - CONFIG_NTC_FAULT_RAW_MARGIN) {
+        return NTC_FAULT_OPEN;
+    }
+    if (raw_max <= CONFIG_NTC_FAULT_RAW_MARGIN) {
+        return NTC_FAULT_SHORT;
+    }
+    return NTC_FAULT_NONE;
+}
+
+// RTD on the low side of a divider with a reference resistor to V_SUPPLY
+static float rtd_convert(int32_t raw, const ntc_channel_config_t *config) {
+    bool pt1000 = config != NULL && config->probe_type == NTC_PROBE_PT1000;
+    float r0 = pt1000 ? 1000.0 : 100.0;
+    float r_ref = pt1000 ? CONFIG_NTC_RTD_PT1000_R_REF : CONFIG_NTC_RTD_PT100_R_REF;
+
+    float voltage_mv = raw_to_millivolts(raw);
+    if (voltage_mv >= V_SUPPLY) {
+        return NAN;
+    }
+    float R_rtd = r_ref * voltage_mv / (V_SUPPLY - voltage_mv);
+
+    // Invert R = R0 (1 + A T + B T^2), accurate above 0°C and within 0.1°C down to -50°C
+    float discriminant = RTD_A * RTD_A - 4.0 * RTD_B * (1.0 - R_rtd / r0);
+    if (discriminant < 0) {
+        return NAN;
+    }
+    return (-RTD_A + sqrtf(discriminant)) / (2.0 * RTD_B);
+}
+
+#if CONFIG_NTC_SENSOR_SIM
+// Simulated probe: slow sine around a per-channel base temperature, raw is centi-degrees + 100°C
+static esp_err_t sim_read_raw(int channel_index, const ntc_channel_config_t *config, int32_t *raw) {
+    float t_s = esp_timer_get_time() / 1000000.0;
+    float temp = 25.0 + channel_index * 2.0 + 5.0 * sinf(2.0 * M_PI * t_s / 60.0);
+    *raw = (int32_t)((temp + 100.0) * 100.0);
+    return ESP_OK;
+}
+
+static float sim_convert(int32_t raw, const ntc_channel_config_t *config) {
+    return raw / 100.0 - 100.0;
+}
+
+static const ntc_sensor_driver_t sim_driver = {
+    .name = "SIM",
+    .source = NTC_SENSOR_SOURCE_POLLED,
+    .sample_rate_hint_hz = 1,
+    .read_raw = sim_read_raw,
+    .convert = sim_convert,
+};
+#endif
+
+static const ntc_sensor_driver_t ntc_driver = {
+    .name = "NTC",
+    .source = NTC_SENSOR_SOURCE_ADC,
+    .sample_rate_hint_hz = 10,
+    .classify = ntc_classify,
+    .convert = ntc_convert,
+};
+
+static const ntc_sensor_driver_t rtd_driver = {
+    .name = "RTD",
+    .source = NTC_SENSOR_SOURCE_ADC,
+    .sample_rate_hint_hz = 10,
+    .classify = rtd_classify,
+    .convert = rtd_convert,
+};
+
+static const ntc_sensor_driver_t *drivers[NTC_PROBE_TYPE_MAX] = {
+    [NTC_PROBE_NTC_100K_B3950] = &ntc_driver,
+    [NTC_PROBE_NTC_10K_B3950] = &ntc_driver,
+    [NTC_PROBE_NTC_10K_B3435] = &ntc_driver,
+    [NTC_PROBE_PT100] = &rtd_driver,
+    [NTC_PROBE_PT1000] = &rtd_driver,
+#if CONFIG_NTC_MAX31855_ENABLE
+    [NTC_PROBE_MAX31855] = &ntc_max31855_driver,
+#endif
+#if CONFIG_NTC_SENSOR_SIM
+    [NTC_PROBE_SIM] = &sim_driver,
+#endif
+};
+
+static const char *probe_names[NTC_PROBE_TYPE_MAX] = {
+    [NTC_PROBE_NTC_100K_B3950] = "NTC 100k B3950",
+    [NTC_PROBE_NTC_10K_B3950] = "NTC 10k B3950",
+    [NTC_PROBE_NTC_10K_B3435] = "NTC 10k B3435",
+    [NTC_PROBE_PT100] = "PT100",
+    [NTC_PROBE_PT1000] = "PT1000",
+    [NTC_PROBE_MAX31855] = "MAX31855",
+    [NTC_PROBE_SIM] = "Simulated",
+};
+
+static const char *fault_names[NTC_FAULT_MAX] = {
+    [NTC_FAULT_NONE] = "OK",
+    [NTC_FAULT_OPEN] = "OPEN",
+    [NTC_FAULT_SHORT] = "SHRT",
+    [NTC_FAULT_SATURATED] = "SAT",
+    [NTC_FAULT_STUCK] = "STCK",
+    [NTC_FAULT_UNSUPPORTED] = "TYPE",
+};
+
+const char *ntc_sensor_get_fault_name(ntc_fault_t fault) {
+    return fault < NTC_FAULT_MAX ? fault_names[fault] : "?";
+}
+
+const ntc_sensor_driver_t *ntc_sensor_get_driver(ntc_probe_type_t probe_type) {
+    return probe_type < NTC_PROBE_TYPE_MAX ? drivers[probe_type] : NULL;
+}
+
+const char *ntc_sensor_get_probe_name(ntc_probe_type_t probe_type) {
+    return probe_type < NTC_PROBE_TYPE_MAX ? probe_names[probe_type] : "?";
+}
@@ -0,0 +1,101 @@
+#ifndef NTC_SENSOR_H
+#define NTC_SENSOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "esp_err.h"
+#include "esp_adc/adc_continuous.h"
+
+#define NTC_CHANNEL_NAME_LEN    3          // 2 characters + terminator
+
+// Constants for NTC thermistor calculations
+#define R_FIXED 10000.0            // 10kΩ fixed resistor
+#define V_SUPPLY 3300.0            // Supply voltage in mV
+#define NTC_BETA 3950.0            // Beta value for NTC thermistor
+#define NTC_R25 100000.0           // Resistance at 25°C in ohms
+#define T0_KELVIN 298.15           // 25°C in Kelvin
+
+// Constants for RTD (Callendar-Van Dusen, IEC 60751)
+#define RTD_A 3.9083e-3
+#define RTD_B -5.775e-7
+
+// Probe types, the value is stored in NVS (4 bits per channel) so never reorder
+typedef enum {
+    NTC_PROBE_NTC_100K_B3950 = 0,   // 100 kOhm NTC, Beta 3950 (default)
+    NTC_PROBE_NTC_10K_B3950,        // 10 kOhm NTC, Beta 3950
+    NTC_PROBE_NTC_10K_B3435,        // 10 kOhm NTC, Beta 3435
+    NTC_PROBE_PT100,                // PT100 RTD in an ADC bridge
+    NTC_PROBE_PT1000,               // PT1000 RTD in an ADC bridge
+    NTC_PROBE_MAX31855,             // Thermocouple via MAX31855 on SPI
+    NTC_PROBE_SIM,                  // Simulated probe for host builds and demos
+    NTC_PROBE_TYPE_MAX
+} ntc_probe_type_t;
+
+// Probe faults, classified from the raw range of each published value
+typedef enum {
+    NTC_FAULT_NONE = 0,
+    NTC_FAULT_OPEN,                 // Probe disconnected
+    NTC_FAULT_SHORT,                // Probe shorted
+    NTC_FAULT_SATURATED,            // Reading at the ADC rail, outside the measurable range
+    NTC_FAULT_STUCK,                // Reading does not change at all
+    NTC_FAULT_UNSUPPORTED,          // Probe type has no driver in this firmware
+    NTC_FAULT_MAX
+} ntc_fault_t;
+
+// Channel map entry: input -> logical probe index
+typedef struct {
+    adc_unit_t unit;                    // ADC unit of the input
+    adc_channel_t channel;              // ADC channel of the input
+    char name[NTC_CHANNEL_NAME_LEN];    // Label on the LCD, console and web API
+    bool enabled;                       // Disabled probes are not sampled
+    ntc_probe_type_t probe_type;        // Driver used for the probe
+} ntc_channel_config_t;
+
+// Where a driver gets its raw values from
+typedef enum {
+    NTC_SENSOR_SOURCE_ADC = 0,  // Sampled by the ADC DMA, raw value is the averaged ADC reading
+    NTC_SENSOR_SOURCE_POLLED,   // Read by the scheduler through read_raw() at publish time
+} ntc_sensor_source_t;
+
+// Sensor driver, all drivers feed the same publish path in ntc_adc
+typedef struct {
+    const char *name;
+    ntc_sensor_source_t source;
+    uint32_t sample_rate_hint_hz;   // Highest useful read rate, polled drivers are throttled to it
+    // Optional, called when a channel starts using the driver
+    esp_err_t (*init)(int channel_index, const ntc_channel_config_t *config);
+    // Polled drivers only, returns a non-negative raw value. A probe fault reported by the
+    // device is returned as ESP_ERR_INVALID_RESPONSE with the ntc_fault_t in raw.
+    esp_err_t (*read_raw)(int channel_index, const ntc_channel_config_t *config, int32_t *raw);
+    // ADC drivers only, classifies the range of the samples averaged into one value
+    ntc_fault_t (*classify)(int32_t raw_min, int32_t raw_max, const ntc_channel_config_t *config);
+    // Converts a raw value to Celsius, NAN if the value cannot be converted
+    float (*convert)(int32_t raw, const ntc_channel_config_t *config);
+} ntc_sensor_driver_t;
+
+/**
+ * @brief Get the driver of a probe type.
+ * @param probe_type Probe type.
+ * @return Driver, NULL for unknown types and drivers not compiled in.
+ */
+const ntc_sensor_driver_t *ntc_sensor_get_driver(ntc_probe_type_t probe_type);
+
+/**
+ * @brief Get the short name of a probe type.
+ * @param probe_type Probe type.
+ * @return Name of the probe type.
+ */
+const char *ntc_sensor_get_probe_name(ntc_probe_type_t probe_type);
+
+/**
+ * @brief Get the four character LCD label of a fault.
+ * @param fault Fault.
+ * @return Label, e.g. "OPEN" or "SHRT".
+ */
+const char *ntc_sensor_get_fault_name(ntc_fault_t fault);
+
+// MAX31855 thermocouple driver, implemented in ntc_max31855.c
+extern const ntc_sensor_driver_t ntc_max31855_driver;
+
+#endif // NTC_SENSOR_H
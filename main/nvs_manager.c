@@ -10,6 +10,7 @@ static running_config_t running_config = {
     .sta_ssid = CONFIG_DEFAULT_STA_SSID,
     .sta_pass = CONFIG_DEFAULT_STA_PASSWORD,
     .ap_channel = CONFIG_DEFAULT_AP_CHANNEL,
+    .channel_probe_types = 0,
 };
 
 void nvs_initialize()
@@ -83,13 +84,52 @@ esp_err_t read_int(const char *key, int32_t *value)
   esp_err_t err = nvs_open("storage", NVS_READONLY, &nvs_handle);
   if (err == ESP_OK)
   {
-    nvs_get_i32(nvs_handle, key, value);
+    err = nvs_get_i32(nvs_handle, key, value);
     nvs_close(nvs_handle);
-  } else {
-    return err;
   }
 
-  return ESP_OK;
+  return err;
+}
+
+esp_err_t store_blob(const char *key, const void *value, size_t size)
+{
+  // A blob is written as one entry, readers see either the old or the new value
+  nvs_handle_t nvs_handle;
+  esp_err_t err = nvs_open("storage", NVS_READWRITE, &nvs_handle);
+  if (err == ESP_OK)
+  {
+    err = nvs_set_blob(nvs_handle, key, value, size);
+    if (err == ESP_OK)
+    {
+      err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+  }
+
+  return err;
+}
+
+esp_err_t read_blob(const char *key, void *value, size_t size)
+{
+  // Only a blob of exactly the expected size is read
+  nvs_handle_t nvs_handle;
+  esp_err_t err = nvs_open("storage", NVS_READONLY, &nvs_handle);
+  if (err == ESP_OK)
+  {
+    size_t stored_size = 0;
+    err = nvs_get_blob(nvs_handle, key, NULL, &stored_size);
+    if (err == ESP_OK && stored_size != size)
+    {
+      err = ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    if (err == ESP_OK)
+    {
+      err = nvs_get_blob(nvs_handle, key, value, &stored_size);
+    }
+    nvs_close(nvs_handle);
+  }
+
+  return err;
 }
 
 running_config_t *get_running_config()
@@ -104,6 +144,7 @@ void store_running_config()
   store_string(STA_SSID_KEY, running_config.sta_ssid);
   store_string(STA_PASS_KEY, running_config.sta_pass);
   store_int(AP_CHANNEL_KEY, running_config.ap_channel);
+  store_int(CHANNEL_PROBE_KEY, running_config.channel_probe_types);
 }
 void read_running_config()
 {
@@ -135,7 +176,7 @@ void read_running_config()
     strncpy(running_config.sta_pass, CONFIG_DEFAULT_STA_PASSWORD, sizeof(running_config.sta_pass));
   }
 
-  read_int(AP_CHANNEL_KEY, &running_config.ap_channel);
+  err = read_int(AP_CHANNEL_KEY, &running_config.ap_channel);
   if (err == ESP_ERR_NVS_NOT_FOUND) {
     ESP_LOGI(TAG, "AP Channel not found, using default: %d", CONFIG_DEFAULT_AP_CHANNEL);
     store_int(AP_CHANNEL_KEY, CONFIG_DEFAULT_AP_CHANNEL);
@@ -146,4 +187,11 @@ void read_running_config()
   {
     running_config.ap_channel = 1; // Default channel
   }
+
+  err = read_int(CHANNEL_PROBE_KEY, &running_config.channel_probe_types);
+  if (err == ESP_ERR_NVS_NOT_FOUND) {
+    ESP_LOGI(TAG, "Channel probe types not found, using default");
+    store_int(CHANNEL_PROBE_KEY, 0);
+    running_config.channel_probe_types = 0;
+  }
 }
\ No newline at end of file
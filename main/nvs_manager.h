@@ -14,6 +14,9 @@
 #define AP_CHANNEL_KEY "ac"
 #define STA_SSID_KEY "ss"
 #define STA_PASS_KEY "sp"
+#define CHANNEL_PROBE_KEY "cp"
+#define CHANNEL_NAME_KEY "cn"
+#define DEVICE_CONFIG_KEY "dc"
 
 typedef struct {
     char ap_ssid[SSID_MAX_LEN];
@@ -21,6 +24,7 @@ typedef struct {
     int32_t ap_channel;
     char sta_ssid[SSID_MAX_LEN];
     char sta_pass[PASS_MAX_LEN];
+    int32_t channel_probe_types; // 4 bits per probe, see ntc_probe_type_t
 } running_config_t;
 
 void nvs_initialize();
@@ -28,6 +32,8 @@ void store_string(const char* key, const char* value);
 esp_err_t read_string(const char* key, char* value, size_t max_len);
 void store_int(const char* key, int32_t value);
 esp_err_t read_int(const char* key, int32_t* value);
+esp_err_t store_blob(const char* key, const void* value, size_t size);
+esp_err_t read_blob(const char* key, void* value, size_t size);
 
 running_config_t* get_running_config();
 void store_running_config();
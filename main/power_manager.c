@@ -0,0 +1,196 @@
+#include "power_manager.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_wifi.h"
+#include "lcd.h"
+
+static const char *TAG = "power_manager";
+
+static const char *task_names[POWER_TASK_MAX] = {
+    [POWER_TASK_ADC] = "adc",
+    [POWER_TASK_LCD] = "lcd",
+    [POWER_TASK_BUTTON] = "button",
+};
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static power_task_stats_t task_stats[POWER_TASK_MAX];
+static int64_t awake_since[POWER_TASK_MAX];
+static int64_t stats_start_time = 0;
+
+static esp_timer_handle_t backlight_timer = NULL;
+static esp_timer_handle_t stats_timer = NULL;
+static volatile uint32_t backlight_timeout_s = CONFIG_POWER_BACKLIGHT_TIMEOUT_S;
+
+static void backlight_timer_callback(void *arg) {
+    ESP_LOGD(TAG, "Backlight timeout");
+    lcd_toggle_backlight(false);
+}
+
+static void backlight_restart(void) {
+    // Restart the timeout from now, no timer runs while the backlight is always on
+    esp_timer_stop(backlight_timer);
+    if (backlight_timeout_s > 0) {
+        esp_timer_start_once(backlight_timer, (uint64_t)backlight_timeout_s * 1000000);
+    }
+}
+
+static void stats_timer_callback(void *arg) {
+    power_log_stats();
+}
+
+static void power_event_handler(void *handler_arg, esp_event_base_t base, int32_t id, void *event_data) {
+    switch (id) {
+        case EVENT_BUTTON_SHORT_PRESS:
+        case EVENT_BUTTON_LONG_PRESS:
+        case EVENT_BUTTON_DOUBLE_CLICK:
+        case EVENT_BUTTON_HOLD_REPEAT:
+            // Any button press wakes the backlight and restarts the timeout
+            lcd_toggle_backlight(true);
+            backlight_restart();
+            break;
+        default:
+            break;
+    }
+}
+
+static void power_configure_pm(void) {
+#if CONFIG_POWER_LOW_POWER_MODE
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_POWER_MAX_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_POWER_MIN_CPU_FREQ_MHZ,
+#if CONFIG_POWER_LIGHT_SLEEP && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+        .light_sleep_enable = true,
+#endif
+    };
+    esp_err_t err = esp_pm_configure(&pm_config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure power management: %s", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(TAG, "Power management configured: %d-%d MHz, light sleep %s",
+             CONFIG_POWER_MIN_CPU_FREQ_MHZ, CONFIG_POWER_MAX_CPU_FREQ_MHZ,
+             pm_config.light_sleep_enable ? "on" : "off");
+#else
+    ESP_LOGW(TAG, "CONFIG_PM_ENABLE is not set, running without DFS and light sleep");
+#endif
+#endif
+}
+
+void power_initialize(void) {
+    stats_start_time = esp_timer_get_time();
+
+    power_configure_pm();
+
+    // Always created, the timeout can be changed at runtime
+    esp_timer_create_args_t backlight_timer_args = {
+        .callback = backlight_timer_callback,
+        .name = "backlight_timer",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&backlight_timer_args, &backlight_timer));
+    backlight_restart();
+
+    events_subscribe(EVENT_BUTTON_SHORT_PRESS, power_event_handler, NULL);
+    events_subscribe(EVENT_BUTTON_LONG_PRESS, power_event_handler, NULL);
+    events_subscribe(EVENT_BUTTON_DOUBLE_CLICK, power_event_handler, NULL);
+    events_subscribe(EVENT_BUTTON_HOLD_REPEAT, power_event_handler, NULL);
+
+    if (CONFIG_POWER_STATS_LOG_INTERVAL_S > 0) {
+        esp_timer_create_args_t stats_timer_args = {
+            .callback = stats_timer_callback,
+            .name = "power_stats_timer",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&stats_timer_args, &stats_timer));
+        ESP_ERROR_CHECK(esp_timer_start_periodic(stats_timer, (uint64_t)CONFIG_POWER_STATS_LOG_INTERVAL_S * 1000000));
+    }
+}
+
+void power_set_backlight_timeout(uint32_t timeout_s) {
+    backlight_timeout_s = timeout_s;
+    if (backlight_timer == NULL) {
+        return;
+    }
+    lcd_toggle_backlight(true); // Show the change, the new timeout counts from now
+    backlight_restart();
+}
+
+uint32_t power_get_backlight_timeout(void) {
+    return backlight_timeout_s;
+}
+
+void power_apply_wifi_ps(void) {
+    // Outside the low-power mode the driver keeps its own default
+#if CONFIG_POWER_LOW_POWER_MODE
+#if CONFIG_POWER_WIFI_PS_MIN_MODEM
+    wifi_ps_type_t ps_type = WIFI_PS_MIN_MODEM;
+#elif CONFIG_POWER_WIFI_PS_MAX_MODEM
+    wifi_ps_type_t ps_type = WIFI_PS_MAX_MODEM;
+#else
+    wifi_ps_type_t ps_type = WIFI_PS_NONE;
+#endif
+    esp_err_t err = esp_wifi_set_ps(ps_type);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set Wi-Fi power save mode: %s", esp_err_to_name(err));
+    }
+#endif
+}
+
+void power_disable_wifi_ps(void) {
+#if CONFIG_POWER_LOW_POWER_MODE
+    esp_err_t err = esp_wifi_set_ps(WIFI_PS_NONE);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to disable Wi-Fi power save: %s", esp_err_to_name(err));
+    }
+#endif
+}
+
+void power_awake_begin(power_task_id_t task) {
+    if (task >= POWER_TASK_MAX) {
+        return;
+    }
+    // Only the owning task writes its own start timestamp
+    awake_since[task] = esp_timer_get_time();
+}
+
+void power_awake_end(power_task_id_t task) {
+    if (task >= POWER_TASK_MAX || awake_since[task] == 0) {
+        return;
+    }
+    int64_t elapsed = esp_timer_get_time() - awake_since[task];
+    awake_since[task] = 0;
+
+    portENTER_CRITICAL(&stats_lock);
+    task_stats[task].awake_us += elapsed;
+    task_stats[task].wakeups++;
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+power_task_stats_t power_get_task_stats(power_task_id_t task) {
+    power_task_stats_t stats = { 0 };
+    if (task >= POWER_TASK_MAX) {
+        return stats;
+    }
+    portENTER_CRITICAL(&stats_lock);
+    stats = task_stats[task];
+    portEXIT_CRITICAL(&stats_lock);
+    return stats;
+}
+
+const char *power_get_task_name(power_task_id_t task) {
+    return task < POWER_TASK_MAX ? task_names[task] : "?";
+}
+
+void power_log_stats(void) {
+    int64_t window_us = esp_timer_get_time() - stats_start_time;
+    if (window_us <= 0) {
+        return;
+    }
+    for (int i = 0; i < POWER_TASK_MAX; i++) {
+        power_task_stats_t stats = power_get_task_stats(i);
+        // Awake ratio in 0.01 % units, used as a proxy for the current consumption
+        uint32_t ratio = (uint32_t)((stats.awake_us * 10000) / window_us);
+        ESP_LOGI(TAG, "%-10s awake %llu us (%lu.%02lu %%), %lu wakeups", task_names[i],
+                 (unsigned long long)stats.awake_us, (unsigned long)(ratio / 100), (unsigned long)(ratio % 100),
+                 (unsigned long)stats.wakeups);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "events.h"
+
+// Tasks tracked by the awake time accounting
+typedef enum {
+    POWER_TASK_ADC = 0,
+    POWER_TASK_LCD,
+    POWER_TASK_BUTTON,
+    POWER_TASK_MAX
+} power_task_id_t;
+
+typedef struct {
+    uint64_t awake_us;  // Total time spent processing
+    uint32_t wakeups;   // Number of processing periods
+} power_task_stats_t;
+
+// Initialize power management (DFS / light sleep, backlight timeout, statistics).
+void power_initialize(void);
+
+// Change the backlight timeout (s, 0 = always on), counted from now.
+void power_set_backlight_timeout(uint32_t timeout_s);
+
+// Get the backlight timeout in seconds, 0 while the backlight stays on.
+uint32_t power_get_backlight_timeout(void);
+
+// Apply the configured Wi-Fi power save mode in the low-power mode, call after esp_wifi_start().
+void power_apply_wifi_ps(void);
+
+// Disable Wi-Fi power save in the low-power mode (required while the soft AP is running).
+void power_disable_wifi_ps(void);
+
+// Mark the start of a processing period of a task.
+void power_awake_begin(power_task_id_t task);
+
+// Mark the end of a processing period of a task.
+void power_awake_end(power_task_id_t task);
+
+// Get a copy of the awake statistics of a task.
+power_task_stats_t power_get_task_stats(power_task_id_t task);
+
+// Get the name of a tracked task.
+const char *power_get_task_name(power_task_id_t task);
+
+// Log the awake statistics of all tracked tasks.
+void power_log_stats(void);
+
+#endif // POWER_MANAGER_H
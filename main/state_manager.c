@@ -1,40 +1,132 @@
 #include "state_manager.h"
+#include "events.h"
+#include "esp_timer.h"
 
-running_state_t running_state = {
-    .wifi_sta_connection_state = 0,
-    .wifi_ap_connection_state = 0,
-    .wifi_ap_mode = false,
-};
+// Sequence lock: writers are serialized by the spinlock and make the sequence odd while they
+// change the state, readers copy without locking and retry if the sequence was odd or moved.
+static running_state_t running_state;
+static uint32_t state_sequence = 0;
+static portMUX_TYPE state_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void state_begin_update(running_state_t *draft) {
+    // Start a change from the current state, taking the writer lock
+    portENTER_CRITICAL(&state_lock);
+    *draft = running_state;
+}
+
+static void state_end_update(const running_state_t *draft, state_field_t field) {
+    // Publish the draft if it differs and release the writer lock, subscribers are told after it
+    bool changed = memcmp(draft, &running_state, sizeof(running_state)) != 0;
+    uint32_t version = running_state.version;
+    if (changed) {
+        __atomic_store_n(&state_sequence, state_sequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        running_state = *draft;
+        version = ++running_state.version;
+        __atomic_store_n(&state_sequence, state_sequence + 1, __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL(&state_lock);
+
+    if (changed) {
+        state_change_t change = {
+            .fields = STATE_FIELD_BIT(field),
+            .version = version,
+        };
+        events_post(EVENT_STATE_CHANGED, &change, sizeof(change));
+    }
+}
 
 void state_initialize(void) {
-    running_state.wifi_sta_connection_state = 0;
-    running_state.wifi_ap_connection_state = 0;
-    running_state.wifi_ap_mode = false;
+    portENTER_CRITICAL(&state_lock);
+    memset(&running_state, 0, sizeof(running_state));
+    portEXIT_CRITICAL(&state_lock);
+}
+
+uint32_t state_get_snapshot(running_state_t *snapshot) {
+    uint32_t begin;
+    uint32_t end;
+    do {
+        begin = __atomic_load_n(&state_sequence, __ATOMIC_ACQUIRE);
+        memcpy(snapshot, &running_state, sizeof(*snapshot));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        end = __atomic_load_n(&state_sequence, __ATOMIC_RELAXED);
+    } while ((begin & 1) != 0 || begin != end);
+
+    snapshot->uptime_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    return snapshot->version;
 }
 
-// considering thread safety
 void state_set_wifi_sta_connection_state(uint8_t state) {
-    running_state.wifi_sta_connection_state = state;
+    running_state_t draft;
+    state_begin_update(&draft);
+    draft.wifi_sta_connection_state = state;
+    state_end_update(&draft, STATE_FIELD_WIFI_STA);
 }
 
 void state_set_wifi_ap_connection_state(uint8_t state) {
-    running_state.wifi_ap_connection_state = state;
+    running_state_t draft;
+    state_begin_update(&draft);
+    draft.wifi_ap_connection_state = state;
+    state_end_update(&draft, STATE_FIELD_WIFI_AP);
 }
 
 void state_set_wifi_ap_mode(bool mode) {
-    running_state.wifi_ap_mode = mode;
+    running_state_t draft;
+    state_begin_update(&draft);
+    draft.wifi_ap_mode = mode;
+    state_end_update(&draft, STATE_FIELD_WIFI_AP);
+}
+
+void state_set_ip_address(uint32_t ip_address) {
+    running_state_t draft;
+    state_begin_update(&draft);
+    draft.ip_address = ip_address;
+    state_end_update(&draft, STATE_FIELD_IP);
+}
+
+void state_set_rssi(int8_t rssi) {
+    running_state_t draft;
+    state_begin_update(&draft);
+    draft.rssi = rssi;
+    state_end_update(&draft, STATE_FIELD_RSSI);
+}
+
+void state_set_alarms(uint32_t channel_mask, uint32_t count) {
+    running_state_t draft;
+    state_begin_update(&draft);
+    draft.alarm_channel_mask = channel_mask;
+    draft.alarm_count = count;
+    state_end_update(&draft, STATE_FIELD_ALARMS);
+}
+
+void state_set_fault_mask(uint32_t channel_mask) {
+    running_state_t draft;
+    state_begin_update(&draft);
+    draft.fault_channel_mask = channel_mask;
+    state_end_update(&draft, STATE_FIELD_FAULTS);
+}
+
+void state_set_sample_rate(uint32_t centi_hz) {
+    running_state_t draft;
+    state_begin_update(&draft);
+    draft.sample_rate_centi_hz = centi_hz;
+    state_end_update(&draft, STATE_FIELD_SAMPLE_RATE);
 }
 
 uint8_t state_get_wifi_sta_connection_state(void) {
-    return running_state.wifi_sta_connection_state;
+    running_state_t snapshot;
+    state_get_snapshot(&snapshot);
+    return snapshot.wifi_sta_connection_state;
 }
 
 uint8_t state_get_wifi_ap_connection_state(void) {
-    return running_state.wifi_ap_connection_state;
+    running_state_t snapshot;
+    state_get_snapshot(&snapshot);
+    return snapshot.wifi_ap_connection_state;
 }
 
 bool state_get_wifi_ap_mode(void) {
-    return running_state.wifi_ap_mode;
+    running_state_t snapshot;
+    state_get_snapshot(&snapshot);
+    return snapshot.wifi_ap_mode;
 }
-
-
@@ -6,20 +6,57 @@
 #include <string.h>
 #include <stdbool.h>
 
+// Fields of the running state, also the bits of a change notification
+typedef enum {
+    STATE_FIELD_WIFI_STA = 0,
+    STATE_FIELD_WIFI_AP,
+    STATE_FIELD_IP,
+    STATE_FIELD_RSSI,
+    STATE_FIELD_ALARMS,
+    STATE_FIELD_FAULTS,
+    STATE_FIELD_SAMPLE_RATE,
+    STATE_FIELD_MAX
+} state_field_t;
+
+#define STATE_FIELD_BIT(field) (1u << (field))
+
 typedef struct {
-    uint8_t wifi_sta_connection_state; // see wifi_err_reason_t
+    uint8_t wifi_sta_connection_state; // 0 while connected, else the last wifi_err_reason_t
     uint8_t wifi_ap_connection_state; // see wifi_err_reason_t
     bool wifi_ap_mode; // 0 = off, 1 = on
+    int8_t rssi; // dBm of the connected AP, 0 while not connected
+    uint32_t ip_address; // Station address (esp_ip4_addr_t), 0 without one
+    uint32_t alarm_channel_mask; // Probes with an active alarm
+    uint32_t alarm_count; // Active alarms over all probes
+    uint32_t fault_channel_mask; // Probes with a fault
+    uint32_t sample_rate_centi_hz; // Measured publish rate, 0.01 Hz
+    uint32_t uptime_s; // Filled in when a snapshot is taken
+    uint32_t version; // Bumped on every change
 } running_state_t;
 
-extern running_state_t running_state;
+// Payload of EVENT_STATE_CHANGED
+typedef struct {
+    uint32_t fields; // STATE_FIELD_BIT of the changed fields
+    uint32_t version; // State version after the change
+} state_change_t;
 
 void state_initialize(void);
+
+// Get a consistent copy of the state, never blocks and never sees a half written change. Returns its version.
+uint32_t state_get_snapshot(running_state_t *snapshot);
+
+// Setters change the state at once and post EVENT_STATE_CHANGED if a value differs.
 void state_set_wifi_sta_connection_state(uint8_t state);
 void state_set_wifi_ap_connection_state(uint8_t state);
 void state_set_wifi_ap_mode(bool mode);
+void state_set_ip_address(uint32_t ip_address);
+void state_set_rssi(int8_t rssi);
+void state_set_alarms(uint32_t channel_mask, uint32_t count);
+void state_set_fault_mask(uint32_t channel_mask);
+void state_set_sample_rate(uint32_t centi_hz);
+
 uint8_t state_get_wifi_sta_connection_state(void);
 uint8_t state_get_wifi_ap_connection_state(void);
 bool state_get_wifi_ap_mode(void);
 
-#endif // STATE_MANAGER_H
\ No newline at end of file
+#endif // STATE_MANAGER_H
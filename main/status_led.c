@@ -1,45 +1,224 @@
 #include "status_led.h"
+#include "alarm_manager.h"
+#include "button_manager.h"
+#include "menu.h"
+#include "task_config.h"
+#include "driver/rmt_tx.h"
+#include "esp_log.h"
+#include "freertos/semphr.h"
 
-static const int16_t state_bit_masks[LED_MAX_STATES] = {
-    [LED_OK] = 0xFFFF,
-    [LED_FAST_BLINK] = 0xAAAA,
-    [LED_SLOW_BLINK] = 0xCCCC,
-    [LED_OFF] = 0x0000,
-    [LED_ERROR] = 0xCC00,
-    [LED_THREE_BLINK] = 0xA800,
+static const char *TAG = "status_led";
+
+#define LED_PATTERN(steps) { steps, sizeof(steps) / sizeof(steps[0]) }
+#define LED_TICKS_PER_MS (STATUS_LED_RESOLUTION_HZ / 1000)
+#define LED_SYMBOL_MAX_TICKS 32767 // 15-bit duration of each half of a symbol
+
+typedef struct {
+    const led_step_t *steps;
+    uint8_t step_count;
+} led_pattern_t;
+
+// One loop of each pattern, the former 16 x 62.5 ms bit masks as steps
+static const led_step_t ok_steps[] = { {100, false, 1000} };
+static const led_step_t fast_blink_steps[] = { {0, false, 63}, {100, false, 62} };
+static const led_step_t slow_blink_steps[] = { {0, false, 125}, {100, false, 125} };
+static const led_step_t off_steps[] = { {0, false, 1000} };
+static const led_step_t error_steps[] = { {0, false, 625}, {100, false, 125}, {0, false, 125}, {100, false, 125} };
+static const led_step_t three_blink_steps[] = {
+    {0, false, 688}, {100, false, 62}, {0, false, 63}, {100, false, 62}, {0, false, 63}, {100, false, 62},
 };
+static const led_step_t breathe_steps[] = { {100, true, 1000}, {0, true, 1000} };
+static const led_step_t dim_steps[] = { {20, false, STATUS_LED_PWM_PERIOD_MS} };
+
+static const led_pattern_t patterns[LED_MAX_STATES] = {
+    [LED_OK] = LED_PATTERN(ok_steps),
+    [LED_FAST_BLINK] = LED_PATTERN(fast_blink_steps),
+    [LED_SLOW_BLINK] = LED_PATTERN(slow_blink_steps),
+    [LED_OFF] = LED_PATTERN(off_steps),
+    [LED_ERROR] = LED_PATTERN(error_steps),
+    [LED_THREE_BLINK] = LED_PATTERN(three_blink_steps),
+    [LED_BREATHE] = LED_PATTERN(breathe_steps),
+    [LED_DIM] = LED_PATTERN(dim_steps),
+};
+
+static rmt_channel_handle_t led_channel = NULL;
+static rmt_encoder_handle_t led_encoder = NULL;
+static SemaphoreHandle_t led_mutex = NULL;
+
+static led_state_t layer_states[LED_LAYER_MAX] = { [0 ... LED_LAYER_MAX - 1] = LED_MAX_STATES };
+static led_state_t shown_state = LED_MAX_STATES;
+static rmt_symbol_word_t waveform[STATUS_LED_MEM_SYMBOLS - 1]; // The channel also holds the end marker
+
+static size_t status_led_emit(size_t count, uint32_t high_ticks, uint32_t low_ticks) {
+    // One symbol, a steady level is split over both halves (a zero duration would end the waveform)
+    if (count >= sizeof(waveform) / sizeof(waveform[0])) {
+        return count;
+    }
+    if (high_ticks == 0 || low_ticks == 0) {
+        uint32_t ticks = high_ticks + low_ticks;
+        uint16_t level = high_ticks != 0;
+        waveform[count] = (rmt_symbol_word_t){
+            .level0 = level, .duration0 = ticks - ticks / 2, .level1 = level, .duration1 = ticks / 2,
+        };
+    } else {
+        waveform[count] = (rmt_symbol_word_t){
+            .level0 = 1, .duration0 = high_ticks, .level1 = 0, .duration1 = low_ticks,
+        };
+    }
+    return count + 1;
+}
+
+static bool status_led_step_steady(const led_step_t *step) {
+    return !step->fade && (step->level == 0 || step->level >= 100);
+}
+
+static uint32_t status_led_pwm_period_ms(const led_pattern_t *pattern) {
+    // Shortest PWM period from STATUS_LED_PWM_PERIOD_MS up with which the whole loop fits the
+    // channel memory, the 2 s breathe needs 200 symbols at 10 ms
+    const size_t capacity = sizeof(waveform) / sizeof(waveform[0]);
+    size_t steady_symbols = 0;
+    uint32_t pwm_ms = 0;
+    for (uint8_t i = 0; i < pattern->step_count; i++) {
+        const led_step_t *step = &pattern->steps[i];
+        if (status_led_step_steady(step)) {
+            uint32_t ticks = step->duration_ms * LED_TICKS_PER_MS;
+            steady_symbols += (ticks + 2 * LED_SYMBOL_MAX_TICKS - 1) / (2 * LED_SYMBOL_MAX_TICKS);
+        } else {
+            pwm_ms += step->duration_ms;
+        }
+    }
+    if (steady_symbols >= capacity) {
+        return STATUS_LED_PWM_PERIOD_MS; // Truncated either way
+    }
+    uint32_t period_ms = (pwm_ms + (capacity - steady_symbols) - 1) / (capacity - steady_symbols);
+    return period_ms > STATUS_LED_PWM_PERIOD_MS ? period_ms : STATUS_LED_PWM_PERIOD_MS;
+}
+
+static size_t status_led_encode(const led_pattern_t *pattern) {
+    // Full on and off steps become steady symbols, other levels one PWM symbol per period with a
+    // quadratic curve so that fades look even. Fades start from the previous step, the first one
+    // from the last step of the loop.
+    const uint32_t period_ms = status_led_pwm_period_ms(pattern);
+    const uint32_t period_ticks = period_ms * LED_TICKS_PER_MS;
+    uint8_t previous = pattern->steps[pattern->step_count - 1].level;
+    size_t count = 0;
+
+    for (uint8_t i = 0; i < pattern->step_count; i++) {
+        const led_step_t *step = &pattern->steps[i];
+        if (status_led_step_steady(step)) {
+            uint32_t ticks = step->duration_ms * LED_TICKS_PER_MS;
+            while (ticks > 0) {
+                uint32_t chunk = ticks < 2 * LED_SYMBOL_MAX_TICKS ? ticks : 2 * LED_SYMBOL_MAX_TICKS;
+                count = status_led_emit(count, step->level ? chunk : 0, step->level ? 0 : chunk);
+                ticks -= chunk;
+            }
+        } else {
+            uint32_t periods = step->duration_ms / period_ms;
+            periods = periods > 0 ? periods : 1;
+            for (uint32_t p = 0; p < periods; p++) {
+                int32_t level = step->fade ? previous + ((int32_t)step->level - previous) * (int32_t)(p + 1) / (int32_t)periods
+                                           : step->level;
+                uint32_t high_ticks = period_ticks * level * level / (100 * 100);
+                count = status_led_emit(count, high_ticks, period_ticks - high_ticks);
+            }
+        }
+        previous = step->level;
+    }
+
+    if (count >= sizeof(waveform) / sizeof(waveform[0])) {
+        ESP_LOGW(TAG, "Pattern truncated to %d symbols", (int)count);
+    }
+    return count;
+}
+
+static void status_led_apply(void) {
+    // Reprogram the channel with the top layer's pattern, the RMT loops it until the next change.
+    // Called with led_mutex held.
+    led_state_t state = LED_OFF;
+    for (int layer = LED_LAYER_MAX - 1; layer >= 0; layer--) {
+        if (layer_states[layer] < LED_MAX_STATES) {
+            state = layer_states[layer];
+            break;
+        }
+    }
+    if (state == shown_state || led_channel == NULL) {
+        return;
+    }
 
-static led_state_t current_led_state = LED_OFF;
-static int8_t led_iterator = 0;
+    size_t count = status_led_encode(&patterns[state]);
+    rmt_transmit_config_t transmit_config = {
+        .loop_count = -1, // Infinite, stopped by disabling the channel
+        .flags.eot_level = 0,
+    };
+    if (shown_state != LED_MAX_STATES) {
+        rmt_disable(led_channel);
+    }
+    esp_err_t err = rmt_enable(led_channel);
+    if (err == ESP_OK) {
+        err = rmt_transmit(led_channel, led_encoder, waveform, count * sizeof(rmt_symbol_word_t), &transmit_config);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot start LED pattern %d: %s", state, esp_err_to_name(err));
+        shown_state = LED_MAX_STATES;
+        rmt_disable(led_channel);
+        return;
+    }
+    shown_state = state;
+}
 
 void status_led_init(void) {
-    gpio_set_direction(GPIO_NUM_2, GPIO_MODE_OUTPUT); // Set GPIO pin as output
-    current_led_state = LED_OFF; // Initialize to OFF state
-    led_iterator = 0; // Initialize iterator
-    gpio_set_level(GPIO_NUM_2, 0); // Ensure LED is off initially
-    // Create the task
-    xTaskCreate(status_led_task, "status_led_task", 2048, NULL, 5, NULL);
+    led_mutex = KERNEL_MUTEX_CREATE();
+
+    rmt_tx_channel_config_t channel_config = {
+        .gpio_num = STATUS_LED_GPIO,
+#if CONFIG_IDF_TARGET_ESP32
+        .clk_src = RMT_CLK_SRC_REF_TICK, // Unaffected by DFS, no PM lock held while the pattern plays
+#else
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+#endif
+        .resolution_hz = STATUS_LED_RESOLUTION_HZ,
+        .mem_block_symbols = STATUS_LED_MEM_SYMBOLS,
+        .trans_queue_depth = 1,
+    };
+    rmt_copy_encoder_config_t encoder_config = {};
+    esp_err_t err = rmt_new_tx_channel(&channel_config, &led_channel);
+    if (err == ESP_OK) {
+        err = rmt_new_copy_encoder(&encoder_config, &led_encoder);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "RMT channel for the status LED failed: %s", esp_err_to_name(err));
+        led_channel = NULL;
+    }
+    status_led_set(LED_OFF);
+
     // Subscribe to events
     events_subscribe(EVENT_WIFI_CONNECTED, status_led_event_handler, NULL);
     events_subscribe(EVENT_WIFI_DISCONNECTED, status_led_event_handler, NULL);
     events_subscribe(EVENT_BUTTON_SHORT_PRESS, status_led_event_handler, NULL);
     events_subscribe(EVENT_BUTTON_LONG_PRESS, status_led_event_handler, NULL);
+    events_subscribe(EVENT_ALARM_RAISED, status_led_event_handler, NULL);
+    events_subscribe(EVENT_ALARM_CLEARED, status_led_event_handler, NULL);
+}
 
+void status_led_set_layer(led_layer_t layer, led_state_t led_state) {
+    if (layer >= LED_LAYER_MAX) {
+        return;
+    }
+    xSemaphoreTake(led_mutex, portMAX_DELAY);
+    layer_states[layer] = led_state < LED_MAX_STATES ? led_state : LED_MAX_STATES;
+    status_led_apply();
+    xSemaphoreGive(led_mutex);
 }
 
 void status_led_set(led_state_t led_state) {
     if (led_state >= LED_MAX_STATES) {
         led_state = LED_OFF; // Default to OFF if invalid state
     }
-    current_led_state = led_state;
+    status_led_set_layer(LED_LAYER_CONNECTIVITY, led_state);
 }
 
-void status_led_task(void *pvParameter) {
-    while (1) {
-        gpio_set_level(GPIO_NUM_2, (state_bit_masks[current_led_state] >> led_iterator) & 0x01);
-        led_iterator = (led_iterator + 1) % 16; // Cycle through the bits
-        vTaskDelay(pdMS_TO_TICKS(1000 / 16)); // Adjust delay as needed
-    }
+led_state_t status_led_get(void) {
+    return shown_state;
 }
 
 void status_led_event_handler(void* handler_arg, esp_event_base_t base, int32_t id, void* event_data) {
@@ -52,16 +231,29 @@ void status_led_event_handler(void* handler_arg, esp_event_base_t base, int32_t
             break;
         case EVENT_BUTTON_SHORT_PRESS:
             // Toggle between SLOW and FAST blink on short press
-            if (current_led_state == LED_SLOW_BLINK) {
+            if (!button_event_is(event_data, BUTTON_ID_MAIN) || menu_owns_button(event_data)) {
+                break;
+            }
+            if (layer_states[LED_LAYER_CONNECTIVITY] == LED_SLOW_BLINK) {
                 status_led_set(LED_FAST_BLINK);
             } else {
                 status_led_set(LED_SLOW_BLINK);
             }
             break;
         case EVENT_BUTTON_LONG_PRESS:
-            status_led_set(LED_THREE_BLINK); // Set to three blink on long press
+            if (button_event_is(event_data, BUTTON_ID_MAIN) && !menu_owns_button(event_data)) {
+                status_led_set(LED_THREE_BLINK); // Set to three blink on long press
+            }
+            break;
+        case EVENT_ALARM_RAISED:
+            status_led_set_layer(LED_LAYER_ALARM, LED_ERROR); // Shown over the connectivity pattern
+            break;
+        case EVENT_ALARM_CLEARED:
+            if (alarm_get_active_count() == 0) {
+                status_led_set_layer(LED_LAYER_ALARM, LED_MAX_STATES); // Back to the connectivity pattern
+            }
             break;
         default:
             break;
     }
-}
\ No newline at end of file
+}
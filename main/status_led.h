@@ -2,10 +2,21 @@
 #define STATUS_LED_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
+#include "soc/soc_caps.h"
 #include "events.h"
 
+#define STATUS_LED_GPIO GPIO_NUM_2
+#define STATUS_LED_RESOLUTION_HZ 10000  // RMT tick of 100 us
+// Channel memory, a looped pattern has to fit in it: up to four memory blocks, two on the
+// targets with only two TX channels (48 words each on the ESP32-C3), 256 symbols on the ESP32
+#define STATUS_LED_MEM_BLOCKS (SOC_RMT_TX_CANDIDATES_PER_GROUP < 4 ? SOC_RMT_TX_CANDIDATES_PER_GROUP : 4)
+#define STATUS_LED_MEM_SYMBOLS (SOC_RMT_MEM_WORDS_PER_CHANNEL * STATUS_LED_MEM_BLOCKS)
+#define STATUS_LED_PWM_PERIOD_MS 10     // One symbol per period on brightness levels between off and on,
+                                        // longer when a pattern would not fit the channel memory
+
 typedef enum {
     LED_OK = 0,
     LED_FAST_BLINK,
@@ -13,12 +24,32 @@ typedef enum {
     LED_OFF,
     LED_ERROR,
     LED_THREE_BLINK,
+    LED_BREATHE,        // Fades in and out, 2 s period
+    LED_DIM,            // Steady at low brightness
     LED_MAX_STATES
 } led_state_t;
 
-void status_led_task(void *pvParameter);
+// Pattern layers, the highest layer with a pattern is shown
+typedef enum {
+    LED_LAYER_CONNECTIVITY = 0,
+    LED_LAYER_ALARM,
+    LED_LAYER_MAX
+} led_layer_t;
+
+// One step of a pattern: reach the brightness (0-100 %) and hold it, or fade to it
+typedef struct {
+    uint8_t level;
+    bool fade;
+    uint16_t duration_ms;
+} led_step_t;
+
 void status_led_init(void);
+// Set the connectivity layer pattern.
 void status_led_set(led_state_t led_state);
+// Set the pattern of a layer, LED_MAX_STATES clears the layer.
+void status_led_set_layer(led_layer_t layer, led_state_t led_state);
+// Get the pattern on the LED.
+led_state_t status_led_get(void);
 void status_led_event_handler(void* handler_arg, esp_event_base_t base, int32_t id, void* event_data);
 
 #endif // STATUS_LED_H
\ No newline at end of file
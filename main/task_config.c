@@ -0,0 +1,90 @@
+#include "task_config.h"
+#include "esp_log.h"
+
+static const char *TAG = "task_config";
+
+// Negative or missing cores leave the task to the scheduler
+#define TASK_CORE(core) ((core) >= 0 && (core) < portNUM_PROCESSORS ? (core) : tskNO_AFFINITY)
+
+static const task_config_t task_configs[TASK_ID_MAX] = {
+    [TASK_ID_TEMPERATURE] = {
+        "temperature_task", CONFIG_TASK_TEMPERATURE_STACK, CONFIG_TASK_TEMPERATURE_PRIORITY,
+        TASK_CORE(CONFIG_TASK_TEMPERATURE_CORE) },
+    [TASK_ID_LCD_UPDATE] = {
+        "lcd_update_task", CONFIG_TASK_LCD_STACK, CONFIG_TASK_LCD_PRIORITY, TASK_CORE(CONFIG_TASK_LCD_CORE) },
+    [TASK_ID_BUTTON] = {
+        "button_task", CONFIG_TASK_BUTTON_STACK, CONFIG_TASK_BUTTON_PRIORITY, TASK_CORE(CONFIG_TASK_BUTTON_CORE) },
+    [TASK_ID_DNS_SERVER] = {
+        "dns_server_task", CONFIG_TASK_DNS_STACK, CONFIG_TASK_DNS_PRIORITY, TASK_CORE(CONFIG_TASK_DNS_CORE) },
+    [TASK_ID_EVENT_LOOP] = {
+        "custom_evt_loop", CONFIG_TASK_EVENTS_STACK, CONFIG_TASK_EVENTS_PRIORITY, TASK_CORE(CONFIG_TASK_EVENTS_CORE) },
+    [TASK_ID_APPLICATION] = {
+        "application_task", CONFIG_TASK_EVENTS_STACK, CONFIG_TASK_EVENTS_PRIORITY + 1, TASK_CORE(CONFIG_TASK_EVENTS_CORE) },
+    [TASK_ID_CLI] = {
+        "cli_task", CONFIG_TASK_CLI_STACK, CONFIG_TASK_CLI_PRIORITY, TASK_CORE(CONFIG_TASK_CLI_CORE) },
+#if CONFIG_ADC_STREAM_ENABLE
+    [TASK_ID_ADC_STREAM] = {
+        "adc_stream_task", CONFIG_TASK_STREAM_STACK, CONFIG_TASK_STREAM_PRIORITY,
+        TASK_CORE(CONFIG_TASK_STREAM_CORE) },
+#else
+    [TASK_ID_ADC_STREAM] = { "adc_stream_task", 0, 0, tskNO_AFFINITY },
+#endif
+};
+
+#if CONFIG_STATIC_ALLOCATION
+// Stacks in bytes as on ESP-IDF, where StackType_t is a byte
+static StackType_t temperature_stack[CONFIG_TASK_TEMPERATURE_STACK / sizeof(StackType_t)];
+static StackType_t lcd_stack[CONFIG_TASK_LCD_STACK / sizeof(StackType_t)];
+static StackType_t button_stack[CONFIG_TASK_BUTTON_STACK / sizeof(StackType_t)];
+static StackType_t dns_stack[CONFIG_TASK_DNS_STACK / sizeof(StackType_t)];
+static StackType_t application_stack[CONFIG_TASK_EVENTS_STACK / sizeof(StackType_t)];
+static StackType_t cli_stack[CONFIG_TASK_CLI_STACK / sizeof(StackType_t)];
+#if CONFIG_ADC_STREAM_ENABLE
+static StackType_t stream_stack[CONFIG_TASK_STREAM_STACK / sizeof(StackType_t)];
+#else
+#define stream_stack NULL // Not built in
+#endif
+
+static StackType_t *const task_stacks[TASK_ID_MAX] = {
+    [TASK_ID_TEMPERATURE] = temperature_stack,
+    [TASK_ID_LCD_UPDATE] = lcd_stack,
+    [TASK_ID_BUTTON] = button_stack,
+    [TASK_ID_DNS_SERVER] = dns_stack,
+    [TASK_ID_EVENT_LOOP] = NULL, // Not created, the application task runs the loop
+    [TASK_ID_APPLICATION] = application_stack,
+    [TASK_ID_CLI] = cli_stack,
+    [TASK_ID_ADC_STREAM] = stream_stack,
+};
+static StaticTask_t task_buffers[TASK_ID_MAX];
+#endif
+
+const task_config_t *task_get_config(task_id_t id) {
+    return id < TASK_ID_MAX ? &task_configs[id] : NULL;
+}
+
+BaseType_t task_create(task_id_t id, TaskFunction_t function, void *arg, TaskHandle_t *handle) {
+    const task_config_t *config = task_get_config(id);
+    if (config == NULL) {
+        return pdFAIL;
+    }
+
+#if CONFIG_STATIC_ALLOCATION
+    if (task_stacks[id] == NULL) {
+        return pdFAIL;
+    }
+    TaskHandle_t task = xTaskCreateStaticPinnedToCore(function, config->name, config->stack_size, arg,
+                                                      config->priority, task_stacks[id], &task_buffers[id],
+                                                      config->core);
+    if (handle != NULL) {
+        *handle = task;
+    }
+    BaseType_t created = task != NULL ? pdPASS : pdFAIL;
+#else
+    BaseType_t created = xTaskCreatePinnedToCore(function, config->name, config->stack_size, arg, config->priority,
+                                                 handle, config->core);
+#endif
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create %s (%lu bytes stack)", config->name, (unsigned long)config->stack_size);
+    }
+    return created;
+}
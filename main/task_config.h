@@ -0,0 +1,68 @@
+#ifndef TASK_CONFIG_H
+#define TASK_CONFIG_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+// Application tasks. Sampling has a core of its own, network and event work share the core
+// of the Wi-Fi driver (core 0 on the ESP32), the display runs below sampling on core 1.
+typedef enum {
+    TASK_ID_TEMPERATURE = 0,    // ADC frames to temperatures, alarms and history
+    TASK_ID_LCD_UPDATE,         // Renders the screens over I2C
+    TASK_ID_BUTTON,             // Gesture classification
+    TASK_ID_DNS_SERVER,         // Captive portal DNS, AP mode only
+    TASK_ID_EVENT_LOOP,         // Dispatch task of the custom event loop
+    TASK_ID_APPLICATION,        // Runs the custom event loop handlers
+    TASK_ID_CLI,                // Console sessions on the UART and TCP
+    TASK_ID_ADC_STREAM,         // Raw ADC capture to the UART or TCP, CONFIG_ADC_STREAM_ENABLE only
+    TASK_ID_MAX
+} task_id_t;
+
+// Kernel objects owned by the firmware. With CONFIG_STATIC_ALLOCATION every use site gets its own
+// static storage, so an object is created once and never deleted.
+#if CONFIG_STATIC_ALLOCATION
+#define KERNEL_MUTEX_CREATE() \
+    ({ static StaticSemaphore_t mutex_buffer; xSemaphoreCreateMutexStatic(&mutex_buffer); })
+#define KERNEL_QUEUE_CREATE(length, item_size) \
+    ({ static StaticQueue_t queue_buffer; static uint8_t queue_storage[(length) * (item_size)]; \
+       xQueueCreateStatic((length), (item_size), queue_storage, &queue_buffer); })
+#define KERNEL_EVENT_GROUP_CREATE() \
+    ({ static StaticEventGroup_t group_buffer; xEventGroupCreateStatic(&group_buffer); })
+#else
+#define KERNEL_MUTEX_CREATE() xSemaphoreCreateMutex()
+#define KERNEL_QUEUE_CREATE(length, item_size) xQueueCreate((length), (item_size))
+#define KERNEL_EVENT_GROUP_CREATE() xEventGroupCreate()
+#endif
+
+typedef struct {
+    const char *name;           // Task name, statistics find the task by it
+    uint32_t stack_size;        // Bytes
+    UBaseType_t priority;
+    BaseType_t core;            // Core number or tskNO_AFFINITY
+} task_config_t;
+
+/**
+ * @brief Get the stack, priority and core of a task, from Kconfig.
+ * @return Entry of the task table, NULL for an unknown task.
+ */
+const task_config_t *task_get_config(task_id_t id);
+
+/**
+ * @brief Create a task as planned in the task table.
+ *
+ * With CONFIG_STATIC_ALLOCATION the stack and control block are static, one set per task:
+ * a task is created once, or again only after it deleted itself.
+ *
+ * @param id       Task to create.
+ * @param function Task function.
+ * @param arg      Argument of the task function.
+ * @param handle   Created task, may be NULL.
+ * @return pdPASS, or pdFAIL if the task could not be created.
+ */
+BaseType_t task_create(task_id_t id, TaskFunction_t function, void *arg, TaskHandle_t *handle);
+
+#endif // TASK_CONFIG_H
@@ -1,8 +1,21 @@
 #include "wifi_manager.h"
+#include "power_manager.h"
+#include "esp_timer.h"
+#include "button_manager.h"
+#include "menu.h"
 
 //EventGroupHandle_t wifi_event_group;
 static const char *TAG = "wifi_ap";
 static bool ap_enabled = false;
+static esp_timer_handle_t rssi_timer = NULL;
+
+static void rssi_timer_callback(void *arg) {
+    // Signal strength of the connected AP for the running state, stopped while disconnected
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+        state_set_rssi(ap_info.rssi);
+    }
+}
 
 static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data) {
     if (event_base == WIFI_EVENT) {
@@ -27,6 +40,13 @@ static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_
                         break;
                 }
 
+                state_set_wifi_sta_connection_state(disconnected->reason);
+                state_set_ip_address(0);
+                state_set_rssi(0);
+                if (rssi_timer != NULL) {
+                    esp_timer_stop(rssi_timer);
+                }
+
                 // Trigger EVENT_WIFI_DISCONNECTED
                 events_post(EVENT_WIFI_DISCONNECTED, &disconnected->reason, sizeof(disconnected->reason));
 
@@ -40,6 +60,13 @@ static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
         ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
+        state_set_wifi_sta_connection_state(0);
+        state_set_ip_address(event->ip_info.ip.addr);
+        if (rssi_timer != NULL) {
+            rssi_timer_callback(NULL);
+            esp_timer_stop(rssi_timer);
+            esp_timer_start_periodic(rssi_timer, (uint64_t)CONFIG_WIFI_RSSI_POLL_S * 1000000);
+        }
         // Trigger EVENT_WIFI_CONNECTED
         events_post(EVENT_WIFI_CONNECTED, &event->ip_info.ip, sizeof(event->ip_info.ip));
     }
@@ -65,12 +92,23 @@ void wifi_sta_init(void) {
     ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &event_handler, NULL, &instance_any_id));
     ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &event_handler, NULL, &instance_got_ip));
 
+    if (CONFIG_WIFI_RSSI_POLL_S > 0) {
+        esp_timer_create_args_t rssi_timer_args = {
+            .callback = rssi_timer_callback,
+            .name = "rssi_timer",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&rssi_timer_args, &rssi_timer));
+    }
+
     // Configure WiFi STA settings
     wifi_config_t wifi_config = {
         .sta = {
             .ssid = "",
             .password = "",
             .threshold.authmode = WIFI_AUTH_WPA2_PSK,
+#if CONFIG_POWER_WIFI_PS_MAX_MODEM
+            .listen_interval = CONFIG_POWER_WIFI_LISTEN_INTERVAL,
+#endif
         },
     };
 
@@ -80,6 +118,7 @@ void wifi_sta_init(void) {
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
+    power_apply_wifi_ps(); // Modem sleep while connected as station
 
     ESP_LOGI(TAG, "WiFi STA initialized and connecting...");
 }
@@ -120,8 +159,10 @@ void enable_ap_mode(void) {
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_APSTA));
     ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_AP, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
+    power_disable_wifi_ps(); // Soft AP needs the radio awake
 
     ESP_LOGI(TAG, "WiFi AP enabled with SSID: %s", config->ap_ssid);
+    state_set_wifi_ap_mode(true);
 
     // Starting DNS server
     cp_start_dns_server();
@@ -132,6 +173,9 @@ void enable_ap_mode(void) {
 }
 
 static void _wifi_button_long_press_event_handler(void* handler_arg, esp_event_base_t base, int32_t id, void* event_data) {
+    if (!button_event_is(event_data, BUTTON_ID_MAIN) || menu_owns_button(event_data)) {
+        return; // Long presses edit the settings while the menu is open
+    }
     ESP_LOGI(TAG, "Long press detected, switching to AP mode...");
     if (!ap_enabled) {
         ap_enabled = true;